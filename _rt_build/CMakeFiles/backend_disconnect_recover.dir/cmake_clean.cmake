@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/backend_disconnect_recover.dir/test/backend_disconnect_recover.c.o"
+  "CMakeFiles/backend_disconnect_recover.dir/test/backend_disconnect_recover.c.o.d"
+  "backend_disconnect_recover"
+  "backend_disconnect_recover.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/backend_disconnect_recover.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/benchmarks.dir/benchmarks/benchmarks.c.o"
+  "CMakeFiles/benchmarks.dir/benchmarks/benchmarks.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/benchmarks.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/channel_layout.c.o"
+  "CMakeFiles/benchmarks.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/channel_mixer.c.o"
+  "CMakeFiles/benchmarks.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/convert.c.o"
+  "CMakeFiles/benchmarks.dir/src/convert.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/dummy.c.o"
+  "CMakeFiles/benchmarks.dir/src/dummy.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/benchmarks.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/meter.c.o"
+  "CMakeFiles/benchmarks.dir/src/meter.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/benchmarks.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/os.c.o"
+  "CMakeFiles/benchmarks.dir/src/os.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/remote.c.o"
+  "CMakeFiles/benchmarks.dir/src/remote.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/ring_buffer.c.o"
+  "CMakeFiles/benchmarks.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/rt_guard.c.o"
+  "CMakeFiles/benchmarks.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/scheduler.c.o"
+  "CMakeFiles/benchmarks.dir/src/scheduler.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/benchmarks.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/soundio.c.o"
+  "CMakeFiles/benchmarks.dir/src/soundio.c.o.d"
+  "CMakeFiles/benchmarks.dir/src/util.c.o"
+  "CMakeFiles/benchmarks.dir/src/util.c.o.d"
+  "benchmarks"
+  "benchmarks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/benchmarks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,35 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/broadcast_ring_buffer.c" "CMakeFiles/latency.dir/src/broadcast_ring_buffer.c.o" "gcc" "CMakeFiles/latency.dir/src/broadcast_ring_buffer.c.o.d"
+  "/root/repo/src/channel_layout.c" "CMakeFiles/latency.dir/src/channel_layout.c.o" "gcc" "CMakeFiles/latency.dir/src/channel_layout.c.o.d"
+  "/root/repo/src/channel_mixer.c" "CMakeFiles/latency.dir/src/channel_mixer.c.o" "gcc" "CMakeFiles/latency.dir/src/channel_mixer.c.o.d"
+  "/root/repo/src/convert.c" "CMakeFiles/latency.dir/src/convert.c.o" "gcc" "CMakeFiles/latency.dir/src/convert.c.o.d"
+  "/root/repo/src/dummy.c" "CMakeFiles/latency.dir/src/dummy.c.o" "gcc" "CMakeFiles/latency.dir/src/dummy.c.o.d"
+  "/root/repo/src/frame_ring_buffer.c" "CMakeFiles/latency.dir/src/frame_ring_buffer.c.o" "gcc" "CMakeFiles/latency.dir/src/frame_ring_buffer.c.o.d"
+  "/root/repo/src/meter.c" "CMakeFiles/latency.dir/src/meter.c.o" "gcc" "CMakeFiles/latency.dir/src/meter.c.o.d"
+  "/root/repo/src/mpsc_queue.c" "CMakeFiles/latency.dir/src/mpsc_queue.c.o" "gcc" "CMakeFiles/latency.dir/src/mpsc_queue.c.o.d"
+  "/root/repo/src/os.c" "CMakeFiles/latency.dir/src/os.c.o" "gcc" "CMakeFiles/latency.dir/src/os.c.o.d"
+  "/root/repo/src/remote.c" "CMakeFiles/latency.dir/src/remote.c.o" "gcc" "CMakeFiles/latency.dir/src/remote.c.o.d"
+  "/root/repo/src/ring_buffer.c" "CMakeFiles/latency.dir/src/ring_buffer.c.o" "gcc" "CMakeFiles/latency.dir/src/ring_buffer.c.o.d"
+  "/root/repo/src/rt_guard.c" "CMakeFiles/latency.dir/src/rt_guard.c.o" "gcc" "CMakeFiles/latency.dir/src/rt_guard.c.o.d"
+  "/root/repo/src/scheduler.c" "CMakeFiles/latency.dir/src/scheduler.c.o" "gcc" "CMakeFiles/latency.dir/src/scheduler.c.o.d"
+  "/root/repo/src/shared_ring_buffer.c" "CMakeFiles/latency.dir/src/shared_ring_buffer.c.o" "gcc" "CMakeFiles/latency.dir/src/shared_ring_buffer.c.o.d"
+  "/root/repo/src/soundio.c" "CMakeFiles/latency.dir/src/soundio.c.o" "gcc" "CMakeFiles/latency.dir/src/soundio.c.o.d"
+  "/root/repo/src/util.c" "CMakeFiles/latency.dir/src/util.c.o" "gcc" "CMakeFiles/latency.dir/src/util.c.o.d"
+  "/root/repo/test/latency.c" "CMakeFiles/latency.dir/test/latency.c.o" "gcc" "CMakeFiles/latency.dir/test/latency.c.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
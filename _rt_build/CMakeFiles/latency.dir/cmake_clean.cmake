@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/latency.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/latency.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/latency.dir/src/channel_layout.c.o"
+  "CMakeFiles/latency.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/latency.dir/src/channel_mixer.c.o"
+  "CMakeFiles/latency.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/latency.dir/src/convert.c.o"
+  "CMakeFiles/latency.dir/src/convert.c.o.d"
+  "CMakeFiles/latency.dir/src/dummy.c.o"
+  "CMakeFiles/latency.dir/src/dummy.c.o.d"
+  "CMakeFiles/latency.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/latency.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/latency.dir/src/meter.c.o"
+  "CMakeFiles/latency.dir/src/meter.c.o.d"
+  "CMakeFiles/latency.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/latency.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/latency.dir/src/os.c.o"
+  "CMakeFiles/latency.dir/src/os.c.o.d"
+  "CMakeFiles/latency.dir/src/remote.c.o"
+  "CMakeFiles/latency.dir/src/remote.c.o.d"
+  "CMakeFiles/latency.dir/src/ring_buffer.c.o"
+  "CMakeFiles/latency.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/latency.dir/src/rt_guard.c.o"
+  "CMakeFiles/latency.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/latency.dir/src/scheduler.c.o"
+  "CMakeFiles/latency.dir/src/scheduler.c.o.d"
+  "CMakeFiles/latency.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/latency.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/latency.dir/src/soundio.c.o"
+  "CMakeFiles/latency.dir/src/soundio.c.o.d"
+  "CMakeFiles/latency.dir/src/util.c.o"
+  "CMakeFiles/latency.dir/src/util.c.o.d"
+  "CMakeFiles/latency.dir/test/latency.c.o"
+  "CMakeFiles/latency.dir/test/latency.c.o.d"
+  "latency"
+  "latency.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/latency.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
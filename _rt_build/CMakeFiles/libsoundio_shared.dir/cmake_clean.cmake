@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libsoundio_shared.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/channel_layout.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/channel_mixer.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/convert.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/convert.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/dummy.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/dummy.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/meter.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/meter.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/os.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/os.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/remote.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/remote.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/ring_buffer.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/rt_guard.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/scheduler.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/scheduler.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/soundio.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/soundio.c.o.d"
+  "CMakeFiles/libsoundio_shared.dir/src/util.c.o"
+  "CMakeFiles/libsoundio_shared.dir/src/util.c.o.d"
+  "libsoundio.pdb"
+  "libsoundio.so"
+  "libsoundio.so.1"
+  "libsoundio.so.1.1.0"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/libsoundio_shared.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,41 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/libsoundio_static.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/channel_layout.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/channel_mixer.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/convert.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/convert.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/dummy.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/dummy.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/meter.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/meter.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/os.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/os.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/remote.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/remote.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/ring_buffer.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/rt_guard.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/scheduler.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/scheduler.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/soundio.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/soundio.c.o.d"
+  "CMakeFiles/libsoundio_static.dir/src/util.c.o"
+  "CMakeFiles/libsoundio_static.dir/src/util.c.o.d"
+  "libsoundio.a"
+  "libsoundio.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/libsoundio_static.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
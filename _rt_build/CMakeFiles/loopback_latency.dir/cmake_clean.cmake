@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/loopback_latency.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/loopback_latency.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/channel_layout.c.o"
+  "CMakeFiles/loopback_latency.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/channel_mixer.c.o"
+  "CMakeFiles/loopback_latency.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/convert.c.o"
+  "CMakeFiles/loopback_latency.dir/src/convert.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/dummy.c.o"
+  "CMakeFiles/loopback_latency.dir/src/dummy.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/loopback_latency.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/meter.c.o"
+  "CMakeFiles/loopback_latency.dir/src/meter.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/loopback_latency.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/os.c.o"
+  "CMakeFiles/loopback_latency.dir/src/os.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/remote.c.o"
+  "CMakeFiles/loopback_latency.dir/src/remote.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/ring_buffer.c.o"
+  "CMakeFiles/loopback_latency.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/rt_guard.c.o"
+  "CMakeFiles/loopback_latency.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/scheduler.c.o"
+  "CMakeFiles/loopback_latency.dir/src/scheduler.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/loopback_latency.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/soundio.c.o"
+  "CMakeFiles/loopback_latency.dir/src/soundio.c.o.d"
+  "CMakeFiles/loopback_latency.dir/src/util.c.o"
+  "CMakeFiles/loopback_latency.dir/src/util.c.o.d"
+  "CMakeFiles/loopback_latency.dir/test/loopback_latency.c.o"
+  "CMakeFiles/loopback_latency.dir/test/loopback_latency.c.o.d"
+  "loopback_latency"
+  "loopback_latency.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/loopback_latency.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/overflow.dir/test/overflow.c.o"
+  "CMakeFiles/overflow.dir/test/overflow.c.o.d"
+  "overflow"
+  "overflow.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/overflow.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sio_list_devices.dir/example/sio_list_devices.c.o"
+  "CMakeFiles/sio_list_devices.dir/example/sio_list_devices.c.o.d"
+  "sio_list_devices"
+  "sio_list_devices.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sio_list_devices.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sio_microphone.dir/example/sio_microphone.c.o"
+  "CMakeFiles/sio_microphone.dir/example/sio_microphone.c.o.d"
+  "sio_microphone"
+  "sio_microphone.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sio_microphone.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
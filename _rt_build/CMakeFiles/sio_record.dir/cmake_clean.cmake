@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sio_record.dir/example/sio_record.c.o"
+  "CMakeFiles/sio_record.dir/example/sio_record.c.o.d"
+  "sio_record"
+  "sio_record.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sio_record.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sio_sine.dir/example/sio_sine.c.o"
+  "CMakeFiles/sio_sine.dir/example/sio_sine.c.o.d"
+  "sio_sine"
+  "sio_sine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/sio_sine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
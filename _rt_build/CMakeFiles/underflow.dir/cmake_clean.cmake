@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/underflow.dir/test/underflow.c.o"
+  "CMakeFiles/underflow.dir/test/underflow.c.o.d"
+  "underflow"
+  "underflow.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/underflow.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,43 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/unit_tests.dir/src/broadcast_ring_buffer.c.o"
+  "CMakeFiles/unit_tests.dir/src/broadcast_ring_buffer.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/channel_layout.c.o"
+  "CMakeFiles/unit_tests.dir/src/channel_layout.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/channel_mixer.c.o"
+  "CMakeFiles/unit_tests.dir/src/channel_mixer.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/convert.c.o"
+  "CMakeFiles/unit_tests.dir/src/convert.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/dummy.c.o"
+  "CMakeFiles/unit_tests.dir/src/dummy.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/frame_ring_buffer.c.o"
+  "CMakeFiles/unit_tests.dir/src/frame_ring_buffer.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/meter.c.o"
+  "CMakeFiles/unit_tests.dir/src/meter.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/mpsc_queue.c.o"
+  "CMakeFiles/unit_tests.dir/src/mpsc_queue.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/os.c.o"
+  "CMakeFiles/unit_tests.dir/src/os.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/remote.c.o"
+  "CMakeFiles/unit_tests.dir/src/remote.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/ring_buffer.c.o"
+  "CMakeFiles/unit_tests.dir/src/ring_buffer.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/rt_guard.c.o"
+  "CMakeFiles/unit_tests.dir/src/rt_guard.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/scheduler.c.o"
+  "CMakeFiles/unit_tests.dir/src/scheduler.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/shared_ring_buffer.c.o"
+  "CMakeFiles/unit_tests.dir/src/shared_ring_buffer.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/soundio.c.o"
+  "CMakeFiles/unit_tests.dir/src/soundio.c.o.d"
+  "CMakeFiles/unit_tests.dir/src/util.c.o"
+  "CMakeFiles/unit_tests.dir/src/util.c.o.d"
+  "CMakeFiles/unit_tests.dir/test/unit_tests.c.o"
+  "CMakeFiles/unit_tests.dir/test/unit_tests.c.o.d"
+  "unit_tests"
+  "unit_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/unit_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_CONFIG_H
+#define SOUNDIO_CONFIG_H
+
+#define SOUNDIO_VERSION_MAJOR 1
+#define SOUNDIO_VERSION_MINOR 1
+#define SOUNDIO_VERSION_PATCH 0
+#define SOUNDIO_VERSION_STRING "1.1.0"
+
+/* #undef SOUNDIO_HAVE_JACK */
+/* #undef SOUNDIO_HAVE_PULSEAUDIO */
+/* #undef SOUNDIO_HAVE_ALSA */
+/* #undef SOUNDIO_HAVE_COREAUDIO */
+/* #undef SOUNDIO_HAVE_WASAPI */
+/* #undef SOUNDIO_HAVE_ANDROID */
+/* #undef SOUNDIO_HAVE_PIPEWIRE */
+#define SOUNDIO_RT_GUARD
+
+#endif
@@ -0,0 +1,649 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Repeatable performance measurements, printed as JSON on stdout so that
+// results from different releases can be compared by a script.
+
+#include "soundio_private.h"
+#include "ring_buffer.h"
+#include "os.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+static int usage(char *exe) {
+    fprintf(stderr, "Usage: %s [options]\n"
+            "Options:\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]  may be repeated; default dummy\n"
+            "  [--duration seconds]  per stream benchmark; default 2\n"
+            "  [--latency seconds]  default 0.01\n"
+            "  [--only ring_buffer|sample_write|convert|recovery|streams]\n", exe);
+    return 1;
+}
+
+static void print_json_string(const char *str) {
+    putchar('"');
+    for (const char *c = str; *c; c += 1) {
+        if (*c == '"' || *c == '\\')
+            printf("\\%c", *c);
+        else if ((unsigned char)*c < 0x20)
+            printf("\\u%04x", *c);
+        else
+            putchar(*c);
+    }
+    putchar('"');
+}
+
+struct RingBufferBench {
+    struct SoundIoRingBuffer ring_buffer;
+    int chunk_bytes;
+    long total_bytes;
+    int cpu;
+};
+
+static void ring_buffer_producer_run(void *arg) {
+    struct RingBufferBench *bench = (struct RingBufferBench *)arg;
+    char chunk[16384];
+    memset(chunk, 0x55, sizeof(chunk));
+    if (bench->cpu >= 0)
+        soundio_os_pin_current_thread(bench->cpu);
+
+    long written = 0;
+    while (written < bench->total_bytes) {
+        if (soundio_ring_buffer_free_count(&bench->ring_buffer) < bench->chunk_bytes)
+            continue;
+        memcpy(soundio_ring_buffer_write_ptr(&bench->ring_buffer), chunk, bench->chunk_bytes);
+        soundio_ring_buffer_advance_write_ptr(&bench->ring_buffer, bench->chunk_bytes);
+        written += bench->chunk_bytes;
+    }
+}
+
+// Producer and consumer on different cores, both spinning, so that the
+// result is bounded by the ring buffer and cache traffic rather than by
+// scheduling.
+static void bench_ring_buffer(void) {
+    static const int chunk_sizes[] = {64, 1024, 16384};
+    int cpu_count = soundio_os_cpu_count();
+    char chunk[16384];
+
+    printf("  \"ring_buffer\": [");
+    for (int i = 0; i < (int)ARRAY_LENGTH(chunk_sizes); i += 1) {
+        struct RingBufferBench bench;
+        int err;
+        if ((err = soundio_ring_buffer_init(&bench.ring_buffer, 64 * 1024)))
+            soundio_panic("ring buffer init: %s", soundio_error_name(err));
+        bench.chunk_bytes = chunk_sizes[i];
+        bench.total_bytes = 256L * 1024 * 1024;
+        bench.cpu = (cpu_count > 1) ? 1 : -1;
+        if (cpu_count > 1)
+            soundio_os_pin_current_thread(0);
+
+        double start = soundio_os_get_time();
+        struct SoundIoOsThread *thread;
+        if ((err = soundio_os_thread_create(ring_buffer_producer_run, &bench, NULL, &thread)))
+            soundio_panic("thread create: %s", soundio_error_name(err));
+        long read = 0;
+        while (read < bench.total_bytes) {
+            if (soundio_ring_buffer_fill_count(&bench.ring_buffer) < bench.chunk_bytes)
+                continue;
+            memcpy(chunk, soundio_ring_buffer_read_ptr(&bench.ring_buffer), bench.chunk_bytes);
+            soundio_ring_buffer_advance_read_ptr(&bench.ring_buffer, bench.chunk_bytes);
+            read += bench.chunk_bytes;
+        }
+        double elapsed = soundio_os_get_time() - start;
+        soundio_os_thread_destroy(thread);
+        soundio_ring_buffer_deinit(&bench.ring_buffer);
+
+        printf("%s\n    {\"chunk_bytes\": %d, \"bytes_per_second\": %.0f, \"cross_core\": %s}",
+                (i == 0) ? "" : ",", bench.chunk_bytes, read / elapsed,
+                (cpu_count > 1) ? "true" : "false");
+    }
+    printf("\n  ],\n");
+}
+
+static void write_sample_s8(char *ptr, double sample) {
+    *(int8_t *)ptr = sample * INT8_MAX;
+}
+
+static void write_sample_u8(char *ptr, double sample) {
+    *(uint8_t *)ptr = (sample + 1.0) * 127.5;
+}
+
+static void write_sample_s16ne(char *ptr, double sample) {
+    *(int16_t *)ptr = sample * INT16_MAX;
+}
+
+static void write_sample_u16ne(char *ptr, double sample) {
+    *(uint16_t *)ptr = (sample + 1.0) * 32767.5;
+}
+
+static void write_sample_s24ne(char *ptr, double sample) {
+    *(int32_t *)ptr = sample * 8388607.0;
+}
+
+static void write_sample_s32ne(char *ptr, double sample) {
+    *(int32_t *)ptr = sample * INT32_MAX;
+}
+
+static void write_sample_u32ne(char *ptr, double sample) {
+    *(uint32_t *)ptr = (sample + 1.0) * 2147483647.5;
+}
+
+static void write_sample_float32ne(char *ptr, double sample) {
+    *(float *)ptr = sample;
+}
+
+static void write_sample_float64ne(char *ptr, double sample) {
+    *(double *)ptr = sample;
+}
+
+struct SampleWriter {
+    enum SoundIoFormat format;
+    void (*write_sample)(char *ptr, double sample);
+};
+
+static const struct SampleWriter sample_writers[] = {
+    {SoundIoFormatS8, write_sample_s8},
+    {SoundIoFormatU8, write_sample_u8},
+    {SoundIoFormatS16NE, write_sample_s16ne},
+    {SoundIoFormatU16NE, write_sample_u16ne},
+    {SoundIoFormatS24NE, write_sample_s24ne},
+    {SoundIoFormatS32NE, write_sample_s32ne},
+    {SoundIoFormatU32NE, write_sample_u32ne},
+    {SoundIoFormatFloat32NE, write_sample_float32ne},
+    {SoundIoFormatFloat64NE, write_sample_float64ne},
+};
+
+// Cost of storing a double sample into each native endian format through a
+// stereo interleaved channel area, the way the example programs do it.
+static void bench_sample_write(void) {
+    const int frame_count = 512 * 1024;
+    const int repeat = 20;
+    const int channel_count = 2;
+    double *source = ALLOCATE_NONZERO(double, frame_count);
+    char *dest = ALLOCATE_NONZERO(char, frame_count * channel_count * 8);
+    if (!source || !dest)
+        soundio_panic("out of memory");
+    for (int i = 0; i < frame_count; i += 1)
+        source[i] = ((i % 200) - 100) / 100.0;
+
+    printf("  \"sample_write\": [");
+    for (int i = 0; i < (int)ARRAY_LENGTH(sample_writers); i += 1) {
+        const struct SampleWriter *writer = &sample_writers[i];
+        int bytes_per_sample = soundio_get_bytes_per_sample(writer->format);
+        int bytes_per_frame = bytes_per_sample * channel_count;
+        double start = soundio_os_get_time();
+        for (int r = 0; r < repeat; r += 1) {
+            for (int ch = 0; ch < channel_count; ch += 1) {
+                char *ptr = dest + ch * bytes_per_sample;
+                for (int frame = 0; frame < frame_count; frame += 1) {
+                    writer->write_sample(ptr, source[frame]);
+                    ptr += bytes_per_frame;
+                }
+            }
+        }
+        double elapsed = soundio_os_get_time() - start;
+        double samples = (double)frame_count * channel_count * repeat;
+        printf("%s\n    {\"format\": ", (i == 0) ? "" : ",");
+        print_json_string(soundio_format_name(writer->format));
+        printf(", \"ns_per_sample\": %.3f}", elapsed * 1e9 / samples);
+    }
+    printf("\n  ],\n");
+
+    free(source);
+    free(dest);
+}
+
+static const enum SoundIoFormat convert_formats[] = {
+    SoundIoFormatFloat32NE,
+    SoundIoFormatS16NE,
+    SoundIoFormatS24NE,
+    SoundIoFormatS32NE,
+};
+
+static void interleaved_areas(struct SoundIoChannelArea *areas, char *buf, int channel_count,
+        enum SoundIoFormat format)
+{
+    int bytes_per_sample = soundio_get_bytes_per_sample(format);
+    for (int ch = 0; ch < channel_count; ch += 1) {
+        areas[ch].ptr = buf + ch * bytes_per_sample;
+        areas[ch].step = bytes_per_sample * channel_count;
+    }
+}
+
+// Cost of ::soundio_converter_convert between every pair of supported
+// formats, stereo interleaved, to compare with the hand written loops above.
+static void bench_convert(void) {
+    const int frame_count = 512 * 1024;
+    const int repeat = 20;
+    const int channel_count = 2;
+    float *ramp = ALLOCATE_NONZERO(float, frame_count * channel_count);
+    char *src = ALLOCATE_NONZERO(char, frame_count * channel_count * 4);
+    char *dest = ALLOCATE_NONZERO(char, frame_count * channel_count * 4);
+    if (!ramp || !src || !dest)
+        soundio_panic("out of memory");
+    for (int i = 0; i < frame_count * channel_count; i += 1)
+        ramp[i] = ((i % 200) - 100) / 100.0f;
+
+    struct SoundIoChannelArea ramp_areas[2];
+    struct SoundIoChannelArea src_areas[2];
+    struct SoundIoChannelArea dest_areas[2];
+    interleaved_areas(ramp_areas, (char *)ramp, channel_count, SoundIoFormatFloat32NE);
+    int err;
+    bool first = true;
+    printf("  \"convert\": [");
+    for (int i = 0; i < (int)ARRAY_LENGTH(convert_formats); i += 1) {
+        enum SoundIoFormat src_format = convert_formats[i];
+        struct SoundIoConverter *converter;
+        interleaved_areas(src_areas, src, channel_count, src_format);
+        if ((err = soundio_converter_create(SoundIoFormatFloat32NE, src_format, channel_count, &converter)))
+            soundio_panic("converter: %s", soundio_error_name(err));
+        soundio_converter_convert(converter, ramp_areas, src_areas, frame_count);
+        soundio_converter_destroy(converter);
+
+        for (int j = 0; j < (int)ARRAY_LENGTH(convert_formats); j += 1) {
+            enum SoundIoFormat dest_format = convert_formats[j];
+            interleaved_areas(dest_areas, dest, channel_count, dest_format);
+            if ((err = soundio_converter_create(src_format, dest_format, channel_count, &converter)))
+                soundio_panic("converter: %s", soundio_error_name(err));
+            double start = soundio_os_get_time();
+            for (int r = 0; r < repeat; r += 1)
+                soundio_converter_convert(converter, src_areas, dest_areas, frame_count);
+            double elapsed = soundio_os_get_time() - start;
+            soundio_converter_destroy(converter);
+
+            double samples = (double)frame_count * channel_count * repeat;
+            printf("%s\n    {\"from\": ", first ? "" : ",");
+            print_json_string(soundio_format_name(src_format));
+            printf(", \"to\": ");
+            print_json_string(soundio_format_name(dest_format));
+            printf(", \"ns_per_sample\": %.3f}", elapsed * 1e9 / samples);
+            first = false;
+        }
+    }
+    printf("\n  ],\n");
+
+    free(ramp);
+    free(src);
+    free(dest);
+}
+
+static void silence_write_callback(struct SoundIoOutStream *outstream, int frame_count_min, int frame_count_max) {
+    int frames_left = frame_count_max;
+    int err;
+    while (frames_left > 0) {
+        int frame_count = frames_left;
+        struct SoundIoChannelArea *areas;
+        if ((err = soundio_outstream_begin_write(outstream, &areas, &frame_count)))
+            soundio_panic("begin write: %s", soundio_error_name(err));
+        if (!frame_count)
+            break;
+        for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
+            char *ptr = areas[ch].ptr;
+            for (int frame = 0; frame < frame_count; frame += 1) {
+                memset(ptr, 0, outstream->bytes_per_sample);
+                ptr += areas[ch].step;
+            }
+        }
+        if ((err = soundio_outstream_end_write(outstream)))
+            soundio_panic("end write: %s", soundio_error_name(err));
+        frames_left -= frame_count;
+    }
+}
+
+// Upper bound, in microseconds, of the histogram bucket holding the given
+// fraction of all samples.
+static double histogram_percentile(const long *histogram, double fraction) {
+    long total = 0;
+    for (int i = 0; i < SOUNDIO_STATS_BUCKET_COUNT; i += 1)
+        total += histogram[i];
+    if (total == 0)
+        return 0.0;
+    long target = ceil_dbl_to_int(total * fraction);
+    long seen = 0;
+    for (int i = 0; i < SOUNDIO_STATS_BUCKET_COUNT; i += 1) {
+        seen += histogram[i];
+        if (seen >= target)
+            return (double)(2L << i);
+    }
+    return (double)(2L << (SOUNDIO_STATS_BUCKET_COUNT - 1));
+}
+
+// On ALSA, prefer the snd-aloop card so that the measurement does not depend
+// on whatever hardware happens to be the default.
+static int pick_output_device(struct SoundIo *soundio, enum SoundIoBackend backend) {
+    if (backend == SoundIoBackendAlsa) {
+        for (int i = 0; i < soundio_output_device_count(soundio); i += 1) {
+            struct SoundIoDevice *device = soundio_get_output_device(soundio, i);
+            bool loopback = device && !device->is_raw && strstr(device->name, "Loopback");
+            soundio_device_unref(device);
+            if (loopback)
+                return i;
+        }
+    }
+    return soundio_default_output_device_index(soundio);
+}
+
+static bool bench_stream(enum SoundIoBackend backend, double duration, double software_latency, bool first) {
+    struct SoundIo *soundio = soundio_create();
+    if (!soundio)
+        soundio_panic("out of memory");
+    int err;
+    if ((err = soundio_connect_backend(soundio, backend))) {
+        fprintf(stderr, "%s: %s\n", soundio_backend_name(backend), soundio_error_name(err));
+        soundio_destroy(soundio);
+        return false;
+    }
+    soundio_flush_events(soundio);
+
+    int device_index = pick_output_device(soundio, backend);
+    struct SoundIoDevice *device = (device_index >= 0) ?
+        soundio_get_output_device(soundio, device_index) : NULL;
+    if (!device) {
+        fprintf(stderr, "%s: no output device\n", soundio_backend_name(backend));
+        soundio_destroy(soundio);
+        return false;
+    }
+
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    if (!outstream)
+        soundio_panic("out of memory");
+    outstream->write_callback = silence_write_callback;
+    outstream->software_latency = software_latency;
+    if ((err = soundio_outstream_open(outstream)) || (err = soundio_outstream_start(outstream))) {
+        fprintf(stderr, "%s: unable to start stream: %s\n", soundio_backend_name(backend),
+                soundio_error_name(err));
+        soundio_outstream_destroy(outstream);
+        soundio_device_unref(device);
+        soundio_destroy(soundio);
+        return false;
+    }
+
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    if (!cond)
+        soundio_panic("out of memory");
+    clock_t cpu_start = clock();
+    double start = soundio_os_get_time();
+    while (soundio_os_get_time() - start < duration) {
+        soundio_flush_events(soundio);
+        soundio_os_cond_timed_wait(cond, NULL, 0.05);
+    }
+    double elapsed = soundio_os_get_time() - start;
+    double cpu_time = (clock() - cpu_start) / (double)CLOCKS_PER_SEC;
+    soundio_os_cond_destroy(cond);
+
+    struct SoundIoStreamStats stats;
+    soundio_outstream_get_stats(outstream, &stats);
+
+    printf("%s\n    {\"backend\": ", first ? "" : ",");
+    print_json_string(soundio_backend_name(backend));
+    printf(", \"device\": ");
+    print_json_string(device->name);
+    printf(", \"format\": ");
+    print_json_string(soundio_format_name(outstream->format));
+    printf(", \"sample_rate\": %d, \"software_latency\": %.6f, \"duration\": %.3f,\n",
+            outstream->sample_rate, outstream->software_latency, elapsed);
+    printf("     \"callbacks\": %ld, \"callback_p50_us\": %.0f, \"callback_p99_us\": %.0f, "
+            "\"callback_max_us\": %.1f,\n", stats.callback_count,
+            histogram_percentile(stats.callback_duration_histogram, 0.5),
+            histogram_percentile(stats.callback_duration_histogram, 0.99),
+            stats.max_callback_duration * 1e6);
+    printf("     \"wakeup_jitter_p50_us\": %.0f, \"wakeup_jitter_p99_us\": %.0f, "
+            "\"late_wakeups\": %ld, \"xruns\": %ld, \"cpu_fraction\": %.4f}",
+            histogram_percentile(stats.wakeup_jitter_histogram, 0.5),
+            histogram_percentile(stats.wakeup_jitter_histogram, 0.99),
+            stats.late_wakeup_count, stats.xrun_count, cpu_time / elapsed);
+
+    soundio_outstream_destroy(outstream);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+    return true;
+}
+
+// Shared between the stream thread, which notes when the fault hit and when
+// audio flowed again, and the main thread, which reads the result once
+// `recovered` is set.
+struct RecoveryBench {
+    struct SoundIoAtomicBool faulted;
+    struct SoundIoAtomicBool recovered;
+    struct SoundIoAtomicBool disconnected;
+    // Streams carry their generation in `userdata`. Only writes from
+    // `recovery_generation` count as recovered, so that a failing stream
+    // cannot recover itself.
+    long recovery_generation;
+    // Genuine xruns happen too, so faults only count once the application
+    // has written as far as the injected fault.
+    long fault_frame;
+    long frames_written;
+    double fault_time;
+    double recovered_time;
+    // frames queued after the latest write, and how many of them the fault
+    // threw away
+    int queued_frames;
+    int dropped_frames;
+};
+
+static struct RecoveryBench recovery;
+
+static void recovery_note_fault(void) {
+    if (SOUNDIO_ATOMIC_LOAD(recovery.faulted))
+        return;
+    recovery.fault_time = soundio_os_get_time();
+    recovery.dropped_frames = recovery.queued_frames;
+    SOUNDIO_ATOMIC_STORE(recovery.faulted, true);
+}
+
+static void recovery_write_callback(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max)
+{
+    silence_write_callback(outstream, frame_count_min, frame_count_max);
+    recovery.frames_written += frame_count_max;
+    if (SOUNDIO_ATOMIC_LOAD(recovery.faulted)) {
+        long generation = (long)(intptr_t)outstream->userdata;
+        if (generation == recovery.recovery_generation &&
+                frame_count_max > 0 && !SOUNDIO_ATOMIC_LOAD(recovery.recovered))
+        {
+            recovery.recovered_time = soundio_os_get_time();
+            SOUNDIO_ATOMIC_STORE(recovery.recovered, true);
+        }
+        return;
+    }
+    double latency;
+    if (!soundio_outstream_get_latency(outstream, &latency))
+        recovery.queued_frames = (int)(latency * outstream->sample_rate);
+}
+
+static void recovery_underflow_callback(struct SoundIoOutStream *outstream) {
+    if (recovery.recovery_generation == 0 && recovery.frames_written >= recovery.fault_frame)
+        recovery_note_fault();
+}
+
+static void recovery_error_callback(struct SoundIoOutStream *outstream, enum SoundIoError err) {
+    recovery_note_fault();
+}
+
+static void recovery_backend_disconnect_callback(struct SoundIo *soundio, enum SoundIoError err) {
+    SOUNDIO_ATOMIC_STORE(recovery.disconnected, true);
+}
+
+static struct SoundIoOutStream *recovery_start_stream(struct SoundIo *soundio,
+        double software_latency, long generation)
+{
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    if (!device)
+        soundio_panic("dummy backend has no output device");
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    soundio_device_unref(device);
+    if (!outstream)
+        soundio_panic("out of memory");
+    outstream->userdata = (void *)(intptr_t)generation;
+    outstream->write_callback = recovery_write_callback;
+    outstream->underflow_callback = recovery_underflow_callback;
+    outstream->error_callback = recovery_error_callback;
+    outstream->software_latency = software_latency;
+    int err;
+    if ((err = soundio_outstream_open(outstream)) || (err = soundio_outstream_start(outstream)))
+        soundio_panic("unable to start stream: %s", soundio_error_name(err));
+    return outstream;
+}
+
+// Injects one fault into a dummy stream running against the wall clock and
+// measures how long it takes until the write callback produces audio again.
+// An xrun is recovered by the backend itself; after a disconnect the
+// application reconnects and opens a new stream. Frames lost are the frames
+// that were queued when the fault hit plus the silence until audio flowed
+// again.
+static void bench_recovery_case(const char *name, enum SoundIoDummyFaultType type,
+        double software_latency, bool first)
+{
+    memset(&recovery, 0, sizeof(recovery));
+    recovery.recovery_generation = (type == SoundIoDummyFaultDisconnect) ? 1 : 0;
+    struct SoundIoDummyFault fault;
+    memset(&fault, 0, sizeof(fault));
+    fault.type = type;
+    fault.frame = 24000;
+    recovery.fault_frame = fault.frame;
+
+    struct SoundIo *soundio = soundio_create();
+    if (!soundio)
+        soundio_panic("out of memory");
+    soundio->dummy_faults = &fault;
+    soundio->dummy_fault_count = 1;
+    soundio->on_backend_disconnect = recovery_backend_disconnect_callback;
+    int err;
+    if ((err = soundio_connect_backend(soundio, SoundIoBackendDummy)))
+        soundio_panic("dummy: %s", soundio_error_name(err));
+    soundio_flush_events(soundio);
+    long generation = 0;
+    struct SoundIoOutStream *outstream = recovery_start_stream(soundio, software_latency, generation);
+    int sample_rate = outstream->sample_rate;
+    double actual_latency = outstream->software_latency;
+
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    if (!cond)
+        soundio_panic("out of memory");
+    double start = soundio_os_get_time();
+    while (!SOUNDIO_ATOMIC_LOAD(recovery.recovered) && soundio_os_get_time() - start < 5.0) {
+        soundio_flush_events(soundio);
+        if (SOUNDIO_ATOMIC_LOAD(recovery.disconnected)) {
+            SOUNDIO_ATOMIC_STORE(recovery.disconnected, false);
+            // the disconnect may reach us before the stream's own error
+            soundio_outstream_destroy(outstream);
+            recovery_note_fault();
+            generation += 1;
+            soundio_disconnect(soundio);
+            soundio->dummy_faults = NULL;
+            soundio->dummy_fault_count = 0;
+            if ((err = soundio_connect_backend(soundio, SoundIoBackendDummy)))
+                soundio_panic("dummy: %s", soundio_error_name(err));
+            soundio_flush_events(soundio);
+            outstream = recovery_start_stream(soundio, software_latency, generation);
+            continue;
+        }
+        soundio_os_cond_timed_wait(cond, NULL, 0.001);
+    }
+    soundio_os_cond_destroy(cond);
+    if (!SOUNDIO_ATOMIC_LOAD(recovery.recovered))
+        soundio_panic("%s: stream did not recover", name);
+
+    double recovery_time = recovery.recovered_time - recovery.fault_time;
+    long frames_lost = recovery.dropped_frames + (long)(recovery_time * sample_rate);
+    printf("%s\n    {\"fault\": ", first ? "" : ",");
+    print_json_string(name);
+    printf(", \"software_latency\": %.6f, \"recovery_us\": %.1f, \"frames_lost\": %ld}",
+            actual_latency, recovery_time * 1e6, frames_lost);
+
+    soundio_outstream_destroy(outstream);
+    soundio_destroy(soundio);
+}
+
+static void bench_recovery(double software_latency) {
+    printf("  \"recovery\": [");
+    bench_recovery_case("xrun", SoundIoDummyFaultXrun, software_latency, true);
+    bench_recovery_case("disconnect", SoundIoDummyFaultDisconnect, software_latency, false);
+    printf("\n  ],\n");
+}
+
+int main(int argc, char **argv) {
+    char *exe = argv[0];
+    enum SoundIoBackend backends[8];
+    int backend_count = 0;
+    double duration = 2.0;
+    double software_latency = 0.01;
+    const char *only = NULL;
+    for (int i = 1; i < argc; i += 1) {
+        char *arg = argv[i];
+        if (arg[0] == '-' && arg[1] == '-') {
+            i += 1;
+            if (i >= argc) {
+                return usage(exe);
+            } else if (strcmp(arg, "--backend") == 0) {
+                if (backend_count >= (int)ARRAY_LENGTH(backends))
+                    return usage(exe);
+                if (strcmp("dummy", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendDummy;
+                } else if (strcmp("alsa", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendAlsa;
+                } else if (strcmp("pulseaudio", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendPipeWire;
+                } else if (strcmp("jack", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendJack;
+                } else if (strcmp("coreaudio", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendCoreAudio;
+                } else if (strcmp("wasapi", argv[i]) == 0) {
+                    backends[backend_count++] = SoundIoBackendWasapi;
+                } else {
+                    fprintf(stderr, "Invalid backend: %s\n", argv[i]);
+                    return 1;
+                }
+            } else if (strcmp(arg, "--duration") == 0) {
+                duration = atof(argv[i]);
+            } else if (strcmp(arg, "--latency") == 0) {
+                software_latency = atof(argv[i]);
+            } else if (strcmp(arg, "--only") == 0) {
+                only = argv[i];
+            } else {
+                return usage(exe);
+            }
+        } else {
+            return usage(exe);
+        }
+    }
+    if (backend_count == 0)
+        backends[backend_count++] = SoundIoBackendDummy;
+
+    int err;
+    if ((err = soundio_os_init()))
+        soundio_panic("os init: %s", soundio_error_name(err));
+
+    printf("{\n  \"version\": \"%s\",\n", soundio_version_string());
+    if (!only || strcmp(only, "ring_buffer") == 0)
+        bench_ring_buffer();
+    if (!only || strcmp(only, "sample_write") == 0)
+        bench_sample_write();
+    if (!only || strcmp(only, "convert") == 0)
+        bench_convert();
+    if (!only || strcmp(only, "recovery") == 0)
+        bench_recovery(software_latency);
+    printf("  \"streams\": [");
+    if (!only || strcmp(only, "streams") == 0) {
+        bool first = true;
+        for (int i = 0; i < backend_count; i += 1) {
+            if (bench_stream(backends[i], duration, software_latency, first))
+                first = false;
+        }
+    }
+    printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,34 @@
+# Copyright (c) 2015 Andrew Kelley
+# This file is MIT licensed.
+# See http://opensource.org/licenses/MIT
+
+# PIPEWIRE_FOUND
+# PIPEWIRE_INCLUDE_DIR
+# SPA_INCLUDE_DIR
+# PIPEWIRE_LIBRARY
+
+# The backend uses PW_KEY_TARGET_OBJECT, which appeared in 0.3.64. Older
+# releases are treated as missing so that the rest of the library builds.
+set(PIPEWIRE_MIN_VERSION "0.3.64")
+
+find_package(PkgConfig QUIET)
+if(PKG_CONFIG_FOUND)
+    pkg_check_modules(PC_PIPEWIRE QUIET "libpipewire-0.3>=${PIPEWIRE_MIN_VERSION}")
+endif()
+
+if(PC_PIPEWIRE_FOUND)
+    find_path(PIPEWIRE_INCLUDE_DIR NAMES pipewire/pipewire.h
+        HINTS ${PC_PIPEWIRE_INCLUDE_DIRS} PATH_SUFFIXES pipewire-0.3)
+    find_path(SPA_INCLUDE_DIR NAMES spa/param/audio/format-utils.h
+        HINTS ${PC_PIPEWIRE_INCLUDE_DIRS} PATH_SUFFIXES spa-0.2)
+    find_library(PIPEWIRE_LIBRARY NAMES pipewire-0.3 HINTS ${PC_PIPEWIRE_LIBRARY_DIRS})
+else()
+    set(PIPEWIRE_INCLUDE_DIR PIPEWIRE_INCLUDE_DIR-NOTFOUND)
+    set(SPA_INCLUDE_DIR SPA_INCLUDE_DIR-NOTFOUND)
+    set(PIPEWIRE_LIBRARY PIPEWIRE_LIBRARY-NOTFOUND)
+endif()
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(PIPEWIRE DEFAULT_MSG PIPEWIRE_LIBRARY PIPEWIRE_INCLUDE_DIR SPA_INCLUDE_DIR)
+
+mark_as_advanced(PIPEWIRE_INCLUDE_DIR SPA_INCLUDE_DIR PIPEWIRE_LIBRARY)
@@ -17,7 +17,7 @@ static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options]\n"
             "Options:\n"
             "  [--watch]\n"
-            "  [--backend dummy|remote|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|remote|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--short]\n", exe);
     return 1;
 }
@@ -137,6 +137,8 @@ int main(int argc, char **argv) {
                     backend = SoundIoBackendAlsa;
                 } else if (strcmp("pulseaudio", argv[i]) == 0) {
                     backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
                 } else if (strcmp("jack", argv[i]) == 0) {
                     backend = SoundIoBackendJack;
                 } else if (strcmp("coreaudio", argv[i]) == 0) {
@@ -179,7 +179,7 @@ static void underflow_callback(struct SoundIoOutStream *outstream) {
 static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options]\n"
             "Options:\n"
-            "  [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--in-device id]\n"
             "  [--in-raw]\n"
             "  [--out-device id]\n"
@@ -215,6 +215,8 @@ int main(int argc, char **argv) {
                     backend = SoundIoBackendAlsa;
                 } else if (strcmp("pulseaudio", argv[i]) == 0) {
                     backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
                 } else if (strcmp("jack", argv[i]) == 0) {
                     backend = SoundIoBackendJack;
                 } else if (strcmp("coreaudio", argv[i]) == 0) {
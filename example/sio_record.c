@@ -12,7 +12,6 @@
 #include <string.h>
 #include <math.h>
 #include <errno.h>
-#include <unistd.h>
 
 struct RecordContext {
     struct SoundIoRingBuffer *ring_buffer;
@@ -120,7 +119,7 @@ static void overflow_callback(struct SoundIoInStream *instream) {
 static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options] outfile\n"
             "Options:\n"
-            "  [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--device id]\n"
             "  [--raw]\n"
             , exe);
@@ -147,6 +146,8 @@ int main(int argc, char **argv) {
                     backend = SoundIoBackendAlsa;
                 } else if (strcmp("pulseaudio", argv[i]) == 0) {
                     backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
                 } else if (strcmp("jack", argv[i]) == 0) {
                     backend = SoundIoBackendJack;
                 } else if (strcmp("coreaudio", argv[i]) == 0) {
@@ -282,11 +283,13 @@ int main(int argc, char **argv) {
     }
 
     // Note: in this example, if you send SIGINT (by pressing Ctrl+C for example)
-    // you will lose up to 1 second of recorded audio data. In non-example code,
-    // consider a better shutdown strategy.
+    // you will lose up to a tenth of a second of recorded audio data. In
+    // non-example code, consider a better shutdown strategy.
+    int chunk_bytes = instream->sample_rate / 10 * instream->bytes_per_frame;
     for (;;) {
         soundio_flush_events(soundio);
-        sleep(1);
+        // the timeout keeps events flowing while the stream delivers nothing
+        soundio_ring_buffer_wait_fill(rc.ring_buffer, chunk_bytes, 1.0);
         int fill_bytes = soundio_ring_buffer_fill_count(rc.ring_buffer);
         char *read_buf = soundio_ring_buffer_read_ptr(rc.ring_buffer);
         size_t amt = fwrite(read_buf, 1, fill_bytes, out_f);
@@ -16,11 +16,13 @@
 static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options]\n"
             "Options:\n"
-            "  [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--device id]\n"
             "  [--raw]\n"
             "  [--name stream_name]\n"
             "  [--latency seconds]\n"
+            "  [--period-frames frames]\n"
+            "  [--periods count]\n"
             "  [--sample-rate hz]\n"
             , exe);
     return 1;
@@ -112,6 +114,8 @@ int main(int argc, char **argv) {
     bool raw = false;
     char *stream_name = NULL;
     double latency = 0.0;
+    int period_frames = 0;
+    int period_count = 0;
     int sample_rate = 0;
     for (int i = 1; i < argc; i += 1) {
         char *arg = argv[i];
@@ -131,6 +135,8 @@ int main(int argc, char **argv) {
                         backend = SoundIoBackendAlsa;
                     } else if (strcmp(argv[i], "pulseaudio") == 0) {
                         backend = SoundIoBackendPulseAudio;
+                    } else if (strcmp(argv[i], "pipewire") == 0) {
+                        backend = SoundIoBackendPipeWire;
                     } else if (strcmp(argv[i], "jack") == 0) {
                         backend = SoundIoBackendJack;
                     } else if (strcmp(argv[i], "coreaudio") == 0) {
@@ -147,6 +153,10 @@ int main(int argc, char **argv) {
                     stream_name = argv[i];
                 } else if (strcmp(arg, "--latency") == 0) {
                     latency = atof(argv[i]);
+                } else if (strcmp(arg, "--period-frames") == 0) {
+                    period_frames = atoi(argv[i]);
+                } else if (strcmp(arg, "--periods") == 0) {
+                    period_count = atoi(argv[i]);
                 } else if (strcmp(arg, "--sample-rate") == 0) {
                     sample_rate = atoi(argv[i]);
                 } else {
@@ -220,6 +230,8 @@ int main(int argc, char **argv) {
     outstream->underflow_callback = underflow_callback;
     outstream->name = stream_name;
     outstream->software_latency = latency;
+    outstream->period_frames = period_frames;
+    outstream->period_count = period_count;
     outstream->sample_rate = sample_rate;
 
     if (soundio_device_supports_format(device, SoundIoFormatFloat32NE)) {
@@ -245,6 +257,11 @@ int main(int argc, char **argv) {
     }
 
     fprintf(stderr, "Software latency: %f\n", outstream->software_latency);
+    if (outstream->period_frames) {
+        fprintf(stderr, "Periods: %d x %d frames, avail_min %d, start_threshold %d\n",
+                outstream->period_count, outstream->period_frames,
+                outstream->avail_min, outstream->start_threshold);
+    }
     fprintf(stderr,
             "'p\\n' - pause\n"
             "'u\\n' - unpause\n"
@@ -10,6 +10,7 @@
 
 #include "endian.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /// \cond
 #ifdef __cplusplus
@@ -225,6 +226,7 @@ enum SoundIoBackend {
     SoundIoBackendAndroid,
     SoundIoBackendRemote,
     SoundIoBackendDummy,
+    SoundIoBackendPipeWire,
 };
 
 enum SoundIoDeviceAim {
@@ -338,6 +340,45 @@ struct SoundIoChannelArea {
     int step;
 };
 
+/// See SoundIoDummyFault
+enum SoundIoDummyFaultType {
+    /// The stream loses its buffered audio and reports an underflow (output)
+    /// or overflow (input).
+    SoundIoDummyFaultXrun,
+    /// The stream thread stops for SoundIoDummyFault::duration seconds of
+    /// stream time, which usually causes a genuine xrun.
+    SoundIoDummyFaultStall,
+    /// From now on, every wakeup of the stream thread is delayed by a pseudo
+    /// random amount up to SoundIoDummyFault::duration seconds. 0 turns
+    /// jitter off again. The sequence is the same on every run.
+    SoundIoDummyFaultJitter,
+    /// A second input and output device appear, or disappear if they are
+    /// present. Fires once for the whole backend.
+    SoundIoDummyFaultDevicesChange,
+    /// The devices' current sample rate becomes SoundIoDummyFault::sample_rate.
+    /// Streams running at any other rate fail with #SoundIoErrorStreaming,
+    /// the way a backend that cannot follow the rate change behaves. Fires once for the whole backend.
+    SoundIoDummyFaultSampleRateChange,
+    /// The backend disconnects: every stream fails with
+    /// #SoundIoErrorStreaming and SoundIo::on_backend_disconnect is called
+    /// with #SoundIoErrorBackendDisconnected. Fires once.
+    SoundIoDummyFaultDisconnect,
+};
+
+/// One step of a dummy backend fault injection scenario. See
+/// SoundIo::dummy_faults.
+struct SoundIoDummyFault {
+    enum SoundIoDummyFaultType type;
+    /// The fault fires once a stream has played (output) or captured (input)
+    /// this many frames since it was started. Each stream walks the scenario
+    /// on its own.
+    long frame;
+    /// Seconds, for #SoundIoDummyFaultStall and #SoundIoDummyFaultJitter.
+    double duration;
+    /// For #SoundIoDummyFaultSampleRateChange.
+    int sample_rate;
+};
+
 /// The size of this struct is not part of the API or ABI.
 struct SoundIo {
     /// Optional. Put whatever you want here. Defaults to NULL.
@@ -365,6 +406,7 @@ struct SoundIo {
     /// Optional callback. Called from an unknown thread that you should not use
     /// to call any soundio functions. You may use this to signal a condition
     /// variable to wake up. Called when ::soundio_wait_events would be woken up.
+    /// See also ::soundio_get_event_fd.
     void (*on_events_signal)(struct SoundIo *);
 
     /// Read-only. After calling ::soundio_connect or ::soundio_connect_backend,
@@ -372,7 +414,7 @@ struct SoundIo {
     enum SoundIoBackend current_backend;
 
     /// Optional: Application name.
-    /// PulseAudio uses this for "application name".
+    /// PulseAudio and PipeWire use this for "application name".
     /// JACK uses this for `client_name`.
     /// Must not contain a colon (":").
     const char *app_name;
@@ -385,6 +427,37 @@ struct SoundIo {
     /// To silence the warning, assign this to a function that does nothing.
     void (*emit_rtprio_warning)(struct SoundIo *);
 
+    /// Optional: Number of shared real-time threads driving streams.
+    /// By default (0), each stream gets its own thread. When positive,
+    /// backends that support it multiplex all of their streams onto this many
+    /// threads, pinned round-robin to the available CPUs, each servicing
+    /// streams in deadline order. Only streams paced by a timer can share a
+    /// thread; backends that block on the device, such as ALSA, keep one
+    /// thread per stream. Must be set before calling ::soundio_connect or
+    /// ::soundio_connect_backend. Currently honored by the dummy and remote
+    /// backends; ignored on Windows.
+    int realtime_worker_count;
+
+    /// Optional: Run dummy backend streams in freewheel mode. Instead of
+    /// pacing themselves against the wall clock, streams advance a virtual
+    /// clock by one period per iteration and call
+    /// SoundIoOutStream::write_callback and SoundIoInStream::read_callback
+    /// back to back, as fast as the callbacks return. Latencies are reported
+    /// against the virtual clock. Useful for offline rendering and tests.
+    /// Such a stream never sleeps, so its thread runs with
+    /// #SoundIoThreadPolicyNormal whatever its thread attributes ask for.
+    /// Must be set before connecting to the dummy backend; other backends
+    /// ignore it. Defaults to `false`.
+    bool dummy_freewheel;
+
+    /// Optional: Fault injection scenario for the dummy backend, in ascending
+    /// SoundIoDummyFault::frame order. The array is copied when connecting.
+    /// Combine with SoundIo::dummy_freewheel for reproducible runs.
+    /// Other backends ignore it. Defaults to `NULL`.
+    const struct SoundIoDummyFault *dummy_faults;
+    /// Number of entries in SoundIo::dummy_faults.
+    int dummy_fault_count;
+
     /// Optional: JACK info callback.
     /// By default, libsoundio sets this to an empty function in order to
     /// silence stdio messages from JACK. You may override the behavior by
@@ -510,6 +583,126 @@ struct SoundIoDevice {
     enum SoundIoError probe_error;
 };
 
+/// Scheduling policy for the thread that drives a stream.
+enum SoundIoThreadPolicy {
+    /// Try `SCHED_FIFO` at the highest priority and fall back to normal
+    /// scheduling, calling SoundIo::emit_rtprio_warning, if that is not
+    /// permitted.
+    SoundIoThreadPolicyDefault,
+    /// Do not request real time scheduling.
+    SoundIoThreadPolicyNormal,
+    SoundIoThreadPolicyFifo,
+    SoundIoThreadPolicyRoundRobin,
+    /// Linux `SCHED_DEADLINE`. The period and relative deadline are the
+    /// period of the stream, derived from its software latency, and the
+    /// runtime budget is half of that. Falls back like
+    /// #SoundIoThreadPolicyDefault where unavailable.
+    SoundIoThreadPolicyDeadline,
+};
+
+/// Requested, and after starting a stream, actual attributes of the thread
+/// that drives the stream. Backends which call the stream callbacks from a
+/// thread they do not own (PulseAudio, PipeWire, JACK, CoreAudio, Android) and streams
+/// serviced by SoundIo::realtime_worker_count ignore these.
+struct SoundIoThreadAttributes {
+    enum SoundIoThreadPolicy policy;
+    /// Priority within a #SoundIoThreadPolicyFifo or
+    /// #SoundIoThreadPolicyRoundRobin policy. 0 means the highest available.
+    int priority;
+    /// Bit `n` allows the thread to run on CPU `n`. 0 means any CPU.
+    unsigned long long cpu_mask;
+    /// Lock the process' memory into RAM with `mlockall` and prefault the
+    /// thread's stack so that the callback never takes a page fault.
+    bool lock_memory;
+};
+
+/// Number of buckets in the histograms of ::SoundIoStreamStats.
+#define SOUNDIO_STATS_BUCKET_COUNT 24
+
+/// Counters describing how well the thread driving a stream keeps up. Bucket
+/// 0 of each histogram counts values below 2 microseconds, bucket `n` counts
+/// values in [2^n, 2^(n+1)) microseconds, and the last bucket also counts
+/// everything larger.
+struct SoundIoStreamStats {
+    /// Number of calls to SoundIoOutStream::write_callback or
+    /// SoundIoInStream::read_callback.
+    long callback_count;
+    /// How long each callback took, wall clock.
+    long callback_duration_histogram[SOUNDIO_STATS_BUCKET_COUNT];
+    /// Longest callback seen, in seconds.
+    double max_callback_duration;
+    /// How long after its scheduled time the stream thread started its work.
+    /// Only recorded by backends that know when that is: dummy, remote,
+    /// JACK, PipeWire and ALSA, where it is the time worth of frames that
+    /// became available beyond `avail_min` before the thread woke up.
+    /// PulseAudio, CoreAudio and WASAPI leave it zero.
+    long wakeup_jitter_histogram[SOUNDIO_STATS_BUCKET_COUNT];
+    /// See ::soundio_outstream_deadline_miss_count. Only the timer-paced
+    /// dummy and remote backends have a deadline to miss; the others leave
+    /// it zero and report lateness through `wakeup_jitter_histogram` and
+    /// `xrun_count`.
+    long late_wakeup_count;
+    /// Underflows for output streams, overflows for input streams.
+    long xrun_count;
+    /// Sum of `frame_count_min` over all callbacks.
+    long frames_requested;
+    /// Sum of `frame_count_max` over all callbacks.
+    long frames_offered;
+    /// Frames actually written or read with the begin/end functions.
+    long frames_transferred;
+    /// Callbacks whose channel areas pointed straight into memory shared
+    /// with the sound server, so no copy was made after the application
+    /// wrote or before it read. Counted by PipeWire and PulseAudio.
+    long zero_copy_periods;
+    /// Callbacks whose audio the backend had to copy on its way to or from
+    /// the server. Counted by PipeWire and PulseAudio; PulseAudio counts a
+    /// period here when `pa_stream_begin_write` returned less than was asked
+    /// for, or when a recorded fragment was a hole or not one fragment in
+    /// size.
+    long copy_periods;
+};
+
+/// Levels of one channel over the last 100 ms block. Linear, 1.0 is full
+/// scale.
+struct SoundIoMeterChannel {
+    float peak;
+    float rms;
+    /// Peak of the signal reconstructed between samples, estimated by 4x
+    /// oversampling as in ITU-R BS.1770. Never less than `peak`.
+    float true_peak;
+};
+
+/// What the meter of a stream measured, see ::soundio_outstream_get_meter.
+/// Loudness follows EBU R128 in LUFS, with the LFE left out and surround
+/// channels weighted by 1.41. It is `-INFINITY` until the first block is
+/// complete and for digital silence.
+struct SoundIoMeterSnapshot {
+    /// 0 when the stream is not metered.
+    int channel_count;
+    struct SoundIoMeterChannel channels[SOUNDIO_MAX_CHANNELS];
+    /// Loudness over the last 400 ms.
+    double momentary_loudness;
+    /// Loudness over the last 3 s, or as much as has been measured so far.
+    double short_term_loudness;
+    /// Number of 100 ms blocks measured since the stream was opened.
+    long block_count;
+};
+
+/// A message for the stream thread, see ::soundio_outstream_post_command.
+/// The meaning of every field is up to the application.
+struct SoundIoCommand {
+    /// For example which parameter to change.
+    int type;
+    /// For example a channel or bus index.
+    int index;
+    /// For example a new gain.
+    double value;
+    /// For example a new buffer to swap in. Once the stream thread is done
+    /// with the object it replaces, hand that one to
+    /// ::soundio_outstream_defer_free.
+    void *ptr;
+};
+
 /// The size of this struct is not part of the API or ABI.
 struct SoundIoOutStream {
     /// Populated automatically when you call ::soundio_outstream_create.
@@ -548,10 +741,18 @@ struct SoundIoOutStream {
     /// still set this, but you might not get the value you requested.
     /// For PulseAudio, if you set this value to non-default, it sets
     /// `PA_STREAM_ADJUST_LATENCY` and is the value used for `maxlength` and
-    /// `tlength`.
+    /// `tlength`, with `minreq` a quarter of that. ::soundio_outstream_open
+    /// writes the granted `tlength` back here. This is a snapshot: when the
+    /// server later changes the buffer, for example because the stream moved
+    /// to another sink, this field keeps its value. Use
+    /// ::soundio_outstream_get_latency for the current latency.
+    ///
+    /// For PipeWire, this is the requested `node.latency` quantum and the
+    /// size of each of the stream's buffers.
     ///
     /// For JACK, this value is always equal to
-    /// SoundIoDevice::software_latency_current of the device.
+    /// SoundIoDevice::software_latency_current of the device, and it follows
+    /// the server's period (see SoundIoOutStream::period_changed_callback).
     double software_latency;
 
     /// Defaults to NULL. Put whatever you want here.
@@ -564,8 +765,9 @@ struct SoundIoOutStream {
     /// you can still get a buffer underflow if you always write
     /// `frame_count_min` frames.
     ///
-    /// For Dummy, ALSA, and PulseAudio, `frame_count_min` will be 0. For JACK
-    /// and CoreAudio `frame_count_min` will be equal to `frame_count_max`.
+    /// For Dummy, ALSA, and PulseAudio, `frame_count_min` will be 0. For JACK,
+    /// PipeWire and CoreAudio `frame_count_min` will be equal to
+    /// `frame_count_max`.
     ///
     /// The code in the supplied function must be suitable for real-time
     /// execution. That means that it cannot call functions that might block
@@ -588,9 +790,9 @@ struct SoundIoOutStream {
     void (*error_callback)(struct SoundIoOutStream *, enum SoundIoError err);
 
     /// Optional: Name of the stream. Defaults to "SoundIoOutStream"
-    /// PulseAudio uses this for the stream name.
-    /// JACK uses this for the client name of the client that connects when you
-    /// open the stream.
+    /// PulseAudio and PipeWire use this for the stream name.
+    /// JACK prefixes the names of the stream's ports with this. All streams
+    /// share one client named after SoundIo::app_name.
     /// WASAPI uses this for the session display name.
     /// Must not contain a colon (":").
     const char *name;
@@ -617,6 +819,73 @@ struct SoundIoOutStream {
     /// Defaults to `false`.
     /// For backends other than JACK, this does nothing.
     bool unconnected;
+
+    /// Optional: Scheduling of the thread that calls
+    /// SoundIoOutStream::write_callback. Defaults to all zeroes, which is
+    /// #SoundIoThreadPolicyDefault on any CPU.
+    struct SoundIoThreadAttributes thread_attributes;
+    /// Set when the backend creates the stream thread (during
+    /// ::soundio_outstream_start, or ::soundio_outstream_open for WASAPI) to
+    /// what actually took effect of SoundIoOutStream::thread_attributes.
+    /// On Windows, real time
+    /// policies are applied as `THREAD_PRIORITY_TIME_CRITICAL` and reported
+    /// as #SoundIoThreadPolicyFifo.
+    struct SoundIoThreadAttributes actual_thread_attributes;
+
+    /// Optional: Keep calling SoundIoOutStream::write_callback with the period
+    /// the stream was opened with when the server changes its period while
+    /// the stream runs. The backend re-blocks through an internal buffer,
+    /// which adds up to one period of latency. When `false`, the callback
+    /// gets the new period directly. Defaults to `false`.
+    /// Only JACK changes the period of running streams.
+    bool keep_period;
+
+    /// Optional callback. Called when the backend changed the period or the
+    /// sample rate of the running stream instead of failing it.
+    /// SoundIoOutStream::sample_rate and SoundIoOutStream::software_latency
+    /// hold the new values. Called from a non-realtime backend thread while
+    /// SoundIoOutStream::write_callback is not running.
+    void (*period_changed_callback)(struct SoundIoOutStream *);
+
+    /// Optional: Number of frames in one period, the unit in which the device
+    /// consumes the buffer. 0 (the default) lets the backend choose.
+    /// Combined with SoundIoOutStream::period_count this replaces
+    /// SoundIoOutStream::software_latency as the buffer size request, for
+    /// example 64 frames times 3 periods.
+    /// After ::soundio_outstream_open this holds the negotiated value.
+    /// ALSA and PulseAudio honor this; other backends ignore it.
+    int period_frames;
+    /// Optional: Number of periods in the buffer. 0 (the default) lets the
+    /// backend choose. After ::soundio_outstream_open this holds the
+    /// negotiated value. ALSA and PulseAudio honor this.
+    int period_count;
+    /// Read-only. Set by ::soundio_outstream_open on ALSA to the negotiated
+    /// `avail_min`: how many frames must be free in the buffer before the
+    /// stream thread wakes up. 0 on other backends.
+    int avail_min;
+    /// Read-only. Set by ::soundio_outstream_open on ALSA to the negotiated
+    /// `start_threshold` in frames. 0 on other backends.
+    int start_threshold;
+
+    /// Optional: Measure the frames passed to ::soundio_outstream_end_write
+    /// and publish peak, RMS, true peak and loudness for
+    /// ::soundio_outstream_get_meter. The measuring happens on the stream
+    /// thread inside ::soundio_outstream_end_write. Only native endian
+    /// float32, s16, s24 and s32 can be metered; other formats open without
+    /// a meter. Defaults to false.
+    bool metering;
+
+    /// Optional: Number of commands ::soundio_outstream_post_command can
+    /// hold before the stream thread drains them, rounded up to a power of
+    /// 2. The same number of pointers fit in the queue behind
+    /// ::soundio_outstream_defer_free. 0 (the default) creates neither
+    /// queue. Requires SoundIoOutStream::command_callback.
+    int command_queue_capacity;
+    /// Called on the stream thread once for every posted command, in the
+    /// order they were posted, right before SoundIoOutStream::write_callback.
+    /// The same realtime rules as for SoundIoOutStream::write_callback
+    /// apply.
+    void (*command_callback)(struct SoundIoOutStream *, const struct SoundIoCommand *command);
 };
 
 /// The size of this struct is not part of the API or ABI.
@@ -646,8 +915,13 @@ struct SoundIoInStream {
     /// still set this, but you might not get the value you requested.
     /// For PulseAudio, if you set this value to non-default, it sets
     /// `PA_STREAM_ADJUST_LATENCY` and is the value used for `fragsize`.
+    /// ::soundio_instream_start writes the granted `fragsize` back here. Like
+    /// SoundIoOutStream::software_latency, this is a snapshot that keeps its
+    /// value when the server later changes the buffer.
+    /// For PipeWire, this is the requested `node.latency` quantum.
     /// For JACK, this value is always equal to
-    /// SoundIoDevice::software_latency_current
+    /// SoundIoDevice::software_latency_current, and it follows the server's
+    /// period (see SoundIoInStream::period_changed_callback).
     double software_latency;
 
     /// Defaults to NULL. Put whatever you want here.
@@ -679,9 +953,9 @@ struct SoundIoInStream {
     void (*error_callback)(struct SoundIoInStream *, enum SoundIoError err);
 
     /// Optional: Name of the stream. Defaults to "SoundIoInStream";
-    /// PulseAudio uses this for the stream name.
-    /// JACK uses this for the client name of the client that connects when you
-    /// open the stream.
+    /// PulseAudio and PipeWire use this for the stream name.
+    /// JACK prefixes the names of the stream's ports with this. All streams
+    /// share one client named after SoundIo::app_name.
     /// WASAPI uses this for the session display name.
     /// Must not contain a colon (":").
     const char *name;
@@ -706,6 +980,41 @@ struct SoundIoInStream {
     /// Defaults to `false`.
     /// For backends other than JACK, this does nothing.
     bool unconnected;
+
+    /// Optional: See SoundIoOutStream::thread_attributes
+    struct SoundIoThreadAttributes thread_attributes;
+    /// See SoundIoOutStream::actual_thread_attributes
+    struct SoundIoThreadAttributes actual_thread_attributes;
+
+    /// Optional: See SoundIoOutStream::keep_period. Re-blocking holds captured
+    /// frames back until a whole period is available.
+    bool keep_period;
+
+    /// Optional callback. See SoundIoOutStream::period_changed_callback.
+    void (*period_changed_callback)(struct SoundIoInStream *);
+
+    /// Optional: See SoundIoOutStream::period_frames. When 0, ALSA uses half
+    /// of SoundIoInStream::software_latency. PulseAudio uses it as the
+    /// fragment size and sets it once the stream is started.
+    int period_frames;
+    /// Optional: See SoundIoOutStream::period_count. When 0, ALSA uses the
+    /// largest buffer the device allows.
+    int period_count;
+    /// Read-only. See SoundIoOutStream::avail_min. For input streams it is
+    /// how many captured frames wake up the stream thread.
+    int avail_min;
+    /// Read-only. See SoundIoOutStream::start_threshold.
+    int start_threshold;
+
+    /// Optional: See SoundIoOutStream::metering. Input streams are measured
+    /// in ::soundio_instream_begin_read.
+    bool metering;
+
+    /// Optional: See SoundIoOutStream::command_queue_capacity.
+    int command_queue_capacity;
+    /// Optional callback. See SoundIoOutStream::command_callback. Runs
+    /// right before SoundIoInStream::read_callback.
+    void (*command_callback)(struct SoundIoInStream *, const struct SoundIoCommand *command);
 };
 
 /// See also ::soundio_version_major, ::soundio_version_minor, ::soundio_version_patch
@@ -789,9 +1098,32 @@ SOUNDIO_EXPORT void soundio_flush_events(struct SoundIo *soundio);
 /// is ready or you call ::soundio_wakeup. Be ready for spurious wakeups.
 SOUNDIO_EXPORT void soundio_wait_events(struct SoundIo *soundio);
 
-/// Makes ::soundio_wait_events stop blocking.
+/// Makes ::soundio_wait_events stop blocking. Also makes the descriptor from
+/// ::soundio_get_event_fd readable.
 SOUNDIO_EXPORT void soundio_wakeup(struct SoundIo *soundio);
 
+/// Obtain a file descriptor which becomes readable when ::soundio_flush_events
+/// has work to do, for integrating libsoundio into an existing `poll`, `epoll`
+/// or `kqueue` event loop instead of dedicating a thread to
+/// ::soundio_wait_events. Watch it for readability, then call
+/// ::soundio_dispatch_events. Do not read from or close the descriptor; it is
+/// owned by `soundio` and remains valid until ::soundio_disconnect.
+///
+/// The descriptor is readable immediately after connecting if devices are
+/// already known, so the first dispatch delivers SoundIo::on_devices_change.
+/// Spurious readiness is possible.
+///
+/// Possible errors:
+/// * #SoundIoErrorInvalid - not connected to a backend
+/// * #SoundIoErrorIncompatibleBackend - not supported on this system (Windows)
+SOUNDIO_EXPORT enum SoundIoError soundio_get_event_fd(struct SoundIo *soundio, int *out_fd);
+
+/// Non-blocking counterpart of ::soundio_wait_events for use with
+/// ::soundio_get_event_fd. Resets the readiness of the descriptor and then
+/// calls ::soundio_flush_events. The same threading rules as
+/// ::soundio_flush_events apply.
+SOUNDIO_EXPORT void soundio_dispatch_events(struct SoundIo *soundio);
+
 
 /// If necessary you can manually trigger a device rescan. Normally you will
 /// not ever have to call this function, as libsoundio listens to system events
@@ -853,6 +1185,54 @@ SOUNDIO_EXPORT const struct SoundIoChannelLayout *soundio_best_matching_channel_
 /// Sorts by channel count, descending.
 SOUNDIO_EXPORT void soundio_sort_channel_layouts(struct SoundIoChannelLayout *layouts, int layout_count);
 
+/// Flags for ::soundio_channel_mixer_create.
+enum SoundIoChannelMixerFlag {
+    /// Mix the LFE channel into the front channels when the destination has
+    /// no LFE channel. By default it is dropped, as ITU-R BS.775 downmixes do.
+    SoundIoChannelMixerFlagMixLfe = 1,
+    /// Scale down each destination channel whose gains add up to more than
+    /// 1, so that the mix cannot clip.
+    SoundIoChannelMixerFlagNormalize = 2,
+};
+
+struct SoundIoChannelMixer;
+
+/// Creates a mixer from `src_layout` to `dst_layout`. Channels which both
+/// layouts have pass through unchanged. Any other source channel is folded
+/// into the nearest channels the destination has, following the usual ITU
+/// downmix gains: center into left and right at -3 dB, surrounds into the
+/// fronts at -3 dB, back and side surrounds which share one destination
+/// channel at -3 dB each, height channels into the ear level channels below
+/// them, and so on. Upmixing only places channels, it does not synthesize the
+/// missing ones, except that mono feeds left and right at -3 dB. Source
+/// channels with nowhere to go are dropped.
+/// `flags` is a mask of #SoundIoChannelMixerFlag.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - a channel count is out of range
+/// * #SoundIoErrorNoMem
+SOUNDIO_EXPORT enum SoundIoError soundio_channel_mixer_create(const struct SoundIoChannelLayout *src_layout,
+        const struct SoundIoChannelLayout *dst_layout, int flags, struct SoundIoChannelMixer **out_mixer);
+/// Creates a mixer from a gain matrix of `dst_channel_count` rows of
+/// `src_channel_count` gains each: destination channel `d` gets the sum of
+/// `gains[d * src_channel_count + s]` times source channel `s`.
+SOUNDIO_EXPORT enum SoundIoError soundio_channel_mixer_create_custom(int src_channel_count,
+        int dst_channel_count, const float *gains, struct SoundIoChannelMixer **out_mixer);
+SOUNDIO_EXPORT void soundio_channel_mixer_destroy(struct SoundIoChannelMixer *mixer);
+
+/// Returns how much of source channel `src_channel` goes into destination
+/// channel `dst_channel`.
+SOUNDIO_EXPORT float soundio_channel_mixer_get_gain(struct SoundIoChannelMixer *mixer,
+        int dst_channel, int src_channel);
+
+/// Mixes `frame_count` frames of #SoundIoFormatFloat32NE samples. Each area
+/// may be planar or interleaved; `step` must be a multiple of 4. The source
+/// and destination must not overlap. Only the non-zero gains are applied, so
+/// routing a few channels of many is cheap. Safe to call from
+/// SoundIoOutStream::write_callback and SoundIoInStream::read_callback.
+SOUNDIO_EXPORT void soundio_channel_mixer_mix(struct SoundIoChannelMixer *mixer,
+        const struct SoundIoChannelArea *src_areas, const struct SoundIoChannelArea *dst_areas,
+        int frame_count);
+
 
 // Sample Formats
 
@@ -874,6 +1254,58 @@ static inline int soundio_get_bytes_per_second(enum SoundIoFormat format,
 /// Returns string representation of `format`.
 SOUNDIO_EXPORT const char * soundio_format_name(enum SoundIoFormat format);
 
+struct SoundIoConverter;
+
+/// Creates a converter between two sample formats for `channel_count`
+/// channels. Create it when the stream opens; the conversion loops are
+/// picked here, once, for the pair of formats and the channel count.
+/// Supported formats are #SoundIoFormatFloat32NE, #SoundIoFormatS16NE,
+/// #SoundIoFormatS24NE and #SoundIoFormatS32NE, in any combination. Float
+/// samples are clamped to [-1.0, 1.0] and rounded; narrowing between integer
+/// formats truncates.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - unsupported format or channel count
+/// * #SoundIoErrorNoMem
+SOUNDIO_EXPORT enum SoundIoError soundio_converter_create(enum SoundIoFormat src_format,
+        enum SoundIoFormat dst_format, int channel_count, struct SoundIoConverter **out_converter);
+SOUNDIO_EXPORT void soundio_converter_destroy(struct SoundIoConverter *converter);
+
+/// Dither for ::soundio_converter_set_dither.
+enum SoundIoDither {
+    /// Round to the nearest value. The default.
+    SoundIoDitherNone,
+    /// Triangular (TPDF) dither of +-1 LSB, which turns the distortion of
+    /// rounding into a constant, flat noise floor.
+    SoundIoDitherTriangular,
+    /// Triangular dither with first order noise shaping, moving the noise
+    /// towards high frequencies.
+    SoundIoDitherShapedLight,
+    /// Triangular dither with a 5-tap psychoacoustic noise shaping filter,
+    /// designed for 44.1 kHz and 48 kHz. Lowers the audible noise floor most,
+    /// at the cost of more total noise.
+    SoundIoDitherShapedStrong,
+};
+
+/// Dithers conversions which lose resolution: float32 to s16 or s24, and
+/// s24 or s32 to s16, and s32 to s24. For other conversions this has no
+/// effect. The noise shaping state of each channel carries over from one
+/// call of ::soundio_converter_convert to the next, so use one converter
+/// per stream. Call this before converting, not concurrently with it.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - unknown `dither`
+SOUNDIO_EXPORT enum SoundIoError soundio_converter_set_dither(struct SoundIoConverter *converter,
+        enum SoundIoDither dither);
+
+/// Converts `frame_count` frames from `src_areas` to `dst_areas`, for
+/// example straight into the areas of ::soundio_outstream_begin_write.
+/// Interleaved and planar areas take loops with fixed strides, unrolled for
+/// 2, 6 and 8 channels; other steps take a generic loop. The source and
+/// destination must not overlap. Safe to call from
+/// SoundIoOutStream::write_callback and SoundIoInStream::read_callback.
+SOUNDIO_EXPORT void soundio_converter_convert(struct SoundIoConverter *converter,
+        const struct SoundIoChannelArea *src_areas, const struct SoundIoChannelArea *dst_areas,
+        int frame_count);
+
 
 
 
@@ -1088,6 +1520,52 @@ SOUNDIO_EXPORT enum SoundIoError soundio_outstream_pause(struct SoundIoOutStream
 SOUNDIO_EXPORT enum SoundIoError soundio_outstream_get_latency(struct SoundIoOutStream *outstream,
         double *out_latency);
 
+/// Returns how many times the thread driving this stream woke up too late to
+/// service a period on schedule. Safe to call from any thread.
+SOUNDIO_EXPORT long soundio_outstream_deadline_miss_count(struct SoundIoOutStream *outstream);
+
+/// Copies the stream's counters into `out_stats`. Lock-free and safe to call
+/// from any thread while the stream runs. Each counter is read atomically,
+/// but the snapshot as a whole may straddle a callback.
+SOUNDIO_EXPORT void soundio_outstream_get_stats(struct SoundIoOutStream *outstream,
+        struct SoundIoStreamStats *out_stats);
+
+/// Queues `command` for SoundIoOutStream::command_callback. Lock-free and
+/// safe to call from any number of threads at once, including other
+/// streams' callbacks. `command` is copied.
+///
+/// Possible errors:
+/// * #SoundIoErrorInvalid - SoundIoOutStream::command_queue_capacity was 0
+/// * #SoundIoErrorSystemResources - the queue is full. Try again after the
+///   next callback.
+SOUNDIO_EXPORT enum SoundIoError soundio_outstream_post_command(struct SoundIoOutStream *outstream,
+        const struct SoundIoCommand *command);
+
+/// Call from SoundIoOutStream::command_callback or
+/// SoundIoOutStream::write_callback to have `ptr` released by the next
+/// ::soundio_outstream_collect_garbage instead of on the stream thread.
+/// `free_fn` releases it; `NULL` means `free`.
+///
+/// Possible errors:
+/// * #SoundIoErrorInvalid - SoundIoOutStream::command_queue_capacity was 0
+/// * #SoundIoErrorSystemResources - the queue is full; `ptr` still belongs
+///   to the caller.
+SOUNDIO_EXPORT enum SoundIoError soundio_outstream_defer_free(struct SoundIoOutStream *outstream,
+        void *ptr, void (*free_fn)(void *));
+
+/// Releases everything passed to ::soundio_outstream_defer_free so far.
+/// Call it now and then from a thread that may block, for example next to
+/// ::soundio_wait_events. ::soundio_outstream_destroy calls it one last
+/// time. Returns at once when another thread is already collecting.
+SOUNDIO_EXPORT void soundio_outstream_collect_garbage(struct SoundIoOutStream *outstream);
+
+/// Copies the latest levels of a stream opened with
+/// SoundIoOutStream::metering into `out_snapshot`. Lock-free and safe to
+/// call from any thread; unlike ::soundio_outstream_get_stats the snapshot
+/// is always consistent. Zeroes `out_snapshot` when the stream has no meter.
+SOUNDIO_EXPORT void soundio_outstream_get_meter(struct SoundIoOutStream *outstream,
+        struct SoundIoMeterSnapshot *out_snapshot);
+
 
 
 // Input Streams
@@ -1193,6 +1671,37 @@ SOUNDIO_EXPORT enum SoundIoError soundio_instream_pause(struct SoundIoInStream *
 SOUNDIO_EXPORT enum SoundIoError soundio_instream_get_latency(struct SoundIoInStream *instream,
         double *out_latency);
 
+/// See ::soundio_outstream_deadline_miss_count
+SOUNDIO_EXPORT long soundio_instream_deadline_miss_count(struct SoundIoInStream *instream);
+
+/// See ::soundio_outstream_get_stats
+SOUNDIO_EXPORT void soundio_instream_get_stats(struct SoundIoInStream *instream,
+        struct SoundIoStreamStats *out_stats);
+
+/// Number of times a realtime thread called `malloc`, `calloc`, `realloc`,
+/// `free`, `write` or `pthread_mutex_lock` while inside libsoundio's realtime
+/// sections, which cover every stream callback. Only tracked when libsoundio
+/// is built with the CMake option `ENABLE_RT_GUARD` (glibc only); returns -1
+/// otherwise. Such builds print the call site of each violation to stderr,
+/// and abort instead if the environment variable `SOUNDIO_RT_GUARD` is
+/// `abort`.
+SOUNDIO_EXPORT long soundio_rt_guard_violation_count(void);
+
+/// See ::soundio_outstream_post_command
+SOUNDIO_EXPORT enum SoundIoError soundio_instream_post_command(struct SoundIoInStream *instream,
+        const struct SoundIoCommand *command);
+
+/// See ::soundio_outstream_defer_free
+SOUNDIO_EXPORT enum SoundIoError soundio_instream_defer_free(struct SoundIoInStream *instream,
+        void *ptr, void (*free_fn)(void *));
+
+/// See ::soundio_outstream_collect_garbage
+SOUNDIO_EXPORT void soundio_instream_collect_garbage(struct SoundIoInStream *instream);
+
+/// See ::soundio_outstream_get_meter
+SOUNDIO_EXPORT void soundio_instream_get_meter(struct SoundIoInStream *instream,
+        struct SoundIoMeterSnapshot *out_snapshot);
+
 
 struct SoundIoRingBuffer;
 
@@ -1231,4 +1740,311 @@ SOUNDIO_EXPORT int soundio_ring_buffer_free_count(struct SoundIoRingBuffer *ring
 /// Must be called by the writer.
 SOUNDIO_EXPORT void soundio_ring_buffer_clear(struct SoundIoRingBuffer *ring_buffer);
 
+/// Must be called by the reader. Blocks until at least `count` bytes can be
+/// read or `timeout` seconds pass; a negative `timeout` waits forever.
+/// Returns whether the bytes are there. Sleeps on a futex on Linux and naps
+/// in short steps elsewhere. The writer stays lock-free: it makes a wake
+/// syscall only while someone waits, so it may write from a real time
+/// thread.
+SOUNDIO_EXPORT bool soundio_ring_buffer_wait_fill(struct SoundIoRingBuffer *ring_buffer,
+        int count, double timeout);
+/// Must be called by the writer. Like ::soundio_ring_buffer_wait_fill, for
+/// at least `count` free bytes. Not for use from a real time thread.
+SOUNDIO_EXPORT bool soundio_ring_buffer_wait_free(struct SoundIoRingBuffer *ring_buffer,
+        int count, double timeout);
+
+/// Flags for ::soundio_ring_buffer_pool_reserve.
+enum SoundIoRingBufferPoolFlag {
+    /// Back the regions with huge pages when the system has them configured.
+    /// Each region then rounds up to a multiple of the huge page size, and
+    /// only serves ring buffers close to that size. Falls back to normal
+    /// pages otherwise.
+    SoundIoRingBufferPoolFlagHugePages = 1,
+    /// Fault in and `mlock` the regions so that reading and writing them never
+    /// page faults. Failing to lock, for example because of `RLIMIT_MEMLOCK`,
+    /// is not an error.
+    SoundIoRingBufferPoolFlagLock = 2,
+};
+
+/// Builds `count` ring buffer memory regions of at least `capacity` bytes
+/// ahead of time. ::soundio_ring_buffer_create and the ring buffers which
+/// backends create when a stream opens take the smallest idle region that
+/// fits instead of mapping new memory. A region only serves requests which
+/// round up to `capacity` or to at most half of it, so that a buffer is
+/// never much larger, and a stream's latency never much higher, than asked
+/// for. Destroying such a ring buffer returns
+/// its region to the pool. The pool is shared by the whole process.
+/// `flags` is a mask of #SoundIoRingBufferPoolFlag.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - `capacity` or `count` is not positive
+/// * #SoundIoErrorNoMem - out of memory or the pool holds too many regions
+/// * #SoundIoErrorSystemResources
+SOUNDIO_EXPORT enum SoundIoError soundio_ring_buffer_pool_reserve(int capacity, int count, int flags);
+
+/// Unmaps every idle region of the pool. Regions in use stay in the pool and
+/// return to it when their ring buffer is destroyed.
+SOUNDIO_EXPORT void soundio_ring_buffer_pool_trim(void);
+
+struct SoundIoRingBufferPoolStats {
+    /// Ring buffers whose memory came from the pool.
+    long hits;
+    /// Ring buffers which had to map new memory.
+    long misses;
+    /// Regions waiting in the pool.
+    int idle_count;
+};
+
+/// Counters are process wide and never reset.
+SOUNDIO_EXPORT void soundio_ring_buffer_pool_get_stats(struct SoundIoRingBufferPoolStats *out_stats);
+
+
+struct SoundIoFrameRingBuffer;
+
+/// A frame ring buffer is a ring buffer of interleaved frames with the same
+/// single reader, single writer rules and mirrored memory as
+/// ::soundio_ring_buffer_create. Sizes and positions are counted in frames
+/// with 64-bit integers, so it is not limited to 2 GiB. Reading and writing
+/// go through channel areas like stream callbacks do, so a callback can
+/// convert samples straight into or out of the buffer.
+/// `requested_frames` of `channel_count` channels in `format`.
+/// Returns `NULL` if and only if memory could not be allocated.
+/// Use ::soundio_frame_ring_buffer_capacity to get the actual capacity, which
+/// might be greater.
+/// See also ::soundio_frame_ring_buffer_destroy
+SOUNDIO_EXPORT struct SoundIoFrameRingBuffer *soundio_frame_ring_buffer_create(struct SoundIo *soundio,
+        enum SoundIoFormat format, int channel_count, int64_t requested_frames);
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_destroy(struct SoundIoFrameRingBuffer *ring_buffer);
+
+/// In frames.
+SOUNDIO_EXPORT int64_t soundio_frame_ring_buffer_capacity(struct SoundIoFrameRingBuffer *ring_buffer);
+SOUNDIO_EXPORT int soundio_frame_ring_buffer_bytes_per_frame(struct SoundIoFrameRingBuffer *ring_buffer);
+
+/// Returns how many frames are ready for reading.
+SOUNDIO_EXPORT int64_t soundio_frame_ring_buffer_fill_count(struct SoundIoFrameRingBuffer *ring_buffer);
+/// Returns how many frames can be written.
+SOUNDIO_EXPORT int64_t soundio_frame_ring_buffer_free_count(struct SoundIoFrameRingBuffer *ring_buffer);
+
+/// Writer only. Reserves up to `*frame_count` frames for writing and sets
+/// `*frame_count` to how many it could reserve, which is 0 when the buffer
+/// is full. `*out_areas` gets one area per channel, valid until
+/// ::soundio_frame_ring_buffer_end_write. The reserved frames are one
+/// contiguous run even across the end of the buffer.
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_begin_write(struct SoundIoFrameRingBuffer *ring_buffer,
+        struct SoundIoChannelArea **out_areas, int64_t *frame_count);
+/// Writer only. Makes the first `frame_count` reserved frames readable.
+/// `frame_count` may be less than what ::soundio_frame_ring_buffer_begin_write
+/// reserved.
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_end_write(struct SoundIoFrameRingBuffer *ring_buffer,
+        int64_t frame_count);
+
+/// Reader only. Like ::soundio_frame_ring_buffer_begin_write, for up to
+/// `*frame_count` frames of what has been written.
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_begin_read(struct SoundIoFrameRingBuffer *ring_buffer,
+        struct SoundIoChannelArea **out_areas, int64_t *frame_count);
+/// Reader only. Frees the first `frame_count` frames handed out by
+/// ::soundio_frame_ring_buffer_begin_read.
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_end_read(struct SoundIoFrameRingBuffer *ring_buffer,
+        int64_t frame_count);
+
+/// Must be called by the writer.
+SOUNDIO_EXPORT void soundio_frame_ring_buffer_clear(struct SoundIoFrameRingBuffer *ring_buffer);
+
+struct SoundIoBroadcastRingBuffer;
+
+/// What a broadcast ring buffer does when the writer catches up with a
+/// reader.
+enum SoundIoBroadcastOverrun {
+    /// The writer never overwrites data that a reader has not read yet.
+    /// ::soundio_broadcast_ring_buffer_free_count is limited by the slowest
+    /// reader, so a stalled reader eventually stalls the writer.
+    SoundIoBroadcastOverrunBlockWriter,
+    /// The writer may always write a whole capacity. A reader the writer
+    /// laps loses everything it had not read: its next
+    /// ::soundio_broadcast_ring_buffer_fill_count returns 0, counts an
+    /// overrun and the reader continues with what the writer writes next.
+    /// A reader lagging by nearly a capacity may copy data which the writer
+    /// is overwriting at the same time. ::soundio_broadcast_ring_buffer_advance_read_ptr
+    /// then returns false and counts an overrun, and the bytes just copied
+    /// must be discarded.
+    SoundIoBroadcastOverrunDropReader,
+};
+
+/// A broadcast ring buffer is a ring buffer with one writer and up to
+/// `max_readers` readers, each of which sees every byte written after it was
+/// added, at its own pace. It uses the same mirrored memory as
+/// ::soundio_ring_buffer_create, so reads and writes are contiguous across
+/// the end of the buffer.
+/// `requested_capacity` in bytes.
+/// Returns `NULL` if and only if memory could not be allocated.
+/// See also ::soundio_broadcast_ring_buffer_destroy
+SOUNDIO_EXPORT struct SoundIoBroadcastRingBuffer *soundio_broadcast_ring_buffer_create(struct SoundIo *soundio,
+        int requested_capacity, int max_readers, enum SoundIoBroadcastOverrun overrun);
+SOUNDIO_EXPORT void soundio_broadcast_ring_buffer_destroy(struct SoundIoBroadcastRingBuffer *ring_buffer);
+
+/// See ::soundio_ring_buffer_capacity
+SOUNDIO_EXPORT int soundio_broadcast_ring_buffer_capacity(struct SoundIoBroadcastRingBuffer *ring_buffer);
+
+/// Adds a reader, which starts at the current write position. The returned
+/// index identifies the reader in the other reader functions. May be called
+/// from any thread, also while the writer is writing.
+/// Possible errors:
+/// * #SoundIoErrorSystemResources - `max_readers` readers exist already
+SOUNDIO_EXPORT enum SoundIoError soundio_broadcast_ring_buffer_add_reader(
+        struct SoundIoBroadcastRingBuffer *ring_buffer, int *out_reader);
+/// The reader no longer holds the writer back. Its index may be handed out
+/// again by ::soundio_broadcast_ring_buffer_add_reader.
+SOUNDIO_EXPORT void soundio_broadcast_ring_buffer_remove_reader(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int reader);
+
+/// Writer only. Do not write more than
+/// ::soundio_broadcast_ring_buffer_free_count.
+SOUNDIO_EXPORT char *soundio_broadcast_ring_buffer_write_ptr(struct SoundIoBroadcastRingBuffer *ring_buffer);
+/// Writer only. `count` in bytes.
+SOUNDIO_EXPORT void soundio_broadcast_ring_buffer_advance_write_ptr(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int count);
+/// Writer only. Returns how many bytes can be written, see
+/// #SoundIoBroadcastOverrun.
+SOUNDIO_EXPORT int soundio_broadcast_ring_buffer_free_count(struct SoundIoBroadcastRingBuffer *ring_buffer);
+
+/// Do not read more than ::soundio_broadcast_ring_buffer_fill_count.
+SOUNDIO_EXPORT char *soundio_broadcast_ring_buffer_read_ptr(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int reader);
+/// `count` in bytes. Returns false with #SoundIoBroadcastOverrunDropReader
+/// when the writer may have overwritten some of the `count` bytes while they
+/// were being read. Discard what was read; the reader continues with what
+/// the writer writes next. Always returns true with
+/// #SoundIoBroadcastOverrunBlockWriter.
+SOUNDIO_EXPORT bool soundio_broadcast_ring_buffer_advance_read_ptr(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int reader, int count);
+/// Returns how many bytes `reader` has not read yet.
+SOUNDIO_EXPORT int soundio_broadcast_ring_buffer_fill_count(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int reader);
+
+struct SoundIoBroadcastReaderStats {
+    /// Bytes written which the reader has not read yet.
+    int lag;
+    /// The largest lag seen by ::soundio_broadcast_ring_buffer_fill_count
+    /// and this function since the reader was added.
+    int max_lag;
+    /// How many times the writer lapped the reader. Always 0 with
+    /// #SoundIoBroadcastOverrunBlockWriter.
+    long overrun_count;
+};
+
+/// May be called from any thread.
+SOUNDIO_EXPORT void soundio_broadcast_ring_buffer_get_reader_stats(struct SoundIoBroadcastRingBuffer *ring_buffer,
+        int reader, struct SoundIoBroadcastReaderStats *out_stats);
+
+/// How many readers may be attached to one shared ring buffer at a time.
+#define SOUNDIO_SHARED_RING_BUFFER_MAX_READERS 16
+
+struct SoundIoSharedRingBuffer;
+
+/// A shared ring buffer is a mirrored ring buffer which several processes
+/// map. The process which creates it is the only writer. Every process which
+/// attaches is a reader with its own read position, starting at the write
+/// position at the time it attaches. The writer never overwrites data that an
+/// attached reader has not read yet, so a stalled reader eventually stalls
+/// the writer; destroy the handle of a reader which stops reading. A reader
+/// whose process dies keeps its slot, and holds the writer back, until the
+/// writer calls ::soundio_shared_ring_buffer_evict_reader.
+///
+/// The buffer also records the format, sample rate and channel layout the
+/// writer announced, see ::soundio_shared_ring_buffer_get_format.
+///
+/// `name` is a POSIX shared memory name such as "capture" or "/capture" that
+/// readers pass to ::soundio_shared_ring_buffer_attach. It must not exist
+/// yet. Pass `NULL` to create an anonymous buffer instead, and hand it to
+/// readers with ::soundio_shared_ring_buffer_send.
+/// `requested_capacity` in bytes; the actual capacity might be greater.
+///
+/// Not available on Windows.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - bad parameters, or `name` already exists
+/// * #SoundIoErrorNoMem
+/// * #SoundIoErrorSystemResources
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_create(const char *name, int requested_capacity,
+        enum SoundIoFormat format, int sample_rate, const struct SoundIoChannelLayout *layout,
+        struct SoundIoSharedRingBuffer **out_ring_buffer);
+/// Attaches as a reader to a buffer created with a name.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - no such buffer, or it is not a shared ring buffer
+/// * #SoundIoErrorNoMem
+/// * #SoundIoErrorSystemResources - also when all reader slots are taken
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_attach(const char *name,
+        struct SoundIoSharedRingBuffer **out_ring_buffer);
+/// Attaches as a reader through a file descriptor of the buffer's memory,
+/// such as one received over a Unix domain socket. On success the returned
+/// buffer owns `fd`.
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_attach_fd(int fd,
+        struct SoundIoSharedRingBuffer **out_ring_buffer);
+/// Sends the buffer's file descriptor over the Unix domain socket
+/// `socket_fd`. The receiving process calls
+/// ::soundio_shared_ring_buffer_receive.
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_send(struct SoundIoSharedRingBuffer *ring_buffer,
+        int socket_fd);
+/// Receives a file descriptor sent with ::soundio_shared_ring_buffer_send
+/// and attaches to it as a reader.
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_receive(int socket_fd,
+        struct SoundIoSharedRingBuffer **out_ring_buffer);
+/// A reader gives up its reader slot. The writer removes the buffer's name;
+/// readers which are still attached keep working.
+SOUNDIO_EXPORT void soundio_shared_ring_buffer_destroy(struct SoundIoSharedRingBuffer *ring_buffer);
+
+/// The file descriptor of the buffer's memory. Owned by the buffer.
+SOUNDIO_EXPORT int soundio_shared_ring_buffer_fd(struct SoundIoSharedRingBuffer *ring_buffer);
+SOUNDIO_EXPORT int soundio_shared_ring_buffer_capacity(struct SoundIoSharedRingBuffer *ring_buffer);
+/// Any of the out parameters may be `NULL`.
+SOUNDIO_EXPORT void soundio_shared_ring_buffer_get_format(struct SoundIoSharedRingBuffer *ring_buffer,
+        enum SoundIoFormat *out_format, int *out_sample_rate, struct SoundIoChannelLayout *out_layout);
+
+/// Writer only. Do not write more than ::soundio_shared_ring_buffer_free_count.
+SOUNDIO_EXPORT char *soundio_shared_ring_buffer_write_ptr(struct SoundIoSharedRingBuffer *ring_buffer);
+/// Writer only. `count` in bytes. Makes a wake syscall only when a reader is
+/// blocked in ::soundio_shared_ring_buffer_wait_fill.
+SOUNDIO_EXPORT void soundio_shared_ring_buffer_advance_write_ptr(struct SoundIoSharedRingBuffer *ring_buffer,
+        int count);
+/// Writer only. Returns how many bytes can be written without overtaking the
+/// slowest attached reader.
+SOUNDIO_EXPORT int soundio_shared_ring_buffer_free_count(struct SoundIoSharedRingBuffer *ring_buffer);
+
+/// Reader only. Do not read more than ::soundio_shared_ring_buffer_fill_count.
+SOUNDIO_EXPORT char *soundio_shared_ring_buffer_read_ptr(struct SoundIoSharedRingBuffer *ring_buffer);
+/// Reader only. `count` in bytes.
+SOUNDIO_EXPORT void soundio_shared_ring_buffer_advance_read_ptr(struct SoundIoSharedRingBuffer *ring_buffer,
+        int count);
+/// Reader only. Returns how many bytes this reader has not read yet.
+SOUNDIO_EXPORT int soundio_shared_ring_buffer_fill_count(struct SoundIoSharedRingBuffer *ring_buffer);
+
+/// Reader only. Returns false once the writer evicted this reader with
+/// ::soundio_shared_ring_buffer_evict_reader. From then on the writer may
+/// overwrite anything, ::soundio_shared_ring_buffer_fill_count returns 0,
+/// and the reader should destroy its handle and attach again.
+SOUNDIO_EXPORT bool soundio_shared_ring_buffer_is_attached(struct SoundIoSharedRingBuffer *ring_buffer);
+
+/// Writer only. Returns how many bytes the reader in slot `index`, from 0 to
+/// #SOUNDIO_SHARED_RING_BUFFER_MAX_READERS - 1, has not read yet, or -1 if
+/// no reader is attached there. A reader whose lag stays at the capacity is
+/// not reading.
+SOUNDIO_EXPORT int soundio_shared_ring_buffer_reader_lag(struct SoundIoSharedRingBuffer *ring_buffer,
+        int index);
+/// Writer only. Frees reader slot `index` so that the reader no longer holds
+/// the writer back, for example because its process died. The slot can be
+/// claimed by the next reader which attaches.
+/// Possible errors:
+/// * #SoundIoErrorInvalid - no reader is attached in that slot, or
+///   `ring_buffer` is a reader
+SOUNDIO_EXPORT enum SoundIoError soundio_shared_ring_buffer_evict_reader(struct SoundIoSharedRingBuffer *ring_buffer,
+        int index);
+
+/// Reader only. Blocks until at least `count` bytes can be read or `timeout`
+/// seconds pass; a negative `timeout` waits forever. Returns whether the
+/// bytes are there. Sleeps on a futex on Linux.
+SOUNDIO_EXPORT bool soundio_shared_ring_buffer_wait_fill(struct SoundIoSharedRingBuffer *ring_buffer,
+        int count, double timeout);
+/// Writer only. Like ::soundio_shared_ring_buffer_wait_fill, for at least
+/// `count` free bytes. Not for use from a real time thread.
+SOUNDIO_EXPORT bool soundio_shared_ring_buffer_wait_free(struct SoundIoSharedRingBuffer *ring_buffer,
+        int count, double timeout);
+
 #endif
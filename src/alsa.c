@@ -78,6 +78,21 @@ static inline snd_pcm_uframes_t ceil_dbl_to_uframes(double x) {
     return truncation + (truncation < x);
 }
 
+// Reads back the thresholds ALSA settled on after snd_pcm_sw_params.
+static enum SoundIoError get_sw_params_thresholds(snd_pcm_sw_params_t *swparams,
+        int *out_avail_min, int *out_start_threshold)
+{
+    snd_pcm_uframes_t avail_min;
+    snd_pcm_uframes_t start_threshold;
+    if (snd_pcm_sw_params_get_avail_min(swparams, &avail_min) < 0)
+        return SoundIoErrorOpeningDevice;
+    if (snd_pcm_sw_params_get_start_threshold(swparams, &start_threshold) < 0)
+        return SoundIoErrorOpeningDevice;
+    *out_avail_min = avail_min;
+    *out_start_threshold = start_threshold;
+    return 0;
+}
+
 static char * str_partition_on_char(char *str, char c) {
     if (!str)
         return NULL;
@@ -772,7 +787,7 @@ static int refresh_devices(struct SoundIoPrivate *si) {
     sia->ready_devices_info = devices_info;
     sia->have_devices_flag = true;
     soundio_os_cond_signal(sia->cond, sia->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(sia->mutex);
     return 0;
 }
@@ -783,7 +798,7 @@ static void shutdown_backend(struct SoundIoPrivate *si, int err) {
     soundio_os_mutex_lock(sia->mutex);
     sia->shutdown_err = err;
     soundio_os_cond_signal(sia->cond, sia->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(sia->mutex);
 }
 
@@ -1027,7 +1042,7 @@ static int outstream_xrun_recovery(struct SoundIoOutStreamPrivate *os, int err)
     if (err == -EPIPE) {
         err = snd_pcm_prepare(osa->handle);
         if (err >= 0)
-            outstream->underflow_callback(outstream);
+            soundio_outstream_invoke_underflow(outstream);
     } else if (err == -ESTRPIPE) {
         while ((err = snd_pcm_resume(osa->handle)) == -EAGAIN) {
             // wait until suspend flag is released
@@ -1036,7 +1051,7 @@ static int outstream_xrun_recovery(struct SoundIoOutStreamPrivate *os, int err)
         if (err < 0)
             err = snd_pcm_prepare(osa->handle);
         if (err >= 0)
-            outstream->underflow_callback(outstream);
+            soundio_outstream_invoke_underflow(outstream);
     }
     return err;
 }
@@ -1047,7 +1062,7 @@ static int instream_xrun_recovery(struct SoundIoInStreamPrivate *is, int err) {
     if (err == -EPIPE) {
         err = snd_pcm_prepare(isa->handle);
         if (err >= 0)
-            instream->overflow_callback(instream);
+            soundio_instream_invoke_overflow(instream);
     } else if (err == -ESTRPIPE) {
         while ((err = snd_pcm_resume(isa->handle)) == -EAGAIN) {
             // wait until suspend flag is released
@@ -1056,7 +1071,7 @@ static int instream_xrun_recovery(struct SoundIoInStreamPrivate *is, int err) {
         if (err < 0)
             err = snd_pcm_prepare(isa->handle);
         if (err >= 0)
-            instream->overflow_callback(instream);
+            soundio_instream_invoke_overflow(instream);
     }
     return err;
 }
@@ -1132,7 +1147,7 @@ static void outstream_thread_run(void *arg) {
                 }
 
                 if ((snd_pcm_uframes_t)avail == osa->buffer_size_frames) {
-                    outstream->write_callback(outstream, 0, avail);
+                    soundio_outstream_invoke_write(outstream, 0, avail);
                     if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osa->thread_exit_flag))
                         return;
                     continue;
@@ -1182,8 +1197,12 @@ static void outstream_thread_run(void *arg) {
                     continue;
                 }
 
+                // poll fires once avail_min frames are free; anything beyond
+                // that piled up while the thread was waiting to run
+                soundio_outstream_record_wakeup(outstream,
+                        (avail - outstream->avail_min) / (double)outstream->sample_rate);
                 if (avail > 0)
-                    outstream->write_callback(outstream, 0, avail);
+                    soundio_outstream_invoke_write(outstream, 0, avail);
                 continue;
             }
             case SND_PCM_STATE_XRUN:
@@ -1251,8 +1270,10 @@ static void instream_thread_run(void *arg) {
                     continue;
                 }
 
+                soundio_instream_record_wakeup(instream,
+                        (avail - instream->avail_min) / (double)instream->sample_rate);
                 if (avail > 0)
-                    instream->read_callback(instream, 0, avail);
+                    soundio_instream_invoke_read(instream, 0, avail);
                 continue;
             }
             case SND_PCM_STATE_XRUN:
@@ -1346,12 +1367,29 @@ static enum SoundIoError outstream_open_alsa(struct SoundIoPrivate *si, struct S
         return SoundIoErrorOpeningDevice;
     }
 
-    osa->buffer_size_frames = outstream->software_latency * outstream->sample_rate;
-    if ((err = snd_pcm_hw_params_set_buffer_size_near(osa->handle, hwparams, &osa->buffer_size_frames)) < 0) {
-        outstream_destroy_alsa(si, os);
-        return SoundIoErrorOpeningDevice;
+    // The period is constrained before the buffer so that an explicit
+    // period geometry wins over software_latency.
+    if (outstream->period_frames > 0) {
+        snd_pcm_uframes_t period_frames = outstream->period_frames;
+        if ((err = snd_pcm_hw_params_set_period_size_near(osa->handle, hwparams, &period_frames, NULL)) < 0) {
+            outstream_destroy_alsa(si, os);
+            return SoundIoErrorOpeningDevice;
+        }
+    }
+    if (outstream->period_count > 0) {
+        unsigned int periods = outstream->period_count;
+        if ((err = snd_pcm_hw_params_set_periods_near(osa->handle, hwparams, &periods, NULL)) < 0) {
+            outstream_destroy_alsa(si, os);
+            return SoundIoErrorOpeningDevice;
+        }
+    }
+    if (outstream->period_frames <= 0 || outstream->period_count <= 0) {
+        osa->buffer_size_frames = outstream->software_latency * outstream->sample_rate;
+        if ((err = snd_pcm_hw_params_set_buffer_size_near(osa->handle, hwparams, &osa->buffer_size_frames)) < 0) {
+            outstream_destroy_alsa(si, os);
+            return SoundIoErrorOpeningDevice;
+        }
     }
-    outstream->software_latency = ((double)osa->buffer_size_frames) / (double)outstream->sample_rate;
 
     // write the hardware parameters to device
     if ((err = snd_pcm_hw_params(osa->handle, hwparams)) < 0) {
@@ -1359,10 +1397,17 @@ static enum SoundIoError outstream_open_alsa(struct SoundIoPrivate *si, struct S
         return (err == -EINVAL) ? SoundIoErrorIncompatibleDevice : SoundIoErrorOpeningDevice;
     }
 
-    if ((snd_pcm_hw_params_get_period_size(hwparams, &osa->period_size, NULL)) < 0) {
+    unsigned int periods;
+    if ((err = snd_pcm_hw_params_get_buffer_size(hwparams, &osa->buffer_size_frames)) < 0 ||
+        (err = snd_pcm_hw_params_get_period_size(hwparams, &osa->period_size, NULL)) < 0 ||
+        (err = snd_pcm_hw_params_get_periods(hwparams, &periods, NULL)) < 0)
+    {
         outstream_destroy_alsa(si, os);
         return SoundIoErrorOpeningDevice;
     }
+    outstream->software_latency = ((double)osa->buffer_size_frames) / (double)outstream->sample_rate;
+    outstream->period_frames = osa->period_size;
+    outstream->period_count = periods;
 
 
     // set channel map
@@ -1398,6 +1443,11 @@ static enum SoundIoError outstream_open_alsa(struct SoundIoPrivate *si, struct S
         return (err == -EINVAL) ? SoundIoErrorIncompatibleDevice : SoundIoErrorOpeningDevice;
     }
 
+    if ((err = get_sw_params_thresholds(swparams, &outstream->avail_min, &outstream->start_threshold))) {
+        outstream_destroy_alsa(si, os);
+        return err;
+    }
+
     if (osa->access == SND_PCM_ACCESS_RW_INTERLEAVED || osa->access == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
         osa->sample_buffer_size = ch_count * osa->period_size * phys_bytes_per_sample;
         osa->sample_buffer = ALLOCATE_NONZERO(char, osa->sample_buffer_size);
@@ -1441,14 +1491,20 @@ static enum SoundIoError outstream_open_alsa(struct SoundIoPrivate *si, struct S
 
 static enum SoundIoError outstream_start_alsa(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamAlsa *osa = &os->backend_data.alsa;
+    struct SoundIoOutStream *outstream = &os->pub;
     struct SoundIo *soundio = &si->pub;
 
     assert(!osa->thread);
 
     enum SoundIoError err;
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osa->thread_exit_flag);
-    if ((err = soundio_os_thread_create(outstream_thread_run, os, soundio, &osa->thread)))
+    double period = osa->period_size / (double)outstream->sample_rate;
+    if ((err = soundio_os_thread_create_with_attributes(outstream_thread_run, os, soundio,
+                    &outstream->thread_attributes, period, &outstream->actual_thread_attributes,
+                    &osa->thread)))
+    {
         return err;
+    }
 
     return 0;
 }
@@ -1668,19 +1724,25 @@ static enum SoundIoError instream_open_alsa(struct SoundIoPrivate *si, struct So
         return SoundIoErrorOpeningDevice;
     }
 
-    snd_pcm_uframes_t period_frames = ceil_dbl_to_uframes(0.5 * instream->software_latency * (double)instream->sample_rate);
+    snd_pcm_uframes_t period_frames = (instream->period_frames > 0) ? (snd_pcm_uframes_t)instream->period_frames :
+        ceil_dbl_to_uframes(0.5 * instream->software_latency * (double)instream->sample_rate);
     if ((err = snd_pcm_hw_params_set_period_size_near(isa->handle, hwparams, &period_frames, NULL)) < 0) {
         instream_destroy_alsa(si, is);
         return SoundIoErrorOpeningDevice;
     }
-    instream->software_latency = ((double)period_frames) / (double)instream->sample_rate;
-    isa->period_size = period_frames;
 
-
-    snd_pcm_uframes_t buffer_size_frames;
-    if ((err = snd_pcm_hw_params_set_buffer_size_last(isa->handle, hwparams, &buffer_size_frames)) < 0) {
-        instream_destroy_alsa(si, is);
-        return SoundIoErrorOpeningDevice;
+    if (instream->period_count > 0) {
+        unsigned int periods = instream->period_count;
+        if ((err = snd_pcm_hw_params_set_periods_near(isa->handle, hwparams, &periods, NULL)) < 0) {
+            instream_destroy_alsa(si, is);
+            return SoundIoErrorOpeningDevice;
+        }
+    } else {
+        snd_pcm_uframes_t buffer_size_frames;
+        if ((err = snd_pcm_hw_params_set_buffer_size_last(isa->handle, hwparams, &buffer_size_frames)) < 0) {
+            instream_destroy_alsa(si, is);
+            return SoundIoErrorOpeningDevice;
+        }
     }
 
     // write the hardware parameters to device
@@ -1689,6 +1751,18 @@ static enum SoundIoError instream_open_alsa(struct SoundIoPrivate *si, struct So
         return (err == -EINVAL) ? SoundIoErrorIncompatibleDevice : SoundIoErrorOpeningDevice;
     }
 
+    unsigned int periods;
+    if ((err = snd_pcm_hw_params_get_period_size(hwparams, &period_frames, NULL)) < 0 ||
+        (err = snd_pcm_hw_params_get_periods(hwparams, &periods, NULL)) < 0)
+    {
+        instream_destroy_alsa(si, is);
+        return SoundIoErrorOpeningDevice;
+    }
+    instream->software_latency = ((double)period_frames) / (double)instream->sample_rate;
+    isa->period_size = period_frames;
+    instream->period_frames = period_frames;
+    instream->period_count = periods;
+
     // set channel map
     isa->chmap->channels = ch_count;
     for (int i = 0; i < ch_count; i += 1) {
@@ -1712,6 +1786,11 @@ static enum SoundIoError instream_open_alsa(struct SoundIoPrivate *si, struct So
         return (err == -EINVAL) ? SoundIoErrorIncompatibleDevice : SoundIoErrorOpeningDevice;
     }
 
+    if ((err = get_sw_params_thresholds(swparams, &instream->avail_min, &instream->start_threshold))) {
+        instream_destroy_alsa(si, is);
+        return err;
+    }
+
     if (isa->access == SND_PCM_ACCESS_RW_INTERLEAVED || isa->access == SND_PCM_ACCESS_RW_NONINTERLEAVED) {
         isa->sample_buffer_size = ch_count * isa->period_size * phys_bytes_per_sample;
         isa->sample_buffer = ALLOCATE_NONZERO(char, isa->sample_buffer_size);
@@ -1743,13 +1822,18 @@ static enum SoundIoError instream_open_alsa(struct SoundIoPrivate *si, struct So
 
 static enum SoundIoError instream_start_alsa(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
     struct SoundIoInStreamAlsa *isa = &is->backend_data.alsa;
+    struct SoundIoInStream *instream = &is->pub;
     struct SoundIo *soundio = &si->pub;
 
     assert(!isa->thread);
 
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isa->thread_exit_flag);
     enum SoundIoError err;
-    if ((err = soundio_os_thread_create(instream_thread_run, is, soundio, &isa->thread))) {
+    double period = isa->period_size / (double)instream->sample_rate;
+    if ((err = soundio_os_thread_create_with_attributes(instream_thread_run, is, soundio,
+                    &instream->thread_attributes, period, &instream->actual_thread_attributes,
+                    &isa->thread)))
+    {
         instream_destroy_alsa(si, is);
         return err;
     }
@@ -84,7 +84,7 @@ static void write_callback_android(SLAndroidSimpleBufferQueueItf bq, void* conte
     struct SoundIoOutStream *outstream = &os->pub;
 
     osa->write_frame_count = 0;
-    outstream->write_callback(outstream, 1, osa->bytes_per_buffer /
+    soundio_outstream_invoke_write(outstream, 1, osa->bytes_per_buffer /
         outstream->bytes_per_frame);
 
     // Sometimes write callbacks return without writing to any buffers. They're
@@ -307,7 +307,7 @@ static void read_callback_android(SLAndroidSimpleBufferQueueItf bq, void* contex
     struct SoundIoInStream *instream = &is->pub;
 
     int frame_count = isa->bytes_per_buffer / instream->bytes_per_frame;
-    instream->read_callback(instream, frame_count, frame_count);
+    soundio_instream_invoke_read(instream, frame_count, frame_count);
 
     if (SL_RESULT_SUCCESS != (*isa->recorderBufferQueue)->Enqueue(
         isa->recorderBufferQueue, isa->buffers[isa->curBuffer], isa->bytes_per_buffer))
@@ -782,5 +782,8 @@ enum SoundIoError soundio_android_init(struct SoundIoPrivate *si) {
         }
     }
 
+    // devices are known up front; let event loop users see them right away
+    soundio_emit_events_signal(soundio);
+
     return SoundIoErrorNone;
 }
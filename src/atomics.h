@@ -14,11 +14,16 @@
 #ifdef __cplusplus
 
 #include <atomic>
+#include <cstdint>
 
 struct SoundIoAtomicLong {
     std::atomic<long> x;
 };
 
+struct SoundIoAtomicInt64 {
+    std::atomic<int64_t> x;
+};
+
 struct SoundIoAtomicInt {
     std::atomic<int> x;
 };
@@ -35,18 +40,26 @@ struct SoundIoAtomicFlag {
 #define SOUNDIO_ATOMIC_FETCH_ADD(a, delta) (a.x.fetch_add(delta))
 #define SOUNDIO_ATOMIC_STORE(a, value) (a.x.store(value))
 #define SOUNDIO_ATOMIC_EXCHANGE(a, value) (a.x.exchange(value))
+#define SOUNDIO_ATOMIC_COMPARE_EXCHANGE(a, expected_ptr, desired) (a.x.compare_exchange_strong(*(expected_ptr), desired))
 #define SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(a) (a.x.test_and_set())
 #define SOUNDIO_ATOMIC_FLAG_CLEAR(a) (a.x.clear())
 #define SOUNDIO_ATOMIC_FLAG_INIT ATOMIC_FLAG_INIT
+#define SOUNDIO_ATOMIC_THREAD_FENCE() (std::atomic_thread_fence(std::memory_order_seq_cst))
 
 #else
 
 #include <stdatomic.h>
+#include <stdint.h>
 
 struct SoundIoAtomicLong {
     atomic_long x;
 };
 
+// Fixed width so that processes sharing it agree on its layout.
+struct SoundIoAtomicInt64 {
+    _Atomic int64_t x;
+};
+
 struct SoundIoAtomicInt {
     atomic_int x;
 };
@@ -63,9 +76,11 @@ struct SoundIoAtomicFlag {
 #define SOUNDIO_ATOMIC_FETCH_ADD(a, delta) atomic_fetch_add(&a.x, delta)
 #define SOUNDIO_ATOMIC_STORE(a, value) atomic_store(&a.x, value)
 #define SOUNDIO_ATOMIC_EXCHANGE(a, value) atomic_exchange(&a.x, value)
+#define SOUNDIO_ATOMIC_COMPARE_EXCHANGE(a, expected_ptr, desired) atomic_compare_exchange_strong(&a.x, expected_ptr, desired)
 #define SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(a) atomic_flag_test_and_set(&a.x)
 #define SOUNDIO_ATOMIC_FLAG_CLEAR(a) atomic_flag_clear(&a.x)
 #define SOUNDIO_ATOMIC_FLAG_INIT ATOMIC_FLAG_INIT
+#define SOUNDIO_ATOMIC_THREAD_FENCE() atomic_thread_fence(memory_order_seq_cst)
 
 #endif
 
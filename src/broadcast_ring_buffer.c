@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "soundio_private.h"
+#include "os.h"
+#include "atomics.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BROADCAST_CACHE_LINE 64
+
+enum BroadcastReaderState {
+    BroadcastReaderStateFree,
+    BroadcastReaderStateClaimed,
+    BroadcastReaderStateActive,
+};
+
+// Each reader's cursor gets its own cache line so that readers on different
+// cores do not slow each other or the writer down.
+struct BroadcastReader {
+    // enum BroadcastReaderState
+    struct SoundIoAtomicInt state;
+    struct SoundIoAtomicInt max_lag;
+    struct SoundIoAtomicLong read_offset;
+    struct SoundIoAtomicLong overrun_count;
+    char padding[BROADCAST_CACHE_LINE - 2 * sizeof(int) - 2 * sizeof(long)];
+};
+
+struct SoundIoBroadcastRingBuffer {
+    struct SoundIoOsMirroredMemory mem;
+    int capacity;
+    int max_readers;
+    enum SoundIoBroadcastOverrun overrun;
+    // cache line aligned, inside readers_allocation
+    struct BroadcastReader *readers;
+    char *readers_allocation;
+
+    // away from the fields above, which readers only ever read
+    char padding[BROADCAST_CACHE_LINE];
+    struct SoundIoAtomicLong write_offset;
+    // largest advance_write_ptr so far; a write in progress may already be
+    // overwriting this much beyond write_offset - capacity
+    struct SoundIoAtomicLong max_write;
+};
+
+static struct BroadcastReader *get_reader(struct SoundIoBroadcastRingBuffer *rb, int reader) {
+    assert(reader >= 0 && reader < rb->max_readers);
+    struct BroadcastReader *r = &rb->readers[reader];
+    assert(SOUNDIO_ATOMIC_LOAD(r->state) == BroadcastReaderStateActive);
+    return r;
+}
+
+static void update_max_lag(struct BroadcastReader *r, int lag) {
+    int max_lag = SOUNDIO_ATOMIC_LOAD(r->max_lag);
+    while (lag > max_lag) {
+        if (SOUNDIO_ATOMIC_COMPARE_EXCHANGE(r->max_lag, &max_lag, lag))
+            break;
+    }
+}
+
+struct SoundIoBroadcastRingBuffer *soundio_broadcast_ring_buffer_create(struct SoundIo *soundio,
+        int requested_capacity, int max_readers, enum SoundIoBroadcastOverrun overrun)
+{
+    assert(requested_capacity > 0);
+    assert(max_readers > 0);
+
+    struct SoundIoBroadcastRingBuffer *rb = ALLOCATE(struct SoundIoBroadcastRingBuffer, 1);
+    if (!rb)
+        return NULL;
+    rb->max_readers = max_readers;
+    rb->overrun = overrun;
+
+    rb->readers_allocation = ALLOCATE(char, (max_readers + 1) * sizeof(struct BroadcastReader));
+    if (!rb->readers_allocation) {
+        soundio_broadcast_ring_buffer_destroy(rb);
+        return NULL;
+    }
+    uintptr_t readers_address = (uintptr_t)rb->readers_allocation;
+    readers_address = (readers_address + BROADCAST_CACHE_LINE - 1) & ~(uintptr_t)(BROADCAST_CACHE_LINE - 1);
+    rb->readers = (struct BroadcastReader *)readers_address;
+
+    if (soundio_os_init_mirrored_memory(&rb->mem, requested_capacity)) {
+        soundio_broadcast_ring_buffer_destroy(rb);
+        return NULL;
+    }
+    rb->capacity = rb->mem.capacity;
+    SOUNDIO_ATOMIC_STORE(rb->write_offset, 0);
+    SOUNDIO_ATOMIC_STORE(rb->max_write, 0);
+    for (int i = 0; i < max_readers; i += 1)
+        SOUNDIO_ATOMIC_STORE(rb->readers[i].state, BroadcastReaderStateFree);
+
+    return rb;
+}
+
+void soundio_broadcast_ring_buffer_destroy(struct SoundIoBroadcastRingBuffer *rb) {
+    if (!rb)
+        return;
+
+    if (rb->mem.address)
+        soundio_os_deinit_mirrored_memory(&rb->mem);
+    free(rb->readers_allocation);
+    free(rb);
+}
+
+int soundio_broadcast_ring_buffer_capacity(struct SoundIoBroadcastRingBuffer *rb) {
+    return rb->capacity;
+}
+
+enum SoundIoError soundio_broadcast_ring_buffer_add_reader(struct SoundIoBroadcastRingBuffer *rb,
+        int *out_reader)
+{
+    for (int i = 0; i < rb->max_readers; i += 1) {
+        struct BroadcastReader *r = &rb->readers[i];
+        int expected = BroadcastReaderStateFree;
+        if (!SOUNDIO_ATOMIC_COMPARE_EXCHANGE(r->state, &expected, BroadcastReaderStateClaimed))
+            continue;
+        SOUNDIO_ATOMIC_STORE(r->max_lag, 0);
+        SOUNDIO_ATOMIC_STORE(r->overrun_count, 0);
+        SOUNDIO_ATOMIC_STORE(r->read_offset, SOUNDIO_ATOMIC_LOAD(rb->write_offset));
+        SOUNDIO_ATOMIC_STORE(r->state, BroadcastReaderStateActive);
+        // Once the writer sees this reader it no longer writes past it. Start
+        // again from whatever the writer has written by now, which cannot be
+        // more than a capacity ahead of that.
+        SOUNDIO_ATOMIC_STORE(r->read_offset, SOUNDIO_ATOMIC_LOAD(rb->write_offset));
+        *out_reader = i;
+        return SoundIoErrorNone;
+    }
+    return SoundIoErrorSystemResources;
+}
+
+void soundio_broadcast_ring_buffer_remove_reader(struct SoundIoBroadcastRingBuffer *rb, int reader) {
+    struct BroadcastReader *r = get_reader(rb, reader);
+    SOUNDIO_ATOMIC_STORE(r->state, BroadcastReaderStateFree);
+}
+
+char *soundio_broadcast_ring_buffer_write_ptr(struct SoundIoBroadcastRingBuffer *rb) {
+    long write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    return rb->mem.address + (write_offset % rb->capacity);
+}
+
+void soundio_broadcast_ring_buffer_advance_write_ptr(struct SoundIoBroadcastRingBuffer *rb, int count) {
+    // only the writer stores it, so a plain compare is enough
+    if (count > SOUNDIO_ATOMIC_LOAD(rb->max_write))
+        SOUNDIO_ATOMIC_STORE(rb->max_write, count);
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->write_offset, count);
+}
+
+int soundio_broadcast_ring_buffer_free_count(struct SoundIoBroadcastRingBuffer *rb) {
+    if (rb->overrun == SoundIoBroadcastOverrunDropReader)
+        return rb->capacity;
+
+    long write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    long slowest = write_offset;
+    for (int i = 0; i < rb->max_readers; i += 1) {
+        struct BroadcastReader *r = &rb->readers[i];
+        if (SOUNDIO_ATOMIC_LOAD(r->state) != BroadcastReaderStateActive)
+            continue;
+        long read_offset = SOUNDIO_ATOMIC_LOAD(r->read_offset);
+        if (read_offset < slowest)
+            slowest = read_offset;
+    }
+    // a reader which is being added may briefly report an old position
+    long free_count = rb->capacity - (write_offset - slowest);
+    return (free_count > 0) ? (int)free_count : 0;
+}
+
+char *soundio_broadcast_ring_buffer_read_ptr(struct SoundIoBroadcastRingBuffer *rb, int reader) {
+    struct BroadcastReader *r = get_reader(rb, reader);
+    long read_offset = SOUNDIO_ATOMIC_LOAD(r->read_offset);
+    return rb->mem.address + (read_offset % rb->capacity);
+}
+
+static void drop_reader(struct SoundIoBroadcastRingBuffer *rb, struct BroadcastReader *r, long write_offset) {
+    assert(rb->overrun == SoundIoBroadcastOverrunDropReader);
+    update_max_lag(r, rb->capacity);
+    SOUNDIO_ATOMIC_FETCH_ADD(r->overrun_count, 1);
+    SOUNDIO_ATOMIC_STORE(r->read_offset, write_offset);
+}
+
+bool soundio_broadcast_ring_buffer_advance_read_ptr(struct SoundIoBroadcastRingBuffer *rb,
+        int reader, int count)
+{
+    struct BroadcastReader *r = get_reader(rb, reader);
+    long read_offset = SOUNDIO_ATOMIC_FETCH_ADD(r->read_offset, count);
+    if (rb->overrun != SoundIoBroadcastOverrunDropReader)
+        return true;
+
+    // The bytes were copied before this point. If the writer has since come
+    // within one write of lapping where they started, some of them may have
+    // been overwritten while they were being copied.
+    SOUNDIO_ATOMIC_THREAD_FENCE();
+    long write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    long max_write = SOUNDIO_ATOMIC_LOAD(rb->max_write);
+    if (write_offset + max_write - read_offset <= rb->capacity)
+        return true;
+    drop_reader(rb, r, write_offset);
+    return false;
+}
+
+int soundio_broadcast_ring_buffer_fill_count(struct SoundIoBroadcastRingBuffer *rb, int reader) {
+    struct BroadcastReader *r = get_reader(rb, reader);
+    // Whichever offset we load first might have a smaller value. So we load
+    // the read_offset first.
+    long read_offset = SOUNDIO_ATOMIC_LOAD(r->read_offset);
+    long write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    long fill_count = write_offset - read_offset;
+    assert(fill_count >= 0);
+    if (fill_count > rb->capacity) {
+        // Only possible when dropping readers. The writer has overwritten
+        // data this reader had not read, so skip to what it writes next.
+        drop_reader(rb, r, write_offset);
+        return 0;
+    }
+    update_max_lag(r, (int)fill_count);
+    return (int)fill_count;
+}
+
+void soundio_broadcast_ring_buffer_get_reader_stats(struct SoundIoBroadcastRingBuffer *rb, int reader,
+        struct SoundIoBroadcastReaderStats *out_stats)
+{
+    struct BroadcastReader *r = get_reader(rb, reader);
+    long read_offset = SOUNDIO_ATOMIC_LOAD(r->read_offset);
+    long write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    long lag = write_offset - read_offset;
+    if (lag > rb->capacity)
+        lag = rb->capacity;
+    update_max_lag(r, (int)lag);
+    out_stats->lag = (int)lag;
+    out_stats->max_lag = SOUNDIO_ATOMIC_LOAD(r->max_lag);
+    out_stats->overrun_count = SOUNDIO_ATOMIC_LOAD(r->overrun_count);
+}
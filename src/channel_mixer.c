@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "soundio_private.h"
+#include "util.h"
+
+// -3 dB
+#define MINUS_3DB 0.70710678f
+
+struct MixerTerm {
+    int src;
+    float gain;
+};
+
+struct SoundIoChannelMixer {
+    int src_channel_count;
+    int dst_channel_count;
+    // dst_channel_count rows of src_channel_count gains
+    float *gains;
+    // The non-zero gains of each destination channel, which is all the mix
+    // loops look at. Row `dst` starts at terms + dst * src_channel_count.
+    struct MixerTerm *terms;
+    int *term_counts;
+};
+
+struct FoldTarget {
+    enum SoundIoChannelId id;
+    float gain;
+};
+
+// Where a source channel goes when the destination lacks it, in order of
+// preference. A target which the destination lacks as well is folded
+// further. Channels without a rule are dropped.
+struct FoldRule {
+    enum SoundIoChannelId id;
+    struct FoldTarget targets[2][2];
+};
+
+static const struct FoldRule fold_rules[] = {
+    {SoundIoChannelIdFrontLeft, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontRight, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontCenter, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}, {SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    // only with SoundIoChannelMixerFlagMixLfe
+    {SoundIoChannelIdLfe, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdBackLeft, {{{SoundIoChannelIdSideLeft, 1.0f}}, {{SoundIoChannelIdFrontLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdBackRight, {{{SoundIoChannelIdSideRight, 1.0f}}, {{SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdSideLeft, {{{SoundIoChannelIdBackLeft, 1.0f}}, {{SoundIoChannelIdFrontLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdSideRight, {{{SoundIoChannelIdBackRight, 1.0f}}, {{SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdBackCenter, {{{SoundIoChannelIdBackLeft, MINUS_3DB}, {SoundIoChannelIdBackRight, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontLeftCenter, {{{SoundIoChannelIdFrontLeft, 1.0f}}}},
+    {SoundIoChannelIdFrontRightCenter, {{{SoundIoChannelIdFrontRight, 1.0f}}}},
+    {SoundIoChannelIdFrontLeftWide, {{{SoundIoChannelIdFrontLeft, 1.0f}}}},
+    {SoundIoChannelIdFrontRightWide, {{{SoundIoChannelIdFrontRight, 1.0f}}}},
+    {SoundIoChannelIdBackLeftCenter, {{{SoundIoChannelIdBackLeft, 1.0f}}}},
+    {SoundIoChannelIdBackRightCenter, {{{SoundIoChannelIdBackRight, 1.0f}}}},
+    {SoundIoChannelIdTopCenter, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdTopFrontLeft, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdTopFrontCenter, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdTopFrontRight, {{{SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdTopBackLeft, {{{SoundIoChannelIdBackLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdTopBackCenter, {{{SoundIoChannelIdBackCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdTopBackRight, {{{SoundIoChannelIdBackRight, MINUS_3DB}}}},
+    {SoundIoChannelIdTopFrontLeftCenter, {{{SoundIoChannelIdTopFrontLeft, 1.0f}}}},
+    {SoundIoChannelIdTopFrontRightCenter, {{{SoundIoChannelIdTopFrontRight, 1.0f}}}},
+    {SoundIoChannelIdTopSideLeft, {{{SoundIoChannelIdSideLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdTopSideRight, {{{SoundIoChannelIdSideRight, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontLeftHigh, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontCenterHigh, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdFrontRightHigh, {{{SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdBottomCenter, {{{SoundIoChannelIdFrontCenter, MINUS_3DB}}}},
+    {SoundIoChannelIdBottomLeftCenter, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}}}},
+    {SoundIoChannelIdBottomRightCenter, {{{SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdLeftLfe, {{{SoundIoChannelIdLfe, 1.0f}}}},
+    {SoundIoChannelIdRightLfe, {{{SoundIoChannelIdLfe, 1.0f}}}},
+    {SoundIoChannelIdLfe2, {{{SoundIoChannelIdLfe, 1.0f}}}},
+    // left = mid + side, right = mid - side
+    {SoundIoChannelIdMsMid, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}, {SoundIoChannelIdFrontRight, MINUS_3DB}}}},
+    {SoundIoChannelIdMsSide, {{{SoundIoChannelIdFrontLeft, MINUS_3DB}, {SoundIoChannelIdFrontRight, -MINUS_3DB}}}},
+    {SoundIoChannelIdXyX, {{{SoundIoChannelIdFrontLeft, 1.0f}}}},
+    {SoundIoChannelIdXyY, {{{SoundIoChannelIdFrontRight, 1.0f}}}},
+    {SoundIoChannelIdHeadphonesLeft, {{{SoundIoChannelIdFrontLeft, 1.0f}}}},
+    {SoundIoChannelIdHeadphonesRight, {{{SoundIoChannelIdFrontRight, 1.0f}}}},
+};
+
+static const struct FoldRule *find_fold_rule(enum SoundIoChannelId id) {
+    for (size_t i = 0; i < ARRAY_LENGTH(fold_rules); i += 1) {
+        if (fold_rules[i].id == id)
+            return &fold_rules[i];
+    }
+    return NULL;
+}
+
+// Adds `gain` times channel `id` to the row of source channel `src`.
+// `visited` holds the channels folded on the way here, to stop cycles such
+// as back left -> side left -> back left. Returns whether anything was added.
+static bool fold_channel(struct SoundIoChannelMixer *mixer, const struct SoundIoChannelLayout *dst_layout,
+        int src, enum SoundIoChannelId id, float gain, uint64_t visited, int flags)
+{
+    int dst = soundio_channel_layout_find_channel(dst_layout, id);
+    if (dst >= 0) {
+        mixer->gains[dst * mixer->src_channel_count + src] += gain;
+        return true;
+    }
+    if (id == SoundIoChannelIdLfe && !(flags & SoundIoChannelMixerFlagMixLfe))
+        return false;
+    const struct FoldRule *rule = find_fold_rule(id);
+    if (!rule)
+        return false;
+    visited |= (uint64_t)1 << id;
+
+    for (int alt = 0; alt < 2; alt += 1) {
+        bool added = false;
+        for (int i = 0; i < 2; i += 1) {
+            const struct FoldTarget *target = &rule->targets[alt][i];
+            if (target->id == SoundIoChannelIdInvalid || (visited & ((uint64_t)1 << target->id)))
+                continue;
+            if (fold_channel(mixer, dst_layout, src, target->id, gain * target->gain, visited, flags))
+                added = true;
+        }
+        if (added)
+            return true;
+    }
+    return false;
+}
+
+// Back and side surrounds share a speaker when the destination has only one
+// of the two, as in 7.1 to 5.1. Both source channels then land on it, and
+// each is folded at -3 dB instead of summing at full gain.
+static const enum SoundIoChannelId surround_pairs[][2] = {
+    {SoundIoChannelIdBackLeft, SoundIoChannelIdSideLeft},
+    {SoundIoChannelIdBackRight, SoundIoChannelIdSideRight},
+};
+
+static void balance_surround_pairs(struct SoundIoChannelMixer *mixer,
+        const struct SoundIoChannelLayout *src_layout, const struct SoundIoChannelLayout *dst_layout)
+{
+    for (size_t i = 0; i < ARRAY_LENGTH(surround_pairs); i += 1) {
+        int src_a = soundio_channel_layout_find_channel(src_layout, surround_pairs[i][0]);
+        int src_b = soundio_channel_layout_find_channel(src_layout, surround_pairs[i][1]);
+        if (src_a < 0 || src_b < 0)
+            continue;
+        int dst_a = soundio_channel_layout_find_channel(dst_layout, surround_pairs[i][0]);
+        int dst_b = soundio_channel_layout_find_channel(dst_layout, surround_pairs[i][1]);
+        if ((dst_a >= 0) == (dst_b >= 0))
+            continue;
+        float *row = &mixer->gains[((dst_a >= 0) ? dst_a : dst_b) * mixer->src_channel_count];
+        row[src_a] *= MINUS_3DB;
+        row[src_b] *= MINUS_3DB;
+    }
+}
+
+void soundio_channel_mixer_destroy(struct SoundIoChannelMixer *mixer) {
+    if (!mixer)
+        return;
+    free(mixer->gains);
+    free(mixer->terms);
+    free(mixer->term_counts);
+    free(mixer);
+}
+
+static struct SoundIoChannelMixer *channel_mixer_alloc(int src_channel_count, int dst_channel_count) {
+    struct SoundIoChannelMixer *mixer = ALLOCATE(struct SoundIoChannelMixer, 1);
+    if (!mixer)
+        return NULL;
+    mixer->src_channel_count = src_channel_count;
+    mixer->dst_channel_count = dst_channel_count;
+    mixer->gains = ALLOCATE(float, src_channel_count * dst_channel_count);
+    mixer->terms = ALLOCATE(struct MixerTerm, src_channel_count * dst_channel_count);
+    mixer->term_counts = ALLOCATE(int, dst_channel_count);
+    if (!mixer->gains || !mixer->terms || !mixer->term_counts) {
+        soundio_channel_mixer_destroy(mixer);
+        return NULL;
+    }
+    return mixer;
+}
+
+static void channel_mixer_finish(struct SoundIoChannelMixer *mixer, int flags) {
+    int src_count = mixer->src_channel_count;
+    for (int dst = 0; dst < mixer->dst_channel_count; dst += 1) {
+        float *row = &mixer->gains[dst * src_count];
+        if (flags & SoundIoChannelMixerFlagNormalize) {
+            float sum = 0.0f;
+            for (int src = 0; src < src_count; src += 1)
+                sum += (row[src] < 0.0f) ? -row[src] : row[src];
+            if (sum > 1.0f) {
+                for (int src = 0; src < src_count; src += 1)
+                    row[src] /= sum;
+            }
+        }
+        struct MixerTerm *terms = &mixer->terms[dst * src_count];
+        int term_count = 0;
+        for (int src = 0; src < src_count; src += 1) {
+            if (row[src] == 0.0f)
+                continue;
+            terms[term_count].src = src;
+            terms[term_count].gain = row[src];
+            term_count += 1;
+        }
+        mixer->term_counts[dst] = term_count;
+    }
+}
+
+enum SoundIoError soundio_channel_mixer_create(const struct SoundIoChannelLayout *src_layout,
+        const struct SoundIoChannelLayout *dst_layout, int flags, struct SoundIoChannelMixer **out_mixer)
+{
+    *out_mixer = NULL;
+    if (src_layout->channel_count <= 0 || src_layout->channel_count > SOUNDIO_MAX_CHANNELS ||
+        dst_layout->channel_count <= 0 || dst_layout->channel_count > SOUNDIO_MAX_CHANNELS)
+    {
+        return SoundIoErrorInvalid;
+    }
+
+    struct SoundIoChannelMixer *mixer = channel_mixer_alloc(src_layout->channel_count,
+            dst_layout->channel_count);
+    if (!mixer)
+        return SoundIoErrorNoMem;
+
+    for (int src = 0; src < src_layout->channel_count; src += 1) {
+        enum SoundIoChannelId id = src_layout->channels[src];
+        // the cycle mask only covers the ids which have fold rules
+        if ((unsigned)id >= 64) {
+            int dst = soundio_channel_layout_find_channel(dst_layout, id);
+            if (dst >= 0)
+                mixer->gains[dst * mixer->src_channel_count + src] = 1.0f;
+            continue;
+        }
+        fold_channel(mixer, dst_layout, src, id, 1.0f, 0, flags);
+    }
+    balance_surround_pairs(mixer, src_layout, dst_layout);
+
+    channel_mixer_finish(mixer, flags);
+    *out_mixer = mixer;
+    return SoundIoErrorNone;
+}
+
+enum SoundIoError soundio_channel_mixer_create_custom(int src_channel_count, int dst_channel_count,
+        const float *gains, struct SoundIoChannelMixer **out_mixer)
+{
+    *out_mixer = NULL;
+    if (src_channel_count <= 0 || src_channel_count > SOUNDIO_MAX_CHANNELS ||
+        dst_channel_count <= 0 || dst_channel_count > SOUNDIO_MAX_CHANNELS)
+    {
+        return SoundIoErrorInvalid;
+    }
+
+    struct SoundIoChannelMixer *mixer = channel_mixer_alloc(src_channel_count, dst_channel_count);
+    if (!mixer)
+        return SoundIoErrorNoMem;
+    memcpy(mixer->gains, gains, sizeof(float) * src_channel_count * dst_channel_count);
+
+    channel_mixer_finish(mixer, 0);
+    *out_mixer = mixer;
+    return SoundIoErrorNone;
+}
+
+float soundio_channel_mixer_get_gain(struct SoundIoChannelMixer *mixer, int dst_channel, int src_channel) {
+    assert(dst_channel >= 0 && dst_channel < mixer->dst_channel_count);
+    assert(src_channel >= 0 && src_channel < mixer->src_channel_count);
+    return mixer->gains[dst_channel * mixer->src_channel_count + src_channel];
+}
+
+// Each kernel has a separate loop for planar buffers, which compilers turn
+// into vector code, and one for any other step. Steps are in samples.
+
+static void mix_copy(float *SOUNDIO_RESTRICT dst, int dst_step,
+        const float *SOUNDIO_RESTRICT src, int src_step, int frame_count)
+{
+    if (dst_step == 1 && src_step == 1) {
+        memcpy(dst, src, sizeof(float) * frame_count);
+        return;
+    }
+    for (int i = 0; i < frame_count; i += 1)
+        dst[i * dst_step] = src[i * src_step];
+}
+
+static void mix_scale(float *SOUNDIO_RESTRICT dst, int dst_step,
+        const float *SOUNDIO_RESTRICT src, int src_step, float gain, int frame_count)
+{
+    if (dst_step == 1 && src_step == 1) {
+        for (int i = 0; i < frame_count; i += 1)
+            dst[i] = src[i] * gain;
+        return;
+    }
+    for (int i = 0; i < frame_count; i += 1)
+        dst[i * dst_step] = src[i * src_step] * gain;
+}
+
+static void mix_accumulate(float *SOUNDIO_RESTRICT dst, int dst_step,
+        const float *SOUNDIO_RESTRICT src, int src_step, float gain, int frame_count)
+{
+    if (dst_step == 1 && src_step == 1) {
+        for (int i = 0; i < frame_count; i += 1)
+            dst[i] += src[i] * gain;
+        return;
+    }
+    for (int i = 0; i < frame_count; i += 1)
+        dst[i * dst_step] += src[i * src_step] * gain;
+}
+
+static void mix_silence(float *dst, int dst_step, int frame_count) {
+    if (dst_step == 1) {
+        memset(dst, 0, sizeof(float) * frame_count);
+        return;
+    }
+    for (int i = 0; i < frame_count; i += 1)
+        dst[i * dst_step] = 0.0f;
+}
+
+void soundio_channel_mixer_mix(struct SoundIoChannelMixer *mixer, const struct SoundIoChannelArea *src_areas,
+        const struct SoundIoChannelArea *dst_areas, int frame_count)
+{
+    int src_count = mixer->src_channel_count;
+    for (int dst = 0; dst < mixer->dst_channel_count; dst += 1) {
+        float *dst_ptr = (float *)dst_areas[dst].ptr;
+        int dst_step = dst_areas[dst].step / (int)sizeof(float);
+        assert(dst_areas[dst].step % sizeof(float) == 0);
+
+        const struct MixerTerm *terms = &mixer->terms[dst * src_count];
+        int term_count = mixer->term_counts[dst];
+        if (term_count == 0) {
+            mix_silence(dst_ptr, dst_step, frame_count);
+            continue;
+        }
+
+        for (int t = 0; t < term_count; t += 1) {
+            const struct SoundIoChannelArea *src_area = &src_areas[terms[t].src];
+            const float *src_ptr = (const float *)src_area->ptr;
+            int src_step = src_area->step / (int)sizeof(float);
+            assert(src_area->step % sizeof(float) == 0);
+            float gain = terms[t].gain;
+            if (t > 0)
+                mix_accumulate(dst_ptr, dst_step, src_ptr, src_step, gain, frame_count);
+            else if (gain == 1.0f)
+                mix_copy(dst_ptr, dst_step, src_ptr, src_step, frame_count);
+            else
+                mix_scale(dst_ptr, dst_step, src_ptr, src_step, gain, frame_count);
+        }
+    }
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "convert.h"
+#include "util.h"
+
+#include <stdint.h>
+
+// Sample types. s24 lives in the low three bytes of a 32-bit word.
+typedef float sample_f32;
+typedef int16_t sample_s16;
+typedef int32_t sample_s24;
+typedef int32_t sample_s32;
+
+static inline float f32_to_float(sample_f32 x) { return x; }
+static inline float s16_to_float(sample_s16 x) { return x * (1.0f / 32768.0f); }
+static inline float s24_to_float(sample_s24 x) {
+    // ignore whatever the unused top byte holds
+    return ((int32_t)((uint32_t)x << 8) >> 8) * (1.0f / 8388608.0f);
+}
+static inline float s32_to_float(sample_s32 x) { return x * (1.0f / 2147483648.0f); }
+
+// Float to integer clamps and rounds half away from zero. The float
+// intermediate keeps these branch free, so that they vectorize.
+static inline float round_away(float x) {
+    return x + ((x < 0.0f) ? -0.5f : 0.5f);
+}
+
+static inline sample_f32 float_to_f32(float x) { return x; }
+static inline sample_s16 float_to_s16(float x) {
+    x *= 32768.0f;
+    x = (x < -32768.0f) ? -32768.0f : x;
+    x = (x > 32767.0f) ? 32767.0f : x;
+    return (sample_s16)round_away(x);
+}
+static inline sample_s24 float_to_s24(float x) {
+    x *= 8388608.0f;
+    x = (x < -8388608.0f) ? -8388608.0f : x;
+    x = (x > 8388607.0f) ? 8388607.0f : x;
+    return (sample_s24)round_away(x);
+}
+static inline sample_s32 float_to_s32(float x) {
+    x *= 2147483648.0f;
+    x = (x < -2147483648.0f) ? -2147483648.0f : x;
+    // the largest float below 2^31
+    x = (x > 2147483520.0f) ? 2147483520.0f : x;
+    // from 2^23 up every float is an integer, and adding 0.5 to an odd one
+    // would round it up to the next even one
+    return (sample_s32)((x > -8388608.0f && x < 8388608.0f) ? round_away(x) : x);
+}
+
+#define CONVERT_VIA_FLOAT(SRC, DST) \
+    static inline sample_##DST convert_##SRC##_##DST(sample_##SRC x) { \
+        return float_to_##DST(SRC##_to_float(x)); \
+    }
+
+CONVERT_VIA_FLOAT(f32, f32)
+CONVERT_VIA_FLOAT(f32, s16)
+CONVERT_VIA_FLOAT(f32, s24)
+CONVERT_VIA_FLOAT(f32, s32)
+CONVERT_VIA_FLOAT(s16, f32)
+CONVERT_VIA_FLOAT(s24, f32)
+CONVERT_VIA_FLOAT(s32, f32)
+
+// Between integer formats samples are shifted, which is exact when widening
+// and truncates when narrowing.
+static inline sample_s16 convert_s16_s16(sample_s16 x) { return x; }
+static inline sample_s24 convert_s16_s24(sample_s16 x) { return x * 256; }
+static inline sample_s32 convert_s16_s32(sample_s16 x) { return x * 65536; }
+static inline sample_s16 convert_s24_s16(sample_s24 x) { return (sample_s16)(((int32_t)((uint32_t)x << 8)) >> 16); }
+static inline sample_s24 convert_s24_s24(sample_s24 x) { return (int32_t)((uint32_t)x << 8) >> 8; }
+static inline sample_s32 convert_s24_s32(sample_s24 x) { return (int32_t)((uint32_t)x << 8); }
+static inline sample_s16 convert_s32_s16(sample_s32 x) { return (sample_s16)(x >> 16); }
+static inline sample_s24 convert_s32_s24(sample_s32 x) { return x >> 8; }
+static inline sample_s32 convert_s32_s32(sample_s32 x) { return x; }
+
+// Both sides interleaved: one run of frame_count * channel_count samples.
+#define DEFINE_INTERLEAVED(SRC, DST) \
+    static void interleaved_##SRC##_##DST(const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        const sample_##SRC *SOUNDIO_RESTRICT src = (const sample_##SRC *)src_areas[0].ptr; \
+        sample_##DST *SOUNDIO_RESTRICT dst = (sample_##DST *)dst_areas[0].ptr; \
+        int sample_count = frame_count * channel_count; \
+        for (int i = 0; i < sample_count; i += 1) \
+            dst[i] = convert_##SRC##_##DST(src[i]); \
+    }
+
+// Both sides planar: one run per channel.
+#define DEFINE_PLANAR(SRC, DST) \
+    static void planar_##SRC##_##DST(const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        for (int ch = 0; ch < channel_count; ch += 1) { \
+            const sample_##SRC *SOUNDIO_RESTRICT src = (const sample_##SRC *)src_areas[ch].ptr; \
+            sample_##DST *SOUNDIO_RESTRICT dst = (sample_##DST *)dst_areas[ch].ptr; \
+            for (int i = 0; i < frame_count; i += 1) \
+                dst[i] = convert_##SRC##_##DST(src[i]); \
+        } \
+    }
+
+// Any steps, in bytes.
+#define DEFINE_GENERIC(SRC, DST) \
+    static void generic_##SRC##_##DST(const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        for (int ch = 0; ch < channel_count; ch += 1) { \
+            const char *src = src_areas[ch].ptr; \
+            char *dst = dst_areas[ch].ptr; \
+            int src_step = src_areas[ch].step; \
+            int dst_step = dst_areas[ch].step; \
+            for (int i = 0; i < frame_count; i += 1) { \
+                *(sample_##DST *)dst = convert_##SRC##_##DST(*(const sample_##SRC *)src); \
+                src += src_step; \
+                dst += dst_step; \
+            } \
+        } \
+    }
+
+// Interleaving with the channel count built in, so that the inner loop is
+// unrolled and the strides are constants.
+#define DEFINE_INTERLEAVE(SRC, DST, C) \
+    static void interleave_##SRC##_##DST##_##C(const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        const sample_##SRC *src[C]; \
+        for (int ch = 0; ch < C; ch += 1) \
+            src[ch] = (const sample_##SRC *)src_areas[ch].ptr; \
+        sample_##DST *SOUNDIO_RESTRICT dst = (sample_##DST *)dst_areas[0].ptr; \
+        for (int i = 0; i < frame_count; i += 1) { \
+            for (int ch = 0; ch < C; ch += 1) \
+                dst[i * C + ch] = convert_##SRC##_##DST(src[ch][i]); \
+        } \
+    } \
+    static void deinterleave_##SRC##_##DST##_##C(const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        const sample_##SRC *SOUNDIO_RESTRICT src = (const sample_##SRC *)src_areas[0].ptr; \
+        sample_##DST *dst[C]; \
+        for (int ch = 0; ch < C; ch += 1) \
+            dst[ch] = (sample_##DST *)dst_areas[ch].ptr; \
+        for (int i = 0; i < frame_count; i += 1) { \
+            for (int ch = 0; ch < C; ch += 1) \
+                dst[ch][i] = convert_##SRC##_##DST(src[i * C + ch]); \
+        } \
+    }
+
+#define DEFINE_KERNELS(SRC, DST) \
+    DEFINE_INTERLEAVED(SRC, DST) \
+    DEFINE_PLANAR(SRC, DST) \
+    DEFINE_GENERIC(SRC, DST) \
+    DEFINE_INTERLEAVE(SRC, DST, 2) \
+    DEFINE_INTERLEAVE(SRC, DST, 6) \
+    DEFINE_INTERLEAVE(SRC, DST, 8) \
+    static const struct SoundIoConvertKernels kernels_##SRC##_##DST[] = { \
+        {2, sizeof(sample_##SRC), sizeof(sample_##DST), interleaved_##SRC##_##DST, planar_##SRC##_##DST, \
+            interleave_##SRC##_##DST##_2, deinterleave_##SRC##_##DST##_2, generic_##SRC##_##DST}, \
+        {6, sizeof(sample_##SRC), sizeof(sample_##DST), interleaved_##SRC##_##DST, planar_##SRC##_##DST, \
+            interleave_##SRC##_##DST##_6, deinterleave_##SRC##_##DST##_6, generic_##SRC##_##DST}, \
+        {8, sizeof(sample_##SRC), sizeof(sample_##DST), interleaved_##SRC##_##DST, planar_##SRC##_##DST, \
+            interleave_##SRC##_##DST##_8, deinterleave_##SRC##_##DST##_8, generic_##SRC##_##DST}, \
+        /* any other channel count; with 1 channel every shape is planar */ \
+        {0, sizeof(sample_##SRC), sizeof(sample_##DST), interleaved_##SRC##_##DST, planar_##SRC##_##DST, \
+            generic_##SRC##_##DST, generic_##SRC##_##DST, generic_##SRC##_##DST}, \
+    };
+
+DEFINE_KERNELS(f32, f32)
+DEFINE_KERNELS(f32, s16)
+DEFINE_KERNELS(f32, s24)
+DEFINE_KERNELS(f32, s32)
+DEFINE_KERNELS(s16, f32)
+DEFINE_KERNELS(s16, s16)
+DEFINE_KERNELS(s16, s24)
+DEFINE_KERNELS(s16, s32)
+DEFINE_KERNELS(s24, f32)
+DEFINE_KERNELS(s24, s16)
+DEFINE_KERNELS(s24, s24)
+DEFINE_KERNELS(s24, s32)
+DEFINE_KERNELS(s32, f32)
+DEFINE_KERNELS(s32, s16)
+DEFINE_KERNELS(s32, s24)
+DEFINE_KERNELS(s32, s32)
+
+// Index into the table below, or -1.
+static int format_index(enum SoundIoFormat format) {
+    switch (format) {
+    case SoundIoFormatFloat32NE: return 0;
+    case SoundIoFormatS16NE:     return 1;
+    case SoundIoFormatS24NE:     return 2;
+    case SoundIoFormatS32NE:     return 3;
+    default:                     return -1;
+    }
+}
+
+static const struct SoundIoConvertKernels *kernel_table[4][4] = {
+    {kernels_f32_f32, kernels_f32_s16, kernels_f32_s24, kernels_f32_s32},
+    {kernels_s16_f32, kernels_s16_s16, kernels_s16_s24, kernels_s16_s32},
+    {kernels_s24_f32, kernels_s24_s16, kernels_s24_s24, kernels_s24_s32},
+    {kernels_s32_f32, kernels_s32_s16, kernels_s32_s24, kernels_s32_s32},
+};
+
+enum SoundIoError soundio_convert_select(struct SoundIoConvertKernels *kernels,
+        enum SoundIoFormat src_format, enum SoundIoFormat dst_format, int channel_count)
+{
+    int src_index = format_index(src_format);
+    int dst_index = format_index(dst_format);
+    if (src_index < 0 || dst_index < 0 || channel_count <= 0 || channel_count > SOUNDIO_MAX_CHANNELS)
+        return SoundIoErrorInvalid;
+
+    const struct SoundIoConvertKernels *candidates = kernel_table[src_index][dst_index];
+    int i = 0;
+    while (candidates[i].channel_count != 0 && candidates[i].channel_count != channel_count)
+        i += 1;
+    *kernels = candidates[i];
+    kernels->channel_count = channel_count;
+    return SoundIoErrorNone;
+}
+
+enum AreaShape {
+    AreaShapeOther,
+    AreaShapePlanar,
+    AreaShapeInterleaved,
+};
+
+static enum AreaShape get_area_shape(const struct SoundIoChannelArea *areas, int channel_count,
+        int bytes_per_sample)
+{
+    bool planar = true;
+    bool interleaved = true;
+    int frame_step = channel_count * bytes_per_sample;
+    for (int ch = 0; ch < channel_count; ch += 1) {
+        planar = planar && areas[ch].step == bytes_per_sample;
+        interleaved = interleaved && areas[ch].step == frame_step &&
+            areas[ch].ptr == areas[0].ptr + ch * bytes_per_sample;
+    }
+    if (planar)
+        return AreaShapePlanar;
+    if (interleaved)
+        return AreaShapeInterleaved;
+    return AreaShapeOther;
+}
+
+void soundio_convert_run(const struct SoundIoConvertKernels *kernels,
+        const struct SoundIoChannelArea *src_areas, const struct SoundIoChannelArea *dst_areas,
+        int frame_count)
+{
+    int channel_count = kernels->channel_count;
+    enum AreaShape src_shape = get_area_shape(src_areas, channel_count, kernels->src_bytes_per_sample);
+    enum AreaShape dst_shape = get_area_shape(dst_areas, channel_count, kernels->dst_bytes_per_sample);
+
+    SoundIoConvertKernel kernel = kernels->generic;
+    if (src_shape == AreaShapeInterleaved && dst_shape == AreaShapeInterleaved)
+        kernel = kernels->interleaved;
+    else if (src_shape == AreaShapePlanar && dst_shape == AreaShapePlanar)
+        kernel = kernels->planar;
+    else if (src_shape == AreaShapePlanar && dst_shape == AreaShapeInterleaved)
+        kernel = kernels->interleave;
+    else if (src_shape == AreaShapeInterleaved && dst_shape == AreaShapePlanar)
+        kernel = kernels->deinterleave;
+    kernel(src_areas, dst_areas, channel_count, frame_count);
+}
+
+// Error feedback filters for noise shaping. The quantizer subtracts the
+// filtered past errors from each sample, which gives the noise the spectrum
+// 1 - sum(c[k] z^-(k+1)).
+#define DITHER_MAX_ORDER 5
+
+// first order high pass: pushes the noise up by 6 dB per octave
+static const float shape_light[] = {1.0f};
+// Lipshitz et al., "Minimally audible noise shaping", E-weighted 5-tap,
+// designed for 44.1 kHz and close enough at 48 kHz
+static const float shape_strong[] = {2.033f, -2.165f, 1.959f, -1.590f, 0.6149f};
+
+struct DitherState {
+    uint32_t rng;
+    int order;
+    const float *coefficients;
+    // newest first
+    float error[SOUNDIO_MAX_CHANNELS][DITHER_MAX_ORDER];
+};
+
+typedef void (*DitherKernel)(struct DitherState *state, const struct SoundIoChannelArea *src_areas,
+        const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count);
+
+static inline uint32_t xorshift32(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Quantizes to DST with triangular dither of +-1 LSB, made from the two
+// halves of one xorshift output, plus the noise shaping filter if any. The
+// error feedback makes every sample depend on the one before, so these run
+// one channel at a time with whatever steps the areas have.
+#define DEFINE_DITHER(SRC, DST, SCALE, MIN, MAX) \
+    static void dither_##SRC##_##DST(struct DitherState *state, const struct SoundIoChannelArea *src_areas, \
+            const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count) \
+    { \
+        uint32_t rng = state->rng; \
+        int order = state->order; \
+        const float *c = state->coefficients; \
+        for (int ch = 0; ch < channel_count; ch += 1) { \
+            float *error = state->error[ch]; \
+            const char *src = src_areas[ch].ptr; \
+            char *dst = dst_areas[ch].ptr; \
+            int src_step = src_areas[ch].step; \
+            int dst_step = dst_areas[ch].step; \
+            for (int i = 0; i < frame_count; i += 1) { \
+                float x = SRC##_to_float(*(const sample_##SRC *)src) * SCALE; \
+                for (int k = 0; k < order; k += 1) \
+                    x -= c[k] * error[k]; \
+                rng = xorshift32(rng); \
+                float noise = ((rng & 0xffff) + (rng >> 16)) * (1.0f / 65536.0f) - 1.0f; \
+                float q = (float)(int32_t)round_away(x + noise); \
+                /* from the unclamped value, so that clipping cannot upset the filter */ \
+                for (int k = order - 1; k > 0; k -= 1) \
+                    error[k] = error[k - 1]; \
+                error[0] = q - x; \
+                q = (q < MIN) ? MIN : q; \
+                q = (q > MAX) ? MAX : q; \
+                *(sample_##DST *)dst = (sample_##DST)q; \
+                src += src_step; \
+                dst += dst_step; \
+            } \
+        } \
+        state->rng = rng; \
+    }
+
+DEFINE_DITHER(f32, s16, 32768.0f, -32768.0f, 32767.0f)
+DEFINE_DITHER(s24, s16, 32768.0f, -32768.0f, 32767.0f)
+DEFINE_DITHER(s32, s16, 32768.0f, -32768.0f, 32767.0f)
+DEFINE_DITHER(f32, s24, 8388608.0f, -8388608.0f, 8388607.0f)
+DEFINE_DITHER(s32, s24, 8388608.0f, -8388608.0f, 8388607.0f)
+
+// The conversions which lose resolution. Same indexes as kernel_table.
+static const DitherKernel dither_table[4][4] = {
+    {NULL, dither_f32_s16, dither_f32_s24, NULL},
+    {NULL, NULL, NULL, NULL},
+    {NULL, dither_s24_s16, NULL, NULL},
+    {NULL, dither_s32_s16, dither_s32_s24, NULL},
+};
+
+struct SoundIoConverter {
+    struct SoundIoConvertKernels kernels;
+    int src_index;
+    int dst_index;
+    // NULL without dither
+    DitherKernel dither_kernel;
+    struct DitherState dither;
+};
+
+enum SoundIoError soundio_converter_create(enum SoundIoFormat src_format, enum SoundIoFormat dst_format,
+        int channel_count, struct SoundIoConverter **out_converter)
+{
+    *out_converter = NULL;
+    struct SoundIoConvertKernels kernels;
+    enum SoundIoError err;
+    if ((err = soundio_convert_select(&kernels, src_format, dst_format, channel_count)))
+        return err;
+
+    struct SoundIoConverter *converter = ALLOCATE(struct SoundIoConverter, 1);
+    if (!converter)
+        return SoundIoErrorNoMem;
+    converter->kernels = kernels;
+    converter->src_index = format_index(src_format);
+    converter->dst_index = format_index(dst_format);
+    *out_converter = converter;
+    return SoundIoErrorNone;
+}
+
+void soundio_converter_destroy(struct SoundIoConverter *converter) {
+    free(converter);
+}
+
+enum SoundIoError soundio_converter_set_dither(struct SoundIoConverter *converter, enum SoundIoDither dither) {
+    struct DitherState *state = &converter->dither;
+    switch (dither) {
+    case SoundIoDitherNone:
+    case SoundIoDitherTriangular:
+        state->order = 0;
+        state->coefficients = NULL;
+        break;
+    case SoundIoDitherShapedLight:
+        state->order = ARRAY_LENGTH(shape_light);
+        state->coefficients = shape_light;
+        break;
+    case SoundIoDitherShapedStrong:
+        state->order = ARRAY_LENGTH(shape_strong);
+        state->coefficients = shape_strong;
+        break;
+    default:
+        return SoundIoErrorInvalid;
+    }
+    memset(state->error, 0, sizeof(state->error));
+    // any non-zero seed works; vary it so that two converters do not make the
+    // same noise
+    state->rng = (uint32_t)(uintptr_t)converter ^ 0x9e3779b9u;
+    if (!state->rng)
+        state->rng = 1;
+
+    converter->dither_kernel = (dither == SoundIoDitherNone) ? NULL :
+        dither_table[converter->src_index][converter->dst_index];
+    return SoundIoErrorNone;
+}
+
+void soundio_converter_convert(struct SoundIoConverter *converter,
+        const struct SoundIoChannelArea *src_areas, const struct SoundIoChannelArea *dst_areas,
+        int frame_count)
+{
+    if (converter->dither_kernel) {
+        converter->dither_kernel(&converter->dither, src_areas, dst_areas,
+                converter->kernels.channel_count, frame_count);
+        return;
+    }
+    soundio_convert_run(&converter->kernels, src_areas, dst_areas, frame_count);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_CONVERT_H
+#define SOUNDIO_CONVERT_H
+
+#include "soundio_internal.h"
+
+// Converts `frame_count` frames of `channel_count` channels. Each kernel
+// handles one shape of areas, see soundio_convert_run.
+typedef void (*SoundIoConvertKernel)(const struct SoundIoChannelArea *src_areas,
+        const struct SoundIoChannelArea *dst_areas, int channel_count, int frame_count);
+
+// The kernels for one pair of formats and one channel count. Where the
+// channel count is 2, 6 or 8 the interleaving kernels have it built in;
+// otherwise they are the generic kernel. A single channel always counts as
+// planar.
+struct SoundIoConvertKernels {
+    int channel_count;
+    int src_bytes_per_sample;
+    int dst_bytes_per_sample;
+    // both sides interleaved
+    SoundIoConvertKernel interleaved;
+    // both sides planar
+    SoundIoConvertKernel planar;
+    // planar to interleaved
+    SoundIoConvertKernel interleave;
+    // interleaved to planar
+    SoundIoConvertKernel deinterleave;
+    // any steps
+    SoundIoConvertKernel generic;
+};
+
+// Supports native endian float32, s16, s24 and s32 in both directions.
+// Returns SoundIoErrorInvalid for anything else.
+enum SoundIoError soundio_convert_select(struct SoundIoConvertKernels *kernels,
+        enum SoundIoFormat src_format, enum SoundIoFormat dst_format, int channel_count);
+
+// Looks at the steps of the areas and calls the matching kernel.
+void soundio_convert_run(const struct SoundIoConvertKernels *kernels,
+        const struct SoundIoChannelArea *src_areas, const struct SoundIoChannelArea *dst_areas,
+        int frame_count);
+
+#endif
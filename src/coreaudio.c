@@ -793,7 +793,7 @@ static void shutdown_backend(struct SoundIoPrivate *si, int err) {
     soundio_os_mutex_unlock(sica->mutex);
     soundio_os_cond_signal(sica->cond, NULL);
     soundio_os_cond_signal(sica->have_devices_cond, NULL);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
 }
 
 static void flush_events_ca(struct SoundIoPrivate *si) {
@@ -869,7 +869,7 @@ static void device_thread_run(void *arg) {
             if (!SOUNDIO_ATOMIC_EXCHANGE(sica->have_devices_flag, true))
                 soundio_os_cond_signal(sica->have_devices_cond, NULL);
             soundio_os_cond_signal(sica->cond, NULL);
-            soundio->on_events_signal(soundio);
+            soundio_emit_events_signal(soundio);
         }
         soundio_os_cond_wait(sica->scan_devices_cond, NULL);
     }
@@ -880,7 +880,7 @@ static OSStatus on_outstream_device_overload(AudioObjectID in_object_id, UInt32
 {
     struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)in_client_data;
     struct SoundIoOutStream *outstream = &os->pub;
-    outstream->underflow_callback(outstream);
+    soundio_outstream_invoke_underflow(outstream);
     return noErr;
 }
 
@@ -916,7 +916,7 @@ static OSStatus write_callback_ca(void *userdata, AudioUnitRenderActionFlags *io
     osca->io_data = io_data;
     osca->buffer_index = 0;
     osca->frames_left = in_number_frames;
-    outstream->write_callback(outstream, osca->frames_left, osca->frames_left);
+    soundio_outstream_invoke_write(outstream, osca->frames_left, osca->frames_left);
     osca->io_data = NULL;
 
     return noErr;
@@ -1116,7 +1116,7 @@ static OSStatus on_instream_device_overload(AudioObjectID in_object_id, UInt32 i
 {
     struct SoundIoInStreamPrivate *os = (struct SoundIoInStreamPrivate *)in_client_data;
     struct SoundIoInStream *instream = &os->pub;
-    instream->overflow_callback(instream);
+    soundio_instream_invoke_overflow(instream);
     return noErr;
 }
 
@@ -1183,7 +1183,7 @@ static OSStatus read_callback_ca(void *userdata, AudioUnitRenderActionFlags *io_
     }
 
     isca->frames_left = in_number_frames;
-    instream->read_callback(instream, isca->frames_left, isca->frames_left);
+    soundio_instream_invoke_read(instream, isca->frames_left, isca->frames_left);
 
     return noErr;
 }
@@ -7,12 +7,142 @@
 
 #include "dummy.h"
 #include "soundio_private.h"
+#include "rt_guard.h"
 
 #include <stdio.h>
 #include <string.h>
 
-static void playback_thread_run(void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+// First period boundary strictly after `now`, so that a task that finishes
+// early never runs twice for the same period.
+static double next_period_after(double start_time, double period_duration, double now) {
+    long periods_passed = (long)((now - start_time) / period_duration);
+    return start_time + (periods_passed + 1) * period_duration;
+}
+
+// In freewheel mode streams run on a virtual clock that only advances by one
+// period per iteration, so that callbacks happen back to back.
+static double outstream_clock(struct SoundIoOutStreamDummy *osd) {
+    return osd->freewheel ? osd->virtual_time : soundio_os_get_time();
+}
+
+static double instream_clock(struct SoundIoInStreamDummy *isd) {
+    return isd->freewheel ? isd->virtual_time : soundio_os_get_time();
+}
+
+// xorshift32, so that injected jitter replays identically on every run
+static double fault_random(struct SoundIoDummyFaultState *state) {
+    uint32_t x = state->rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state->rng_state = x;
+    return x / (double)UINT32_MAX;
+}
+
+static void fault_state_init(struct SoundIoDummy *sid, struct SoundIoDummyFaultState *state) {
+    state->next_fault = 0;
+    state->delay = 0.0;
+    state->jitter_max = 0.0;
+    state->rng_state = 0x9e3779b9;
+    state->device_sample_rate = SOUNDIO_ATOMIC_LOAD(sid->sample_rate);
+    state->failed = false;
+}
+
+// Extra time to wait before the next wakeup.
+static double take_fault_delay(struct SoundIoDummyFaultState *state) {
+    double delay = state->delay;
+    state->delay = 0.0;
+    if (state->jitter_max > 0.0)
+        delay += state->jitter_max * fault_random(state);
+    return delay;
+}
+
+static bool claim_fault(struct SoundIoDummy *sid, const struct SoundIoDummyFault *fault) {
+    return !SOUNDIO_ATOMIC_EXCHANGE(sid->fault_fired[fault - sid->faults], true);
+}
+
+// Realtime safe: a futex wake is the only system call.
+static void post_backend_event(struct SoundIoDummy *sid) {
+    SOUNDIO_ATOMIC_FETCH_ADD(sid->event_seq, 1);
+    soundio_os_futex_wake_all(&sid->event_seq, false);
+}
+
+static void event_thread_run(void *arg) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
+    int seen = SOUNDIO_ATOMIC_LOAD(sid->event_seq);
+    while (!SOUNDIO_ATOMIC_LOAD(sid->event_thread_abort)) {
+        soundio_os_futex_wait(&sid->event_seq, seen, 1.0, false);
+        int seq = SOUNDIO_ATOMIC_LOAD(sid->event_seq);
+        if (seq == seen)
+            continue;
+        seen = seq;
+        soundio_os_cond_signal(sid->cond, NULL);
+        soundio_emit_events_signal(&si->pub);
+    }
+}
+
+static void refresh_devices(struct SoundIoDummy *sid) {
+    SOUNDIO_ATOMIC_FLAG_CLEAR(sid->refresh_devices_flag);
+    post_backend_event(sid);
+}
+
+// Fires every fault the stream has reached. Backend-wide faults take effect
+// here; returns whether the caller should inject an xrun into its buffer.
+static bool advance_faults(struct SoundIoPrivate *si, struct SoundIoDummyFaultState *state, long position) {
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
+    bool xrun = false;
+    while (state->next_fault < sid->fault_count) {
+        const struct SoundIoDummyFault *fault = &sid->faults[state->next_fault];
+        if (fault->frame > position)
+            break;
+        state->next_fault += 1;
+        switch (fault->type) {
+        case SoundIoDummyFaultXrun:
+            xrun = true;
+            break;
+        case SoundIoDummyFaultStall:
+            state->delay += fault->duration;
+            break;
+        case SoundIoDummyFaultJitter:
+            state->jitter_max = fault->duration;
+            break;
+        case SoundIoDummyFaultDevicesChange:
+            if (claim_fault(sid, fault)) {
+                SOUNDIO_ATOMIC_STORE(sid->extra_devices, !SOUNDIO_ATOMIC_LOAD(sid->extra_devices));
+                refresh_devices(sid);
+            }
+            break;
+        case SoundIoDummyFaultSampleRateChange:
+            if (claim_fault(sid, fault)) {
+                SOUNDIO_ATOMIC_STORE(sid->sample_rate, fault->sample_rate);
+                refresh_devices(sid);
+            }
+            break;
+        case SoundIoDummyFaultDisconnect:
+            if (claim_fault(sid, fault)) {
+                SOUNDIO_ATOMIC_STORE(sid->disconnected, true);
+                post_backend_event(sid);
+            }
+            break;
+        }
+    }
+    return xrun;
+}
+
+// Whether the stream has to stop, either because the backend is gone or
+// because the device sample rate moved away from the stream's.
+static bool stream_lost(struct SoundIoDummy *sid, struct SoundIoDummyFaultState *state, int sample_rate) {
+    if (SOUNDIO_ATOMIC_LOAD(sid->disconnected))
+        return true;
+    int device_sample_rate = SOUNDIO_ATOMIC_LOAD(sid->sample_rate);
+    if (device_sample_rate == state->device_sample_rate)
+        return false;
+    state->device_sample_rate = device_sample_rate;
+    return device_sample_rate != sample_rate;
+}
+
+static void playback_begin(struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStream *outstream = &os->pub;
     struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
 
@@ -21,121 +151,308 @@ static void playback_thread_run(void *arg) {
     int free_frames = free_bytes / outstream->bytes_per_frame;
     osd->frames_left = free_frames;
     if (free_frames > 0)
-        outstream->write_callback(outstream, 0, free_frames);
-    double start_time = soundio_os_get_time();
-    long frames_consumed = 0;
+        soundio_outstream_invoke_write(outstream, 0, free_frames);
+    osd->start_time = outstream_clock(osd);
+    osd->frames_consumed = 0;
+}
+
+static void playback_iterate(struct SoundIoOutStreamPrivate *os, double now) {
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
+
+    if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->clear_buffer_flag)) {
+        soundio_ring_buffer_clear(&osd->ring_buffer);
+        int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer);
+        int free_frames = free_bytes / outstream->bytes_per_frame;
+        osd->frames_left = free_frames;
+        if (free_frames > 0)
+            soundio_outstream_invoke_write(outstream, 0, free_frames);
+        osd->frames_consumed = 0;
+        osd->start_time = outstream_clock(osd);
+        return;
+    }
+
+    if (SOUNDIO_ATOMIC_LOAD(osd->pause_requested)) {
+        osd->start_time = now;
+        osd->frames_consumed = 0;
+        return;
+    }
+
+    int fill_bytes = soundio_ring_buffer_fill_count(&osd->ring_buffer);
+    int fill_frames = fill_bytes / outstream->bytes_per_frame;
+    int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer) - fill_bytes;
+    int free_frames = free_bytes / outstream->bytes_per_frame;
+
+    double total_time = outstream_clock(osd) - osd->start_time;
+    long total_frames = total_time * outstream->sample_rate;
+    int frames_to_kill = total_frames - osd->frames_consumed;
+    int read_count = soundio_int_min(frames_to_kill, fill_frames);
+    int byte_count = read_count * outstream->bytes_per_frame;
+    soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, byte_count);
+    osd->frames_consumed += read_count;
+    osd->frame_position += read_count;
+
+    if (frames_to_kill > fill_frames) {
+        soundio_outstream_invoke_underflow(outstream);
+        osd->frames_left = free_frames;
+        if (free_frames > 0)
+            soundio_outstream_invoke_write(outstream, 0, free_frames);
+        osd->frames_consumed = 0;
+        osd->start_time = outstream_clock(osd);
+    } else if (free_frames > 0) {
+        osd->frames_left = free_frames;
+        soundio_outstream_invoke_write(outstream, 0, free_frames);
+    }
+}
+
+static void playback_apply_faults(struct SoundIoOutStreamPrivate *os) {
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)outstream->device->soundio;
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
 
+    if (sid->fault_count == 0 || osd->faults.failed)
+        return;
+
+    if (advance_faults(si, &osd->faults, osd->frame_position)) {
+        // the device lost whatever was queued
+        soundio_ring_buffer_clear(&osd->ring_buffer);
+        soundio_outstream_invoke_underflow(outstream);
+        int free_frames = soundio_ring_buffer_capacity(&osd->ring_buffer) / outstream->bytes_per_frame;
+        osd->frames_left = free_frames;
+        soundio_outstream_invoke_write(outstream, 0, free_frames);
+        osd->frames_consumed = 0;
+        osd->start_time = outstream_clock(osd);
+    }
+
+    if (stream_lost(sid, &osd->faults, outstream->sample_rate)) {
+        osd->faults.failed = true;
+        outstream->error_callback(outstream, SoundIoErrorStreaming);
+    }
+}
+
+static void playback_thread_run(void *arg) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+    struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
+
+    soundio_rt_guard_enter();
+    playback_begin(os);
     while (SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->abort_flag)) {
+        if (osd->faults.failed || (osd->freewheel && SOUNDIO_ATOMIC_LOAD(osd->pause_requested))) {
+            soundio_rt_guard_leave();
+            soundio_os_cond_timed_wait(osd->cond, NULL, osd->period_duration);
+            soundio_rt_guard_enter();
+            if (osd->faults.failed)
+                continue;
+        }
+        if (osd->freewheel) {
+            if (!SOUNDIO_ATOMIC_LOAD(osd->pause_requested))
+                osd->virtual_time += osd->period_duration + take_fault_delay(&osd->faults);
+            playback_iterate(os, osd->virtual_time);
+            playback_apply_faults(os);
+            continue;
+        }
         double now = soundio_os_get_time();
-        double time_passed = now - start_time;
-        double next_period = start_time +
+        double time_passed = now - osd->start_time;
+        double next_period = osd->start_time +
             ceil_dbl(time_passed / osd->period_duration) * osd->period_duration;
-        double relative_time = next_period - now;
+        double relative_time = next_period - now + take_fault_delay(&osd->faults);
+        soundio_rt_guard_leave();
         soundio_os_cond_timed_wait(osd->cond, NULL, relative_time);
-        if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->clear_buffer_flag)) {
-            soundio_ring_buffer_clear(&osd->ring_buffer);
-            int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer);
-            int free_frames = free_bytes / outstream->bytes_per_frame;
-            osd->frames_left = free_frames;
-            if (free_frames > 0)
-                outstream->write_callback(outstream, 0, free_frames);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-            continue;
-        }
+        soundio_rt_guard_enter();
+        now = soundio_os_get_time();
+        soundio_outstream_record_wakeup(&os->pub, now - next_period);
+        if (now > next_period + osd->period_duration)
+            SOUNDIO_ATOMIC_FETCH_ADD(os->deadline_miss_count, 1);
+        playback_iterate(os, now);
+        playback_apply_faults(os);
+    }
+    soundio_rt_guard_leave();
+}
 
-        if (SOUNDIO_ATOMIC_LOAD(osd->pause_requested)) {
-            start_time = now;
-            frames_consumed = 0;
-            continue;
-        }
+static double playback_task_run(struct SoundIoSchedulerTask *task, double now) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)task->arg;
+    struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
 
-        int fill_bytes = soundio_ring_buffer_fill_count(&osd->ring_buffer);
-        int fill_frames = fill_bytes / outstream->bytes_per_frame;
-        int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer) - fill_bytes;
-        int free_frames = free_bytes / outstream->bytes_per_frame;
+    if (osd->faults.failed)
+        return -1.0;
+    soundio_rt_guard_enter();
+    soundio_outstream_record_wakeup(&os->pub, now - task->deadline);
+    if (!osd->task_started) {
+        osd->task_started = true;
+        playback_begin(os);
+    } else {
+        playback_iterate(os, now);
+        playback_apply_faults(os);
+    }
+    soundio_rt_guard_leave();
+    if (osd->faults.failed)
+        return -1.0;
+    return next_period_after(osd->start_time, osd->period_duration, soundio_os_get_time()) +
+        take_fault_delay(&osd->faults);
+}
 
-        double total_time = soundio_os_get_time() - start_time;
-        long total_frames = total_time * outstream->sample_rate;
-        int frames_to_kill = total_frames - frames_consumed;
-        int read_count = soundio_int_min(frames_to_kill, fill_frames);
-        int byte_count = read_count * outstream->bytes_per_frame;
-        soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, byte_count);
-        frames_consumed += read_count;
-
-        if (frames_to_kill > fill_frames) {
-            outstream->underflow_callback(outstream);
-            osd->frames_left = free_frames;
-            if (free_frames > 0)
-                outstream->write_callback(outstream, 0, free_frames);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-        } else if (free_frames > 0) {
-            osd->frames_left = free_frames;
-            outstream->write_callback(outstream, 0, free_frames);
-        }
+static void capture_iterate(struct SoundIoInStreamPrivate *is, double now) {
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
+
+    if (SOUNDIO_ATOMIC_LOAD(isd->pause_requested)) {
+        isd->start_time = now;
+        isd->frames_consumed = 0;
+        return;
+    }
+
+    int fill_bytes = soundio_ring_buffer_fill_count(&isd->ring_buffer);
+    int free_bytes = soundio_ring_buffer_capacity(&isd->ring_buffer) - fill_bytes;
+    int fill_frames = fill_bytes / instream->bytes_per_frame;
+    int free_frames = free_bytes / instream->bytes_per_frame;
+
+    double total_time = instream_clock(isd) - isd->start_time;
+    long total_frames = total_time * instream->sample_rate;
+    int frames_to_kill = total_frames - isd->frames_consumed;
+    int write_count = soundio_int_min(frames_to_kill, free_frames);
+    int byte_count = write_count * instream->bytes_per_frame;
+    soundio_ring_buffer_advance_write_ptr(&isd->ring_buffer, byte_count);
+    isd->frames_consumed += write_count;
+    isd->frame_position += write_count;
+
+    if (frames_to_kill > free_frames) {
+        soundio_instream_invoke_overflow(instream);
+        isd->frames_consumed = 0;
+        isd->start_time = instream_clock(isd);
+    }
+    if (fill_frames > 0) {
+        isd->frames_left = fill_frames;
+        soundio_instream_invoke_read(instream, 0, fill_frames);
+    }
+}
+
+static void capture_apply_faults(struct SoundIoInStreamPrivate *is) {
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)instream->device->soundio;
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
+
+    if (sid->fault_count == 0 || isd->faults.failed)
+        return;
+
+    if (advance_faults(si, &isd->faults, isd->frame_position)) {
+        // captured frames that were not read yet are gone
+        soundio_ring_buffer_clear(&isd->ring_buffer);
+        soundio_instream_invoke_overflow(instream);
+        isd->frames_consumed = 0;
+        isd->start_time = instream_clock(isd);
+    }
+
+    if (stream_lost(sid, &isd->faults, instream->sample_rate)) {
+        isd->faults.failed = true;
+        instream->error_callback(instream, SoundIoErrorStreaming);
     }
 }
 
 static void capture_thread_run(void *arg) {
     struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
-    struct SoundIoInStream *instream = &is->pub;
     struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
 
-    long frames_consumed = 0;
-    double start_time = soundio_os_get_time();
+    soundio_rt_guard_enter();
+    isd->frames_consumed = 0;
+    isd->start_time = instream_clock(isd);
     while (SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isd->abort_flag)) {
+        if (isd->faults.failed || (isd->freewheel && SOUNDIO_ATOMIC_LOAD(isd->pause_requested))) {
+            soundio_rt_guard_leave();
+            soundio_os_cond_timed_wait(isd->cond, NULL, isd->period_duration);
+            soundio_rt_guard_enter();
+            if (isd->faults.failed)
+                continue;
+        }
+        if (isd->freewheel) {
+            if (!SOUNDIO_ATOMIC_LOAD(isd->pause_requested))
+                isd->virtual_time += isd->period_duration + take_fault_delay(&isd->faults);
+            capture_iterate(is, isd->virtual_time);
+            capture_apply_faults(is);
+            continue;
+        }
         double now = soundio_os_get_time();
-        double time_passed = now - start_time;
-        double next_period = start_time +
+        double time_passed = now - isd->start_time;
+        double next_period = isd->start_time +
             ceil_dbl(time_passed / isd->period_duration) * isd->period_duration;
-        double relative_time = next_period - now;
+        double relative_time = next_period - now + take_fault_delay(&isd->faults);
+        soundio_rt_guard_leave();
         soundio_os_cond_timed_wait(isd->cond, NULL, relative_time);
-
-        if (SOUNDIO_ATOMIC_LOAD(isd->pause_requested)) {
-            start_time = now;
-            frames_consumed = 0;
-            continue;
-        }
-
-        int fill_bytes = soundio_ring_buffer_fill_count(&isd->ring_buffer);
-        int free_bytes = soundio_ring_buffer_capacity(&isd->ring_buffer) - fill_bytes;
-        int fill_frames = fill_bytes / instream->bytes_per_frame;
-        int free_frames = free_bytes / instream->bytes_per_frame;
-
-        double total_time = soundio_os_get_time() - start_time;
-        long total_frames = total_time * instream->sample_rate;
-        int frames_to_kill = total_frames - frames_consumed;
-        int write_count = soundio_int_min(frames_to_kill, free_frames);
-        int byte_count = write_count * instream->bytes_per_frame;
-        soundio_ring_buffer_advance_write_ptr(&isd->ring_buffer, byte_count);
-        frames_consumed += write_count;
-
-        if (frames_to_kill > free_frames) {
-            instream->overflow_callback(instream);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-        }
-        if (fill_frames > 0) {
-            isd->frames_left = fill_frames;
-            instream->read_callback(instream, 0, fill_frames);
-        }
+        soundio_rt_guard_enter();
+        now = soundio_os_get_time();
+        soundio_instream_record_wakeup(&is->pub, now - next_period);
+        if (now > next_period + isd->period_duration)
+            SOUNDIO_ATOMIC_FETCH_ADD(is->deadline_miss_count, 1);
+        capture_iterate(is, now);
+        capture_apply_faults(is);
     }
+    soundio_rt_guard_leave();
+}
+
+static double capture_task_run(struct SoundIoSchedulerTask *task, double now) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)task->arg;
+    struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
+    if (isd->faults.failed)
+        return -1.0;
+    soundio_rt_guard_enter();
+    soundio_instream_record_wakeup(&is->pub, now - task->deadline);
+    capture_iterate(is, now);
+    capture_apply_faults(is);
+    soundio_rt_guard_leave();
+    if (isd->faults.failed)
+        return -1.0;
+    return next_period_after(isd->start_time, isd->period_duration, soundio_os_get_time()) +
+        take_fault_delay(&isd->faults);
 }
 
 static void destroy_dummy(struct SoundIoPrivate *si) {
     struct SoundIoDummy *sid = &si->backend_data.dummy;
 
+    if (sid->event_thread) {
+        SOUNDIO_ATOMIC_STORE(sid->event_thread_abort, true);
+        post_backend_event(sid);
+        soundio_os_thread_destroy(sid->event_thread);
+    }
+
     if (sid->cond)
         soundio_os_cond_destroy(sid->cond);
 
     if (sid->mutex)
         soundio_os_mutex_destroy(sid->mutex);
+
+    free(sid->faults);
+    free(sid->fault_fired);
 }
 
+static enum SoundIoError create_devices_info(struct SoundIoPrivate *si, struct SoundIoDevicesInfo **out_devices_info);
+
 static void flush_events_dummy(struct SoundIoPrivate *si) {
     struct SoundIo *soundio = &si->pub;
     struct SoundIoDummy *sid = &si->backend_data.dummy;
+
+    if (SOUNDIO_ATOMIC_LOAD(sid->disconnected)) {
+        if (!sid->emitted_disconnect) {
+            sid->emitted_disconnect = true;
+            soundio->on_backend_disconnect(soundio, SoundIoErrorBackendDisconnected);
+        }
+        return;
+    }
+
+    if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(sid->refresh_devices_flag)) {
+        struct SoundIoDevicesInfo *devices_info;
+        if (create_devices_info(si, &devices_info)) {
+            // try again on the next flush
+            SOUNDIO_ATOMIC_FLAG_CLEAR(sid->refresh_devices_flag);
+            return;
+        }
+        soundio_destroy_devices_info(si->safe_devices_info);
+        si->safe_devices_info = devices_info;
+        sid->devices_emitted = true;
+        soundio->on_devices_change(soundio);
+        return;
+    }
+
     if (sid->devices_emitted)
         return;
     sid->devices_emitted = true;
@@ -154,12 +471,16 @@ static void wakeup_dummy(struct SoundIoPrivate *si) {
 }
 
 static void force_device_scan_dummy(struct SoundIoPrivate *si) {
-    // nothing to do; dummy devices never change
+    // nothing to do; dummy devices only change through injected faults
 }
 
 static void outstream_destroy_dummy(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
 
+    if (osd->task_added) {
+        soundio_scheduler_remove(si->scheduler, &osd->task);
+        osd->task_added = false;
+    }
     if (osd->thread) {
         SOUNDIO_ATOMIC_FLAG_CLEAR(osd->abort_flag);
         soundio_os_cond_signal(osd->cond, NULL);
@@ -179,6 +500,8 @@ static enum SoundIoError outstream_open_dummy(struct SoundIoPrivate *si, struct
 
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->clear_buffer_flag);
     SOUNDIO_ATOMIC_STORE(osd->pause_requested, false);
+    osd->freewheel = si->backend_data.dummy.freewheel;
+    osd->virtual_time = 0.0;
 
     if (outstream->software_latency == 0.0) {
         outstream->software_latency = soundio_double_clamp(
@@ -214,13 +537,46 @@ static enum SoundIoError outstream_pause_dummy(struct SoundIoPrivate *si, struct
     return SoundIoErrorNone;
 }
 
+// A freewheeling stream never sleeps, so a real time policy would starve
+// every other thread on its CPU for as long as it runs.
+static struct SoundIoThreadAttributes stream_thread_attributes(
+        const struct SoundIoThreadAttributes *requested, bool freewheel)
+{
+    struct SoundIoThreadAttributes attributes = *requested;
+    if (freewheel) {
+        attributes.policy = SoundIoThreadPolicyNormal;
+        attributes.priority = 0;
+    }
+    return attributes;
+}
+
 static enum SoundIoError outstream_start_dummy(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
     struct SoundIo *soundio = &si->pub;
     assert(!osd->thread);
+    assert(!osd->task_added);
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->abort_flag);
+    fault_state_init(&si->backend_data.dummy, &osd->faults);
+    osd->frame_position = 0;
     enum SoundIoError err;
-    if ((err = soundio_os_thread_create(playback_thread_run, os, soundio, &osd->thread))) {
+    // a freewheeling stream would monopolize a shared worker
+    if (si->scheduler && !osd->freewheel) {
+        osd->task.run = playback_task_run;
+        osd->task.arg = os;
+        osd->task.slack = osd->period_duration;
+        osd->task.miss_count = &os->deadline_miss_count;
+        osd->task_started = false;
+        if ((err = soundio_scheduler_add(si->scheduler, &osd->task, soundio_os_get_time())))
+            return err;
+        osd->task_added = true;
+        return SoundIoErrorNone;
+    }
+    struct SoundIoThreadAttributes attributes = stream_thread_attributes(
+            &os->pub.thread_attributes, osd->freewheel);
+    if ((err = soundio_os_thread_create_with_attributes(playback_thread_run, os, soundio,
+                    &attributes, osd->period_duration,
+                    &os->pub.actual_thread_attributes, &osd->thread)))
+    {
         return err;
     }
     return SoundIoErrorNone;
@@ -258,7 +614,10 @@ static enum SoundIoError outstream_end_write_dummy(struct SoundIoPrivate *si, st
 static enum SoundIoError outstream_clear_buffer_dummy(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamDummy *osd = &os->backend_data.dummy;
     SOUNDIO_ATOMIC_FLAG_CLEAR(osd->clear_buffer_flag);
-    soundio_os_cond_signal(osd->cond, NULL);
+    if (osd->task_added)
+        soundio_scheduler_wake(&osd->task);
+    else
+        soundio_os_cond_signal(osd->cond, NULL);
     return SoundIoErrorNone;
 }
 
@@ -274,6 +633,10 @@ static enum SoundIoError outstream_get_latency_dummy(struct SoundIoPrivate *si,
 static void instream_destroy_dummy(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
     struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
 
+    if (isd->task_added) {
+        soundio_scheduler_remove(si->scheduler, &isd->task);
+        isd->task_added = false;
+    }
     if (isd->thread) {
         SOUNDIO_ATOMIC_FLAG_CLEAR(isd->abort_flag);
         soundio_os_cond_signal(isd->cond, NULL);
@@ -292,6 +655,8 @@ static enum SoundIoError instream_open_dummy(struct SoundIoPrivate *si, struct S
     struct SoundIoDevice *device = instream->device;
 
     SOUNDIO_ATOMIC_STORE(isd->pause_requested, false);
+    isd->freewheel = si->backend_data.dummy.freewheel;
+    isd->virtual_time = 0.0;
 
     if (instream->software_latency == 0.0) {
         instream->software_latency = soundio_double_clamp(
@@ -331,9 +696,32 @@ static enum SoundIoError instream_start_dummy(struct SoundIoPrivate *si, struct
     struct SoundIoInStreamDummy *isd = &is->backend_data.dummy;
     struct SoundIo *soundio = &si->pub;
     assert(!isd->thread);
+    assert(!isd->task_added);
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isd->abort_flag);
+    fault_state_init(&si->backend_data.dummy, &isd->faults);
+    isd->frame_position = 0;
     enum SoundIoError err;
-    if ((err = soundio_os_thread_create(capture_thread_run, is, soundio, &isd->thread))) {
+    if (si->scheduler && !isd->freewheel) {
+        isd->task.run = capture_task_run;
+        isd->task.arg = is;
+        isd->task.slack = isd->period_duration;
+        isd->task.miss_count = &is->deadline_miss_count;
+        isd->frames_consumed = 0;
+        isd->start_time = soundio_os_get_time();
+        if ((err = soundio_scheduler_add(si->scheduler, &isd->task,
+                        isd->start_time + isd->period_duration)))
+        {
+            return err;
+        }
+        isd->task_added = true;
+        return 0;
+    }
+    struct SoundIoThreadAttributes attributes = stream_thread_attributes(
+            &is->pub.thread_attributes, isd->freewheel);
+    if ((err = soundio_os_thread_create_with_attributes(capture_thread_run, is, soundio,
+                    &attributes, isd->period_duration,
+                    &is->pub.actual_thread_attributes, &isd->thread)))
+    {
         return err;
     }
     return 0;
@@ -427,123 +815,134 @@ static enum SoundIoError set_all_device_channel_layouts(struct SoundIoDevice *de
     return 0;
 }
 
-enum SoundIoError soundio_dummy_init(struct SoundIoPrivate *si) {
-    struct SoundIo *soundio = &si->pub;
+static enum SoundIoError create_device(struct SoundIoPrivate *si, enum SoundIoDeviceAim aim,
+        const char *id, const char *name, struct SoundIoListDevicePtr *device_list)
+{
     struct SoundIoDummy *sid = &si->backend_data.dummy;
 
-    sid->mutex = soundio_os_mutex_create();
-    if (!sid->mutex) {
-        destroy_dummy(si);
+    struct SoundIoDevicePrivate *dev = ALLOCATE(struct SoundIoDevicePrivate, 1);
+    if (!dev)
+        return SoundIoErrorNoMem;
+    struct SoundIoDevice *device = &dev->pub;
+
+    device->ref_count = 1;
+    device->soundio = &si->pub;
+    device->id = strdup(id);
+    device->name = strdup(name);
+    if (!device->id || !device->name) {
+        soundio_device_unref(device);
         return SoundIoErrorNoMem;
     }
 
-    sid->cond = soundio_os_cond_create();
-    if (!sid->cond) {
-        destroy_dummy(si);
-        return SoundIoErrorNoMem;
+    enum SoundIoError err;
+    if ((err = set_all_device_channel_layouts(device))) {
+        soundio_device_unref(device);
+        return err;
+    }
+    if ((err = set_all_device_formats(device))) {
+        soundio_device_unref(device);
+        return err;
     }
+    set_all_device_sample_rates(device);
 
-    assert(!si->safe_devices_info);
-    si->safe_devices_info = ALLOCATE(struct SoundIoDevicesInfo, 1);
-    if (!si->safe_devices_info) {
-        destroy_dummy(si);
+    device->software_latency_current = 0.1;
+    device->software_latency_min = 0.01;
+    device->software_latency_max = 4.0;
+
+    device->sample_rate_current = SOUNDIO_ATOMIC_LOAD(sid->sample_rate);
+    device->aim = aim;
+
+    if (SoundIoListDevicePtr_append(device_list, device)) {
+        soundio_device_unref(device);
         return SoundIoErrorNoMem;
     }
+    return SoundIoErrorNone;
+}
 
-    si->safe_devices_info->default_input_index = 0;
-    si->safe_devices_info->default_output_index = 0;
+static enum SoundIoError create_devices_info(struct SoundIoPrivate *si, struct SoundIoDevicesInfo **out_devices_info) {
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
+
+    struct SoundIoDevicesInfo *devices_info = ALLOCATE(struct SoundIoDevicesInfo, 1);
+    if (!devices_info)
+        return SoundIoErrorNoMem;
 
-    // create output device
+    devices_info->default_input_index = 0;
+    devices_info->default_output_index = 0;
+
+    enum SoundIoError err;
+    if ((err = create_device(si, SoundIoDeviceAimOutput, "dummy-out", "Dummy Output Device",
+                    &devices_info->output_devices)) ||
+        (err = create_device(si, SoundIoDeviceAimInput, "dummy-in", "Dummy Input Device",
+                    &devices_info->input_devices)))
     {
-        struct SoundIoDevicePrivate *dev = ALLOCATE(struct SoundIoDevicePrivate, 1);
-        if (!dev) {
-            destroy_dummy(si);
-            return SoundIoErrorNoMem;
-        }
-        struct SoundIoDevice *device = &dev->pub;
-
-        device->ref_count = 1;
-        device->soundio = soundio;
-        device->id = strdup("dummy-out");
-        device->name = strdup("Dummy Output Device");
-        if (!device->id || !device->name) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
-            return SoundIoErrorNoMem;
-        }
+        soundio_destroy_devices_info(devices_info);
+        return err;
+    }
 
-        int err;
-        if ((err = set_all_device_channel_layouts(device))) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
-            return err;
-        }
-        if ((err = set_all_device_formats(device))) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
+    if (SOUNDIO_ATOMIC_LOAD(sid->extra_devices)) {
+        if ((err = create_device(si, SoundIoDeviceAimOutput, "dummy-out-2", "Dummy Output Device 2",
+                        &devices_info->output_devices)) ||
+            (err = create_device(si, SoundIoDeviceAimInput, "dummy-in-2", "Dummy Input Device 2",
+                        &devices_info->input_devices)))
+        {
+            soundio_destroy_devices_info(devices_info);
             return err;
         }
-        set_all_device_sample_rates(device);
+    }
 
-        device->software_latency_current = 0.1;
-        device->software_latency_min = 0.01;
-        device->software_latency_max = 4.0;
+    *out_devices_info = devices_info;
+    return SoundIoErrorNone;
+}
 
-        device->sample_rate_current = 48000;
-        device->aim = SoundIoDeviceAimOutput;
+enum SoundIoError soundio_dummy_init(struct SoundIoPrivate *si) {
+    struct SoundIo *soundio = &si->pub;
+    struct SoundIoDummy *sid = &si->backend_data.dummy;
 
-        if (SoundIoListDevicePtr_append(&si->safe_devices_info->output_devices, device)) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
-            return SoundIoErrorNoMem;
-        }
-    }
+    sid->freewheel = soundio->dummy_freewheel;
+    SOUNDIO_ATOMIC_STORE(sid->sample_rate, 48000);
+    SOUNDIO_ATOMIC_STORE(sid->extra_devices, false);
+    SOUNDIO_ATOMIC_STORE(sid->disconnected, false);
+    SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(sid->refresh_devices_flag);
 
-    // create input device
-    {
-        struct SoundIoDevicePrivate *dev = ALLOCATE(struct SoundIoDevicePrivate, 1);
-        if (!dev) {
-            destroy_dummy(si);
-            return SoundIoErrorNoMem;
-        }
-        struct SoundIoDevice *device = &dev->pub;
-
-        device->ref_count = 1;
-        device->soundio = soundio;
-        device->id = strdup("dummy-in");
-        device->name = strdup("Dummy Input Device");
-        if (!device->id || !device->name) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
-            return SoundIoErrorNoMem;
-        }
+    sid->mutex = soundio_os_mutex_create();
+    if (!sid->mutex) {
+        destroy_dummy(si);
+        return SoundIoErrorNoMem;
+    }
 
-        int err;
-        if ((err = set_all_device_channel_layouts(device))) {
-            soundio_device_unref(device);
-            destroy_dummy(si);
-            return err;
-        }
+    sid->cond = soundio_os_cond_create();
+    if (!sid->cond) {
+        destroy_dummy(si);
+        return SoundIoErrorNoMem;
+    }
 
-        if ((err = set_all_device_formats(device))) {
-            soundio_device_unref(device);
+    if (soundio->dummy_fault_count > 0) {
+        sid->faults = ALLOCATE(struct SoundIoDummyFault, soundio->dummy_fault_count);
+        sid->fault_fired = ALLOCATE(struct SoundIoAtomicBool, soundio->dummy_fault_count);
+        if (!sid->faults || !sid->fault_fired) {
             destroy_dummy(si);
-            return err;
+            return SoundIoErrorNoMem;
         }
-        set_all_device_sample_rates(device);
-        device->software_latency_current = 0.1;
-        device->software_latency_min = 0.01;
-        device->software_latency_max = 4.0;
-        device->sample_rate_current = 48000;
-        device->aim = SoundIoDeviceAimInput;
-
-        if (SoundIoListDevicePtr_append(&si->safe_devices_info->input_devices, device)) {
-            soundio_device_unref(device);
+        memcpy(sid->faults, soundio->dummy_faults,
+                soundio->dummy_fault_count * sizeof(struct SoundIoDummyFault));
+        for (int i = 0; i < soundio->dummy_fault_count; i += 1)
+            SOUNDIO_ATOMIC_STORE(sid->fault_fired[i], false);
+        sid->fault_count = soundio->dummy_fault_count;
+
+        SOUNDIO_ATOMIC_STORE(sid->event_seq, 0);
+        SOUNDIO_ATOMIC_STORE(sid->event_thread_abort, false);
+        if (soundio_os_thread_create(event_thread_run, si, NULL, &sid->event_thread)) {
             destroy_dummy(si);
-            return SoundIoErrorNoMem;
+            return SoundIoErrorSystemResources;
         }
     }
 
+    assert(!si->safe_devices_info);
+    enum SoundIoError err;
+    if ((err = create_devices_info(si, &si->safe_devices_info))) {
+        destroy_dummy(si);
+        return err;
+    }
 
     si->destroy = destroy_dummy;
     si->flush_events = flush_events_dummy;
@@ -568,5 +967,8 @@ enum SoundIoError soundio_dummy_init(struct SoundIoPrivate *si) {
     si->instream_pause = instream_pause_dummy;
     si->instream_get_latency = instream_get_latency_dummy;
 
+    // devices are known up front; let event loop users see them right away
+    soundio_emit_events_signal(soundio);
+
     return 0;
 }
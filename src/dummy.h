@@ -12,6 +12,9 @@
 #include "os.h"
 #include "ring_buffer.h"
 #include "atomics.h"
+#include "scheduler.h"
+
+#include <stdint.h>
 
 struct SoundIoPrivate;
 enum SoundIoError soundio_dummy_init(struct SoundIoPrivate *si);
@@ -20,6 +23,34 @@ struct SoundIoDummy {
     struct SoundIoOsMutex *mutex;
     struct SoundIoOsCond *cond;
     bool devices_emitted;
+    bool freewheel;
+
+    // copy of SoundIo::dummy_faults
+    struct SoundIoDummyFault *faults;
+    int fault_count;
+    // backend-wide faults fire only once, from whichever stream gets there first
+    struct SoundIoAtomicBool *fault_fired;
+    struct SoundIoAtomicInt sample_rate;
+    struct SoundIoAtomicBool extra_devices;
+    struct SoundIoAtomicFlag refresh_devices_flag;
+    struct SoundIoAtomicBool disconnected;
+    bool emitted_disconnect;
+    // Stream threads report backend-wide faults by bumping `event_seq`;
+    // `event_thread` does the signalling, which locks and writes.
+    struct SoundIoOsThread *event_thread;
+    struct SoundIoAtomicInt event_seq;
+    struct SoundIoAtomicBool event_thread_abort;
+};
+
+// Per-stream progress through the fault injection scenario.
+struct SoundIoDummyFaultState {
+    int next_fault;
+    // added to the next wakeup only
+    double delay;
+    double jitter_max;
+    uint32_t rng_state;
+    int device_sample_rate;
+    bool failed;
 };
 
 struct SoundIoDeviceDummy { int make_the_struct_not_empty; };
@@ -34,6 +65,15 @@ struct SoundIoOutStreamDummy {
     int write_frame_count;
     struct SoundIoRingBuffer ring_buffer;
     double playback_start_time;
+    double start_time;
+    long frames_consumed;
+    struct SoundIoSchedulerTask task;
+    bool task_added;
+    bool task_started;
+    bool freewheel;
+    double virtual_time;
+    long frame_position;
+    struct SoundIoDummyFaultState faults;
     struct SoundIoAtomicFlag clear_buffer_flag;
     struct SoundIoAtomicBool pause_requested;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
@@ -48,6 +88,14 @@ struct SoundIoInStreamDummy {
     int read_frame_count;
     int buffer_frame_count;
     struct SoundIoRingBuffer ring_buffer;
+    double start_time;
+    long frames_consumed;
+    struct SoundIoSchedulerTask task;
+    bool task_added;
+    bool freewheel;
+    double virtual_time;
+    long frame_position;
+    struct SoundIoDummyFaultState faults;
     struct SoundIoAtomicBool pause_requested;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
 };
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "soundio_private.h"
+#include "os.h"
+#include "atomics.h"
+#include "util.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+struct SoundIoFrameRingBuffer {
+    struct SoundIoOsMirroredMemory mem;
+    int channel_count;
+    int bytes_per_sample;
+    int bytes_per_frame;
+    // in frames; capacity * bytes_per_frame might be less than mem.capacity
+    int64_t capacity;
+
+    // offsets in frames
+    struct SoundIoAtomicInt64 write_offset;
+    struct SoundIoAtomicInt64 read_offset;
+
+    // what begin_write and begin_read handed out
+    int64_t write_reserved;
+    int64_t read_reserved;
+    struct SoundIoChannelArea write_areas[SOUNDIO_MAX_CHANNELS];
+    struct SoundIoChannelArea read_areas[SOUNDIO_MAX_CHANNELS];
+};
+
+struct SoundIoFrameRingBuffer *soundio_frame_ring_buffer_create(struct SoundIo *soundio,
+        enum SoundIoFormat format, int channel_count, int64_t requested_frames)
+{
+    assert(requested_frames > 0);
+    assert(channel_count > 0 && channel_count <= SOUNDIO_MAX_CHANNELS);
+    int bytes_per_sample = soundio_get_bytes_per_sample(format);
+    assert(bytes_per_sample > 0);
+
+    struct SoundIoFrameRingBuffer *rb = ALLOCATE(struct SoundIoFrameRingBuffer, 1);
+    if (!rb)
+        return NULL;
+    rb->channel_count = channel_count;
+    rb->bytes_per_sample = bytes_per_sample;
+    rb->bytes_per_frame = bytes_per_sample * channel_count;
+
+    if ((uint64_t)requested_frames > SIZE_MAX / 2 / (uint64_t)rb->bytes_per_frame) {
+        free(rb);
+        return NULL;
+    }
+    // The mirrored mapping makes any byte offset contiguous for a whole
+    // capacity, so the byte capacity need not be a multiple of the frame size.
+    if (soundio_os_init_mirrored_memory(&rb->mem, (size_t)requested_frames * rb->bytes_per_frame)) {
+        free(rb);
+        return NULL;
+    }
+    rb->capacity = rb->mem.capacity / rb->bytes_per_frame;
+    SOUNDIO_ATOMIC_STORE(rb->write_offset, 0);
+    SOUNDIO_ATOMIC_STORE(rb->read_offset, 0);
+
+    return rb;
+}
+
+void soundio_frame_ring_buffer_destroy(struct SoundIoFrameRingBuffer *rb) {
+    if (!rb)
+        return;
+
+    soundio_os_deinit_mirrored_memory(&rb->mem);
+    free(rb);
+}
+
+int64_t soundio_frame_ring_buffer_capacity(struct SoundIoFrameRingBuffer *rb) {
+    return rb->capacity;
+}
+
+int soundio_frame_ring_buffer_bytes_per_frame(struct SoundIoFrameRingBuffer *rb) {
+    return rb->bytes_per_frame;
+}
+
+int64_t soundio_frame_ring_buffer_fill_count(struct SoundIoFrameRingBuffer *rb) {
+    // Whichever offset we load first might have a smaller value. So we load
+    // the read_offset first.
+    int64_t read_offset = SOUNDIO_ATOMIC_LOAD(rb->read_offset);
+    int64_t write_offset = SOUNDIO_ATOMIC_LOAD(rb->write_offset);
+    int64_t count = write_offset - read_offset;
+    assert(count >= 0);
+    assert(count <= rb->capacity);
+    return count;
+}
+
+int64_t soundio_frame_ring_buffer_free_count(struct SoundIoFrameRingBuffer *rb) {
+    return rb->capacity - soundio_frame_ring_buffer_fill_count(rb);
+}
+
+static void set_areas(struct SoundIoFrameRingBuffer *rb, struct SoundIoChannelArea *areas, int64_t offset) {
+    char *ptr = rb->mem.address + (size_t)((uint64_t)offset * rb->bytes_per_frame % rb->mem.capacity);
+    for (int ch = 0; ch < rb->channel_count; ch += 1) {
+        areas[ch].ptr = ptr + ch * rb->bytes_per_sample;
+        areas[ch].step = rb->bytes_per_frame;
+    }
+}
+
+void soundio_frame_ring_buffer_begin_write(struct SoundIoFrameRingBuffer *rb,
+        struct SoundIoChannelArea **out_areas, int64_t *frame_count)
+{
+    assert(*frame_count >= 0);
+    int64_t free_count = soundio_frame_ring_buffer_free_count(rb);
+    if (*frame_count > free_count)
+        *frame_count = free_count;
+    rb->write_reserved = *frame_count;
+    set_areas(rb, rb->write_areas, SOUNDIO_ATOMIC_LOAD(rb->write_offset));
+    *out_areas = rb->write_areas;
+}
+
+void soundio_frame_ring_buffer_end_write(struct SoundIoFrameRingBuffer *rb, int64_t frame_count) {
+    assert(frame_count >= 0 && frame_count <= rb->write_reserved);
+    rb->write_reserved = 0;
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->write_offset, frame_count);
+}
+
+void soundio_frame_ring_buffer_begin_read(struct SoundIoFrameRingBuffer *rb,
+        struct SoundIoChannelArea **out_areas, int64_t *frame_count)
+{
+    assert(*frame_count >= 0);
+    int64_t fill_count = soundio_frame_ring_buffer_fill_count(rb);
+    if (*frame_count > fill_count)
+        *frame_count = fill_count;
+    rb->read_reserved = *frame_count;
+    set_areas(rb, rb->read_areas, SOUNDIO_ATOMIC_LOAD(rb->read_offset));
+    *out_areas = rb->read_areas;
+}
+
+void soundio_frame_ring_buffer_end_read(struct SoundIoFrameRingBuffer *rb, int64_t frame_count) {
+    assert(frame_count >= 0 && frame_count <= rb->read_reserved);
+    rb->read_reserved = 0;
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->read_offset, frame_count);
+}
+
+void soundio_frame_ring_buffer_clear(struct SoundIoFrameRingBuffer *rb) {
+    int64_t read_offset = SOUNDIO_ATOMIC_LOAD(rb->read_offset);
+    SOUNDIO_ATOMIC_STORE(rb->write_offset, read_offset);
+}
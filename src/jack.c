@@ -116,6 +116,10 @@ static int refresh_devices_bare(struct SoundIoPrivate *si) {
             return SoundIoErrorInterrupted;
         }
 
+        // the ports of our own streams are not devices
+        if (jack_port_is_mine(sij->client, jport))
+            continue;
+
         int flags = jack_port_flags(jport);
         const char *port_type = jack_port_type(jport);
         if (strcmp(port_type, JACK_DEFAULT_AUDIO_TYPE) != 0) {
@@ -347,29 +351,186 @@ static void force_device_scan_jack(struct SoundIoPrivate *si) {
     SOUNDIO_ATOMIC_FLAG_CLEAR(sij->refresh_devices_flag);
     soundio_os_mutex_lock(sij->mutex);
     soundio_os_cond_signal(sij->cond, sij->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(sij->mutex);
 }
 
-static int outstream_process_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+// Calls the write callback with whole periods until the buffer holds at
+// least nframes, then deinterleaves nframes into the ports.
+static void outstream_write_reblocked(struct SoundIoOutStreamPrivate *os, jack_nframes_t nframes) {
+    struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoRingBuffer *rb = &osj->reblock_buffer;
+    int channel_count = outstream->layout.channel_count;
+    int needed_bytes = nframes * outstream->bytes_per_frame;
+    int period_bytes = osj->period_size * outstream->bytes_per_frame;
+
+    while (soundio_ring_buffer_fill_count(rb) < needed_bytes) {
+        char *write_ptr = soundio_ring_buffer_write_ptr(rb);
+        // whatever the callback does not write plays as silence
+        memset(write_ptr, 0, period_bytes);
+        for (int ch = 0; ch < channel_count; ch += 1) {
+            osj->areas[ch].ptr = write_ptr + outstream->bytes_per_sample * ch;
+            osj->areas[ch].step = outstream->bytes_per_frame;
+        }
+        osj->frames_left = osj->period_size;
+        soundio_outstream_invoke_write(outstream, osj->frames_left, osj->frames_left);
+        soundio_ring_buffer_advance_write_ptr(rb, period_bytes);
+    }
+
+    const float *frames = (const float *)soundio_ring_buffer_read_ptr(rb);
+    for (int ch = 0; ch < channel_count; ch += 1) {
+        float *port_buf = (float *)jack_port_get_buffer(osj->ports[ch].source_port, nframes);
+        for (jack_nframes_t i = 0; i < nframes; i += 1)
+            port_buf[i] = frames[i * channel_count + ch];
+    }
+    soundio_ring_buffer_advance_read_ptr(rb, needed_bytes);
+}
+
+static void outstream_process(struct SoundIoOutStreamPrivate *os, jack_client_t *client, jack_nframes_t nframes) {
     struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
     struct SoundIoOutStream *outstream = &os->pub;
+    soundio_outstream_record_wakeup(outstream,
+            jack_frames_since_cycle_start(client) / (double)outstream->sample_rate);
+    if (osj->reblocking) {
+        outstream_write_reblocked(os, nframes);
+        return;
+    }
     osj->frames_left = nframes;
     for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
         struct SoundIoOutStreamJackPort *osjp = &osj->ports[ch];
         osj->areas[ch].ptr = (char*)jack_port_get_buffer(osjp->source_port, nframes);
         osj->areas[ch].step = outstream->bytes_per_sample;
     }
-    outstream->write_callback(outstream, osj->frames_left, osj->frames_left);
+    soundio_outstream_invoke_write(outstream, osj->frames_left, osj->frames_left);
+}
+
+// Ports of a stream that is not started or is paused still belong to the
+// graph, so they have to play silence.
+static void outstream_silence(struct SoundIoOutStreamPrivate *os, jack_nframes_t nframes) {
+    struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
+    struct SoundIoOutStream *outstream = &os->pub;
+    for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
+        void *port_buf = jack_port_get_buffer(osj->ports[ch].source_port, nframes);
+        memset(port_buf, 0, nframes * sizeof(jack_default_audio_sample_t));
+    }
+}
+
+// Makes the stream visible to the process and notification callbacks. Called
+// once the stream is fully set up.
+static enum SoundIoError acquire_slot(struct SoundIoJack *sij, bool is_input, void *stream,
+        struct SoundIoJackStreamSlot **out_slot)
+{
+    soundio_os_mutex_lock(sij->stream_mutex);
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    struct SoundIoJackStreamSlot *slot = NULL;
+    for (int i = 0; i < slot_count; i += 1) {
+        if (!SOUNDIO_ATOMIC_LOAD(sij->slots[i].in_use)) {
+            slot = &sij->slots[i];
+            break;
+        }
+    }
+    if (!slot) {
+        if (slot_count >= SOUNDIO_JACK_MAX_STREAMS) {
+            soundio_os_mutex_unlock(sij->stream_mutex);
+            return SoundIoErrorSystemResources;
+        }
+        slot = &sij->slots[slot_count];
+    }
+    slot->is_input = is_input;
+    slot->stream = stream;
+    SOUNDIO_ATOMIC_STORE(slot->running, false);
+    SOUNDIO_ATOMIC_STORE(slot->in_use, true);
+    if (slot == &sij->slots[slot_count])
+        SOUNDIO_ATOMIC_STORE(sij->slot_count, slot_count + 1);
+    soundio_os_mutex_unlock(sij->stream_mutex);
+    *out_slot = slot;
+    return 0;
+}
+
+// After this returns the process callback no longer touches the stream.
+static void release_slot(struct SoundIoJack *sij, struct SoundIoJackStreamSlot *slot) {
+    soundio_os_mutex_lock(sij->stream_mutex);
+    SOUNDIO_ATOMIC_STORE(slot->running, false);
+    SOUNDIO_ATOMIC_STORE(slot->in_use, false);
+    soundio_os_mutex_unlock(sij->stream_mutex);
+    // a cycle that started before the store may still be using the stream
+    while (SOUNDIO_ATOMIC_LOAD(sij->process_busy))
+        soundio_os_cond_timed_wait(sij->cond, NULL, 0.0005);
+}
+
+// Registers the stream's ports on the shared client as "<name>/<channel>",
+// falling back to "<name>-2/<channel>" and so on when another stream already
+// uses the name.
+static enum SoundIoError register_ports(struct SoundIoJack *sij, const char *stream_name,
+        const struct SoundIoChannelLayout *layout, unsigned long flags, jack_port_t **out_ports)
+{
+    const char *client_name = jack_get_client_name(sij->client);
+    const char *first_channel = soundio_get_channel_name(layout->channels[0]);
+    char *prefix = NULL;
+    for (int serial = 1; serial < SOUNDIO_JACK_MAX_STREAMS + 2; serial += 1) {
+        int len;
+        if (serial == 1)
+            prefix = soundio_alloc_sprintf(&len, "%s", stream_name);
+        else
+            prefix = soundio_alloc_sprintf(&len, "%s-%d", stream_name, serial);
+        if (!prefix)
+            return SoundIoErrorNoMem;
+        char *full_name = soundio_alloc_sprintf(&len, "%s:%s/%s", client_name, prefix, first_channel);
+        if (!full_name) {
+            free(prefix);
+            return SoundIoErrorNoMem;
+        }
+        bool taken = jack_port_by_name(sij->client, full_name) != NULL;
+        free(full_name);
+        if (!taken)
+            break;
+        free(prefix);
+        prefix = NULL;
+    }
+    if (!prefix)
+        return SoundIoErrorOpeningDevice;
+
+    for (int ch = 0; ch < layout->channel_count; ch += 1) {
+        const char *channel_name = soundio_get_channel_name(layout->channels[ch]);
+        int len;
+        char *port_name = soundio_alloc_sprintf(&len, "%s/%s", prefix, channel_name);
+        if (!port_name) {
+            free(prefix);
+            return SoundIoErrorNoMem;
+        }
+        out_ports[ch] = jack_port_register(sij->client, port_name, JACK_DEFAULT_AUDIO_TYPE, flags, 0);
+        free(port_name);
+        if (!out_ports[ch]) {
+            free(prefix);
+            return SoundIoErrorOpeningDevice;
+        }
+    }
+    free(prefix);
     return 0;
 }
 
-static void outstream_destroy_jack(struct SoundIoPrivate *is, struct SoundIoOutStreamPrivate *os) {
+static void outstream_destroy_jack(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
+    struct SoundIoJack *sij = &si->backend_data.jack;
     struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
 
-    jack_client_close(osj->client);
-    osj->client = NULL;
+    if (osj->slot) {
+        release_slot(sij, osj->slot);
+        osj->slot = NULL;
+    }
+
+    for (int ch = 0; ch < SOUNDIO_MAX_CHANNELS; ch += 1) {
+        struct SoundIoOutStreamJackPort *osjp = &osj->ports[ch];
+        if (osjp->source_port) {
+            jack_port_unregister(sij->client, osjp->source_port);
+            osjp->source_port = NULL;
+        }
+    }
+
+    if (osj->reblocking) {
+        soundio_ring_buffer_deinit(&osj->reblock_buffer);
+        osj->reblocking = false;
+    }
 }
 
 static struct SoundIoDeviceJackPort *find_port_matching_channel(struct SoundIoDevice *device, enum SoundIoChannelId id) {
@@ -385,40 +546,50 @@ static struct SoundIoDeviceJackPort *find_port_matching_channel(struct SoundIoDe
     return NULL;
 }
 
-static int outstream_xrun_callback(void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
-    struct SoundIoOutStream *outstream = &os->pub;
-    outstream->underflow_callback(outstream);
-    return 0;
-}
-
-static int outstream_buffer_size_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+// JACK stops the graph while it changes the buffer size, so neither this nor
+// the sample rate handler runs concurrently with the process callback.
+static int outstream_buffer_size_changed(struct SoundIoOutStreamPrivate *os, jack_nframes_t nframes) {
     struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
     struct SoundIoOutStream *outstream = &os->pub;
-    if ((jack_nframes_t)osj->period_size == nframes) {
+    if ((jack_nframes_t)osj->server_period_size == nframes)
         return 0;
-    } else {
-        outstream->error_callback(outstream, SoundIoErrorStreaming);
-        return -1;
-    }
-}
+    osj->server_period_size = nframes;
 
-static int outstream_sample_rate_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
-    struct SoundIoOutStream *outstream = &os->pub;
-    if (nframes == (jack_nframes_t)outstream->sample_rate) {
-        return 0;
+    if (outstream->keep_period) {
+        // frames queued for the old period are dropped
+        if (osj->reblocking) {
+            soundio_ring_buffer_deinit(&osj->reblock_buffer);
+            osj->reblocking = false;
+        }
+        if ((jack_nframes_t)osj->period_size != nframes) {
+            int capacity = (nframes + osj->period_size) * outstream->bytes_per_frame;
+            if (soundio_ring_buffer_init(&osj->reblock_buffer, capacity)) {
+                outstream->error_callback(outstream, SoundIoErrorStreaming);
+                return -1;
+            }
+            osj->reblocking = true;
+        }
     } else {
-        outstream->error_callback(outstream, SoundIoErrorStreaming);
-        return -1;
+        osj->period_size = nframes;
+        outstream->software_latency = nframes / (double)outstream->sample_rate;
     }
+
+    outstream->period_changed_callback(outstream);
+    return 0;
 }
 
-static void outstream_shutdown_callback(void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+static void outstream_sample_rate_changed(struct SoundIoOutStreamPrivate *os, jack_nframes_t nframes) {
+    struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
     struct SoundIoOutStream *outstream = &os->pub;
-    outstream->error_callback(outstream, SoundIoErrorStreaming);
+    if (nframes == (jack_nframes_t)outstream->sample_rate)
+        return;
+
+    // port latencies are in frames, so they stay put while seconds change
+    osj->hardware_latency = osj->hardware_latency * outstream->sample_rate / (double)nframes;
+    outstream->sample_rate = nframes;
+    outstream->software_latency = osj->period_size / (double)nframes;
+
+    outstream->period_changed_callback(outstream);
 }
 
 static inline jack_nframes_t nframes_max(jack_nframes_t a, jack_nframes_t b) {
@@ -441,56 +612,27 @@ static enum SoundIoError outstream_open_jack(struct SoundIoPrivate *si, struct S
 
     outstream->software_latency = device->software_latency_current;
     osj->period_size = sij->period_size;
-
-    jack_status_t status;
-    osj->client = jack_client_open(outstream->name, JackNoStartServer, &status);
-    if (!osj->client) {
-        outstream_destroy_jack(si, os);
-        assert(!(status & JackInvalidOption));
-        if (status & JackShmFailure)
-            return SoundIoErrorSystemResources;
-        if (status & JackNoSuchClient)
-            return SoundIoErrorNoSuchClient;
-        return SoundIoErrorOpeningDevice;
-    }
-
-    enum SoundIoError err;
-    if ((err = jack_set_process_callback(osj->client, outstream_process_callback, os))) {
-        outstream_destroy_jack(si, os);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_buffer_size_callback(osj->client, outstream_buffer_size_callback, os))) {
+    osj->server_period_size = sij->period_size;
+
+    unsigned long flags = JackPortIsOutput;
+    if (!outstream->non_terminal_hint)
+        flags |= JackPortIsTerminal;
+    jack_port_t *jports[SOUNDIO_MAX_CHANNELS] = {0};
+    enum SoundIoError err = register_ports(sij, outstream->name, &outstream->layout, flags, jports);
+    for (int ch = 0; ch < outstream->layout.channel_count; ch += 1)
+        osj->ports[ch].source_port = jports[ch];
+    if (err) {
         outstream_destroy_jack(si, os);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_sample_rate_callback(osj->client, outstream_sample_rate_callback, os))) {
-        outstream_destroy_jack(si, os);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_xrun_callback(osj->client, outstream_xrun_callback, os))) {
-        outstream_destroy_jack(si, os);
-        return SoundIoErrorOpeningDevice;
+        return err;
     }
-    jack_on_shutdown(osj->client, outstream_shutdown_callback, os);
-
 
     jack_nframes_t max_port_latency = 0;
 
-    // register ports and map channels
+    // map channels
     int connected_count = 0;
     for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
         enum SoundIoChannelId my_channel_id = outstream->layout.channels[ch];
-        const char *channel_name = soundio_get_channel_name(my_channel_id);
-        unsigned long flags = JackPortIsOutput;
-        if (!outstream->non_terminal_hint)
-            flags |= JackPortIsTerminal;
-        jack_port_t *jport = jack_port_register(osj->client, channel_name, JACK_DEFAULT_AUDIO_TYPE, flags, 0);
-        if (!jport) {
-            outstream_destroy_jack(si, os);
-            return SoundIoErrorOpeningDevice;
-        }
         struct SoundIoOutStreamJackPort *osjp = &osj->ports[ch];
-        osjp->source_port = jport;
         // figure out which dest port this connects to
         struct SoundIoDeviceJackPort *djp = find_port_matching_channel(device, my_channel_id);
         if (djp) {
@@ -518,30 +660,35 @@ static enum SoundIoError outstream_open_jack(struct SoundIoPrivate *si, struct S
 
     osj->hardware_latency = max_port_latency / (double)outstream->sample_rate;
 
+    if ((err = acquire_slot(sij, false, os, &osj->slot))) {
+        outstream_destroy_jack(si, os);
+        return err;
+    }
+
     return 0;
 }
 
 static enum SoundIoError outstream_pause_jack(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os, bool pause) {
     struct SoundIoJack *sij = &si->backend_data.jack;
+    struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
 
     if (sij->is_shutdown)
         return SoundIoErrorBackendDisconnected;
 
-    return SoundIoErrorIncompatibleBackend;
+    SOUNDIO_ATOMIC_STORE(osj->slot->running, !pause);
+    return 0;
 }
 
 static enum SoundIoError outstream_start_jack(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
     struct SoundIoOutStream *outstream = &os->pub;
     struct SoundIoJack *sij = &si->backend_data.jack;
-    enum SoundIoError err;
 
     if (sij->is_shutdown)
         return SoundIoErrorBackendDisconnected;
 
-    if ((err = jack_activate(osj->client)))
-        return SoundIoErrorStreaming;
-
+    // The client is already active. Make every connection before the stream
+    // joins the process callback so that its first period reaches all ports.
     if (!outstream->unconnected) {
         for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
             struct SoundIoOutStreamJackPort *osjp = &osj->ports[ch];
@@ -550,11 +697,12 @@ static enum SoundIoError outstream_start_jack(struct SoundIoPrivate *si, struct
             if (!dest_port_name)
                 continue;
             const char *source_port_name = jack_port_name(osjp->source_port);
-            if ((err = jack_connect(osj->client, source_port_name, dest_port_name)))
+            if (jack_connect(sij->client, source_port_name, dest_port_name))
                 return SoundIoErrorStreaming;
         }
     }
 
+    SOUNDIO_ATOMIC_STORE(osj->slot->running, true);
     return 0;
 }
 
@@ -584,68 +732,128 @@ static enum SoundIoError outstream_clear_buffer_jack(struct SoundIoPrivate *si,
 static enum SoundIoError outstream_get_latency_jack(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os,
         double *out_latency)
 {
+    struct SoundIoOutStream *outstream = &os->pub;
     struct SoundIoOutStreamJack *osj = &os->backend_data.jack;
     *out_latency = osj->hardware_latency;
+    if (osj->reblocking) {
+        int queued_frames = soundio_ring_buffer_fill_count(&osj->reblock_buffer) / outstream->bytes_per_frame;
+        *out_latency += queued_frames / (double)outstream->sample_rate;
+    }
     return 0;
 }
 
 
 static void instream_destroy_jack(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
+    struct SoundIoJack *sij = &si->backend_data.jack;
     struct SoundIoInStreamJack *isj = &is->backend_data.jack;
 
-    jack_client_close(isj->client);
-    isj->client = NULL;
-}
+    if (isj->slot) {
+        release_slot(sij, isj->slot);
+        isj->slot = NULL;
+    }
 
-static int instream_xrun_callback(void *arg) {
-    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
-    struct SoundIoInStream *instream = &is->pub;
-    instream->overflow_callback(instream);
-    return 0;
+    for (int ch = 0; ch < SOUNDIO_MAX_CHANNELS; ch += 1) {
+        struct SoundIoInStreamJackPort *isjp = &isj->ports[ch];
+        if (isjp->dest_port) {
+            jack_port_unregister(sij->client, isjp->dest_port);
+            isjp->dest_port = NULL;
+        }
+    }
+
+    if (isj->reblocking) {
+        soundio_ring_buffer_deinit(&isj->reblock_buffer);
+        isj->reblocking = false;
+    }
 }
 
-static int instream_buffer_size_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
+static int instream_buffer_size_changed(struct SoundIoInStreamPrivate *is, jack_nframes_t nframes) {
     struct SoundIoInStreamJack *isj = &is->backend_data.jack;
     struct SoundIoInStream *instream = &is->pub;
-
-    if ((jack_nframes_t)isj->period_size == nframes) {
+    if ((jack_nframes_t)isj->server_period_size == nframes)
         return 0;
+    isj->server_period_size = nframes;
+
+    if (instream->keep_period) {
+        // a partial period captured at the old size is dropped
+        if (isj->reblocking) {
+            soundio_ring_buffer_deinit(&isj->reblock_buffer);
+            isj->reblocking = false;
+        }
+        if ((jack_nframes_t)isj->period_size != nframes) {
+            int capacity = (nframes + isj->period_size) * instream->bytes_per_frame;
+            if (soundio_ring_buffer_init(&isj->reblock_buffer, capacity)) {
+                instream->error_callback(instream, SoundIoErrorStreaming);
+                return -1;
+            }
+            isj->reblocking = true;
+        }
     } else {
-        instream->error_callback(instream, SoundIoErrorStreaming);
-        return -1;
+        isj->period_size = nframes;
+        instream->software_latency = nframes / (double)instream->sample_rate;
     }
+
+    instream->period_changed_callback(instream);
+    return 0;
 }
 
-static int instream_sample_rate_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
+static void instream_sample_rate_changed(struct SoundIoInStreamPrivate *is, jack_nframes_t nframes) {
+    struct SoundIoInStreamJack *isj = &is->backend_data.jack;
     struct SoundIoInStream *instream = &is->pub;
-    if (nframes == (jack_nframes_t)instream->sample_rate) {
-        return 0;
-    } else {
-        instream->error_callback(instream, SoundIoErrorStreaming);
-        return -1;
-    }
+    if (nframes == (jack_nframes_t)instream->sample_rate)
+        return;
+
+    isj->hardware_latency = isj->hardware_latency * instream->sample_rate / (double)nframes;
+    instream->sample_rate = nframes;
+    instream->software_latency = isj->period_size / (double)nframes;
+
+    instream->period_changed_callback(instream);
 }
 
-static void instream_shutdown_callback(void *arg) {
-    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
+// Interleaves nframes from the ports into the buffer, then calls the read
+// callback once for every whole period in it.
+static void instream_read_reblocked(struct SoundIoInStreamPrivate *is, jack_nframes_t nframes) {
     struct SoundIoInStream *instream = &is->pub;
-    instream->error_callback(instream, SoundIoErrorStreaming);
+    struct SoundIoInStreamJack *isj = &is->backend_data.jack;
+    struct SoundIoRingBuffer *rb = &isj->reblock_buffer;
+    int channel_count = instream->layout.channel_count;
+    int period_bytes = isj->period_size * instream->bytes_per_frame;
+
+    float *frames = (float *)soundio_ring_buffer_write_ptr(rb);
+    for (int ch = 0; ch < channel_count; ch += 1) {
+        const float *port_buf = (const float *)jack_port_get_buffer(isj->ports[ch].dest_port, nframes);
+        for (jack_nframes_t i = 0; i < nframes; i += 1)
+            frames[i * channel_count + ch] = port_buf[i];
+    }
+    soundio_ring_buffer_advance_write_ptr(rb, nframes * instream->bytes_per_frame);
+
+    while (soundio_ring_buffer_fill_count(rb) >= period_bytes) {
+        char *read_ptr = soundio_ring_buffer_read_ptr(rb);
+        for (int ch = 0; ch < channel_count; ch += 1) {
+            isj->areas[ch].ptr = read_ptr + instream->bytes_per_sample * ch;
+            isj->areas[ch].step = instream->bytes_per_frame;
+        }
+        isj->frames_left = isj->period_size;
+        soundio_instream_invoke_read(instream, isj->frames_left, isj->frames_left);
+        soundio_ring_buffer_advance_read_ptr(rb, period_bytes);
+    }
 }
 
-static int instream_process_callback(jack_nframes_t nframes, void *arg) {
-    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
+static void instream_process(struct SoundIoInStreamPrivate *is, jack_client_t *client, jack_nframes_t nframes) {
     struct SoundIoInStream *instream = &is->pub;
     struct SoundIoInStreamJack *isj = &is->backend_data.jack;
+    soundio_instream_record_wakeup(instream,
+            jack_frames_since_cycle_start(client) / (double)instream->sample_rate);
+    if (isj->reblocking) {
+        instream_read_reblocked(is, nframes);
+        return;
+    }
     isj->frames_left = nframes;
     for (int ch = 0; ch < instream->layout.channel_count; ch += 1) {
         struct SoundIoInStreamJackPort *isjp = &isj->ports[ch];
         isj->areas[ch].ptr = (char*)jack_port_get_buffer(isjp->dest_port, nframes);
         isj->areas[ch].step = instream->bytes_per_sample;
     }
-    instream->read_callback(instream, isj->frames_left, isj->frames_left);
-    return 0;
+    soundio_instream_invoke_read(instream, isj->frames_left, isj->frames_left);
 }
 
 static enum SoundIoError instream_open_jack(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
@@ -664,55 +872,27 @@ static enum SoundIoError instream_open_jack(struct SoundIoPrivate *si, struct So
 
     instream->software_latency = device->software_latency_current;
     isj->period_size = sij->period_size;
-
-    jack_status_t status;
-    isj->client = jack_client_open(instream->name, JackNoStartServer, &status);
-    if (!isj->client) {
-        instream_destroy_jack(si, is);
-        assert(!(status & JackInvalidOption));
-        if (status & JackShmFailure)
-            return SoundIoErrorSystemResources;
-        if (status & JackNoSuchClient)
-            return SoundIoErrorNoSuchClient;
-        return SoundIoErrorOpeningDevice;
-    }
-
-    enum SoundIoError err;
-    if ((err = jack_set_process_callback(isj->client, instream_process_callback, is))) {
-        instream_destroy_jack(si, is);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_buffer_size_callback(isj->client, instream_buffer_size_callback, is))) {
+    isj->server_period_size = sij->period_size;
+
+    unsigned long flags = JackPortIsInput;
+    if (!instream->non_terminal_hint)
+        flags |= JackPortIsTerminal;
+    jack_port_t *jports[SOUNDIO_MAX_CHANNELS] = {0};
+    enum SoundIoError err = register_ports(sij, instream->name, &instream->layout, flags, jports);
+    for (int ch = 0; ch < instream->layout.channel_count; ch += 1)
+        isj->ports[ch].dest_port = jports[ch];
+    if (err) {
         instream_destroy_jack(si, is);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_sample_rate_callback(isj->client, instream_sample_rate_callback, is))) {
-        instream_destroy_jack(si, is);
-        return SoundIoErrorOpeningDevice;
-    }
-    if ((err = jack_set_xrun_callback(isj->client, instream_xrun_callback, is))) {
-        instream_destroy_jack(si, is);
-        return SoundIoErrorOpeningDevice;
+        return err;
     }
-    jack_on_shutdown(isj->client, instream_shutdown_callback, is);
 
     jack_nframes_t max_port_latency = 0;
 
-    // register ports and map channels
+    // map channels
     int connected_count = 0;
     for (int ch = 0; ch < instream->layout.channel_count; ch += 1) {
         enum SoundIoChannelId my_channel_id = instream->layout.channels[ch];
-        const char *channel_name = soundio_get_channel_name(my_channel_id);
-        unsigned long flags = JackPortIsInput;
-        if (!instream->non_terminal_hint)
-            flags |= JackPortIsTerminal;
-        jack_port_t *jport = jack_port_register(isj->client, channel_name, JACK_DEFAULT_AUDIO_TYPE, flags, 0);
-        if (!jport) {
-            instream_destroy_jack(si, is);
-            return SoundIoErrorOpeningDevice;
-        }
         struct SoundIoInStreamJackPort *isjp = &isj->ports[ch];
-        isjp->dest_port = jport;
         // figure out which source port this connects to
         struct SoundIoDeviceJackPort *djp = find_port_matching_channel(device, my_channel_id);
         if (djp) {
@@ -740,30 +920,33 @@ static enum SoundIoError instream_open_jack(struct SoundIoPrivate *si, struct So
 
     isj->hardware_latency = max_port_latency / (double)instream->sample_rate;
 
+    if ((err = acquire_slot(sij, true, is, &isj->slot))) {
+        instream_destroy_jack(si, is);
+        return err;
+    }
+
     return 0;
 }
 
 static enum SoundIoError instream_pause_jack(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is, bool pause) {
     struct SoundIoJack *sij = &si->backend_data.jack;
+    struct SoundIoInStreamJack *isj = &is->backend_data.jack;
 
     if (sij->is_shutdown)
         return SoundIoErrorBackendDisconnected;
 
-    return SoundIoErrorIncompatibleBackend;
+    SOUNDIO_ATOMIC_STORE(isj->slot->running, !pause);
+    return 0;
 }
 
 static enum SoundIoError instream_start_jack(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
     struct SoundIoInStreamJack *isj = &is->backend_data.jack;
     struct SoundIoInStream *instream = &is->pub;
     struct SoundIoJack *sij = &si->backend_data.jack;
-    enum SoundIoError err;
 
     if (sij->is_shutdown)
         return SoundIoErrorBackendDisconnected;
 
-    if ((err = jack_activate(isj->client)))
-        return SoundIoErrorStreaming;
-
     if (!instream->unconnected) {
         for (int ch = 0; ch < instream->layout.channel_count; ch += 1) {
             struct SoundIoInStreamJackPort *isjp = &isj->ports[ch];
@@ -772,11 +955,12 @@ static enum SoundIoError instream_start_jack(struct SoundIoPrivate *si, struct S
             if (!source_port_name)
                 continue;
             const char *dest_port_name = jack_port_name(isjp->dest_port);
-            if ((err = jack_connect(isj->client, source_port_name, dest_port_name)))
+            if (jack_connect(sij->client, source_port_name, dest_port_name))
                 return SoundIoErrorStreaming;
         }
     }
 
+    SOUNDIO_ATOMIC_STORE(isj->slot->running, true);
     return 0;
 }
 
@@ -802,8 +986,61 @@ static enum SoundIoError instream_end_read_jack(struct SoundIoPrivate *si, struc
 static enum SoundIoError instream_get_latency_jack(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is,
         double *out_latency)
 {
+    struct SoundIoInStream *instream = &is->pub;
     struct SoundIoInStreamJack *isj = &is->backend_data.jack;
     *out_latency = isj->hardware_latency;
+    if (isj->reblocking) {
+        int held_frames = soundio_ring_buffer_fill_count(&isj->reblock_buffer) / instream->bytes_per_frame;
+        *out_latency += held_frames / (double)instream->sample_rate;
+    }
+    return 0;
+}
+
+// The one process callback of the shared client. Every open stream is served
+// from here, so the graph schedules a single client however many streams exist.
+static int process_callback(jack_nframes_t nframes, void *arg) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
+    struct SoundIoJack *sij = &si->backend_data.jack;
+    SOUNDIO_ATOMIC_STORE(sij->process_busy, true);
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    for (int i = 0; i < slot_count; i += 1) {
+        struct SoundIoJackStreamSlot *slot = &sij->slots[i];
+        if (!SOUNDIO_ATOMIC_LOAD(slot->in_use))
+            continue;
+        bool running = SOUNDIO_ATOMIC_LOAD(slot->running);
+        if (slot->is_input) {
+            if (running)
+                instream_process((struct SoundIoInStreamPrivate *)slot->stream, sij->client, nframes);
+        } else {
+            struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)slot->stream;
+            if (running)
+                outstream_process(os, sij->client, nframes);
+            else
+                outstream_silence(os, nframes);
+        }
+    }
+    SOUNDIO_ATOMIC_STORE(sij->process_busy, false);
+    return 0;
+}
+
+static int xrun_callback(void *arg) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
+    struct SoundIoJack *sij = &si->backend_data.jack;
+    soundio_os_mutex_lock(sij->stream_mutex);
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    for (int i = 0; i < slot_count; i += 1) {
+        struct SoundIoJackStreamSlot *slot = &sij->slots[i];
+        if (!SOUNDIO_ATOMIC_LOAD(slot->in_use) || !SOUNDIO_ATOMIC_LOAD(slot->running))
+            continue;
+        if (slot->is_input) {
+            struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)slot->stream;
+            soundio_instream_invoke_overflow(&is->pub);
+        } else {
+            struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)slot->stream;
+            soundio_outstream_invoke_underflow(&os->pub);
+        }
+    }
+    soundio_os_mutex_unlock(sij->stream_mutex);
     return 0;
 }
 
@@ -813,7 +1050,7 @@ static void notify_devices_change(struct SoundIoPrivate *si) {
     SOUNDIO_ATOMIC_FLAG_CLEAR(sij->refresh_devices_flag);
     soundio_os_mutex_lock(sij->mutex);
     soundio_os_cond_signal(sij->cond, sij->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(sij->mutex);
 }
 
@@ -821,14 +1058,44 @@ static int buffer_size_callback(jack_nframes_t nframes, void *arg) {
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
     struct SoundIoJack *sij = &si->backend_data.jack;
     sij->period_size = nframes;
+
+    int result = 0;
+    soundio_os_mutex_lock(sij->stream_mutex);
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    for (int i = 0; i < slot_count; i += 1) {
+        struct SoundIoJackStreamSlot *slot = &sij->slots[i];
+        if (!SOUNDIO_ATOMIC_LOAD(slot->in_use))
+            continue;
+        int err = slot->is_input ?
+            instream_buffer_size_changed((struct SoundIoInStreamPrivate *)slot->stream, nframes) :
+            outstream_buffer_size_changed((struct SoundIoOutStreamPrivate *)slot->stream, nframes);
+        if (err)
+            result = err;
+    }
+    soundio_os_mutex_unlock(sij->stream_mutex);
+
     notify_devices_change(si);
-    return 0;
+    return result;
 }
 
 static int sample_rate_callback(jack_nframes_t nframes, void *arg) {
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
     struct SoundIoJack *sij = &si->backend_data.jack;
     sij->sample_rate = nframes;
+
+    soundio_os_mutex_lock(sij->stream_mutex);
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    for (int i = 0; i < slot_count; i += 1) {
+        struct SoundIoJackStreamSlot *slot = &sij->slots[i];
+        if (!SOUNDIO_ATOMIC_LOAD(slot->in_use))
+            continue;
+        if (slot->is_input)
+            instream_sample_rate_changed((struct SoundIoInStreamPrivate *)slot->stream, nframes);
+        else
+            outstream_sample_rate_changed((struct SoundIoOutStreamPrivate *)slot->stream, nframes);
+    }
+    soundio_os_mutex_unlock(sij->stream_mutex);
+
     notify_devices_change(si);
     return 0;
 }
@@ -849,10 +1116,27 @@ static void shutdown_callback(void *arg) {
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)arg;
     struct SoundIo *soundio = &si->pub;
     struct SoundIoJack *sij = &si->backend_data.jack;
+
+    // Every stream lived on this client. The stream mutex is not taken here
+    // because JACK may call this from inside the process thread.
+    int slot_count = SOUNDIO_ATOMIC_LOAD(sij->slot_count);
+    for (int i = 0; i < slot_count; i += 1) {
+        struct SoundIoJackStreamSlot *slot = &sij->slots[i];
+        if (!SOUNDIO_ATOMIC_LOAD(slot->in_use))
+            continue;
+        if (slot->is_input) {
+            struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)slot->stream;
+            is->pub.error_callback(&is->pub, SoundIoErrorStreaming);
+        } else {
+            struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)slot->stream;
+            os->pub.error_callback(&os->pub, SoundIoErrorStreaming);
+        }
+    }
+
     soundio_os_mutex_lock(sij->mutex);
     sij->is_shutdown = true;
     soundio_os_cond_signal(sij->cond, sij->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(sij->mutex);
 }
 
@@ -867,6 +1151,9 @@ static void destroy_jack(struct SoundIoPrivate *si) {
 
     if (sij->mutex)
         soundio_os_mutex_destroy(sij->mutex);
+
+    if (sij->stream_mutex)
+        soundio_os_mutex_destroy(sij->stream_mutex);
 }
 
 enum SoundIoError soundio_jack_init(struct SoundIoPrivate *si) {
@@ -893,6 +1180,12 @@ enum SoundIoError soundio_jack_init(struct SoundIoPrivate *si) {
         return SoundIoErrorNoMem;
     }
 
+    sij->stream_mutex = soundio_os_mutex_create();
+    if (!sij->stream_mutex) {
+        destroy_jack(si);
+        return SoundIoErrorNoMem;
+    }
+
     // We pass JackNoStartServer due to
     // https://github.com/jackaudio/jack2/issues/138
     jack_status_t status;
@@ -909,6 +1202,14 @@ enum SoundIoError soundio_jack_init(struct SoundIoPrivate *si) {
     }
 
     int err;
+    if ((err = jack_set_process_callback(sij->client, process_callback, si))) {
+        destroy_jack(si);
+        return SoundIoErrorInitAudioBackend;
+    }
+    if ((err = jack_set_xrun_callback(sij->client, xrun_callback, si))) {
+        destroy_jack(si);
+        return SoundIoErrorInitAudioBackend;
+    }
     if ((err = jack_set_buffer_size_callback(sij->client, buffer_size_callback, si))) {
         destroy_jack(si);
         return SoundIoErrorInitAudioBackend;
@@ -964,5 +1265,8 @@ enum SoundIoError soundio_jack_init(struct SoundIoPrivate *si) {
     si->instream_pause = instream_pause_jack;
     si->instream_get_latency = instream_get_latency_jack;
 
+    // the first flush delivers the device list scanned above
+    soundio_emit_events_signal(soundio);
+
     return 0;
 }
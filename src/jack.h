@@ -11,6 +11,7 @@
 #include "soundio_internal.h"
 #include "os.h"
 #include "atomics.h"
+#include "ring_buffer.h"
 
 // jack.h does not properly put `void` in function prototypes with no
 // arguments, so we're forced to temporarily disable -Werror=strict-prototypes
@@ -34,6 +35,17 @@ struct SoundIoDeviceJack {
     struct SoundIoDeviceJackPort *ports;
 };
 
+// Streams are served by the process callback of the one shared client.
+#define SOUNDIO_JACK_MAX_STREAMS 256
+
+struct SoundIoJackStreamSlot {
+    struct SoundIoAtomicBool in_use;
+    struct SoundIoAtomicBool running;
+    bool is_input;
+    // SoundIoOutStreamPrivate or SoundIoInStreamPrivate
+    void *stream;
+};
+
 struct SoundIoJack {
     jack_client_t *client;
     struct SoundIoOsMutex *mutex;
@@ -43,6 +55,14 @@ struct SoundIoJack {
     int period_size;
     bool is_shutdown;
     bool emitted_shutdown_cb;
+
+    // taken to add or remove streams and by the notification callbacks; the
+    // process callback never takes it
+    struct SoundIoOsMutex *stream_mutex;
+    struct SoundIoAtomicInt slot_count;
+    // set for the duration of every process cycle
+    struct SoundIoAtomicBool process_busy;
+    struct SoundIoJackStreamSlot slots[SOUNDIO_JACK_MAX_STREAMS];
 };
 
 struct SoundIoOutStreamJackPort {
@@ -52,10 +72,17 @@ struct SoundIoOutStreamJackPort {
 };
 
 struct SoundIoOutStreamJack {
-    jack_client_t *client;
+    struct SoundIoJackStreamSlot *slot;
+    // the period the write callback is called with
     int period_size;
+    // the period the server runs at. differs from period_size only while
+    // re-blocking for SoundIoOutStream::keep_period
+    int server_period_size;
     int frames_left;
     double hardware_latency;
+    bool reblocking;
+    // interleaved frames the write callback produced ahead of the server
+    struct SoundIoRingBuffer reblock_buffer;
     struct SoundIoOutStreamJackPort ports[SOUNDIO_MAX_CHANNELS];
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
 };
@@ -67,10 +94,15 @@ struct SoundIoInStreamJackPort {
 };
 
 struct SoundIoInStreamJack {
-    jack_client_t *client;
+    struct SoundIoJackStreamSlot *slot;
+    // see SoundIoOutStreamJack
     int period_size;
+    int server_period_size;
     int frames_left;
     double hardware_latency;
+    bool reblocking;
+    // interleaved frames captured but not yet handed to the read callback
+    struct SoundIoRingBuffer reblock_buffer;
     struct SoundIoInStreamJackPort ports[SOUNDIO_MAX_CHANNELS];
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
     char *buf_ptrs[SOUNDIO_MAX_CHANNELS];
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "meter.h"
+#include "convert.h"
+#include "atomics.h"
+#include "util.h"
+
+#include <math.h>
+
+// Samples are converted to planar float in chunks of this many frames and
+// measured from there.
+#define METER_CHUNK_FRAMES 256
+// Levels are published once per 100 ms block, the step of EBU R128
+// momentary and short-term loudness.
+#define METER_BLOCKS_PER_SECOND 10
+#define MOMENTARY_BLOCKS 4
+#define SHORT_TERM_BLOCKS 30
+// ITU-R BS.1770 true peak: 4x oversampling through a polyphase FIR.
+#define TRUE_PEAK_PHASES 4
+#define TRUE_PEAK_TAPS 12
+
+static const double METER_PI = 3.14159265358979323846;
+
+struct Biquad {
+    double b0, b1, b2, a1, a2;
+};
+
+struct MeterChannelState {
+    float peak;
+    float true_peak;
+    double sum_squares;
+    double weighted_sum_squares;
+    // transposed direct form II state of the two K-weighting stages
+    double z[2][2];
+    // newest first
+    float history[TRUE_PEAK_TAPS];
+};
+
+struct MeterPublished {
+    struct SoundIoMeterChannel channels[SOUNDIO_MAX_CHANNELS];
+    double momentary_energy;
+    double short_term_energy;
+    long block_count;
+};
+
+struct SoundIoMeter {
+    int channel_count;
+    int block_frames;
+    struct SoundIoConvertKernels kernels;
+    struct Biquad k_weighting[2];
+    float true_peak_taps[TRUE_PEAK_PHASES][TRUE_PEAK_TAPS];
+    float channel_weights[SOUNDIO_MAX_CHANNELS];
+
+    // only touched by the stream thread
+    int block_frame_count;
+    struct MeterChannelState channels[SOUNDIO_MAX_CHANNELS];
+    double block_energies[SHORT_TERM_BLOCKS];
+    long block_count;
+    float *scratch;
+    struct SoundIoChannelArea scratch_areas[SOUNDIO_MAX_CHANNELS];
+
+    // Sequence lock: odd while the stream thread updates `published`.
+    struct SoundIoAtomicInt seq;
+    struct MeterPublished published;
+};
+
+// BS.1770 channel weights: surrounds count 1.41 times, LFE not at all.
+static float channel_weight(enum SoundIoChannelId id) {
+    switch (id) {
+    case SoundIoChannelIdLfe:
+    case SoundIoChannelIdLfe2:
+    case SoundIoChannelIdLeftLfe:
+    case SoundIoChannelIdRightLfe:
+        return 0.0f;
+    case SoundIoChannelIdBackLeft:
+    case SoundIoChannelIdBackRight:
+    case SoundIoChannelIdSideLeft:
+    case SoundIoChannelIdSideRight:
+        return 1.41f;
+    default:
+        return 1.0f;
+    }
+}
+
+// The K-weighting pre-filter and RLB high pass of BS.1770, derived for any
+// sample rate from their analog prototypes.
+static void init_k_weighting(struct Biquad *stages, int sample_rate) {
+    double f0 = 1681.974450955533;
+    double gain_db = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(METER_PI * f0 / sample_rate);
+    double vh = pow(10.0, gain_db / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    stages[0].b0 = (vh + vb * k / q + k * k) / a0;
+    stages[0].b1 = 2.0 * (k * k - vh) / a0;
+    stages[0].b2 = (vh - vb * k / q + k * k) / a0;
+    stages[0].a1 = 2.0 * (k * k - 1.0) / a0;
+    stages[0].a2 = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(METER_PI * f0 / sample_rate);
+    a0 = 1.0 + k / q + k * k;
+    stages[1].b0 = 1.0;
+    stages[1].b1 = -2.0;
+    stages[1].b2 = 1.0;
+    stages[1].a1 = 2.0 * (k * k - 1.0) / a0;
+    stages[1].a2 = (1.0 - k / q + k * k) / a0;
+}
+
+// Hann windowed sinc interpolator, split into phases.
+static void init_true_peak(struct SoundIoMeter *meter) {
+    int tap_count = TRUE_PEAK_PHASES * TRUE_PEAK_TAPS;
+    double center = (tap_count - 1) / 2.0;
+    for (int n = 0; n < tap_count; n += 1) {
+        double t = (n - center) / TRUE_PEAK_PHASES;
+        double sinc = (t == 0.0) ? 1.0 : sin(METER_PI * t) / (METER_PI * t);
+        double window = 0.5 - 0.5 * cos(2.0 * METER_PI * (n + 0.5) / tap_count);
+        meter->true_peak_taps[n % TRUE_PEAK_PHASES][n / TRUE_PEAK_PHASES] = (float)(sinc * window);
+    }
+}
+
+enum SoundIoError soundio_meter_create(enum SoundIoFormat format, const struct SoundIoChannelLayout *layout,
+        int sample_rate, struct SoundIoMeter **out_meter)
+{
+    *out_meter = NULL;
+    if (sample_rate <= 0)
+        return SoundIoErrorInvalid;
+
+    struct SoundIoConvertKernels kernels;
+    enum SoundIoError err;
+    if ((err = soundio_convert_select(&kernels, format, SoundIoFormatFloat32NE, layout->channel_count)))
+        return err;
+
+    struct SoundIoMeter *meter = ALLOCATE(struct SoundIoMeter, 1);
+    if (!meter)
+        return SoundIoErrorNoMem;
+    meter->scratch = ALLOCATE(float, layout->channel_count * METER_CHUNK_FRAMES);
+    if (!meter->scratch) {
+        soundio_meter_destroy(meter);
+        return SoundIoErrorNoMem;
+    }
+
+    meter->channel_count = layout->channel_count;
+    meter->block_frames = soundio_int_max(1, sample_rate / METER_BLOCKS_PER_SECOND);
+    meter->kernels = kernels;
+    init_k_weighting(meter->k_weighting, sample_rate);
+    init_true_peak(meter);
+    for (int ch = 0; ch < layout->channel_count; ch += 1) {
+        meter->channel_weights[ch] = channel_weight(layout->channels[ch]);
+        meter->scratch_areas[ch].ptr = (char *)&meter->scratch[ch * METER_CHUNK_FRAMES];
+        meter->scratch_areas[ch].step = sizeof(float);
+    }
+
+    *out_meter = meter;
+    return SoundIoErrorNone;
+}
+
+void soundio_meter_destroy(struct SoundIoMeter *meter) {
+    if (!meter)
+        return;
+    free(meter->scratch);
+    free(meter);
+}
+
+static void measure_channel(struct SoundIoMeter *meter, struct MeterChannelState *state,
+        const float *samples, int frame_count)
+{
+    const struct Biquad *s0 = &meter->k_weighting[0];
+    const struct Biquad *s1 = &meter->k_weighting[1];
+
+    float peak = state->peak;
+    double sum_squares = 0.0;
+    for (int i = 0; i < frame_count; i += 1) {
+        float x = samples[i];
+        float magnitude = (x < 0.0f) ? -x : x;
+        peak = (magnitude > peak) ? magnitude : peak;
+        sum_squares += (double)x * x;
+    }
+    state->peak = peak;
+    state->sum_squares += sum_squares;
+
+    double z00 = state->z[0][0], z01 = state->z[0][1];
+    double z10 = state->z[1][0], z11 = state->z[1][1];
+    double weighted = 0.0;
+    for (int i = 0; i < frame_count; i += 1) {
+        double x = samples[i];
+        double y = s0->b0 * x + z00;
+        z00 = s0->b1 * x - s0->a1 * y + z01;
+        z01 = s0->b2 * x - s0->a2 * y;
+        x = y;
+        y = s1->b0 * x + z10;
+        z10 = s1->b1 * x - s1->a1 * y + z11;
+        z11 = s1->b2 * x - s1->a2 * y;
+        weighted += y * y;
+    }
+    state->z[0][0] = z00;
+    state->z[0][1] = z01;
+    state->z[1][0] = z10;
+    state->z[1][1] = z11;
+    state->weighted_sum_squares += weighted;
+
+    float true_peak = state->true_peak;
+    float *history = state->history;
+    for (int i = 0; i < frame_count; i += 1) {
+        for (int k = TRUE_PEAK_TAPS - 1; k > 0; k -= 1)
+            history[k] = history[k - 1];
+        history[0] = samples[i];
+        for (int phase = 0; phase < TRUE_PEAK_PHASES; phase += 1) {
+            const float *taps = meter->true_peak_taps[phase];
+            float y = 0.0f;
+            for (int k = 0; k < TRUE_PEAK_TAPS; k += 1)
+                y += taps[k] * history[k];
+            float magnitude = (y < 0.0f) ? -y : y;
+            true_peak = (magnitude > true_peak) ? magnitude : true_peak;
+        }
+    }
+    state->true_peak = true_peak;
+}
+
+static double mean_energy(const struct SoundIoMeter *meter, int block_count) {
+    long available = (meter->block_count < block_count) ? meter->block_count : block_count;
+    double sum = 0.0;
+    for (long i = 0; i < available; i += 1)
+        sum += meter->block_energies[(meter->block_count - 1 - i) % SHORT_TERM_BLOCKS];
+    return sum / available;
+}
+
+static void finish_block(struct SoundIoMeter *meter) {
+    double energy = 0.0;
+    for (int ch = 0; ch < meter->channel_count; ch += 1) {
+        struct MeterChannelState *state = &meter->channels[ch];
+        energy += meter->channel_weights[ch] * state->weighted_sum_squares / meter->block_frame_count;
+    }
+    meter->block_energies[meter->block_count % SHORT_TERM_BLOCKS] = energy;
+    meter->block_count += 1;
+
+    SOUNDIO_ATOMIC_FETCH_ADD(meter->seq, 1);
+    SOUNDIO_ATOMIC_THREAD_FENCE();
+    struct MeterPublished *published = &meter->published;
+    for (int ch = 0; ch < meter->channel_count; ch += 1) {
+        struct MeterChannelState *state = &meter->channels[ch];
+        published->channels[ch].peak = state->peak;
+        published->channels[ch].rms = (float)sqrt(state->sum_squares / meter->block_frame_count);
+        // interpolation can undershoot a lone sample at full scale
+        published->channels[ch].true_peak = (state->true_peak > state->peak) ? state->true_peak : state->peak;
+        state->peak = 0.0f;
+        state->true_peak = 0.0f;
+        state->sum_squares = 0.0;
+        state->weighted_sum_squares = 0.0;
+    }
+    published->momentary_energy = mean_energy(meter, MOMENTARY_BLOCKS);
+    published->short_term_energy = mean_energy(meter, SHORT_TERM_BLOCKS);
+    published->block_count = meter->block_count;
+    SOUNDIO_ATOMIC_THREAD_FENCE();
+    SOUNDIO_ATOMIC_FETCH_ADD(meter->seq, 1);
+
+    meter->block_frame_count = 0;
+}
+
+void soundio_meter_process(struct SoundIoMeter *meter, const struct SoundIoChannelArea *areas,
+        int frame_count)
+{
+    struct SoundIoChannelArea chunk_areas[SOUNDIO_MAX_CHANNELS];
+    int done = 0;
+    while (done < frame_count) {
+        int chunk = soundio_int_min(frame_count - done, METER_CHUNK_FRAMES);
+        chunk = soundio_int_min(chunk, meter->block_frames - meter->block_frame_count);
+        for (int ch = 0; ch < meter->channel_count; ch += 1) {
+            chunk_areas[ch].ptr = areas[ch].ptr + done * areas[ch].step;
+            chunk_areas[ch].step = areas[ch].step;
+        }
+        soundio_convert_run(&meter->kernels, chunk_areas, meter->scratch_areas, chunk);
+        for (int ch = 0; ch < meter->channel_count; ch += 1)
+            measure_channel(meter, &meter->channels[ch], &meter->scratch[ch * METER_CHUNK_FRAMES], chunk);
+
+        meter->block_frame_count += chunk;
+        done += chunk;
+        if (meter->block_frame_count == meter->block_frames)
+            finish_block(meter);
+    }
+}
+
+static double energy_to_lufs(double energy) {
+    return -0.691 + 10.0 * log10(energy);
+}
+
+void soundio_meter_get_snapshot(struct SoundIoMeter *meter, struct SoundIoMeterSnapshot *out_snapshot) {
+    memset(out_snapshot, 0, sizeof(struct SoundIoMeterSnapshot));
+    if (!meter)
+        return;
+
+    struct MeterPublished published;
+    for (;;) {
+        int seq = SOUNDIO_ATOMIC_LOAD(meter->seq);
+        if (seq % 2 != 0)
+            continue;
+        SOUNDIO_ATOMIC_THREAD_FENCE();
+        memcpy(&published, &meter->published, sizeof(struct MeterPublished));
+        SOUNDIO_ATOMIC_THREAD_FENCE();
+        if (SOUNDIO_ATOMIC_LOAD(meter->seq) == seq)
+            break;
+    }
+
+    out_snapshot->channel_count = meter->channel_count;
+    memcpy(out_snapshot->channels, published.channels, sizeof(published.channels));
+    out_snapshot->block_count = published.block_count;
+    if (published.block_count > 0) {
+        out_snapshot->momentary_loudness = energy_to_lufs(published.momentary_energy);
+        out_snapshot->short_term_loudness = energy_to_lufs(published.short_term_energy);
+    } else {
+        out_snapshot->momentary_loudness = -HUGE_VAL;
+        out_snapshot->short_term_loudness = -HUGE_VAL;
+    }
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_METER_H
+#define SOUNDIO_METER_H
+
+#include "soundio_internal.h"
+
+struct SoundIoMeter;
+
+// Returns SoundIoErrorInvalid for formats the converter cannot read.
+enum SoundIoError soundio_meter_create(enum SoundIoFormat format, const struct SoundIoChannelLayout *layout,
+        int sample_rate, struct SoundIoMeter **out_meter);
+void soundio_meter_destroy(struct SoundIoMeter *meter);
+
+// Called by the stream thread with the frames passing through the stream.
+// Does not allocate or lock.
+void soundio_meter_process(struct SoundIoMeter *meter, const struct SoundIoChannelArea *areas,
+        int frame_count);
+
+// Any thread. Zeroes `out_snapshot` when `meter` is NULL.
+void soundio_meter_get_snapshot(struct SoundIoMeter *meter, struct SoundIoMeterSnapshot *out_snapshot);
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "mpsc_queue.h"
+#include "util.h"
+
+#include <string.h>
+
+enum SoundIoError soundio_mpsc_queue_init(struct SoundIoMpscQueue *queue, int item_size,
+        int requested_capacity)
+{
+    if (item_size <= 0 || requested_capacity <= 0 || requested_capacity > (1 << 24))
+        return SoundIoErrorInvalid;
+
+    int capacity = 1;
+    while (capacity < requested_capacity)
+        capacity *= 2;
+
+    queue->sequences = ALLOCATE(struct SoundIoAtomicInt64, capacity);
+    queue->items = ALLOCATE(char, (size_t)capacity * item_size);
+    if (!queue->sequences || !queue->items) {
+        soundio_mpsc_queue_deinit(queue);
+        return SoundIoErrorNoMem;
+    }
+
+    queue->item_size = item_size;
+    queue->mask = capacity - 1;
+    for (int i = 0; i < capacity; i += 1)
+        SOUNDIO_ATOMIC_STORE(queue->sequences[i], (int64_t)i);
+    SOUNDIO_ATOMIC_STORE(queue->write_pos, (int64_t)0);
+    queue->read_pos = 0;
+    return SoundIoErrorNone;
+}
+
+void soundio_mpsc_queue_deinit(struct SoundIoMpscQueue *queue) {
+    free(queue->sequences);
+    free(queue->items);
+    queue->sequences = NULL;
+    queue->items = NULL;
+}
+
+bool soundio_mpsc_queue_push(struct SoundIoMpscQueue *queue, const void *item) {
+    int64_t pos = SOUNDIO_ATOMIC_LOAD(queue->write_pos);
+    for (;;) {
+        int64_t seq = SOUNDIO_ATOMIC_LOAD(queue->sequences[pos & queue->mask]);
+        if (seq == pos) {
+            // on failure `pos` is reloaded with the current value
+            if (SOUNDIO_ATOMIC_COMPARE_EXCHANGE(queue->write_pos, &pos, pos + 1))
+                break;
+        } else if (seq < pos) {
+            // the consumer has not released this slot from the last lap
+            return false;
+        } else {
+            pos = SOUNDIO_ATOMIC_LOAD(queue->write_pos);
+        }
+    }
+    memcpy(queue->items + (pos & queue->mask) * queue->item_size, item, queue->item_size);
+    SOUNDIO_ATOMIC_STORE(queue->sequences[pos & queue->mask], pos + 1);
+    return true;
+}
+
+bool soundio_mpsc_queue_pop(struct SoundIoMpscQueue *queue, void *out_item) {
+    int64_t pos = queue->read_pos;
+    int64_t seq = SOUNDIO_ATOMIC_LOAD(queue->sequences[pos & queue->mask]);
+    if (seq != pos + 1)
+        return false;
+    memcpy(out_item, queue->items + (pos & queue->mask) * queue->item_size, queue->item_size);
+    SOUNDIO_ATOMIC_STORE(queue->sequences[pos & queue->mask], pos + queue->mask + 1);
+    queue->read_pos = pos + 1;
+    return true;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_MPSC_QUEUE_H
+#define SOUNDIO_MPSC_QUEUE_H
+
+#include "soundio_internal.h"
+#include "atomics.h"
+
+// Bounded queue of fixed size items. Any number of threads may push, one
+// thread at a time may pop. Neither side locks or allocates.
+//
+// Every slot carries a sequence number telling whose turn it is: a slot
+// at position `pos` may be filled when its sequence equals `pos` and read
+// when it equals `pos + 1`. Producers claim positions with a compare
+// exchange on `write_pos`.
+struct SoundIoMpscQueue {
+    struct SoundIoAtomicInt64 *sequences;
+    char *items;
+    int item_size;
+    int64_t mask;
+    struct SoundIoAtomicInt64 write_pos;
+    // only touched by the consumer
+    int64_t read_pos;
+};
+
+// The capacity is rounded up to a power of 2.
+enum SoundIoError soundio_mpsc_queue_init(struct SoundIoMpscQueue *queue, int item_size,
+        int requested_capacity);
+void soundio_mpsc_queue_deinit(struct SoundIoMpscQueue *queue);
+
+// Returns false when the queue is full.
+bool soundio_mpsc_queue_push(struct SoundIoMpscQueue *queue, const void *item);
+// Returns false when the queue is empty.
+bool soundio_mpsc_queue_pop(struct SoundIoMpscQueue *queue, void *out_item);
+
+#endif
@@ -15,12 +15,16 @@
 #include "os.h"
 #include "soundio_internal.h"
 #include "util.h"
+#include "atomics.h"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <time.h>
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
+#include <limits.h>
 
 #if defined(_WIN32)
 #define SOUNDIO_OS_WINDOWS
@@ -58,8 +62,12 @@
 #else
 
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
 #define MAP_ANONYMOUS MAP_ANON
 #endif
@@ -78,8 +86,45 @@
 #include <mach/mach.h>
 #endif
 
+#if defined(__linux__)
+#define SOUNDIO_OS_EVENTFD
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_sched_setattr)
+// glibc does not wrap sched_setattr
+#define SOUNDIO_OS_SCHED_DEADLINE
+#define SOUNDIO_SCHED_DEADLINE 6
+struct SoundIoSchedAttr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+#endif
+
+#if defined(__linux__) && defined(SYS_futex)
+#define SOUNDIO_OS_FUTEX
+#include <linux/futex.h>
+#endif
+
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_memfd_create)
+// glibc only wraps memfd_create since 2.27
+#define SOUNDIO_OS_MEMFD
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#endif
+
 #ifdef __ANDROID__
-#include <fcntl.h>
 #include <linux/ashmem.h>
 #include <sys/ioctl.h>
 #endif
@@ -94,9 +139,21 @@ struct SoundIoOsThread {
 
     pthread_t id;
     bool running;
+
+    // handshake with soundio_os_thread_create_with_attributes
+    pthread_mutex_t setup_mutex;
+    pthread_cond_t setup_cond;
+    bool setup_init;
+    bool setup_done;
+    bool rtprio_failed;
 #endif
     void *arg;
     void (*run)(void *arg);
+
+    // only valid until setup is done
+    const struct SoundIoThreadAttributes *attributes;
+    struct SoundIoThreadAttributes *actual;
+    double period;
 };
 
 struct SoundIoOsMutex {
@@ -131,6 +188,15 @@ struct SoundIoOsCond {
 };
 #endif
 
+struct SoundIoOsPollable {
+#if defined(SOUNDIO_OS_EVENTFD)
+    int fd;
+#elif !defined(SOUNDIO_OS_WINDOWS)
+    // [0] is the read end handed out to the caller, [1] the write end.
+    int pipe_fd[2];
+#endif
+};
+
 #if defined(SOUNDIO_OS_WINDOWS)
 static INIT_ONCE win32_init_once = INIT_ONCE_STATIC_INIT;
 static double win32_time_resolution;
@@ -145,6 +211,21 @@ static clock_serv_t cclock;
 
 static int page_size;
 
+// Mirrored regions built ahead of time by
+// soundio_os_mirrored_memory_pool_reserve. The pool owns every region it
+// built; soundio_os_deinit_mirrored_memory hands those back instead of
+// unmapping them.
+#define SOUNDIO_OS_MIRRORED_POOL_MAX 256
+struct SoundIoOsPoolRegion {
+    struct SoundIoOsMirroredMemory mem;
+    bool idle;
+};
+static struct SoundIoOsMutex *pool_mutex;
+static struct SoundIoOsPoolRegion pool_regions[SOUNDIO_OS_MIRRORED_POOL_MAX];
+static int pool_region_count;
+static long pool_hits;
+static long pool_misses;
+
 double soundio_os_get_time(void) {
 #if defined(SOUNDIO_OS_WINDOWS)
     unsigned __int64 time;
@@ -183,8 +264,109 @@ static void assert_no_err(int err) {
     assert(!err);
 }
 
+// Touches this much stack so that its pages are resident (and, with
+// mlockall, locked) before the real time loop starts.
+#define SOUNDIO_PREFAULT_STACK_SIZE (64 * 1024)
+
+static void prefault_stack(void) {
+    char stack[SOUNDIO_PREFAULT_STACK_SIZE];
+    volatile char *page = stack;
+    for (int i = 0; i < SOUNDIO_PREFAULT_STACK_SIZE; i += 4096)
+        page[i] = 0;
+}
+
+static bool set_realtime_policy(int policy, int requested_priority, int *out_priority) {
+    int min_priority = sched_get_priority_min(policy);
+    int max_priority = sched_get_priority_max(policy);
+    if (min_priority == -1 || max_priority == -1)
+        return false;
+    struct sched_param param;
+    param.sched_priority = (requested_priority > 0) ?
+        soundio_int_clamp(min_priority, requested_priority, max_priority) : max_priority;
+    if (pthread_setschedparam(pthread_self(), policy, &param))
+        return false;
+    *out_priority = param.sched_priority;
+    return true;
+}
+
+#if defined(SOUNDIO_OS_SCHED_DEADLINE)
+static bool set_deadline_policy(double period) {
+    if (period <= 0.0)
+        return false;
+    struct SoundIoSchedAttr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SOUNDIO_SCHED_DEADLINE;
+    attr.sched_period = (uint64_t)(period * 1000000000.0);
+    attr.sched_deadline = attr.sched_period;
+    attr.sched_runtime = attr.sched_period / 2;
+    return syscall(SYS_sched_setattr, 0, &attr, 0) == 0;
+}
+#endif
+
+static void apply_thread_attributes(struct SoundIoOsThread *thread) {
+    const struct SoundIoThreadAttributes *attributes = thread->attributes;
+    struct SoundIoThreadAttributes *actual = thread->actual;
+    memset(actual, 0, sizeof(struct SoundIoThreadAttributes));
+    actual->policy = SoundIoThreadPolicyNormal;
+
+#if defined(__linux__)
+    // Before the policy: the kernel refuses SCHED_DEADLINE for threads with a
+    // restricted affinity, which then falls back to SCHED_FIFO below.
+    if (attributes->cpu_mask) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu += 1) {
+            if (attributes->cpu_mask & (1ULL << cpu))
+                CPU_SET(cpu, &set);
+        }
+        if (!pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+            actual->cpu_mask = attributes->cpu_mask;
+    }
+#endif
+
+    if (attributes->lock_memory) {
+        actual->lock_memory = !mlockall(MCL_CURRENT | MCL_FUTURE);
+        prefault_stack();
+    }
+
+    switch (attributes->policy) {
+    case SoundIoThreadPolicyNormal:
+        return;
+    case SoundIoThreadPolicyDeadline:
+#if defined(SOUNDIO_OS_SCHED_DEADLINE)
+        if (set_deadline_policy(thread->period)) {
+            actual->policy = SoundIoThreadPolicyDeadline;
+            return;
+        }
+#endif
+        // fall through
+    case SoundIoThreadPolicyDefault:
+    case SoundIoThreadPolicyFifo:
+        if (set_realtime_policy(SCHED_FIFO, attributes->priority, &actual->priority)) {
+            actual->policy = SoundIoThreadPolicyFifo;
+            return;
+        }
+        break;
+    case SoundIoThreadPolicyRoundRobin:
+        if (set_realtime_policy(SCHED_RR, attributes->priority, &actual->priority)) {
+            actual->policy = SoundIoThreadPolicyRoundRobin;
+            return;
+        }
+        break;
+    }
+    thread->rtprio_failed = true;
+}
+
 static void *run_pthread(void *userdata) {
     struct SoundIoOsThread *thread = (struct SoundIoOsThread *)userdata;
+    if (thread->attributes) {
+        apply_thread_attributes(thread);
+        assert_no_err(pthread_mutex_lock(&thread->setup_mutex));
+        thread->setup_done = true;
+        assert_no_err(pthread_cond_signal(&thread->setup_cond));
+        assert_no_err(pthread_mutex_unlock(&thread->setup_mutex));
+    }
     thread->run(thread->arg);
     return NULL;
 }
@@ -263,6 +445,80 @@ int soundio_os_thread_create(
     return 0;
 }
 
+int soundio_os_thread_create_with_attributes(
+        void (*run)(void *arg), void *arg,
+        struct SoundIo *soundio,
+        const struct SoundIoThreadAttributes *attributes, double period,
+        struct SoundIoThreadAttributes *out_actual,
+        struct SoundIoOsThread **out_thread)
+{
+    *out_thread = NULL;
+
+    struct SoundIoOsThread *thread = ALLOCATE(struct SoundIoOsThread, 1);
+    if (!thread) {
+        soundio_os_thread_destroy(thread);
+        return SoundIoErrorNoMem;
+    }
+
+    thread->run = run;
+    thread->arg = arg;
+
+#if defined(SOUNDIO_OS_WINDOWS)
+    thread->handle = CreateThread(NULL, 0, run_win32_thread, thread, CREATE_SUSPENDED, &thread->id);
+    if (!thread->handle) {
+        soundio_os_thread_destroy(thread);
+        return SoundIoErrorSystemResources;
+    }
+    memset(out_actual, 0, sizeof(struct SoundIoThreadAttributes));
+    out_actual->policy = SoundIoThreadPolicyNormal;
+    if (attributes->cpu_mask) {
+        if (SetThreadAffinityMask(thread->handle, (DWORD_PTR)attributes->cpu_mask))
+            out_actual->cpu_mask = attributes->cpu_mask;
+    }
+    if (attributes->policy != SoundIoThreadPolicyNormal) {
+        if (SetThreadPriority(thread->handle, THREAD_PRIORITY_TIME_CRITICAL))
+            out_actual->policy = SoundIoThreadPolicyFifo;
+        else
+            soundio->emit_rtprio_warning(soundio);
+    }
+    ResumeThread(thread->handle);
+#else
+    int err;
+    if ((err = pthread_mutex_init(&thread->setup_mutex, NULL))) {
+        soundio_os_thread_destroy(thread);
+        return SoundIoErrorNoMem;
+    }
+    if ((err = pthread_cond_init(&thread->setup_cond, NULL))) {
+        assert_no_err(pthread_mutex_destroy(&thread->setup_mutex));
+        soundio_os_thread_destroy(thread);
+        return SoundIoErrorNoMem;
+    }
+    thread->setup_init = true;
+    thread->attributes = attributes;
+    thread->actual = out_actual;
+    thread->period = period;
+
+    if ((err = pthread_create(&thread->id, NULL, run_pthread, thread))) {
+        soundio_os_thread_destroy(thread);
+        return SoundIoErrorNoMem;
+    }
+    thread->running = true;
+
+    assert_no_err(pthread_mutex_lock(&thread->setup_mutex));
+    while (!thread->setup_done)
+        assert_no_err(pthread_cond_wait(&thread->setup_cond, &thread->setup_mutex));
+    assert_no_err(pthread_mutex_unlock(&thread->setup_mutex));
+    thread->attributes = NULL;
+    thread->actual = NULL;
+
+    if (thread->rtprio_failed)
+        soundio->emit_rtprio_warning(soundio);
+#endif
+
+    *out_thread = thread;
+    return 0;
+}
+
 void soundio_os_thread_destroy(struct SoundIoOsThread *thread) {
     if (!thread)
         return;
@@ -283,11 +539,37 @@ void soundio_os_thread_destroy(struct SoundIoOsThread *thread) {
     if (thread->attr_init) {
         assert_no_err(pthread_attr_destroy(&thread->attr));
     }
+
+    if (thread->setup_init) {
+        assert_no_err(pthread_cond_destroy(&thread->setup_cond));
+        assert_no_err(pthread_mutex_destroy(&thread->setup_mutex));
+    }
 #endif
 
     free(thread);
 }
 
+int soundio_os_cpu_count(void) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return win32_system_info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+#endif
+}
+
+void soundio_os_pin_current_thread(int cpu) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    SetThreadAffinityMask(GetCurrentThread(), ((DWORD_PTR)1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    // best effort; the thread keeps running wherever it is on failure
+    sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
 struct SoundIoOsMutex *soundio_os_mutex_create(void) {
     struct SoundIoOsMutex *mutex = ALLOCATE(struct SoundIoOsMutex, 1);
     if (!mutex) {
@@ -560,6 +842,88 @@ void soundio_os_cond_wait(struct SoundIoOsCond *cond,
 #endif
 }
 
+struct SoundIoOsPollable *soundio_os_pollable_create(void) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return NULL;
+#else
+    struct SoundIoOsPollable *pollable = ALLOCATE(struct SoundIoOsPollable, 1);
+    if (!pollable)
+        return NULL;
+
+#if defined(SOUNDIO_OS_EVENTFD)
+    pollable->fd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+    if (pollable->fd == -1) {
+        free(pollable);
+        return NULL;
+    }
+#else
+    if (pipe(pollable->pipe_fd)) {
+        free(pollable);
+        return NULL;
+    }
+    for (int i = 0; i < 2; i += 1) {
+        int fd = pollable->pipe_fd[i];
+        if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == -1 ||
+            fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
+        {
+            close(pollable->pipe_fd[0]);
+            close(pollable->pipe_fd[1]);
+            free(pollable);
+            return NULL;
+        }
+    }
+#endif
+    return pollable;
+#endif
+}
+
+void soundio_os_pollable_destroy(struct SoundIoOsPollable *pollable) {
+    if (!pollable)
+        return;
+#if defined(SOUNDIO_OS_EVENTFD)
+    close(pollable->fd);
+#elif !defined(SOUNDIO_OS_WINDOWS)
+    close(pollable->pipe_fd[0]);
+    close(pollable->pipe_fd[1]);
+#endif
+    free(pollable);
+}
+
+int soundio_os_pollable_fd(struct SoundIoOsPollable *pollable) {
+#if defined(SOUNDIO_OS_EVENTFD)
+    return pollable->fd;
+#elif !defined(SOUNDIO_OS_WINDOWS)
+    return pollable->pipe_fd[0];
+#else
+    return -1;
+#endif
+}
+
+void soundio_os_pollable_signal(struct SoundIoOsPollable *pollable) {
+#if defined(SOUNDIO_OS_EVENTFD)
+    uint64_t one = 1;
+    // EAGAIN means the counter is saturated, which is still readable.
+    ssize_t amt = write(pollable->fd, &one, sizeof(one));
+    (void)amt;
+#elif !defined(SOUNDIO_OS_WINDOWS)
+    // EAGAIN means the pipe is full, which is still readable.
+    char byte = 0;
+    ssize_t amt = write(pollable->pipe_fd[1], &byte, 1);
+    (void)amt;
+#endif
+}
+
+void soundio_os_pollable_clear(struct SoundIoOsPollable *pollable) {
+#if defined(SOUNDIO_OS_EVENTFD)
+    uint64_t count;
+    ssize_t amt = read(pollable->fd, &count, sizeof(count));
+    (void)amt;
+#elif !defined(SOUNDIO_OS_WINDOWS)
+    char buf[64];
+    while (read(pollable->pipe_fd[0], buf, sizeof(buf)) > 0) {}
+#endif
+}
+
 static int internal_init(void) {
 #if defined(SOUNDIO_OS_WINDOWS)
     unsigned __int64 frequency;
@@ -576,6 +940,9 @@ static int internal_init(void) {
     host_get_clock_service(mach_host_self(), SYSTEM_CLOCK, &cclock);
 #endif
 #endif
+    pool_mutex = soundio_os_mutex_create();
+    if (!pool_mutex)
+        return SoundIoErrorNoMem;
     return 0;
 }
 
@@ -620,9 +987,118 @@ static inline size_t ceil_dbl_to_size_t(double x) {
     return truncation + (truncation < x);
 }
 
-int soundio_os_init_mirrored_memory(struct SoundIoOsMirroredMemory *mem, size_t requested_capacity) {
-    size_t actual_capacity = ceil_dbl_to_size_t(requested_capacity / (double)page_size) * page_size;
+#if !defined(SOUNDIO_OS_WINDOWS)
+// Returns an unlinked shared memory file of `capacity` bytes.
+static int create_shared_memory_fd(size_t capacity, unsigned int memfd_flags, int *out_fd) {
+    int fd;
+#if defined(__ANDROID__)
+    fd = open("/dev/ashmem", O_RDWR);
+    if (fd < 0)
+        return SoundIoErrorSystemResources;
+
+    int ret = ioctl(fd, ASHMEM_SET_SIZE, capacity);
+    if (ret < 0) {
+        close(fd);
+        return SoundIoErrorSystemResources;
+    }
+#else
+    fd = -1;
+#if defined(SOUNDIO_OS_MEMFD)
+    // an anonymous file never touches a file system
+    fd = syscall(SYS_memfd_create, "soundio", MFD_CLOEXEC | memfd_flags);
+    if (fd < 0 && memfd_flags)
+        return SoundIoErrorSystemResources;
+#endif
+    if (fd < 0) {
+        char shm_path[] = "/dev/shm/soundio-XXXXXX";
+        char tmp_path[] = "/tmp/soundio-XXXXXX";
+        char *chosen_path;
+
+        fd = mkstemp(shm_path);
+        if (fd < 0) {
+            fd = mkstemp(tmp_path);
+            if (fd < 0) {
+                return SoundIoErrorSystemResources;
+            } else {
+                chosen_path = tmp_path;
+            }
+        } else {
+            chosen_path = shm_path;
+        }
+
+        if (unlink(chosen_path)) {
+            close(fd);
+            return SoundIoErrorSystemResources;
+        }
+    }
+
+    if (ftruncate(fd, capacity)) {
+        close(fd);
+        return SoundIoErrorSystemResources;
+    }
+#endif
+    *out_fd = fd;
+    return 0;
+}
+
+#if defined(SOUNDIO_OS_MEMFD)
+// Returns 0 when the system has no huge pages configured.
+static size_t huge_page_size(void) {
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (!f)
+        return 0;
+    char line[128];
+    unsigned long kib = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "Hugepagesize: %lu kB", &kib) == 1)
+            break;
+    }
+    fclose(f);
+    return kib * 1024;
+}
+#endif
+#endif
 
+#if !defined(SOUNDIO_OS_WINDOWS)
+// Maps the first `header_size` bytes of `fd` once, followed by the
+// `capacity` bytes after them twice in a row. `out_address` receives the
+// start of the header; the data starts `header_size` bytes later, aligned to
+// `alignment`.
+static int map_mirrored_fd(int fd, size_t header_size, size_t capacity, size_t alignment, char **out_address) {
+    // Both views of a huge page file must start on a huge page boundary, so
+    // reserve enough to align and give the slack back.
+    size_t map_size = header_size + capacity * 2;
+    size_t reserve_size = map_size + (alignment - page_size);
+    char *reserved = (char*)mmap(NULL, reserve_size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (reserved == MAP_FAILED)
+        return SoundIoErrorNoMem;
+    char *data = (char*)(((uintptr_t)reserved + header_size + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    char *address = data - header_size;
+    if (address != reserved)
+        munmap(reserved, address - reserved);
+    size_t tail_size = (reserved + reserve_size) - (address + map_size);
+    if (tail_size)
+        munmap(address + map_size, tail_size);
+
+    bool ok = true;
+    if (header_size) {
+        ok = mmap(address, header_size, PROT_READ|PROT_WRITE, MAP_FIXED|MAP_SHARED, fd, 0) == address;
+    }
+    ok = ok && mmap(data, capacity, PROT_READ|PROT_WRITE,
+            MAP_FIXED|MAP_SHARED, fd, header_size) == data;
+    ok = ok && mmap(data + capacity, capacity, PROT_READ|PROT_WRITE,
+            MAP_FIXED|MAP_SHARED, fd, header_size) == data + capacity;
+    if (!ok) {
+        munmap(address, map_size);
+        return SoundIoErrorNoMem;
+    }
+
+    *out_address = address;
+    return 0;
+}
+#endif
+
+static int map_mirrored_memory(struct SoundIoOsMirroredMemory *mem, size_t actual_capacity, int flags) {
 #if defined(SOUNDIO_OS_WINDOWS)
     BOOL ok;
     HANDLE hMapFile = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, actual_capacity * 2, NULL);
@@ -676,81 +1152,55 @@ int soundio_os_init_mirrored_memory(struct SoundIoOsMirroredMemory *mem, size_t
         break;
     }
 #else
-
-    int fd;
-#ifdef __ANDROID__
-    fd = open("/dev/ashmem", O_RDWR);
-    if (fd < 0)
-        return SoundIoErrorSystemResources;
-
-    int ret = ioctl(fd, ASHMEM_SET_SIZE, actual_capacity);
-    if (ret < 0) {
-        close(fd);
-        return SoundIoErrorSystemResources;
-    }
-#else
-    char shm_path[] = "/dev/shm/soundio-XXXXXX";
-    char tmp_path[] = "/tmp/soundio-XXXXXX";
-    char *chosen_path;
-
-    fd = mkstemp(shm_path);
-    if (fd < 0) {
-        fd = mkstemp(tmp_path);
-        if (fd < 0) {
-            return SoundIoErrorSystemResources;
-        } else {
-            chosen_path = tmp_path;
+    int err;
+    size_t page_capacity = actual_capacity;
+    size_t alignment = page_size;
+    int fd = -1;
+#if defined(SOUNDIO_OS_MEMFD)
+    if (flags & SoundIoRingBufferPoolFlagHugePages) {
+        size_t huge_size = huge_page_size();
+        if (huge_size > (size_t)page_size) {
+            size_t huge_capacity = ceil_dbl_to_size_t(actual_capacity / (double)huge_size) * huge_size;
+            if (!create_shared_memory_fd(huge_capacity, MFD_HUGETLB, &fd)) {
+                actual_capacity = huge_capacity;
+                alignment = huge_size;
+            }
         }
-    } else {
-        chosen_path = shm_path;
-    }
-
-    if (unlink(chosen_path)) {
-        close(fd);
-        return SoundIoErrorSystemResources;
-    }
-
-    if (ftruncate(fd, actual_capacity)) {
-        close(fd);
-        return SoundIoErrorSystemResources;
     }
 #endif
+    if (fd < 0 && (err = create_shared_memory_fd(actual_capacity, 0, &fd)))
+        return err;
 
-    char *address = (char*)mmap(NULL, actual_capacity * 2, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
-    if (address == MAP_FAILED) {
+    char *address;
+    if ((err = map_mirrored_fd(fd, 0, actual_capacity, alignment, &address))) {
         close(fd);
-        return SoundIoErrorNoMem;
+        // huge pages can run out even though the file was created
+        if (alignment != (size_t)page_size)
+            return map_mirrored_memory(mem, page_capacity, flags & ~SoundIoRingBufferPoolFlagHugePages);
+        return err;
     }
 
-    char *other_address = (char*)mmap(address, actual_capacity, PROT_READ|PROT_WRITE,
-            MAP_FIXED|MAP_SHARED, fd, 0);
-    if (other_address != address) {
+    if (close(fd)) {
         munmap(address, 2 * actual_capacity);
-        close(fd);
-        return SoundIoErrorNoMem;
+        return SoundIoErrorSystemResources;
     }
 
-    other_address = (char*)mmap(address + actual_capacity, actual_capacity,
-            PROT_READ|PROT_WRITE, MAP_FIXED|MAP_SHARED, fd, 0);
-    if (other_address != address + actual_capacity) {
-        munmap(address, 2 * actual_capacity);
-        close(fd);
-        return SoundIoErrorNoMem;
+    if (flags & SoundIoRingBufferPoolFlagLock) {
+        // Touch both views so that neither the pages nor the page table
+        // entries fault later. Failing to lock leaves them resident for now,
+        // which is the best we can do without the privilege.
+        memset(address, 0, 2 * actual_capacity);
+        mlock(address, 2 * actual_capacity);
     }
 
     mem->address = address;
-
-    if (close(fd))
-        return SoundIoErrorSystemResources;
 #endif
 
     mem->capacity = actual_capacity;
     return 0;
 }
 
-void soundio_os_deinit_mirrored_memory(struct SoundIoOsMirroredMemory *mem) {
-    if (!mem->address)
-        return;
+static void unmap_mirrored_memory(struct SoundIoOsMirroredMemory *mem) {
 #if defined(SOUNDIO_OS_WINDOWS)
     BOOL ok;
     ok = UnmapViewOfFile(mem->address);
@@ -765,3 +1215,358 @@ void soundio_os_deinit_mirrored_memory(struct SoundIoOsMirroredMemory *mem) {
 #endif
     mem->address = NULL;
 }
+
+int soundio_os_init_mirrored_memory(struct SoundIoOsMirroredMemory *mem, size_t requested_capacity) {
+    size_t actual_capacity = ceil_dbl_to_size_t(requested_capacity / (double)page_size) * page_size;
+
+    // The buffer's capacity is the whole region's, huge page rounding
+    // included, and stream latencies follow from it, so only regions of at
+    // most the next power of 2 of the request qualify. Of those the
+    // smallest idle one wins.
+    size_t size_class = page_size;
+    while (size_class < actual_capacity)
+        size_class *= 2;
+    soundio_os_mutex_lock(pool_mutex);
+    struct SoundIoOsPoolRegion *best = NULL;
+    for (int i = 0; i < pool_region_count; i += 1) {
+        struct SoundIoOsPoolRegion *region = &pool_regions[i];
+        if (region->idle && region->mem.capacity >= actual_capacity &&
+            region->mem.capacity <= size_class &&
+            (!best || region->mem.capacity < best->mem.capacity))
+        {
+            best = region;
+        }
+    }
+    if (best) {
+        best->idle = false;
+        *mem = best->mem;
+        pool_hits += 1;
+    } else {
+        pool_misses += 1;
+    }
+    soundio_os_mutex_unlock(pool_mutex);
+
+    if (best) {
+        // callers expect the contents of fresh memory
+        memset(mem->address, 0, mem->capacity);
+        return 0;
+    }
+
+    return map_mirrored_memory(mem, actual_capacity, 0);
+}
+
+void soundio_os_deinit_mirrored_memory(struct SoundIoOsMirroredMemory *mem) {
+    if (!mem->address)
+        return;
+
+    soundio_os_mutex_lock(pool_mutex);
+    for (int i = 0; i < pool_region_count; i += 1) {
+        struct SoundIoOsPoolRegion *region = &pool_regions[i];
+        if (region->mem.address == mem->address) {
+            region->idle = true;
+            soundio_os_mutex_unlock(pool_mutex);
+            mem->address = NULL;
+            return;
+        }
+    }
+    soundio_os_mutex_unlock(pool_mutex);
+
+    unmap_mirrored_memory(mem);
+}
+
+int soundio_os_mirrored_memory_pool_reserve(size_t capacity, int count, int flags) {
+    size_t actual_capacity = ceil_dbl_to_size_t(capacity / (double)page_size) * page_size;
+
+    // Mapping happens outside the lock so that streams opening meanwhile do
+    // not wait on it.
+    for (int i = 0; i < count; i += 1) {
+        struct SoundIoOsMirroredMemory mem = {0};
+        int err;
+        if ((err = map_mirrored_memory(&mem, actual_capacity, flags)))
+            return err;
+
+        soundio_os_mutex_lock(pool_mutex);
+        if (pool_region_count >= SOUNDIO_OS_MIRRORED_POOL_MAX) {
+            soundio_os_mutex_unlock(pool_mutex);
+            unmap_mirrored_memory(&mem);
+            return SoundIoErrorNoMem;
+        }
+        struct SoundIoOsPoolRegion *region = &pool_regions[pool_region_count];
+        region->mem = mem;
+        region->idle = true;
+        pool_region_count += 1;
+        soundio_os_mutex_unlock(pool_mutex);
+    }
+    return 0;
+}
+
+void soundio_os_mirrored_memory_pool_trim(void) {
+    soundio_os_mutex_lock(pool_mutex);
+    int kept = 0;
+    for (int i = 0; i < pool_region_count; i += 1) {
+        struct SoundIoOsPoolRegion *region = &pool_regions[i];
+        if (region->idle)
+            unmap_mirrored_memory(&region->mem);
+        else
+            pool_regions[kept++] = *region;
+    }
+    pool_region_count = kept;
+    soundio_os_mutex_unlock(pool_mutex);
+}
+
+void soundio_os_mirrored_memory_pool_stats(long *out_hits, long *out_misses, int *out_idle) {
+    soundio_os_mutex_lock(pool_mutex);
+    *out_hits = pool_hits;
+    *out_misses = pool_misses;
+    int idle = 0;
+    for (int i = 0; i < pool_region_count; i += 1)
+        idle += pool_regions[i].idle;
+    *out_idle = idle;
+    soundio_os_mutex_unlock(pool_mutex);
+}
+
+#if !defined(SOUNDIO_OS_WINDOWS)
+static int open_named_shared_memory(const char *name, int oflag) {
+    if (name[0] == '/')
+        name += 1;
+    if (!name[0] || strchr(name, '/')) {
+        errno = EINVAL;
+        return -1;
+    }
+#if defined(__linux__)
+    // what shm_open does, without needing librt on older glibc
+    char path[256];
+    if (snprintf(path, sizeof(path), "/dev/shm/%s", name) >= (int)sizeof(path)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return open(path, oflag | O_CLOEXEC, 0600);
+#else
+    char path[256];
+    if (snprintf(path, sizeof(path), "/%s", name) >= (int)sizeof(path)) {
+        errno = EINVAL;
+        return -1;
+    }
+    return shm_open(path, oflag, 0600);
+#endif
+}
+#endif
+
+int soundio_os_shared_memory_create(const char *name, size_t size, int *out_fd) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    if (!name)
+        return create_shared_memory_fd(size, 0, out_fd);
+
+    int fd = open_named_shared_memory(name, O_RDWR | O_CREAT | O_EXCL);
+    if (fd < 0)
+        return (errno == EEXIST || errno == EINVAL) ? SoundIoErrorInvalid : SoundIoErrorSystemResources;
+    if (ftruncate(fd, size)) {
+        close(fd);
+        soundio_os_shared_memory_unlink(name);
+        return SoundIoErrorSystemResources;
+    }
+    *out_fd = fd;
+    return 0;
+#endif
+}
+
+int soundio_os_shared_memory_open(const char *name, int *out_fd, size_t *out_size) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    int fd = open_named_shared_memory(name, O_RDWR);
+    if (fd < 0)
+        return (errno == ENOENT || errno == EINVAL) ? SoundIoErrorInvalid : SoundIoErrorSystemResources;
+    int err;
+    if ((err = soundio_os_shared_memory_size(fd, out_size))) {
+        close(fd);
+        return err;
+    }
+    *out_fd = fd;
+    return 0;
+#endif
+}
+
+int soundio_os_shared_memory_size(int fd, size_t *out_size) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    struct stat st;
+    if (fstat(fd, &st))
+        return SoundIoErrorInvalid;
+    *out_size = st.st_size;
+    return 0;
+#endif
+}
+
+void soundio_os_shared_memory_unlink(const char *name) {
+#if !defined(SOUNDIO_OS_WINDOWS)
+    if (name[0] == '/')
+        name += 1;
+#if defined(__linux__)
+    char path[256];
+    if (snprintf(path, sizeof(path), "/dev/shm/%s", name) < (int)sizeof(path))
+        unlink(path);
+#else
+    char path[256];
+    if (snprintf(path, sizeof(path), "/%s", name) < (int)sizeof(path))
+        shm_unlink(path);
+#endif
+#endif
+}
+
+void soundio_os_shared_memory_close(int fd) {
+#if !defined(SOUNDIO_OS_WINDOWS)
+    close(fd);
+#endif
+}
+
+int soundio_os_map_shared_ring(int fd, size_t header_size, size_t capacity, char **out_address) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    return map_mirrored_fd(fd, header_size, capacity, page_size, out_address);
+#endif
+}
+
+void soundio_os_unmap_shared_ring(char *address, size_t header_size, size_t capacity) {
+#if !defined(SOUNDIO_OS_WINDOWS)
+    // only fails for a range that was never mapped, which means the ring
+    // buffer's own bookkeeping is broken
+    if (munmap(address, header_size + 2 * capacity))
+        soundio_panic("libsoundio: unable to unmap shared ring buffer");
+#endif
+}
+
+int soundio_os_send_fd(int socket_fd, int fd) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    char byte = 0;
+    struct iovec iov = { &byte, 1 };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    ssize_t amt;
+    do {
+        amt = sendmsg(socket_fd, &msg, 0);
+    } while (amt < 0 && errno == EINTR);
+    return (amt == 1) ? 0 : SoundIoErrorSystemResources;
+#endif
+}
+
+int soundio_os_recv_fd(int socket_fd, int *out_fd) {
+#if defined(SOUNDIO_OS_WINDOWS)
+    return SoundIoErrorSystemResources;
+#else
+    char byte;
+    struct iovec iov = { &byte, 1 };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t amt;
+    do {
+        amt = recvmsg(socket_fd, &msg, 0);
+    } while (amt < 0 && errno == EINTR);
+    if (amt != 1)
+        return SoundIoErrorSystemResources;
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(int)))
+    {
+        return SoundIoErrorInvalid;
+    }
+    memcpy(out_fd, CMSG_DATA(cmsg), sizeof(int));
+    return 0;
+#endif
+}
+
+#if defined(SOUNDIO_OS_FUTEX)
+static int futex_op(int op, bool process_shared) {
+    return process_shared ? op : (op | FUTEX_PRIVATE_FLAG);
+}
+#endif
+
+void soundio_os_futex_wait(struct SoundIoAtomicInt *word, int expected, double seconds,
+        bool process_shared)
+{
+    if (seconds <= 0.0)
+        return;
+#if defined(SOUNDIO_OS_FUTEX)
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1000000000.0);
+    syscall(SYS_futex, &word->x, futex_op(FUTEX_WAIT, process_shared), expected, &ts, NULL, 0);
+#else
+    (void)process_shared;
+    // without futexes, nap briefly and let the caller check again
+    if (SOUNDIO_ATOMIC_LOAD((*word)) != expected)
+        return;
+    double nap = (seconds < 0.001) ? seconds : 0.001;
+#if defined(SOUNDIO_OS_WINDOWS)
+    Sleep((DWORD)(nap * 1000.0));
+#else
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = (long)(nap * 1000000000.0);
+    nanosleep(&ts, NULL);
+#endif
+#endif
+}
+
+void soundio_os_futex_wake_all(struct SoundIoAtomicInt *word, bool process_shared) {
+#if defined(SOUNDIO_OS_FUTEX)
+    syscall(SYS_futex, &word->x, futex_op(FUTEX_WAKE, process_shared), INT_MAX, NULL, NULL, 0);
+#else
+    (void)word;
+    (void)process_shared;
+#endif
+}
+
+bool soundio_os_futex_wait_seq(struct SoundIoAtomicInt *seq, struct SoundIoAtomicInt *waiter_count,
+        bool process_shared, bool (*ready)(void *context, int count), void *context, int count,
+        double timeout)
+{
+    double deadline = soundio_os_get_time() + timeout;
+    for (;;) {
+        // load the sequence first so that an update after the check below
+        // makes the futex wait return right away
+        int current_seq = SOUNDIO_ATOMIC_LOAD((*seq));
+        if (ready(context, count))
+            return true;
+        double remaining = (timeout < 0.0) ? 1.0 : deadline - soundio_os_get_time();
+        if (remaining <= 0.0)
+            return false;
+        SOUNDIO_ATOMIC_FETCH_ADD((*waiter_count), 1);
+        soundio_os_futex_wait(seq, current_seq, remaining, process_shared);
+        SOUNDIO_ATOMIC_FETCH_ADD((*waiter_count), -1);
+    }
+}
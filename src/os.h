@@ -25,8 +25,25 @@ int soundio_os_thread_create(
         struct SoundIo *soundio, // pass NULL to disable real time priority
         struct SoundIoOsThread **out_thread);
 
+struct SoundIoThreadAttributes;
+// Like soundio_os_thread_create but applies `attributes` from inside the new
+// thread before `run` is called, and writes what took effect to `out_actual`
+// before returning. `period` is the interval in seconds at which the thread
+// services its stream; it sizes SoundIoThreadPolicyDeadline reservations.
+int soundio_os_thread_create_with_attributes(
+        void (*run)(void *arg), void *arg,
+        struct SoundIo *soundio,
+        const struct SoundIoThreadAttributes *attributes, double period,
+        struct SoundIoThreadAttributes *out_actual,
+        struct SoundIoOsThread **out_thread);
+
 void soundio_os_thread_destroy(struct SoundIoOsThread *thread);
 
+int soundio_os_cpu_count(void);
+// Restricts the calling thread to run only on `cpu`. Does nothing on systems
+// which do not support thread affinity.
+void soundio_os_pin_current_thread(int cpu);
+
 
 struct SoundIoOsMutex;
 struct SoundIoOsMutex *soundio_os_mutex_create(void);
@@ -51,6 +68,18 @@ void soundio_os_cond_wait(struct SoundIoOsCond *cond,
         struct SoundIoOsMutex *locked_mutex);
 
 
+// A file descriptor which can be watched with poll, epoll or kqueue. It
+// becomes readable after soundio_os_pollable_signal and stays readable until
+// soundio_os_pollable_clear. Signal is safe to call from any thread and never
+// blocks. Not available on Windows; create returns NULL there.
+struct SoundIoOsPollable;
+struct SoundIoOsPollable *soundio_os_pollable_create(void);
+void soundio_os_pollable_destroy(struct SoundIoOsPollable *pollable);
+int soundio_os_pollable_fd(struct SoundIoOsPollable *pollable);
+void soundio_os_pollable_signal(struct SoundIoOsPollable *pollable);
+void soundio_os_pollable_clear(struct SoundIoOsPollable *pollable);
+
+
 int soundio_os_page_size(void);
 
 // You may rely on the size of this struct as part of the API and ABI.
@@ -65,4 +94,48 @@ struct SoundIoOsMirroredMemory {
 int soundio_os_init_mirrored_memory(struct SoundIoOsMirroredMemory *mem, size_t capacity);
 void soundio_os_deinit_mirrored_memory(struct SoundIoOsMirroredMemory *mem);
 
+// Builds `count` regions of at least `capacity` bytes up front.
+// soundio_os_init_mirrored_memory hands out the smallest idle one that fits
+// before it maps new memory, and soundio_os_deinit_mirrored_memory gives
+// pool regions back instead of unmapping them. `flags` is a mask of
+// enum SoundIoRingBufferPoolFlag.
+int soundio_os_mirrored_memory_pool_reserve(size_t capacity, int count, int flags);
+// Unmaps the idle pool regions.
+void soundio_os_mirrored_memory_pool_trim(void);
+void soundio_os_mirrored_memory_pool_stats(long *out_hits, long *out_misses, int *out_idle);
+
+// Shared memory files for ring buffers which several processes map. A NULL
+// `name` creates an anonymous file whose descriptor can be passed to another
+// process with soundio_os_send_fd. Not available on Windows.
+int soundio_os_shared_memory_create(const char *name, size_t size, int *out_fd);
+int soundio_os_shared_memory_open(const char *name, int *out_fd, size_t *out_size);
+int soundio_os_shared_memory_size(int fd, size_t *out_size);
+void soundio_os_shared_memory_unlink(const char *name);
+void soundio_os_shared_memory_close(int fd);
+// Maps the first `header_size` bytes of `fd` followed by the `capacity` bytes
+// after them twice in a row. Both sizes must be multiples of the page size.
+int soundio_os_map_shared_ring(int fd, size_t header_size, size_t capacity, char **out_address);
+void soundio_os_unmap_shared_ring(char *address, size_t header_size, size_t capacity);
+// Passes a file descriptor over a Unix domain socket.
+int soundio_os_send_fd(int socket_fd, int fd);
+int soundio_os_recv_fd(int socket_fd, int *out_fd);
+
+struct SoundIoAtomicInt;
+// Blocks while `word` holds `expected`, for at most `seconds`. May return
+// early, so callers check their condition again. `process_shared` must be
+// set when `word` lives in memory shared between processes, and must match
+// between waiters and wakers; otherwise the cheaper process-private futex is
+// used. Systems without futexes nap for at most a millisecond instead.
+void soundio_os_futex_wait(struct SoundIoAtomicInt *word, int expected, double seconds,
+        bool process_shared);
+// Wakes every thread blocked in soundio_os_futex_wait on `word`.
+void soundio_os_futex_wake_all(struct SoundIoAtomicInt *word, bool process_shared);
+// Sleeps on the sequence counter `seq` until `ready(context, count)` holds or
+// `timeout` seconds pass, and returns whether it held. A negative timeout
+// waits forever. While asleep the caller is counted in `waiter_count`, so
+// that whoever bumps `seq` can skip the wake system call when it is zero.
+bool soundio_os_futex_wait_seq(struct SoundIoAtomicInt *seq, struct SoundIoAtomicInt *waiter_count,
+        bool process_shared, bool (*ready)(void *context, int count), void *context, int count,
+        double timeout);
+
 #endif
@@ -0,0 +1,1154 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "pipewire.h"
+#include "soundio_private.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <spa/param/audio/format-utils.h>
+#include <spa/param/buffers.h>
+#include <spa/pod/builder.h>
+#pragma GCC diagnostic pop
+
+SOUNDIO_MAKE_LIST_DEF(struct SoundIoPipeWireNode *, SoundIoListPipeWireNodePtr, SOUNDIO_LIST_STATIC)
+
+// PipeWire runs the graph at 48000 Hz unless configured otherwise and
+// resamples every stream to the graph rate.
+static const int default_sample_rate = 48000;
+static const int default_period_frames = 1024;
+static const int min_period_frames = 32;
+static const int max_period_frames = 8192;
+
+static void destroy_node(struct SoundIoPipeWireNode *node) {
+    if (!node)
+        return;
+    free(node->name);
+    free(node->description);
+    free(node);
+}
+
+static void core_done_callback(void *data, uint32_t id, int seq) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)data;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    if (id == PW_ID_CORE && seq == sipw->pending_sync) {
+        sipw->sync_done = true;
+        pw_thread_loop_signal(sipw->loop, false);
+    }
+}
+
+static void core_error_callback(void *data, uint32_t id, int seq, int res, const char *message) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)data;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    if (id != PW_ID_CORE || res != -EPIPE)
+        return;
+    // the daemon went away
+    sipw->connection_err = SoundIoErrorBackendDisconnected;
+    sipw->sync_done = true;
+    pw_thread_loop_signal(sipw->loop, false);
+    soundio_emit_events_signal(&si->pub);
+}
+
+static const struct pw_core_events core_events = {
+    .version = PW_VERSION_CORE_EVENTS,
+    .done = core_done_callback,
+    .error = core_error_callback,
+};
+
+// call this while holding the thread loop lock
+static int roundtrip(struct SoundIoPrivate *si) {
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    sipw->sync_done = false;
+    sipw->pending_sync = pw_core_sync(sipw->core, PW_ID_CORE, sipw->pending_sync);
+    while (!sipw->sync_done)
+        pw_thread_loop_wait(sipw->loop);
+    return sipw->connection_err;
+}
+
+// The default metadata stores values such as {"name":"alsa_output.pci-0000_00_1f.3"}.
+static char *parse_default_name(const char *value) {
+    if (!value)
+        return NULL;
+    const char *key = strstr(value, "\"name\"");
+    if (!key)
+        return NULL;
+    const char *start = strchr(key + 6, '"');
+    if (!start)
+        return NULL;
+    start += 1;
+    const char *end = strchr(start, '"');
+    if (!end)
+        return NULL;
+    return soundio_alloc_sprintf(NULL, "%.*s", (int)(end - start), start);
+}
+
+static int metadata_property_callback(void *data, uint32_t subject, const char *key,
+        const char *type, const char *value)
+{
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)data;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (subject != PW_ID_CORE)
+        return 0;
+
+    bool all = !key;
+    if (all || strcmp(key, "default.audio.sink") == 0) {
+        free(sipw->default_sink_name);
+        sipw->default_sink_name = all ? NULL : parse_default_name(value);
+    }
+    if (all || strcmp(key, "default.audio.source") == 0) {
+        free(sipw->default_source_name);
+        sipw->default_source_name = all ? NULL : parse_default_name(value);
+    }
+
+    sipw->devices_changed = true;
+    pw_thread_loop_signal(sipw->loop, false);
+    soundio_emit_events_signal(&si->pub);
+    return 0;
+}
+
+static const struct pw_metadata_events metadata_events = {
+    .version = PW_VERSION_METADATA_EVENTS,
+    .property = metadata_property_callback,
+};
+
+static void registry_global_callback(void *data, uint32_t id, uint32_t permissions,
+        const char *type, uint32_t version, const struct spa_dict *props)
+{
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)data;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (!props)
+        return;
+
+    if (strcmp(type, PW_TYPE_INTERFACE_Metadata) == 0) {
+        const char *metadata_name = spa_dict_lookup(props, PW_KEY_METADATA_NAME);
+        if (sipw->metadata || !metadata_name || strcmp(metadata_name, "default") != 0)
+            return;
+        sipw->metadata = (struct pw_metadata *)pw_registry_bind(sipw->registry, id,
+                PW_TYPE_INTERFACE_Metadata, PW_VERSION_METADATA, 0);
+        if (!sipw->metadata)
+            return;
+        sipw->metadata_id = id;
+        pw_metadata_add_listener(sipw->metadata, &sipw->metadata_listener, &metadata_events, si);
+        return;
+    }
+
+    if (strcmp(type, PW_TYPE_INTERFACE_Node) != 0)
+        return;
+
+    const char *media_class = spa_dict_lookup(props, PW_KEY_MEDIA_CLASS);
+    if (!media_class)
+        return;
+    enum SoundIoDeviceAim aim;
+    if (strcmp(media_class, "Audio/Sink") == 0)
+        aim = SoundIoDeviceAimOutput;
+    else if (strcmp(media_class, "Audio/Source") == 0)
+        aim = SoundIoDeviceAimInput;
+    else
+        return;
+
+    const char *name = spa_dict_lookup(props, PW_KEY_NODE_NAME);
+    if (!name)
+        return;
+    const char *description = spa_dict_lookup(props, PW_KEY_NODE_DESCRIPTION);
+    if (!description)
+        description = name;
+
+    struct SoundIoPipeWireNode *node = ALLOCATE(struct SoundIoPipeWireNode, 1);
+    if (!node) {
+        sipw->connection_err = SoundIoErrorNoMem;
+        return;
+    }
+    node->id = id;
+    node->aim = aim;
+    node->name = strdup(name);
+    node->description = strdup(description);
+    if (!node->name || !node->description || SoundIoListPipeWireNodePtr_append(&sipw->nodes, node)) {
+        destroy_node(node);
+        sipw->connection_err = SoundIoErrorNoMem;
+        return;
+    }
+
+    sipw->devices_changed = true;
+    pw_thread_loop_signal(sipw->loop, false);
+    soundio_emit_events_signal(&si->pub);
+}
+
+static void registry_global_remove_callback(void *data, uint32_t id) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)data;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (sipw->metadata && id == sipw->metadata_id) {
+        spa_hook_remove(&sipw->metadata_listener);
+        pw_proxy_destroy((struct pw_proxy *)sipw->metadata);
+        sipw->metadata = NULL;
+        return;
+    }
+
+    for (int i = 0; i < sipw->nodes.length; i += 1) {
+        struct SoundIoPipeWireNode *node = SoundIoListPipeWireNodePtr_val_at(&sipw->nodes, i);
+        if (node->id == id) {
+            SoundIoListPipeWireNodePtr_swap_remove(&sipw->nodes, i);
+            destroy_node(node);
+            sipw->devices_changed = true;
+            pw_thread_loop_signal(sipw->loop, false);
+            soundio_emit_events_signal(&si->pub);
+            return;
+        }
+    }
+}
+
+static const struct pw_registry_events registry_events = {
+    .version = PW_VERSION_REGISTRY_EVENTS,
+    .global = registry_global_callback,
+    .global_remove = registry_global_remove_callback,
+};
+
+static void destroy_pw(struct SoundIoPrivate *si) {
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (sipw->loop)
+        pw_thread_loop_stop(sipw->loop);
+
+    if (sipw->metadata) {
+        spa_hook_remove(&sipw->metadata_listener);
+        pw_proxy_destroy((struct pw_proxy *)sipw->metadata);
+        sipw->metadata = NULL;
+    }
+    if (sipw->registry) {
+        spa_hook_remove(&sipw->registry_listener);
+        pw_proxy_destroy((struct pw_proxy *)sipw->registry);
+        sipw->registry = NULL;
+    }
+    if (sipw->core) {
+        spa_hook_remove(&sipw->core_listener);
+        pw_core_disconnect(sipw->core);
+        sipw->core = NULL;
+    }
+    if (sipw->context) {
+        pw_context_destroy(sipw->context);
+        sipw->context = NULL;
+    }
+    if (sipw->loop) {
+        pw_thread_loop_destroy(sipw->loop);
+        sipw->loop = NULL;
+    }
+
+    for (int i = 0; i < sipw->nodes.length; i += 1)
+        destroy_node(SoundIoListPipeWireNodePtr_val_at(&sipw->nodes, i));
+    SoundIoListPipeWireNodePtr_deinit(&sipw->nodes);
+
+    free(sipw->default_sink_name);
+    free(sipw->default_source_name);
+
+    pw_deinit();
+}
+
+static int set_all_device_formats(struct SoundIoDevice *device) {
+    device->format_count = 18;
+    device->formats = ALLOCATE(enum SoundIoFormat, device->format_count);
+    if (!device->formats)
+        return SoundIoErrorNoMem;
+    device->formats[0] = SoundIoFormatFloat32LE;
+    device->formats[1] = SoundIoFormatFloat32BE;
+    device->formats[2] = SoundIoFormatS32LE;
+    device->formats[3] = SoundIoFormatS32BE;
+    device->formats[4] = SoundIoFormatS24LE;
+    device->formats[5] = SoundIoFormatS24BE;
+    device->formats[6] = SoundIoFormatS24PackedLE;
+    device->formats[7] = SoundIoFormatS24PackedBE;
+    device->formats[8] = SoundIoFormatS16LE;
+    device->formats[9] = SoundIoFormatS16BE;
+    device->formats[10] = SoundIoFormatFloat64LE;
+    device->formats[11] = SoundIoFormatFloat64BE;
+    device->formats[12] = SoundIoFormatU32LE;
+    device->formats[13] = SoundIoFormatU32BE;
+    device->formats[14] = SoundIoFormatU16LE;
+    device->formats[15] = SoundIoFormatU16BE;
+    device->formats[16] = SoundIoFormatS8;
+    device->formats[17] = SoundIoFormatU8;
+    return 0;
+}
+
+static int set_all_device_channel_layouts(struct SoundIoDevice *device) {
+    device->layout_count = soundio_channel_layout_builtin_count();
+    device->layouts = ALLOCATE(struct SoundIoChannelLayout, device->layout_count);
+    if (!device->layouts)
+        return SoundIoErrorNoMem;
+    for (int i = 0; i < device->layout_count; i += 1)
+        device->layouts[i] = *soundio_channel_layout_get_builtin(i);
+    return 0;
+}
+
+static int create_device(struct SoundIoPrivate *si, struct SoundIoDevicesInfo *devices_info,
+        struct SoundIoPipeWireNode *node)
+{
+    struct SoundIo *soundio = &si->pub;
+    int err;
+
+    struct SoundIoDevicePrivate *dev = ALLOCATE(struct SoundIoDevicePrivate, 1);
+    if (!dev)
+        return SoundIoErrorNoMem;
+    struct SoundIoDevice *device = &dev->pub;
+
+    device->ref_count = 1;
+    device->soundio = soundio;
+    device->aim = node->aim;
+    device->id = strdup(node->name);
+    device->name = strdup(node->description);
+    if (!device->id || !device->name) {
+        soundio_device_unref(device);
+        return SoundIoErrorNoMem;
+    }
+
+    // The node's format is negotiated per link and not published on the
+    // registry, and PipeWire converts format, channels and rate for every
+    // stream, so advertise everything that can be converted.
+    device->current_layout = *soundio_channel_layout_get_default(2);
+    if ((err = set_all_device_channel_layouts(device))) {
+        soundio_device_unref(device);
+        return err;
+    }
+
+    device->current_format = SoundIoFormatFloat32NE;
+    if ((err = set_all_device_formats(device))) {
+        soundio_device_unref(device);
+        return err;
+    }
+
+    device->sample_rate_current = default_sample_rate;
+    device->sample_rate_count = 1;
+    device->sample_rates = &dev->prealloc_sample_rate_range;
+    device->sample_rates[0].min = SOUNDIO_MIN_SAMPLE_RATE;
+    device->sample_rates[0].max = SOUNDIO_MAX_SAMPLE_RATE;
+
+    device->software_latency_min = min_period_frames / (double)default_sample_rate;
+    device->software_latency_max = max_period_frames / (double)default_sample_rate;
+    device->software_latency_current = default_period_frames / (double)default_sample_rate;
+
+    struct SoundIoListDevicePtr *device_list = (node->aim == SoundIoDeviceAimOutput) ?
+        &devices_info->output_devices : &devices_info->input_devices;
+    if (SoundIoListDevicePtr_append(device_list, device)) {
+        soundio_device_unref(device);
+        return SoundIoErrorNoMem;
+    }
+    return 0;
+}
+
+static int find_default_index(struct SoundIoListDevicePtr *devices, const char *default_name) {
+    if (devices->length == 0)
+        return -1;
+    if (default_name) {
+        for (int i = 0; i < devices->length; i += 1) {
+            struct SoundIoDevice *device = SoundIoListDevicePtr_val_at(devices, i);
+            if (strcmp(device->id, default_name) == 0)
+                return i;
+        }
+    }
+    return 0;
+}
+
+// call this while holding the thread loop lock
+static int refresh_devices(struct SoundIoPrivate *si, struct SoundIoDevicesInfo **out_devices_info) {
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    int err;
+
+    struct SoundIoDevicesInfo *devices_info = ALLOCATE(struct SoundIoDevicesInfo, 1);
+    if (!devices_info)
+        return SoundIoErrorNoMem;
+
+    for (int i = 0; i < sipw->nodes.length; i += 1) {
+        struct SoundIoPipeWireNode *node = SoundIoListPipeWireNodePtr_val_at(&sipw->nodes, i);
+        if ((err = create_device(si, devices_info, node))) {
+            soundio_destroy_devices_info(devices_info);
+            return err;
+        }
+    }
+
+    devices_info->default_output_index = find_default_index(&devices_info->output_devices,
+            sipw->default_sink_name);
+    devices_info->default_input_index = find_default_index(&devices_info->input_devices,
+            sipw->default_source_name);
+
+    *out_devices_info = devices_info;
+    return 0;
+}
+
+static void my_flush_events(struct SoundIoPrivate *si, bool wait) {
+    struct SoundIo *soundio = &si->pub;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    bool change = false;
+    bool cb_shutdown = false;
+    struct SoundIoDevicesInfo *old_devices_info = NULL;
+    struct SoundIoDevicesInfo *new_devices_info = NULL;
+
+    pw_thread_loop_lock(sipw->loop);
+
+    if (wait)
+        pw_thread_loop_wait(sipw->loop);
+
+    if (sipw->devices_changed && !sipw->connection_err) {
+        sipw->devices_changed = false;
+        sipw->connection_err = refresh_devices(si, &new_devices_info);
+    }
+
+    if (sipw->connection_err && !sipw->emitted_shutdown_cb) {
+        sipw->emitted_shutdown_cb = true;
+        cb_shutdown = true;
+    } else if (new_devices_info) {
+        old_devices_info = si->safe_devices_info;
+        si->safe_devices_info = new_devices_info;
+        new_devices_info = NULL;
+        change = true;
+    }
+
+    pw_thread_loop_unlock(sipw->loop);
+
+    if (cb_shutdown)
+        soundio->on_backend_disconnect(soundio, sipw->connection_err);
+    else if (change)
+        soundio->on_devices_change(soundio);
+
+    soundio_destroy_devices_info(old_devices_info);
+    soundio_destroy_devices_info(new_devices_info);
+}
+
+static void flush_events_pw(struct SoundIoPrivate *si) {
+    my_flush_events(si, false);
+}
+
+static void wait_events_pw(struct SoundIoPrivate *si) {
+    my_flush_events(si, false);
+    my_flush_events(si, true);
+}
+
+static void wakeup_pw(struct SoundIoPrivate *si) {
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    pw_thread_loop_lock(sipw->loop);
+    pw_thread_loop_signal(sipw->loop, false);
+    pw_thread_loop_unlock(sipw->loop);
+}
+
+static void force_device_scan_pw(struct SoundIoPrivate *si) {
+    struct SoundIo *soundio = &si->pub;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    pw_thread_loop_lock(sipw->loop);
+    sipw->devices_changed = true;
+    pw_thread_loop_signal(sipw->loop, false);
+    soundio_emit_events_signal(soundio);
+    pw_thread_loop_unlock(sipw->loop);
+}
+
+static enum spa_audio_format to_pipewire_format(enum SoundIoFormat format) {
+    switch (format) {
+    case SoundIoFormatS8:           return SPA_AUDIO_FORMAT_S8;
+    case SoundIoFormatU8:           return SPA_AUDIO_FORMAT_U8;
+    case SoundIoFormatS16LE:        return SPA_AUDIO_FORMAT_S16_LE;
+    case SoundIoFormatS16BE:        return SPA_AUDIO_FORMAT_S16_BE;
+    case SoundIoFormatU16LE:        return SPA_AUDIO_FORMAT_U16_LE;
+    case SoundIoFormatU16BE:        return SPA_AUDIO_FORMAT_U16_BE;
+    case SoundIoFormatS24LE:        return SPA_AUDIO_FORMAT_S24_32_LE;
+    case SoundIoFormatS24BE:        return SPA_AUDIO_FORMAT_S24_32_BE;
+    case SoundIoFormatU24LE:        return SPA_AUDIO_FORMAT_U24_32_LE;
+    case SoundIoFormatU24BE:        return SPA_AUDIO_FORMAT_U24_32_BE;
+    case SoundIoFormatS24PackedLE:  return SPA_AUDIO_FORMAT_S24_LE;
+    case SoundIoFormatS24PackedBE:  return SPA_AUDIO_FORMAT_S24_BE;
+    case SoundIoFormatU24PackedLE:  return SPA_AUDIO_FORMAT_U24_LE;
+    case SoundIoFormatU24PackedBE:  return SPA_AUDIO_FORMAT_U24_BE;
+    case SoundIoFormatS32LE:        return SPA_AUDIO_FORMAT_S32_LE;
+    case SoundIoFormatS32BE:        return SPA_AUDIO_FORMAT_S32_BE;
+    case SoundIoFormatU32LE:        return SPA_AUDIO_FORMAT_U32_LE;
+    case SoundIoFormatU32BE:        return SPA_AUDIO_FORMAT_U32_BE;
+    case SoundIoFormatFloat32LE:    return SPA_AUDIO_FORMAT_F32_LE;
+    case SoundIoFormatFloat32BE:    return SPA_AUDIO_FORMAT_F32_BE;
+    case SoundIoFormatFloat64LE:    return SPA_AUDIO_FORMAT_F64_LE;
+    case SoundIoFormatFloat64BE:    return SPA_AUDIO_FORMAT_F64_BE;
+
+    case SoundIoFormatInvalid:
+        return SPA_AUDIO_FORMAT_UNKNOWN;
+    }
+    return SPA_AUDIO_FORMAT_UNKNOWN;
+}
+
+static uint32_t to_pipewire_channel_pos(enum SoundIoChannelId channel_id) {
+    if (channel_id >= SoundIoChannelIdAux0 && channel_id <= SoundIoChannelIdAux15)
+        return SPA_AUDIO_CHANNEL_AUX0 + (channel_id - SoundIoChannelIdAux0);
+
+    switch (channel_id) {
+    case SoundIoChannelIdFrontLeft: return SPA_AUDIO_CHANNEL_FL;
+    case SoundIoChannelIdFrontRight: return SPA_AUDIO_CHANNEL_FR;
+    case SoundIoChannelIdFrontCenter: return SPA_AUDIO_CHANNEL_FC;
+    case SoundIoChannelIdLfe: return SPA_AUDIO_CHANNEL_LFE;
+    case SoundIoChannelIdBackLeft: return SPA_AUDIO_CHANNEL_RL;
+    case SoundIoChannelIdBackRight: return SPA_AUDIO_CHANNEL_RR;
+    case SoundIoChannelIdFrontLeftCenter: return SPA_AUDIO_CHANNEL_FLC;
+    case SoundIoChannelIdFrontRightCenter: return SPA_AUDIO_CHANNEL_FRC;
+    case SoundIoChannelIdBackCenter: return SPA_AUDIO_CHANNEL_RC;
+    case SoundIoChannelIdSideLeft: return SPA_AUDIO_CHANNEL_SL;
+    case SoundIoChannelIdSideRight: return SPA_AUDIO_CHANNEL_SR;
+    case SoundIoChannelIdTopCenter: return SPA_AUDIO_CHANNEL_TC;
+    case SoundIoChannelIdTopFrontLeft: return SPA_AUDIO_CHANNEL_TFL;
+    case SoundIoChannelIdTopFrontCenter: return SPA_AUDIO_CHANNEL_TFC;
+    case SoundIoChannelIdTopFrontRight: return SPA_AUDIO_CHANNEL_TFR;
+    case SoundIoChannelIdTopBackLeft: return SPA_AUDIO_CHANNEL_TRL;
+    case SoundIoChannelIdTopBackCenter: return SPA_AUDIO_CHANNEL_TRC;
+    case SoundIoChannelIdTopBackRight: return SPA_AUDIO_CHANNEL_TRR;
+    case SoundIoChannelIdBackLeftCenter: return SPA_AUDIO_CHANNEL_RLC;
+    case SoundIoChannelIdBackRightCenter: return SPA_AUDIO_CHANNEL_RRC;
+    case SoundIoChannelIdFrontLeftWide: return SPA_AUDIO_CHANNEL_FLW;
+    case SoundIoChannelIdFrontRightWide: return SPA_AUDIO_CHANNEL_FRW;
+    case SoundIoChannelIdFrontLeftHigh: return SPA_AUDIO_CHANNEL_FLH;
+    case SoundIoChannelIdFrontCenterHigh: return SPA_AUDIO_CHANNEL_FCH;
+    case SoundIoChannelIdFrontRightHigh: return SPA_AUDIO_CHANNEL_FRH;
+    case SoundIoChannelIdTopFrontLeftCenter: return SPA_AUDIO_CHANNEL_TFLC;
+    case SoundIoChannelIdTopFrontRightCenter: return SPA_AUDIO_CHANNEL_TFRC;
+    case SoundIoChannelIdTopSideLeft: return SPA_AUDIO_CHANNEL_TSL;
+    case SoundIoChannelIdTopSideRight: return SPA_AUDIO_CHANNEL_TSR;
+    case SoundIoChannelIdLeftLfe: return SPA_AUDIO_CHANNEL_LLFE;
+    case SoundIoChannelIdRightLfe: return SPA_AUDIO_CHANNEL_RLFE;
+    case SoundIoChannelIdLfe2: return SPA_AUDIO_CHANNEL_LFE2;
+    case SoundIoChannelIdBottomCenter: return SPA_AUDIO_CHANNEL_BC;
+    case SoundIoChannelIdBottomLeftCenter: return SPA_AUDIO_CHANNEL_BLC;
+    case SoundIoChannelIdBottomRightCenter: return SPA_AUDIO_CHANNEL_BRC;
+    case SoundIoChannelIdAux: return SPA_AUDIO_CHANNEL_AUX0;
+
+    default:
+        return SPA_AUDIO_CHANNEL_UNKNOWN;
+    }
+}
+
+static const struct spa_pod *build_format_param(struct spa_pod_builder *builder,
+        enum SoundIoFormat format, int sample_rate, const struct SoundIoChannelLayout *layout)
+{
+    struct spa_audio_info_raw info;
+    memset(&info, 0, sizeof(info));
+    info.format = to_pipewire_format(format);
+    info.rate = sample_rate;
+    info.channels = layout->channel_count;
+    for (int ch = 0; ch < layout->channel_count; ch += 1)
+        info.position[ch] = to_pipewire_channel_pos(layout->channels[ch]);
+    return spa_format_audio_raw_build(builder, SPA_PARAM_EnumFormat, &info);
+}
+
+// Asks for buffers that hold one period each so the graph cannot queue more
+// audio than software_latency. Shared memory (memfd) buffers are mapped
+// directly into our address space; MemPtr is only accepted as a fallback.
+static const struct spa_pod *build_buffers_param(struct spa_pod_builder *builder,
+        int bytes_per_frame, int period_frames)
+{
+    struct spa_pod_frame frame;
+    spa_pod_builder_push_object(builder, &frame, SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers);
+    spa_pod_builder_prop(builder, SPA_PARAM_BUFFERS_buffers, 0);
+    spa_pod_builder_int(builder, 2);
+    spa_pod_builder_prop(builder, SPA_PARAM_BUFFERS_blocks, 0);
+    spa_pod_builder_int(builder, 1);
+    spa_pod_builder_prop(builder, SPA_PARAM_BUFFERS_size, 0);
+    spa_pod_builder_int(builder, bytes_per_frame * period_frames);
+    spa_pod_builder_prop(builder, SPA_PARAM_BUFFERS_stride, 0);
+    spa_pod_builder_int(builder, bytes_per_frame);
+    spa_pod_builder_prop(builder, SPA_PARAM_BUFFERS_dataType, 0);
+    spa_pod_builder_int(builder, (1 << SPA_DATA_MemFd) | (1 << SPA_DATA_MemPtr));
+    return (const struct spa_pod *)spa_pod_builder_pop(builder, &frame);
+}
+
+static int to_period_frames(double software_latency, int sample_rate) {
+    if (software_latency <= 0.0)
+        return default_period_frames;
+    int frames = ceil_dbl_to_int(software_latency * sample_rate);
+    return soundio_int_min(soundio_int_max(frames, min_period_frames), max_period_frames);
+}
+
+static struct pw_properties *create_stream_props(const char *category, const char *target,
+        int period_frames, int sample_rate)
+{
+    struct pw_properties *props = pw_properties_new(
+            PW_KEY_MEDIA_TYPE, "Audio",
+            PW_KEY_MEDIA_CATEGORY, category,
+            NULL);
+    if (!props)
+        return NULL;
+    pw_properties_setf(props, PW_KEY_NODE_LATENCY, "%d/%d", period_frames, sample_rate);
+    if (target)
+        pw_properties_set(props, PW_KEY_TARGET_OBJECT, target);
+    return props;
+}
+
+static void count_buffer_kind(struct SoundIoStreamCounters *counters, const struct spa_data *d) {
+    if (d->type == SPA_DATA_MemFd || d->type == SPA_DATA_DmaBuf)
+        SOUNDIO_ATOMIC_FETCH_ADD(counters->zero_copy_periods, 1);
+    else
+        SOUNDIO_ATOMIC_FETCH_ADD(counters->copy_periods, 1);
+}
+
+static double stream_lateness(struct pw_stream *stream) {
+    struct pw_time time;
+    if (pw_stream_get_time_n(stream, &time, sizeof(time)) || time.now == 0)
+        return -1.0;
+    return (pw_stream_get_nsec(stream) - time.now) / 1000000000.0;
+}
+
+static double stream_latency(struct pw_stream *stream, int bytes_per_frame, int sample_rate) {
+    struct pw_time time;
+    if (pw_stream_get_time_n(stream, &time, sizeof(time)) || time.rate.denom == 0)
+        return 0.0;
+    double graph_delay = time.delay * (double)time.rate.num / (double)time.rate.denom;
+    double queued = (time.queued / (double)bytes_per_frame + time.buffered) / (double)sample_rate;
+    return graph_delay + queued;
+}
+
+// The process callbacks run on the data loop because of
+// PW_STREAM_FLAG_RT_PROCESS. Pausing or clearing from there, which the API
+// allows from the write and read callbacks, must neither take the thread
+// loop lock nor touch the stream's control side, so the call is handed to
+// the main loop instead.
+enum DeferredStreamOpKind {
+    DeferredStreamOpActivate,
+    DeferredStreamOpDeactivate,
+    DeferredStreamOpFlush,
+};
+
+struct DeferredStreamOp {
+    // points into the stream's backend data; NULL once the stream is gone
+    struct pw_stream **stream;
+    enum DeferredStreamOpKind kind;
+};
+
+static int run_deferred_stream_op(struct spa_loop *loop, bool async, uint32_t seq,
+        const void *data, size_t size, void *user_data)
+{
+    const struct DeferredStreamOp *op = (const struct DeferredStreamOp *)data;
+    struct pw_stream *stream = *op->stream;
+    if (!stream)
+        return 0;
+    switch (op->kind) {
+        case DeferredStreamOpActivate: return pw_stream_set_active(stream, true);
+        case DeferredStreamOpDeactivate: return pw_stream_set_active(stream, false);
+        case DeferredStreamOpFlush: return pw_stream_flush(stream, false);
+    }
+    return 0;
+}
+
+// Runs `kind` right away under the thread loop lock, or queues it on the
+// main loop when called from inside a process callback.
+static enum SoundIoError stream_op(struct SoundIoPipeWire *sipw, struct pw_stream **stream,
+        struct SoundIoAtomicBool *in_process, enum DeferredStreamOpKind kind)
+{
+    struct DeferredStreamOp op = {stream, kind};
+    int err;
+    if (SOUNDIO_ATOMIC_LOAD(*in_process)) {
+        err = pw_loop_invoke(pw_thread_loop_get_loop(sipw->loop), run_deferred_stream_op,
+                SPA_ID_INVALID, &op, sizeof(op), false, NULL);
+    } else {
+        bool in_thread = pw_thread_loop_in_thread(sipw->loop);
+        if (!in_thread)
+            pw_thread_loop_lock(sipw->loop);
+        err = run_deferred_stream_op(NULL, false, 0, &op, sizeof(op), NULL);
+        if (!in_thread)
+            pw_thread_loop_unlock(sipw->loop);
+    }
+    return (err < 0) ? SoundIoErrorStreaming : SoundIoErrorNone;
+}
+
+// Waits until the main loop has run everything queued by stream_op, so that
+// none of it reaches a stream whose memory is gone. Call without the thread
+// loop lock.
+static void drain_deferred_stream_ops(struct SoundIoPipeWire *sipw) {
+    pw_loop_invoke(pw_thread_loop_get_loop(sipw->loop), NULL, SPA_ID_INVALID, NULL, 0, true, NULL);
+}
+
+static void outstream_state_changed_callback(void *data, enum pw_stream_state old,
+        enum pw_stream_state state, const char *error)
+{
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)data;
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)outstream->device->soundio;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    ospw->state = state;
+    pw_thread_loop_signal(sipw->loop, false);
+
+    if (state == PW_STREAM_STATE_ERROR && ospw->opened)
+        outstream->error_callback(outstream, SoundIoErrorStreaming);
+}
+
+static void outstream_param_changed_callback(void *data, uint32_t id, const struct spa_pod *param) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)data;
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+
+    if (!param || id != SPA_PARAM_Format)
+        return;
+
+    uint8_t buffer[1024];
+    struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+    const struct spa_pod *params[1];
+    params[0] = build_buffers_param(&builder, outstream->bytes_per_frame, ospw->period_frames);
+    pw_stream_update_params(ospw->stream, params, 1);
+}
+
+static void outstream_process_callback(void *data) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)data;
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+
+    struct pw_buffer *b = pw_stream_dequeue_buffer(ospw->stream);
+    if (!b) {
+        soundio_outstream_invoke_underflow(outstream);
+        return;
+    }
+    struct spa_data *d = &b->buffer->datas[0];
+    if (!d->data) {
+        pw_stream_queue_buffer(ospw->stream, b);
+        return;
+    }
+
+    soundio_outstream_record_wakeup(outstream, stream_lateness(ospw->stream));
+
+    int frame_count = d->maxsize / outstream->bytes_per_frame;
+    if (b->requested > 0)
+        frame_count = soundio_int_min(frame_count, (int)b->requested);
+
+    ospw->buffer = b;
+    ospw->buffer_frame_count = frame_count;
+    ospw->frames_written = 0;
+    SOUNDIO_ATOMIC_STORE(ospw->in_process, true);
+    soundio_outstream_invoke_write(outstream, frame_count, frame_count);
+    SOUNDIO_ATOMIC_STORE(ospw->in_process, false);
+
+    d->chunk->offset = 0;
+    d->chunk->stride = outstream->bytes_per_frame;
+    d->chunk->size = ospw->frames_written * outstream->bytes_per_frame;
+    ospw->buffer = NULL;
+    pw_stream_queue_buffer(ospw->stream, b);
+
+    count_buffer_kind(&os->counters, d);
+}
+
+static const struct pw_stream_events outstream_events = {
+    .version = PW_VERSION_STREAM_EVENTS,
+    .state_changed = outstream_state_changed_callback,
+    .param_changed = outstream_param_changed_callback,
+    .process = outstream_process_callback,
+};
+
+static void outstream_destroy_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (ospw->stream) {
+        pw_thread_loop_lock(sipw->loop);
+        spa_hook_remove(&ospw->stream_listener);
+        pw_stream_destroy(ospw->stream);
+        ospw->stream = NULL;
+        pw_thread_loop_unlock(sipw->loop);
+        drain_deferred_stream_ops(sipw);
+    }
+}
+
+static enum SoundIoError outstream_open_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if ((unsigned)outstream->layout.channel_count > SPA_AUDIO_MAX_CHANNELS)
+        return SoundIoErrorIncompatibleBackend;
+
+    if (!outstream->name)
+        outstream->name = "SoundIoOutStream";
+
+    ospw->period_frames = to_period_frames(outstream->software_latency, outstream->sample_rate);
+    outstream->software_latency = ospw->period_frames / (double)outstream->sample_rate;
+
+    struct pw_properties *props = create_stream_props("Playback", outstream->device->id,
+            ospw->period_frames, outstream->sample_rate);
+    if (!props)
+        return SoundIoErrorNoMem;
+
+    pw_thread_loop_lock(sipw->loop);
+
+    ospw->state = PW_STREAM_STATE_UNCONNECTED;
+    ospw->stream = pw_stream_new(sipw->core, outstream->name, props);
+    if (!ospw->stream) {
+        pw_thread_loop_unlock(sipw->loop);
+        return SoundIoErrorNoMem;
+    }
+    pw_stream_add_listener(ospw->stream, &ospw->stream_listener, &outstream_events, os);
+
+    uint8_t buffer[1024];
+    struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+    const struct spa_pod *params[1];
+    params[0] = build_format_param(&builder, outstream->format, outstream->sample_rate,
+            &outstream->layout);
+
+    enum pw_stream_flags flags = (enum pw_stream_flags)(PW_STREAM_FLAG_AUTOCONNECT |
+            PW_STREAM_FLAG_MAP_BUFFERS | PW_STREAM_FLAG_RT_PROCESS | PW_STREAM_FLAG_INACTIVE);
+    if (pw_stream_connect(ospw->stream, PW_DIRECTION_OUTPUT, PW_ID_ANY, flags, params, 1)) {
+        pw_thread_loop_unlock(sipw->loop);
+        outstream_destroy_pw(si, os);
+        return SoundIoErrorOpeningDevice;
+    }
+
+    while (ospw->state != PW_STREAM_STATE_PAUSED && ospw->state != PW_STREAM_STATE_STREAMING &&
+            ospw->state != PW_STREAM_STATE_ERROR && !sipw->connection_err)
+    {
+        pw_thread_loop_wait(sipw->loop);
+    }
+    bool failed = ospw->state == PW_STREAM_STATE_ERROR || sipw->connection_err;
+    ospw->opened = true;
+
+    pw_thread_loop_unlock(sipw->loop);
+
+    if (failed) {
+        outstream_destroy_pw(si, os);
+        return SoundIoErrorOpeningDevice;
+    }
+    return 0;
+}
+
+static enum SoundIoError outstream_pause_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os, bool pause) {
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    return stream_op(sipw, &ospw->stream, &ospw->in_process,
+            pause ? DeferredStreamOpDeactivate : DeferredStreamOpActivate);
+}
+
+static enum SoundIoError outstream_start_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
+    return outstream_pause_pw(si, os, false);
+}
+
+static enum SoundIoError outstream_begin_write_pw(struct SoundIoPrivate *si,
+        struct SoundIoOutStreamPrivate *os, struct SoundIoChannelArea **out_areas, int *frame_count)
+{
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+
+    if (!ospw->buffer)
+        return SoundIoErrorInvalid;
+
+    ospw->write_frame_count = soundio_int_min(*frame_count,
+            ospw->buffer_frame_count - ospw->frames_written);
+    char *base = (char *)ospw->buffer->buffer->datas[0].data +
+        ospw->frames_written * outstream->bytes_per_frame;
+    for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
+        ospw->areas[ch].ptr = base + outstream->bytes_per_sample * ch;
+        ospw->areas[ch].step = outstream->bytes_per_frame;
+    }
+
+    *frame_count = ospw->write_frame_count;
+    *out_areas = ospw->areas;
+    return 0;
+}
+
+static enum SoundIoError outstream_end_write_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    ospw->frames_written += ospw->write_frame_count;
+    ospw->write_frame_count = 0;
+    return 0;
+}
+
+static enum SoundIoError outstream_clear_buffer_pw(struct SoundIoPrivate *si,
+        struct SoundIoOutStreamPrivate *os)
+{
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    return stream_op(sipw, &ospw->stream, &ospw->in_process, DeferredStreamOpFlush);
+}
+
+static enum SoundIoError outstream_get_latency_pw(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os,
+        double *out_latency)
+{
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPipeWire *ospw = &os->backend_data.pipewire;
+    *out_latency = stream_latency(ospw->stream, outstream->bytes_per_frame, outstream->sample_rate);
+    return 0;
+}
+
+static void instream_state_changed_callback(void *data, enum pw_stream_state old,
+        enum pw_stream_state state, const char *error)
+{
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)data;
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)instream->device->soundio;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    ispw->state = state;
+    pw_thread_loop_signal(sipw->loop, false);
+
+    if (state == PW_STREAM_STATE_ERROR && ispw->opened)
+        instream->error_callback(instream, SoundIoErrorStreaming);
+}
+
+static void instream_param_changed_callback(void *data, uint32_t id, const struct spa_pod *param) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)data;
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+
+    if (!param || id != SPA_PARAM_Format)
+        return;
+
+    uint8_t buffer[1024];
+    struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+    const struct spa_pod *params[1];
+    params[0] = build_buffers_param(&builder, instream->bytes_per_frame, ispw->period_frames);
+    pw_stream_update_params(ispw->stream, params, 1);
+}
+
+static void instream_process_callback(void *data) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)data;
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+
+    struct pw_buffer *b = pw_stream_dequeue_buffer(ispw->stream);
+    if (!b) {
+        soundio_instream_invoke_overflow(instream);
+        return;
+    }
+    struct spa_data *d = &b->buffer->datas[0];
+
+    soundio_instream_record_wakeup(instream, stream_lateness(ispw->stream));
+
+    uint32_t offset = soundio_int_min(d->chunk->offset, d->maxsize);
+    uint32_t size = soundio_int_min(d->chunk->size, d->maxsize - offset);
+    int frame_count = size / instream->bytes_per_frame;
+
+    // a buffer without memory is a hole; report it as silence
+    ispw->read_base = d->data ? (char *)d->data + offset : NULL;
+    ispw->buffer_frame_count = frame_count;
+    ispw->frames_read = 0;
+    SOUNDIO_ATOMIC_STORE(ispw->in_process, true);
+    if (frame_count > 0)
+        soundio_instream_invoke_read(instream, frame_count, frame_count);
+    SOUNDIO_ATOMIC_STORE(ispw->in_process, false);
+    ispw->read_base = NULL;
+    pw_stream_queue_buffer(ispw->stream, b);
+
+    count_buffer_kind(&is->counters, d);
+}
+
+static const struct pw_stream_events instream_events = {
+    .version = PW_VERSION_STREAM_EVENTS,
+    .state_changed = instream_state_changed_callback,
+    .param_changed = instream_param_changed_callback,
+    .process = instream_process_callback,
+};
+
+static void instream_destroy_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if (ispw->stream) {
+        pw_thread_loop_lock(sipw->loop);
+        spa_hook_remove(&ispw->stream_listener);
+        pw_stream_destroy(ispw->stream);
+        ispw->stream = NULL;
+        pw_thread_loop_unlock(sipw->loop);
+        drain_deferred_stream_ops(sipw);
+    }
+}
+
+static enum SoundIoError instream_open_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+
+    if ((unsigned)instream->layout.channel_count > SPA_AUDIO_MAX_CHANNELS)
+        return SoundIoErrorIncompatibleBackend;
+
+    if (!instream->name)
+        instream->name = "SoundIoInStream";
+
+    ispw->period_frames = to_period_frames(instream->software_latency, instream->sample_rate);
+    instream->software_latency = ispw->period_frames / (double)instream->sample_rate;
+
+    struct pw_properties *props = create_stream_props("Capture", instream->device->id,
+            ispw->period_frames, instream->sample_rate);
+    if (!props)
+        return SoundIoErrorNoMem;
+
+    pw_thread_loop_lock(sipw->loop);
+
+    ispw->state = PW_STREAM_STATE_UNCONNECTED;
+    ispw->stream = pw_stream_new(sipw->core, instream->name, props);
+    if (!ispw->stream) {
+        pw_thread_loop_unlock(sipw->loop);
+        return SoundIoErrorNoMem;
+    }
+    pw_stream_add_listener(ispw->stream, &ispw->stream_listener, &instream_events, is);
+
+    uint8_t buffer[1024];
+    struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+    const struct spa_pod *params[1];
+    params[0] = build_format_param(&builder, instream->format, instream->sample_rate,
+            &instream->layout);
+
+    enum pw_stream_flags flags = (enum pw_stream_flags)(PW_STREAM_FLAG_AUTOCONNECT |
+            PW_STREAM_FLAG_MAP_BUFFERS | PW_STREAM_FLAG_RT_PROCESS | PW_STREAM_FLAG_INACTIVE);
+    if (pw_stream_connect(ispw->stream, PW_DIRECTION_INPUT, PW_ID_ANY, flags, params, 1)) {
+        pw_thread_loop_unlock(sipw->loop);
+        instream_destroy_pw(si, is);
+        return SoundIoErrorOpeningDevice;
+    }
+
+    while (ispw->state != PW_STREAM_STATE_PAUSED && ispw->state != PW_STREAM_STATE_STREAMING &&
+            ispw->state != PW_STREAM_STATE_ERROR && !sipw->connection_err)
+    {
+        pw_thread_loop_wait(sipw->loop);
+    }
+    bool failed = ispw->state == PW_STREAM_STATE_ERROR || sipw->connection_err;
+    ispw->opened = true;
+
+    pw_thread_loop_unlock(sipw->loop);
+
+    if (failed) {
+        instream_destroy_pw(si, is);
+        return SoundIoErrorOpeningDevice;
+    }
+    return 0;
+}
+
+static enum SoundIoError instream_pause_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is, bool pause) {
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    return stream_op(sipw, &ispw->stream, &ispw->in_process,
+            pause ? DeferredStreamOpDeactivate : DeferredStreamOpActivate);
+}
+
+static enum SoundIoError instream_start_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
+    return instream_pause_pw(si, is, false);
+}
+
+static enum SoundIoError instream_begin_read_pw(struct SoundIoPrivate *si,
+        struct SoundIoInStreamPrivate *is, struct SoundIoChannelArea **out_areas, int *frame_count)
+{
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+
+    ispw->read_frame_count = soundio_int_min(*frame_count,
+            ispw->buffer_frame_count - ispw->frames_read);
+    *frame_count = ispw->read_frame_count;
+
+    if (!ispw->read_base) {
+        *out_areas = NULL;
+        return 0;
+    }
+
+    char *base = ispw->read_base + ispw->frames_read * instream->bytes_per_frame;
+    for (int ch = 0; ch < instream->layout.channel_count; ch += 1) {
+        ispw->areas[ch].ptr = base + instream->bytes_per_sample * ch;
+        ispw->areas[ch].step = instream->bytes_per_frame;
+    }
+    *out_areas = ispw->areas;
+    return 0;
+}
+
+static enum SoundIoError instream_end_read_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    ispw->frames_read += ispw->read_frame_count;
+    ispw->read_frame_count = 0;
+    return 0;
+}
+
+static enum SoundIoError instream_get_latency_pw(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is,
+        double *out_latency)
+{
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamPipeWire *ispw = &is->backend_data.pipewire;
+    *out_latency = stream_latency(ispw->stream, instream->bytes_per_frame, instream->sample_rate);
+    return 0;
+}
+
+enum SoundIoError soundio_pipewire_init(struct SoundIoPrivate *si) {
+    struct SoundIo *soundio = &si->pub;
+    struct SoundIoPipeWire *sipw = &si->backend_data.pipewire;
+    int err;
+
+    pw_init(NULL, NULL);
+
+    sipw->loop = pw_thread_loop_new("libsoundio", NULL);
+    if (!sipw->loop) {
+        destroy_pw(si);
+        return SoundIoErrorNoMem;
+    }
+
+    sipw->context = pw_context_new(pw_thread_loop_get_loop(sipw->loop), NULL, 0);
+    if (!sipw->context) {
+        destroy_pw(si);
+        return SoundIoErrorNoMem;
+    }
+
+    struct pw_properties *props = pw_properties_new(PW_KEY_APP_NAME, soundio->app_name, NULL);
+    if (!props) {
+        destroy_pw(si);
+        return SoundIoErrorNoMem;
+    }
+
+    // fails right away when no daemon is listening on the socket
+    sipw->core = pw_context_connect(sipw->context, props, 0);
+    if (!sipw->core) {
+        destroy_pw(si);
+        return SoundIoErrorInitAudioBackend;
+    }
+    pw_core_add_listener(sipw->core, &sipw->core_listener, &core_events, si);
+
+    sipw->registry = pw_core_get_registry(sipw->core, PW_VERSION_REGISTRY, 0);
+    if (!sipw->registry) {
+        destroy_pw(si);
+        return SoundIoErrorNoMem;
+    }
+    pw_registry_add_listener(sipw->registry, &sipw->registry_listener, &registry_events, si);
+
+    if (pw_thread_loop_start(sipw->loop)) {
+        destroy_pw(si);
+        return SoundIoErrorNoMem;
+    }
+
+    pw_thread_loop_lock(sipw->loop);
+
+    // The first roundtrip delivers the existing globals, the second one the
+    // properties of the default metadata bound while handling them.
+    if ((err = roundtrip(si)) || (err = roundtrip(si))) {
+        pw_thread_loop_unlock(sipw->loop);
+        destroy_pw(si);
+        return (err == SoundIoErrorBackendDisconnected) ? SoundIoErrorInitAudioBackend : err;
+    }
+    sipw->devices_changed = true;
+
+    pw_thread_loop_unlock(sipw->loop);
+
+    si->destroy = destroy_pw;
+    si->flush_events = flush_events_pw;
+    si->wait_events = wait_events_pw;
+    si->wakeup = wakeup_pw;
+    si->force_device_scan = force_device_scan_pw;
+
+    si->outstream_open = outstream_open_pw;
+    si->outstream_destroy = outstream_destroy_pw;
+    si->outstream_start = outstream_start_pw;
+    si->outstream_begin_write = outstream_begin_write_pw;
+    si->outstream_end_write = outstream_end_write_pw;
+    si->outstream_clear_buffer = outstream_clear_buffer_pw;
+    si->outstream_pause = outstream_pause_pw;
+    si->outstream_get_latency = outstream_get_latency_pw;
+
+    si->instream_open = instream_open_pw;
+    si->instream_destroy = instream_destroy_pw;
+    si->instream_start = instream_start_pw;
+    si->instream_begin_read = instream_begin_read_pw;
+    si->instream_end_read = instream_end_read_pw;
+    si->instream_pause = instream_pause_pw;
+    si->instream_get_latency = instream_get_latency_pw;
+
+    return 0;
+}
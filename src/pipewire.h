@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_PIPEWIRE_H
+#define SOUNDIO_PIPEWIRE_H
+
+#include "soundio_internal.h"
+#include "list.h"
+#include "atomics.h"
+
+#include <stdint.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#include <pipewire/pipewire.h>
+#include <pipewire/extensions/metadata.h>
+#pragma GCC diagnostic pop
+
+struct SoundIoPrivate;
+enum SoundIoError soundio_pipewire_init(struct SoundIoPrivate *si);
+
+struct SoundIoDevicePipeWire { int make_the_struct_not_empty; };
+
+// An audio sink or source seen on the registry.
+struct SoundIoPipeWireNode {
+    uint32_t id;
+    enum SoundIoDeviceAim aim;
+    char *name;
+    char *description;
+};
+
+SOUNDIO_MAKE_LIST_STRUCT(struct SoundIoPipeWireNode *, SoundIoListPipeWireNodePtr, SOUNDIO_LIST_STATIC)
+
+struct SoundIoPipeWire {
+    struct pw_thread_loop *loop;
+    struct pw_context *context;
+    struct pw_core *core;
+    struct spa_hook core_listener;
+    struct pw_registry *registry;
+    struct spa_hook registry_listener;
+    struct pw_metadata *metadata;
+    uint32_t metadata_id;
+    struct spa_hook metadata_listener;
+
+    // everything below is protected by the thread loop lock
+    struct SoundIoListPipeWireNodePtr nodes;
+    char *default_sink_name;
+    char *default_source_name;
+    int pending_sync;
+    bool sync_done;
+    bool devices_changed;
+    enum SoundIoError connection_err;
+    bool emitted_shutdown_cb;
+};
+
+struct SoundIoOutStreamPipeWire {
+    struct pw_stream *stream;
+    struct spa_hook stream_listener;
+    enum pw_stream_state state;
+    bool opened;
+    int period_frames;
+    // set while the process callback runs on the data loop
+    struct SoundIoAtomicBool in_process;
+    // the buffer being filled during the process callback
+    struct pw_buffer *buffer;
+    int buffer_frame_count;
+    int frames_written;
+    int write_frame_count;
+    struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
+};
+
+struct SoundIoInStreamPipeWire {
+    struct pw_stream *stream;
+    struct spa_hook stream_listener;
+    enum pw_stream_state state;
+    bool opened;
+    int period_frames;
+    // set while the process callback runs on the data loop
+    struct SoundIoAtomicBool in_process;
+    // the buffer being read during the process callback
+    char *read_base;
+    int buffer_frame_count;
+    int frames_read;
+    int read_frame_count;
+    struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
+};
+
+#endif
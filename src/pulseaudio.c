@@ -20,7 +20,7 @@ static void subscribe_callback(pa_context *context,
     struct SoundIoPulseAudio *sipa = &si->backend_data.pulseaudio;
     sipa->device_scan_queued = true;
     pa_threaded_mainloop_signal(sipa->main_loop, 0);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
 }
 
 static int subscribe_to_events(struct SoundIoPrivate *si) {
@@ -63,7 +63,7 @@ static void context_state_callback(pa_context *context, void *userdata) {
             sipa->ready_flag = true;
         }
         pa_threaded_mainloop_signal(sipa->main_loop, 0);
-        soundio->on_events_signal(soundio);
+        soundio_emit_events_signal(soundio);
         return;
     }
 }
@@ -443,7 +443,7 @@ static int refresh_devices(struct SoundIoPrivate *si) {
     sipa->ready_devices_info = sipa->current_devices_info;
     sipa->current_devices_info = NULL;
     pa_threaded_mainloop_signal(sipa->main_loop, 0);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
 
     return 0;
 }
@@ -509,7 +509,7 @@ static void force_device_scan_pa(struct SoundIoPrivate *si) {
     pa_threaded_mainloop_lock(sipa->main_loop);
     sipa->device_scan_queued = true;
     pa_threaded_mainloop_signal(sipa->main_loop, 0);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     pa_threaded_mainloop_unlock(sipa->main_loop);
 }
 
@@ -621,16 +621,43 @@ static void playback_stream_state_callback(pa_stream *stream, void *userdata) {
     }
 }
 
+// A period is zero-copy when the application wrote it straight into one
+// block of the server's memory pool, or read it from one fragment of the
+// size asked for. Blocks cut short and holes mean the period was split.
+static void count_period(struct SoundIoStreamCounters *counters, bool split) {
+    if (split)
+        SOUNDIO_ATOMIC_FETCH_ADD(counters->copy_periods, 1);
+    else
+        SOUNDIO_ATOMIC_FETCH_ADD(counters->zero_copy_periods, 1);
+}
+
 static void playback_stream_underflow_callback(pa_stream *stream, void *userdata) {
     struct SoundIoOutStream *outstream = (struct SoundIoOutStream*)userdata;
-    outstream->underflow_callback(outstream);
+    soundio_outstream_invoke_underflow(outstream);
 }
 
 static void playback_stream_write_callback(pa_stream *stream, size_t nbytes, void *userdata) {
     struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate*)(userdata);
     struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamPulseAudio *ospa = &os->backend_data.pulseaudio;
     int frame_count = nbytes / outstream->bytes_per_frame;
-    outstream->write_callback(outstream, 0, frame_count);
+    ospa->period_split = false;
+    soundio_outstream_invoke_write(outstream, 0, frame_count);
+    count_period(&os->counters, ospa->period_split);
+}
+
+// Reads back what the server granted. Runs again whenever the server changes
+// the buffer, for example because the stream moved to a device with a
+// different minimum latency. Always called with the mainloop lock held; the
+// public fields are only written by the thread opening the stream, so the
+// application can read them without racing the mainloop thread.
+static void playback_stream_buffer_attr_callback(pa_stream *stream, void *userdata) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate*)userdata;
+    struct SoundIoOutStreamPulseAudio *ospa = &os->backend_data.pulseaudio;
+    const pa_buffer_attr *attr = pa_stream_get_buffer_attr(stream);
+    if (!attr)
+        return;
+    ospa->buffer_attr = *attr;
 }
 
 static void outstream_destroy_pa(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
@@ -645,6 +672,8 @@ static void outstream_destroy_pa(struct SoundIoPrivate *si, struct SoundIoOutStr
         pa_stream_set_state_callback(stream, NULL, NULL);
         pa_stream_set_underflow_callback(stream, NULL, NULL);
         pa_stream_set_overflow_callback(stream, NULL, NULL);
+        pa_stream_set_buffer_attr_callback(stream, NULL, NULL);
+        pa_stream_set_moved_callback(stream, NULL, NULL);
         pa_stream_disconnect(stream);
 
         pa_stream_unref(stream);
@@ -700,17 +729,35 @@ static enum SoundIoError outstream_open_pa(struct SoundIoPrivate *si, struct Sou
     ospa->buffer_attr.minreq = UINT32_MAX;
     ospa->buffer_attr.fragsize = UINT32_MAX;
 
+    pa_stream_flags_t flags = (pa_stream_flags_t)(PA_STREAM_START_CORKED | PA_STREAM_AUTO_TIMING_UPDATE |
+            PA_STREAM_INTERPOLATE_TIMING);
+
     int bytes_per_second = outstream->bytes_per_frame * outstream->sample_rate;
-    if (outstream->software_latency > 0.0) {
-        int buffer_length = outstream->bytes_per_frame *
-            ceil_dbl_to_int(outstream->software_latency * bytes_per_second / (double)outstream->bytes_per_frame);
+    bool use_periods = outstream->period_frames > 0 && outstream->period_count > 0;
+    if (use_periods || outstream->software_latency > 0.0) {
+        int frame_count = use_periods ? outstream->period_frames * outstream->period_count :
+            ceil_dbl_to_int(outstream->software_latency * outstream->sample_rate);
+        int buffer_length = outstream->bytes_per_frame * frame_count;
 
         ospa->buffer_attr.maxlength = buffer_length;
         ospa->buffer_attr.tlength = buffer_length;
+        // ask for more data every period, or every quarter of the buffer,
+        // instead of whenever the server feels like it
+        int period_frames = outstream->period_frames > 0 ?
+            outstream->period_frames : soundio_int_max(1, frame_count / 4);
+        ospa->buffer_attr.minreq = outstream->bytes_per_frame * period_frames;
+        // prebuf stays 0 so that the server never stops playback to refill
+        // after an underflow.
+
+        // Without this the server keeps its default sink latency and
+        // tlength is added on top of it. PA_STREAM_EARLY_REQUESTS cannot be
+        // combined with it; minreq above gives the same request cadence.
+        flags = (pa_stream_flags_t)(flags | PA_STREAM_ADJUST_LATENCY);
+    } else if (outstream->period_frames > 0) {
+        ospa->buffer_attr.minreq = outstream->bytes_per_frame * outstream->period_frames;
     }
-
-    pa_stream_flags_t flags = (pa_stream_flags_t)(PA_STREAM_START_CORKED | PA_STREAM_AUTO_TIMING_UPDATE |
-            PA_STREAM_INTERPOLATE_TIMING);
+    pa_stream_set_buffer_attr_callback(ospa->stream, playback_stream_buffer_attr_callback, os);
+    pa_stream_set_moved_callback(ospa->stream, playback_stream_buffer_attr_callback, os);
 
     int err = pa_stream_connect_playback(ospa->stream,
             outstream->device->id, &ospa->buffer_attr,
@@ -729,8 +776,14 @@ static enum SoundIoError outstream_open_pa(struct SoundIoPrivate *si, struct Sou
         return err;
     }
 
-    size_t writable_size = pa_stream_writable_size(ospa->stream);
-    outstream->software_latency = ((double)writable_size) / (double)bytes_per_second;
+    playback_stream_buffer_attr_callback(ospa->stream, os);
+    outstream->software_latency = ospa->buffer_attr.tlength / (double)bytes_per_second;
+    // minreq is the size of the blocks the server asks for, which is the
+    // closest PulseAudio has to a period.
+    if (ospa->buffer_attr.minreq > 0 && ospa->buffer_attr.minreq != UINT32_MAX) {
+        outstream->period_frames = ospa->buffer_attr.minreq / outstream->bytes_per_frame;
+        outstream->period_count = soundio_int_max(1, ospa->buffer_attr.tlength / ospa->buffer_attr.minreq);
+    }
 
     pa_threaded_mainloop_unlock(sipa->main_loop);
 
@@ -746,7 +799,7 @@ static enum SoundIoError outstream_start_pa(struct SoundIoPrivate *si, struct So
 
     ospa->write_byte_count = pa_stream_writable_size(ospa->stream);
     int frame_count = ospa->write_byte_count / outstream->bytes_per_frame;
-    outstream->write_callback(outstream, 0, frame_count);
+    soundio_outstream_invoke_write(outstream, 0, frame_count);
 
     pa_operation *op = pa_stream_cork(ospa->stream, false, NULL, NULL);
     if (!op) {
@@ -770,9 +823,12 @@ static enum SoundIoError outstream_begin_write_pa(struct SoundIoPrivate *si,
     struct SoundIoOutStreamPulseAudio *ospa = &os->backend_data.pulseaudio;
     pa_stream *stream = ospa->stream;
 
-    ospa->write_byte_count = *frame_count * outstream->bytes_per_frame;
+    size_t requested_byte_count = *frame_count * outstream->bytes_per_frame;
+    ospa->write_byte_count = requested_byte_count;
     if (pa_stream_begin_write(stream, (void**)&ospa->write_ptr, &ospa->write_byte_count))
         return SoundIoErrorStreaming;
+    if (ospa->write_byte_count < requested_byte_count)
+        ospa->period_split = true;
 
     for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
         ospa->areas[ch].ptr = ospa->write_ptr + outstream->bytes_per_sample * ch;
@@ -868,8 +924,21 @@ static void recording_stream_read_callback(pa_stream *stream, size_t nbytes, voi
     struct SoundIoInStream *instream = &is->pub;
     assert(nbytes % instream->bytes_per_frame == 0);
     assert(nbytes > 0);
+    struct SoundIoInStreamPulseAudio *ispa = &is->backend_data.pulseaudio;
     int available_frame_count = nbytes / instream->bytes_per_frame;
-    instream->read_callback(instream, 0, available_frame_count);
+    ispa->period_split = false;
+    soundio_instream_invoke_read(instream, 0, available_frame_count);
+    count_period(&is->counters, ispa->period_split);
+}
+
+// See playback_stream_buffer_attr_callback.
+static void recording_stream_buffer_attr_callback(pa_stream *stream, void *userdata) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate*)userdata;
+    struct SoundIoInStreamPulseAudio *ispa = &is->backend_data.pulseaudio;
+    const pa_buffer_attr *attr = pa_stream_get_buffer_attr(stream);
+    if (!attr)
+        return;
+    ispa->buffer_attr = *attr;
 }
 
 static void instream_destroy_pa(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
@@ -881,6 +950,8 @@ static void instream_destroy_pa(struct SoundIoPrivate *si, struct SoundIoInStrea
 
         pa_stream_set_state_callback(stream, NULL, NULL);
         pa_stream_set_read_callback(stream, NULL, NULL);
+        pa_stream_set_buffer_attr_callback(stream, NULL, NULL);
+        pa_stream_set_moved_callback(stream, NULL, NULL);
         pa_stream_disconnect(stream);
         pa_stream_unref(stream);
 
@@ -922,6 +993,8 @@ static enum SoundIoError instream_open_pa(struct SoundIoPrivate *si, struct Soun
 
     pa_stream_set_state_callback(stream, recording_stream_state_callback, is);
     pa_stream_set_read_callback(stream, recording_stream_read_callback, is);
+    pa_stream_set_buffer_attr_callback(stream, recording_stream_buffer_attr_callback, is);
+    pa_stream_set_moved_callback(stream, recording_stream_buffer_attr_callback, is);
 
     ispa->buffer_attr.maxlength = UINT32_MAX;
     ispa->buffer_attr.tlength = UINT32_MAX;
@@ -929,11 +1002,13 @@ static enum SoundIoError instream_open_pa(struct SoundIoPrivate *si, struct Soun
     ispa->buffer_attr.minreq = UINT32_MAX;
     ispa->buffer_attr.fragsize = UINT32_MAX;
 
-    if (instream->software_latency > 0.0) {
-        int bytes_per_second = instream->bytes_per_frame * instream->sample_rate;
-        int buffer_length = instream->bytes_per_frame *
-            ceil_dbl_to_int(instream->software_latency * bytes_per_second / (double)instream->bytes_per_frame);
-        ispa->buffer_attr.fragsize = buffer_length;
+    // the server hands out recorded data in fragsize chunks, so a requested
+    // period maps onto it directly
+    if (instream->period_frames > 0) {
+        ispa->buffer_attr.fragsize = instream->bytes_per_frame * instream->period_frames;
+    } else if (instream->software_latency > 0.0) {
+        int frame_count = ceil_dbl_to_int(instream->software_latency * instream->sample_rate);
+        ispa->buffer_attr.fragsize = instream->bytes_per_frame * frame_count;
     }
 
     pa_threaded_mainloop_unlock(sipa->main_loop);
@@ -948,6 +1023,10 @@ static enum SoundIoError instream_start_pa(struct SoundIoPrivate *si, struct Sou
     pa_threaded_mainloop_lock(sipa->main_loop);
 
     pa_stream_flags_t flags = (pa_stream_flags_t)(PA_STREAM_AUTO_TIMING_UPDATE | PA_STREAM_INTERPOLATE_TIMING);
+    // size the source latency to fragsize rather than delivering fragsize
+    // chunks out of a larger default source buffer
+    if (ispa->buffer_attr.fragsize != UINT32_MAX)
+        flags = (pa_stream_flags_t)(flags | PA_STREAM_ADJUST_LATENCY);
 
     int err = pa_stream_connect_record(ispa->stream,
             instream->device->id,
@@ -966,6 +1045,11 @@ static enum SoundIoError instream_start_pa(struct SoundIoPrivate *si, struct Sou
         return err;
     }
 
+    recording_stream_buffer_attr_callback(ispa->stream, is);
+    int bytes_per_second = instream->bytes_per_frame * instream->sample_rate;
+    instream->software_latency = ispa->buffer_attr.fragsize / (double)bytes_per_second;
+    if (ispa->buffer_attr.fragsize > 0 && ispa->buffer_attr.fragsize != UINT32_MAX)
+        instream->period_frames = ispa->buffer_attr.fragsize / instream->bytes_per_frame;
 
     pa_threaded_mainloop_unlock(sipa->main_loop);
     return 0;
@@ -986,6 +1070,8 @@ static enum SoundIoError instream_begin_read_pa(struct SoundIoPrivate *si,
 
         ispa->peek_buf_frames_left = ispa->peek_buf_size / instream->bytes_per_frame;
         ispa->peek_buf_index = 0;
+        if (!ispa->peek_buf || ispa->peek_buf_size != ispa->buffer_attr.fragsize)
+            ispa->period_split = true;
 
         // hole
         if (!ispa->peek_buf) {
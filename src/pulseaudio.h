@@ -46,6 +46,9 @@ struct SoundIoOutStreamPulseAudio {
     pa_buffer_attr buffer_attr;
     char *write_ptr;
     size_t write_byte_count;
+    // set when pa_stream_begin_write handed out a block smaller than asked
+    // for during the current write callback
+    bool period_split;
     struct SoundIoAtomicFlag clear_buffer_flag;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
 };
@@ -59,6 +62,9 @@ struct SoundIoInStreamPulseAudio {
     size_t peek_buf_size;
     int peek_buf_frames_left;
     int read_frame_count;
+    // set when the current read callback peeked a hole or a fragment other
+    // than one fragsize
+    bool period_split;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
 };
 
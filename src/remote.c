@@ -8,6 +8,7 @@
 
 #include "remote.h"
 #include "soundio_private.h"
+#include "rt_guard.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -36,8 +37,14 @@ static void die(char *s)
     perror(s);
 }
 
-static void playback_thread_run(void *arg) {
-    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+// First period boundary strictly after `now`, so that a task that finishes
+// early never runs twice for the same period.
+static double next_period_after(double start_time, double period_duration, double now) {
+    long periods_passed = (long)((now - start_time) / period_duration);
+    return start_time + (periods_passed + 1) * period_duration;
+}
+
+static void playback_begin(struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStream *outstream = &os->pub;
     struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
 
@@ -46,128 +53,186 @@ static void playback_thread_run(void *arg) {
     int free_frames = free_bytes / outstream->bytes_per_frame;
     osd->frames_left = free_frames;
     if (free_frames > 0)
-        outstream->write_callback(outstream, 0, free_frames);
-    double start_time = soundio_os_get_time();
-    long frames_consumed = 0;
+        soundio_outstream_invoke_write(outstream, 0, free_frames);
+    osd->start_time = soundio_os_get_time();
+    osd->frames_consumed = 0;
+}
+
+static void playback_iterate(struct SoundIoOutStreamPrivate *os, double now) {
+    struct SoundIoOutStream *outstream = &os->pub;
+    struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
+
+    if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->clear_buffer_flag)) {
+        soundio_ring_buffer_clear(&osd->ring_buffer);
+        int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer);
+        int free_frames = free_bytes / outstream->bytes_per_frame;
+        osd->frames_left = free_frames;
+        if (free_frames > 0)
+            soundio_outstream_invoke_write(outstream, 0, free_frames);
+        osd->frames_consumed = 0;
+        osd->start_time = soundio_os_get_time();
+        return;
+    }
 
+    if (SOUNDIO_ATOMIC_LOAD(osd->pause_requested)) {
+        osd->start_time = now;
+        osd->frames_consumed = 0;
+        return;
+    }
+
+    int fill_bytes = soundio_ring_buffer_fill_count(&osd->ring_buffer);
+    int fill_frames = fill_bytes / outstream->bytes_per_frame;
+    int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer) - fill_bytes;
+    int free_frames = free_bytes / outstream->bytes_per_frame;
+    double total_time = soundio_os_get_time() - osd->start_time;
+    long total_frames = total_time * outstream->sample_rate;
+    int frames_to_kill = total_frames - osd->frames_consumed;
+    int read_count = soundio_int_min(frames_to_kill, fill_frames);
+    int byte_count = read_count * outstream->bytes_per_frame;
+
+    // if a packet has been received from client within 5 sec (otherwise stop)
+    if (difftime( time(NULL), last_recv_time) < 5.0) {
+        unsigned int slen = sizeof(si_other);
+        int bytes_remaining = byte_count;
+        while (bytes_remaining > 0) {
+            // MTU is normally 1500, need to stay below to avoid fragmentation
+            int read_bytes = bytes_remaining > 1400 ? 1400 : bytes_remaining;
+            bytes_remaining -= read_bytes;
+            int bytes_written = sendto(sock, soundio_ring_buffer_read_ptr(&osd->ring_buffer), 
+                read_bytes, 0, (struct sockaddr*) &si_other, slen);
+
+            if (bytes_written == -1) {
+                die("sendto()");
+            }
+            soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, read_bytes);
+        }
+    } else {
+        soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, byte_count);
+    }
+
+    osd->frames_consumed += read_count;
+
+    if (frames_to_kill > fill_frames) {
+        soundio_outstream_invoke_underflow(outstream);
+        osd->frames_left = free_frames;
+        if (free_frames > 0)
+            soundio_outstream_invoke_write(outstream, 0, free_frames);
+        osd->frames_consumed = 0;
+        osd->start_time = soundio_os_get_time();
+    } else if (free_frames > 0) {
+        osd->frames_left = free_frames;
+        soundio_outstream_invoke_write(outstream, 0, free_frames);
+    }
+}
+
+static void playback_thread_run(void *arg) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)arg;
+    struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
+
+    soundio_rt_guard_enter();
+    playback_begin(os);
     while (SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->abort_flag)) {
         double now = soundio_os_get_time();
-        double time_passed = now - start_time;
-        double next_period = start_time +
+        double time_passed = now - osd->start_time;
+        double next_period = osd->start_time +
             ceil_dbl(time_passed / osd->period_duration) * osd->period_duration;
         double relative_time = next_period - now;
+        soundio_rt_guard_leave();
         soundio_os_cond_timed_wait(osd->cond, NULL, relative_time);
-        if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->clear_buffer_flag)) {
-            soundio_ring_buffer_clear(&osd->ring_buffer);
-            int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer);
-            int free_frames = free_bytes / outstream->bytes_per_frame;
-            osd->frames_left = free_frames;
-            if (free_frames > 0)
-                outstream->write_callback(outstream, 0, free_frames);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-            continue;
-        }
+        soundio_rt_guard_enter();
+        now = soundio_os_get_time();
+        soundio_outstream_record_wakeup(&os->pub, now - next_period);
+        if (now > next_period + osd->period_duration)
+            SOUNDIO_ATOMIC_FETCH_ADD(os->deadline_miss_count, 1);
+        playback_iterate(os, now);
+    }
+    soundio_rt_guard_leave();
+}
 
-        if (SOUNDIO_ATOMIC_LOAD(osd->pause_requested)) {
-            start_time = now;
-            frames_consumed = 0;
-            continue;
-        }
+static double playback_task_run(struct SoundIoSchedulerTask *task, double now) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)task->arg;
+    struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
 
-        int fill_bytes = soundio_ring_buffer_fill_count(&osd->ring_buffer);
-        int fill_frames = fill_bytes / outstream->bytes_per_frame;
-        int free_bytes = soundio_ring_buffer_capacity(&osd->ring_buffer) - fill_bytes;
-        int free_frames = free_bytes / outstream->bytes_per_frame;
-        double total_time = soundio_os_get_time() - start_time;
-        long total_frames = total_time * outstream->sample_rate;
-        int frames_to_kill = total_frames - frames_consumed;
-        int read_count = soundio_int_min(frames_to_kill, fill_frames);
-        int byte_count = read_count * outstream->bytes_per_frame;
-
-        // if a packet has been received from client within 5 sec (otherwise stop)
-        if (difftime( time(NULL), last_recv_time) < 5.0) {
-	        unsigned int slen = sizeof(si_other);
-            int bytes_remaining = byte_count;
-            while (bytes_remaining > 0) {
-                // MTU is normally 1500, need to stay below to avoid fragmentation
-                int read_bytes = bytes_remaining > 1400 ? 1400 : bytes_remaining;
-                bytes_remaining -= read_bytes;
-                int bytes_written = sendto(sock, soundio_ring_buffer_read_ptr(&osd->ring_buffer), 
-                    read_bytes, 0, (struct sockaddr*) &si_other, slen);
-
-                if (bytes_written == -1) {
-                    die("sendto()");
-                }
-                soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, read_bytes);
-            }
-        } else {
-            soundio_ring_buffer_advance_read_ptr(&osd->ring_buffer, byte_count);
-        }
+    soundio_rt_guard_enter();
+    soundio_outstream_record_wakeup(&os->pub, now - task->deadline);
+    if (!osd->task_started) {
+        osd->task_started = true;
+        playback_begin(os);
+    } else {
+        playback_iterate(os, now);
+    }
+    soundio_rt_guard_leave();
+    return next_period_after(osd->start_time, osd->period_duration, soundio_os_get_time());
+}
 
-        frames_consumed += read_count;
-
-        if (frames_to_kill > fill_frames) {
-            outstream->underflow_callback(outstream);
-            osd->frames_left = free_frames;
-            if (free_frames > 0)
-                outstream->write_callback(outstream, 0, free_frames);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-        } else if (free_frames > 0) {
-            osd->frames_left = free_frames;
-            outstream->write_callback(outstream, 0, free_frames);
-        }
+static void capture_iterate(struct SoundIoInStreamPrivate *is, double now) {
+    struct SoundIoInStream *instream = &is->pub;
+    struct SoundIoInStreamRemote *isd = &is->backend_data.remote;
+
+    if (SOUNDIO_ATOMIC_LOAD(isd->pause_requested)) {
+        isd->start_time = now;
+        isd->frames_consumed = 0;
+        return;
+    }
+
+    int fill_bytes = soundio_ring_buffer_fill_count(&isd->ring_buffer);
+    int free_bytes = soundio_ring_buffer_capacity(&isd->ring_buffer) - fill_bytes;
+    int fill_frames = fill_bytes / instream->bytes_per_frame;
+    int free_frames = free_bytes / instream->bytes_per_frame;
+
+    double total_time = soundio_os_get_time() - isd->start_time;
+    long total_frames = total_time * instream->sample_rate;
+    int frames_to_kill = total_frames - isd->frames_consumed;
+    int write_count = soundio_int_min(frames_to_kill, free_frames);
+    int byte_count = write_count * instream->bytes_per_frame;
+    soundio_ring_buffer_advance_write_ptr(&isd->ring_buffer, byte_count);
+    isd->frames_consumed += write_count;
+
+    if (frames_to_kill > free_frames) {
+        soundio_instream_invoke_overflow(instream);
+        isd->frames_consumed = 0;
+        isd->start_time = soundio_os_get_time();
+    }
+    if (fill_frames > 0) {
+        isd->frames_left = fill_frames;
+        soundio_instream_invoke_read(instream, 0, fill_frames);
     }
 }
 
 static void capture_thread_run(void *arg) {
     struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)arg;
-    struct SoundIoInStream *instream = &is->pub;
     struct SoundIoInStreamRemote *isd = &is->backend_data.remote;
 
-    long frames_consumed = 0;
-    double start_time = soundio_os_get_time();
+    soundio_rt_guard_enter();
+    isd->frames_consumed = 0;
+    isd->start_time = soundio_os_get_time();
     while (SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isd->abort_flag)) {
         double now = soundio_os_get_time();
-        double time_passed = now - start_time;
-        double next_period = start_time +
+        double time_passed = now - isd->start_time;
+        double next_period = isd->start_time +
             ceil_dbl(time_passed / isd->period_duration) * isd->period_duration;
         double relative_time = next_period - now;
+        soundio_rt_guard_leave();
         soundio_os_cond_timed_wait(isd->cond, NULL, relative_time);
+        soundio_rt_guard_enter();
+        now = soundio_os_get_time();
+        soundio_instream_record_wakeup(&is->pub, now - next_period);
+        if (now > next_period + isd->period_duration)
+            SOUNDIO_ATOMIC_FETCH_ADD(is->deadline_miss_count, 1);
+        capture_iterate(is, now);
+    }
+    soundio_rt_guard_leave();
+}
 
-        if (SOUNDIO_ATOMIC_LOAD(isd->pause_requested)) {
-            start_time = now;
-            frames_consumed = 0;
-            continue;
-        }
+static double capture_task_run(struct SoundIoSchedulerTask *task, double now) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)task->arg;
+    struct SoundIoInStreamRemote *isd = &is->backend_data.remote;
 
-        printf("capture thread\n");
-        fflush(stdout);
-
-        int fill_bytes = soundio_ring_buffer_fill_count(&isd->ring_buffer);
-        int free_bytes = soundio_ring_buffer_capacity(&isd->ring_buffer) - fill_bytes;
-        int fill_frames = fill_bytes / instream->bytes_per_frame;
-        int free_frames = free_bytes / instream->bytes_per_frame;
-
-        double total_time = soundio_os_get_time() - start_time;
-        long total_frames = total_time * instream->sample_rate;
-        int frames_to_kill = total_frames - frames_consumed;
-        int write_count = soundio_int_min(frames_to_kill, free_frames);
-        int byte_count = write_count * instream->bytes_per_frame;
-        soundio_ring_buffer_advance_write_ptr(&isd->ring_buffer, byte_count);
-        frames_consumed += write_count;
-
-        if (frames_to_kill > free_frames) {
-            instream->overflow_callback(instream);
-            frames_consumed = 0;
-            start_time = soundio_os_get_time();
-        }
-        if (fill_frames > 0) {
-            isd->frames_left = fill_frames;
-            instream->read_callback(instream, 0, fill_frames);
-        }
-    }
+    soundio_rt_guard_enter();
+    soundio_instream_record_wakeup(&is->pub, now - task->deadline);
+    capture_iterate(is, now);
+    soundio_rt_guard_leave();
+    return next_period_after(isd->start_time, isd->period_duration, soundio_os_get_time());
 }
 
 static void destroy_remote(struct SoundIoPrivate *si) {
@@ -207,6 +272,10 @@ static void force_device_scan_remote(struct SoundIoPrivate *si) {
 static void outstream_destroy_remote(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
 
+    if (osd->task_added) {
+        soundio_scheduler_remove(si->scheduler, &osd->task);
+        osd->task_added = false;
+    }
     if (osd->thread) {
         SOUNDIO_ATOMIC_FLAG_CLEAR(osd->abort_flag);
         soundio_os_cond_signal(osd->cond, NULL);
@@ -266,9 +335,24 @@ static enum SoundIoError outstream_start_remote(struct SoundIoPrivate *si, struc
     struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
     struct SoundIo *soundio = &si->pub;
     assert(!osd->thread);
+    assert(!osd->task_added);
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osd->abort_flag);
     enum SoundIoError err;
-    if ((err = soundio_os_thread_create(playback_thread_run, os, soundio, &osd->thread))) {
+    if (si->scheduler) {
+        osd->task.run = playback_task_run;
+        osd->task.arg = os;
+        osd->task.slack = osd->period_duration;
+        osd->task.miss_count = &os->deadline_miss_count;
+        osd->task_started = false;
+        if ((err = soundio_scheduler_add(si->scheduler, &osd->task, soundio_os_get_time())))
+            return err;
+        osd->task_added = true;
+        return SoundIoErrorNone;
+    }
+    if ((err = soundio_os_thread_create_with_attributes(playback_thread_run, os, soundio,
+                    &os->pub.thread_attributes, osd->period_duration,
+                    &os->pub.actual_thread_attributes, &osd->thread)))
+    {
         return err;
     }
     return SoundIoErrorNone;
@@ -306,7 +390,10 @@ static enum SoundIoError outstream_end_write_remote(struct SoundIoPrivate *si, s
 static enum SoundIoError outstream_clear_buffer_remote(struct SoundIoPrivate *si, struct SoundIoOutStreamPrivate *os) {
     struct SoundIoOutStreamRemote *osd = &os->backend_data.remote;
     SOUNDIO_ATOMIC_FLAG_CLEAR(osd->clear_buffer_flag);
-    soundio_os_cond_signal(osd->cond, NULL);
+    if (osd->task_added)
+        soundio_scheduler_wake(&osd->task);
+    else
+        soundio_os_cond_signal(osd->cond, NULL);
     return SoundIoErrorNone;
 }
 
@@ -322,6 +409,10 @@ static enum SoundIoError outstream_get_latency_remote(struct SoundIoPrivate *si,
 static void instream_destroy_remote(struct SoundIoPrivate *si, struct SoundIoInStreamPrivate *is) {
     struct SoundIoInStreamRemote *isd = &is->backend_data.remote;
 
+    if (isd->task_added) {
+        soundio_scheduler_remove(si->scheduler, &isd->task);
+        isd->task_added = false;
+    }
     if (isd->thread) {
         SOUNDIO_ATOMIC_FLAG_CLEAR(isd->abort_flag);
         soundio_os_cond_signal(isd->cond, NULL);
@@ -380,9 +471,28 @@ static enum SoundIoError instream_start_remote(struct SoundIoPrivate *si, struct
     struct SoundIoInStreamRemote *isd = &is->backend_data.remote;
     struct SoundIo *soundio = &si->pub;
     assert(!isd->thread);
+    assert(!isd->task_added);
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isd->abort_flag);
     enum SoundIoError err;
-    if ((err = soundio_os_thread_create(capture_thread_run, is, soundio, &isd->thread))) {
+    if (si->scheduler) {
+        isd->task.run = capture_task_run;
+        isd->task.arg = is;
+        isd->task.slack = isd->period_duration;
+        isd->task.miss_count = &is->deadline_miss_count;
+        isd->frames_consumed = 0;
+        isd->start_time = soundio_os_get_time();
+        if ((err = soundio_scheduler_add(si->scheduler, &isd->task,
+                        isd->start_time + isd->period_duration)))
+        {
+            return err;
+        }
+        isd->task_added = true;
+        return 0;
+    }
+    if ((err = soundio_os_thread_create_with_attributes(capture_thread_run, is, soundio,
+                    &is->pub.thread_attributes, isd->period_duration,
+                    &is->pub.actual_thread_attributes, &isd->thread)))
+    {
         return err;
     }
     return 0;
@@ -678,5 +788,8 @@ enum SoundIoError soundio_remote_init(struct SoundIoPrivate *si) {
     si->instream_pause = instream_pause_remote;
     si->instream_get_latency = instream_get_latency_remote;
 
+    // devices are known up front; let event loop users see them right away
+    soundio_emit_events_signal(soundio);
+
     return 0;
 }
@@ -13,6 +13,7 @@
 #include "os.h"
 #include "ring_buffer.h"
 #include "atomics.h"
+#include "scheduler.h"
 
 struct SoundIoPrivate;
 enum SoundIoError soundio_remote_init(struct SoundIoPrivate *si);
@@ -35,6 +36,11 @@ struct SoundIoOutStreamRemote {
     int write_frame_count;
     struct SoundIoRingBuffer ring_buffer;
     double playback_start_time;
+    double start_time;
+    long frames_consumed;
+    struct SoundIoSchedulerTask task;
+    bool task_added;
+    bool task_started;
     struct SoundIoAtomicFlag clear_buffer_flag;
     struct SoundIoAtomicBool pause_requested;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
@@ -49,6 +55,10 @@ struct SoundIoInStreamRemote {
     int read_frame_count;
     int buffer_frame_count;
     struct SoundIoRingBuffer ring_buffer;
+    double start_time;
+    long frames_consumed;
+    struct SoundIoSchedulerTask task;
+    bool task_added;
     struct SoundIoAtomicBool pause_requested;
     struct SoundIoChannelArea areas[SOUNDIO_MAX_CHANNELS];
 };
@@ -10,6 +10,7 @@
 #include "util.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 struct SoundIoRingBuffer *soundio_ring_buffer_create(struct SoundIo *soundio, int requested_capacity) {
     struct SoundIoRingBuffer *rb = ALLOCATE(struct SoundIoRingBuffer, 1);
@@ -50,6 +51,9 @@ char *soundio_ring_buffer_write_ptr(struct SoundIoRingBuffer *rb) {
 void soundio_ring_buffer_advance_write_ptr(struct SoundIoRingBuffer *rb, int count) {
     SOUNDIO_ATOMIC_FETCH_ADD(rb->write_offset, count);
     assert(soundio_ring_buffer_fill_count(rb) >= 0);
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->data_seq, 1);
+    if (SOUNDIO_ATOMIC_LOAD(rb->waiter_count))
+        soundio_os_futex_wake_all(&rb->data_seq, false);
 }
 
 char *soundio_ring_buffer_read_ptr(struct SoundIoRingBuffer *rb) {
@@ -60,6 +64,9 @@ char *soundio_ring_buffer_read_ptr(struct SoundIoRingBuffer *rb) {
 void soundio_ring_buffer_advance_read_ptr(struct SoundIoRingBuffer *rb, int count) {
     SOUNDIO_ATOMIC_FETCH_ADD(rb->read_offset, count);
     assert(soundio_ring_buffer_fill_count(rb) >= 0);
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->space_seq, 1);
+    if (SOUNDIO_ATOMIC_LOAD(rb->waiter_count))
+        soundio_os_futex_wake_all(&rb->space_seq, false);
 }
 
 int soundio_ring_buffer_fill_count(struct SoundIoRingBuffer *rb) {
@@ -82,12 +89,36 @@ void soundio_ring_buffer_clear(struct SoundIoRingBuffer *rb) {
     SOUNDIO_ATOMIC_STORE(rb->write_offset, read_offset);
 }
 
+// The ring buffer lives in one process, so its futexes are process-private.
+static bool fill_ready(void *context, int count) {
+    return soundio_ring_buffer_fill_count((struct SoundIoRingBuffer *)context) >= count;
+}
+
+static bool free_ready(void *context, int count) {
+    return soundio_ring_buffer_free_count((struct SoundIoRingBuffer *)context) >= count;
+}
+
+bool soundio_ring_buffer_wait_fill(struct SoundIoRingBuffer *rb, int count, double timeout) {
+    assert(count <= rb->capacity);
+    return soundio_os_futex_wait_seq(&rb->data_seq, &rb->waiter_count, false,
+            fill_ready, rb, count, timeout);
+}
+
+bool soundio_ring_buffer_wait_free(struct SoundIoRingBuffer *rb, int count, double timeout) {
+    assert(count <= rb->capacity);
+    return soundio_os_futex_wait_seq(&rb->space_seq, &rb->waiter_count, false,
+            free_ready, rb, count, timeout);
+}
+
 int soundio_ring_buffer_init(struct SoundIoRingBuffer *rb, int requested_capacity) {
     int err;
     if ((err = soundio_os_init_mirrored_memory(&rb->mem, requested_capacity)))
         return err;
     SOUNDIO_ATOMIC_STORE(rb->write_offset, 0);
     SOUNDIO_ATOMIC_STORE(rb->read_offset, 0);
+    SOUNDIO_ATOMIC_STORE(rb->data_seq, 0);
+    SOUNDIO_ATOMIC_STORE(rb->space_seq, 0);
+    SOUNDIO_ATOMIC_STORE(rb->waiter_count, 0);
     rb->capacity = rb->mem.capacity;
 
     return 0;
@@ -96,3 +127,26 @@ int soundio_ring_buffer_init(struct SoundIoRingBuffer *rb, int requested_capacit
 void soundio_ring_buffer_deinit(struct SoundIoRingBuffer *rb) {
     soundio_os_deinit_mirrored_memory(&rb->mem);
 }
+
+enum SoundIoError soundio_ring_buffer_pool_reserve(int capacity, int count, int flags) {
+    if (capacity <= 0 || count <= 0)
+        return SoundIoErrorInvalid;
+    enum SoundIoError err;
+    if ((err = soundio_os_init()))
+        return err;
+    return soundio_os_mirrored_memory_pool_reserve(capacity, count, flags);
+}
+
+void soundio_ring_buffer_pool_trim(void) {
+    if (soundio_os_init())
+        return;
+    soundio_os_mirrored_memory_pool_trim();
+}
+
+void soundio_ring_buffer_pool_get_stats(struct SoundIoRingBufferPoolStats *out_stats) {
+    if (soundio_os_init()) {
+        memset(out_stats, 0, sizeof(struct SoundIoRingBufferPoolStats));
+        return;
+    }
+    soundio_os_mirrored_memory_pool_stats(&out_stats->hits, &out_stats->misses, &out_stats->idle_count);
+}
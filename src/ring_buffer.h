@@ -16,6 +16,12 @@ struct SoundIoRingBuffer {
     struct SoundIoAtomicLong write_offset;
     struct SoundIoAtomicLong read_offset;
     int capacity;
+    // Bumped after every write and every read. Waiters sleep on these and
+    // the other side only makes the wake syscall while `waiter_count` says
+    // someone sleeps.
+    struct SoundIoAtomicInt data_seq;
+    struct SoundIoAtomicInt space_seq;
+    struct SoundIoAtomicInt waiter_count;
 };
 
 int soundio_ring_buffer_init(struct SoundIoRingBuffer *rb, int requested_capacity);
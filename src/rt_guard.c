@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "rt_guard.h"
+#include "soundio_internal.h"
+#include "atomics.h"
+#include "util.h"
+
+#if defined(SOUNDIO_RT_GUARD)
+
+#if !defined(__GLIBC__)
+#error "ENABLE_RT_GUARD requires glibc"
+#endif
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// The hooks are exported so that they take precedence over glibc for the
+// whole process, not only for calls made from within libsoundio.
+
+// Stop printing after this many reports; the count keeps going.
+#define SOUNDIO_RT_GUARD_MAX_REPORTS 32
+
+// glibc's own entry points, which the hooks below forward to
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+ssize_t __write(int fd, const void *buf, size_t count);
+
+static struct SoundIoAtomicLong violation_count;
+static struct SoundIoAtomicLong report_count;
+static bool abort_on_violation;
+static int (*real_pthread_mutex_lock)(pthread_mutex_t *mutex);
+
+static _Thread_local int realtime_depth;
+static _Thread_local bool reporting;
+
+__attribute__((constructor))
+static void rt_guard_init(void) {
+    const char *mode = getenv("SOUNDIO_RT_GUARD");
+    abort_on_violation = mode && strcmp(mode, "abort") == 0;
+}
+
+void soundio_rt_guard_enter(void) {
+    realtime_depth += 1;
+}
+
+void soundio_rt_guard_leave(void) {
+    realtime_depth -= 1;
+}
+
+static bool in_realtime(void) {
+    return realtime_depth > 0 && !reporting;
+}
+
+static void report_violation(const char *function, void *call_site) {
+    reporting = true;
+    SOUNDIO_ATOMIC_FETCH_ADD(violation_count, 1);
+    if (SOUNDIO_ATOMIC_FETCH_ADD(report_count, 1) < SOUNDIO_RT_GUARD_MAX_REPORTS || abort_on_violation) {
+        char msg[512];
+        int len;
+        Dl_info info;
+        if (dladdr(call_site, &info) && info.dli_sname) {
+            len = snprintf(msg, sizeof(msg), "libsoundio: realtime thread called %s from %s+0x%lx (%s)\n",
+                    function, info.dli_sname,
+                    (unsigned long)((char *)call_site - (char *)info.dli_saddr), info.dli_fname);
+        } else if (dladdr(call_site, &info) && info.dli_fname) {
+            len = snprintf(msg, sizeof(msg), "libsoundio: realtime thread called %s from %p (%s+0x%lx)\n",
+                    function, call_site, info.dli_fname,
+                    (unsigned long)((char *)call_site - (char *)info.dli_fbase));
+        } else {
+            len = snprintf(msg, sizeof(msg), "libsoundio: realtime thread called %s from %p\n",
+                    function, call_site);
+        }
+        if (len > 0) {
+            ssize_t amt = __write(STDERR_FILENO, msg, soundio_int_min(len, (int)sizeof(msg) - 1));
+            (void)amt;
+        }
+    }
+    if (abort_on_violation)
+        abort();
+    reporting = false;
+}
+
+SOUNDIO_EXPORT void *malloc(size_t size) {
+    if (in_realtime())
+        report_violation("malloc", __builtin_return_address(0));
+    return __libc_malloc(size);
+}
+
+SOUNDIO_EXPORT void *calloc(size_t count, size_t size) {
+    if (in_realtime())
+        report_violation("calloc", __builtin_return_address(0));
+    return __libc_calloc(count, size);
+}
+
+SOUNDIO_EXPORT void *realloc(void *ptr, size_t size) {
+    if (in_realtime())
+        report_violation("realloc", __builtin_return_address(0));
+    return __libc_realloc(ptr, size);
+}
+
+SOUNDIO_EXPORT void free(void *ptr) {
+    if (ptr && in_realtime())
+        report_violation("free", __builtin_return_address(0));
+    __libc_free(ptr);
+}
+
+SOUNDIO_EXPORT ssize_t write(int fd, const void *buf, size_t count) {
+    if (in_realtime())
+        report_violation("write", __builtin_return_address(0));
+    return __write(fd, buf, count);
+}
+
+SOUNDIO_EXPORT int pthread_mutex_lock(pthread_mutex_t *mutex) {
+    if (in_realtime())
+        report_violation("pthread_mutex_lock", __builtin_return_address(0));
+    if (!real_pthread_mutex_lock)
+        *(void **)(&real_pthread_mutex_lock) = dlsym(RTLD_NEXT, "pthread_mutex_lock");
+    return real_pthread_mutex_lock(mutex);
+}
+
+long soundio_rt_guard_violation_count(void) {
+    return SOUNDIO_ATOMIC_LOAD(violation_count);
+}
+
+#else
+
+long soundio_rt_guard_violation_count(void) {
+    return -1;
+}
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_RT_GUARD_H
+#define SOUNDIO_RT_GUARD_H
+
+#include "config.h"
+
+// Realtime code brackets itself with these. While the calling thread is inside
+// at least one enter/leave pair, the hooks in rt_guard.c report calls to
+// malloc, calloc, realloc, free, pthread_mutex_lock and write. Without
+// ENABLE_RT_GUARD they compile to nothing.
+#if defined(SOUNDIO_RT_GUARD)
+void soundio_rt_guard_enter(void);
+void soundio_rt_guard_leave(void);
+#else
+static inline void soundio_rt_guard_enter(void) { }
+static inline void soundio_rt_guard_leave(void) { }
+#endif
+
+#endif
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include "scheduler.h"
+#include "soundio_internal.h"
+#include "list.h"
+#include "util.h"
+
+#if !defined(_WIN32)
+
+#include <poll.h>
+#include <time.h>
+
+SOUNDIO_MAKE_LIST_STRUCT(struct SoundIoSchedulerTask *, SoundIoListTaskPtr, SOUNDIO_LIST_STATIC)
+SOUNDIO_MAKE_LIST_DEF(struct SoundIoSchedulerTask *, SoundIoListTaskPtr, SOUNDIO_LIST_STATIC)
+
+struct SoundIoSchedulerWorker {
+    struct SoundIoOsThread *thread;
+    struct SoundIoOsPollable *wake;
+    // Guards everything below. The worker drops it while a task runs.
+    struct SoundIoOsMutex *mutex;
+    struct SoundIoAtomicBool abort;
+    int cpu;
+
+    // every task assigned to this worker
+    struct SoundIoListTaskPtr tasks;
+    // min-heap on deadline of the tasks which have one
+    struct SoundIoListTaskPtr heap;
+    // The task whose `run` is executing. soundio_scheduler_remove waits on
+    // `idle_cond` until it is some other task.
+    struct SoundIoSchedulerTask *running;
+    int remove_waiting;
+    struct SoundIoOsCond *idle_cond;
+};
+
+struct SoundIoScheduler {
+    int worker_count;
+    struct SoundIoSchedulerWorker *workers;
+};
+
+static bool heap_less(struct SoundIoListTaskPtr *heap, int a, int b) {
+    return SoundIoListTaskPtr_val_at(heap, a)->deadline < SoundIoListTaskPtr_val_at(heap, b)->deadline;
+}
+
+static void heap_swap(struct SoundIoListTaskPtr *heap, int a, int b) {
+    struct SoundIoSchedulerTask *task_a = SoundIoListTaskPtr_val_at(heap, a);
+    struct SoundIoSchedulerTask *task_b = SoundIoListTaskPtr_val_at(heap, b);
+    heap->items[a] = task_b;
+    heap->items[b] = task_a;
+    task_b->heap_index = a;
+    task_a->heap_index = b;
+}
+
+static void heap_sift_up(struct SoundIoListTaskPtr *heap, int index) {
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!heap_less(heap, index, parent))
+            break;
+        heap_swap(heap, index, parent);
+        index = parent;
+    }
+}
+
+static void heap_sift_down(struct SoundIoListTaskPtr *heap, int index) {
+    for (;;) {
+        int left = 2 * index + 1;
+        int right = left + 1;
+        int smallest = index;
+        if (left < heap->length && heap_less(heap, left, smallest))
+            smallest = left;
+        if (right < heap->length && heap_less(heap, right, smallest))
+            smallest = right;
+        if (smallest == index)
+            break;
+        heap_swap(heap, index, smallest);
+        index = smallest;
+    }
+}
+
+static void heap_remove(struct SoundIoListTaskPtr *heap, struct SoundIoSchedulerTask *task) {
+    int index = task->heap_index;
+    if (index < 0)
+        return;
+    int last = heap->length - 1;
+    if (index != last)
+        heap_swap(heap, index, last);
+    SoundIoListTaskPtr_pop(heap);
+    task->heap_index = -1;
+    if (index < heap->length) {
+        heap_sift_up(heap, index);
+        heap_sift_down(heap, index);
+    }
+}
+
+// The heap has capacity for every task of the worker, reserved in
+// soundio_scheduler_add, so this never allocates.
+static void set_deadline(struct SoundIoSchedulerWorker *worker, struct SoundIoSchedulerTask *task,
+        double deadline)
+{
+    task->deadline = deadline;
+    if (deadline < 0.0) {
+        heap_remove(&worker->heap, task);
+        return;
+    }
+    if (task->heap_index < 0) {
+        assert(worker->heap.length < worker->heap.capacity);
+        task->heap_index = worker->heap.length;
+        worker->heap.items[worker->heap.length] = task;
+        worker->heap.length += 1;
+    }
+    heap_sift_up(&worker->heap, task->heap_index);
+    heap_sift_down(&worker->heap, task->heap_index);
+}
+
+// Called and returns with `worker->mutex` held, but releases it around
+// `task->run`.
+static void run_task(struct SoundIoSchedulerWorker *worker, struct SoundIoSchedulerTask *task,
+        double now, bool from_deadline)
+{
+    if (from_deadline && task->miss_count && now > task->deadline + task->slack)
+        SOUNDIO_ATOMIC_FETCH_ADD((*task->miss_count), 1);
+    worker->running = task;
+    soundio_os_mutex_unlock(worker->mutex);
+    double next = task->run(task, now);
+    soundio_os_mutex_lock(worker->mutex);
+    worker->running = NULL;
+    if (worker->remove_waiting > 0)
+        soundio_os_cond_signal(worker->idle_cond, worker->mutex);
+    set_deadline(worker, task, next);
+}
+
+static int poll_until(struct pollfd *fds, int fd_count, double deadline) {
+    if (deadline < 0.0)
+        return poll(fds, fd_count, -1);
+    double relative = soundio_double_max(deadline - soundio_os_get_time(), 0.0);
+#if defined(__linux__)
+    struct timespec timeout;
+    timeout.tv_sec = (time_t)relative;
+    timeout.tv_nsec = (long)((relative - timeout.tv_sec) * 1000000000.0);
+    return ppoll(fds, fd_count, &timeout, NULL);
+#else
+    return poll(fds, fd_count, ceil_dbl_to_int(relative * 1000.0));
+#endif
+}
+
+static void worker_thread_run(void *arg) {
+    struct SoundIoSchedulerWorker *worker = (struct SoundIoSchedulerWorker *)arg;
+    soundio_os_pin_current_thread(worker->cpu);
+
+    struct pollfd wake_fd;
+    wake_fd.fd = soundio_os_pollable_fd(worker->wake);
+    wake_fd.events = POLLIN;
+
+    soundio_os_mutex_lock(worker->mutex);
+    while (!SOUNDIO_ATOMIC_LOAD(worker->abort)) {
+        double deadline = (worker->heap.length > 0) ?
+            SoundIoListTaskPtr_val_at(&worker->heap, 0)->deadline : -1.0;
+
+        soundio_os_mutex_unlock(worker->mutex);
+        wake_fd.revents = 0;
+        poll_until(&wake_fd, 1, deadline);
+        if (wake_fd.revents)
+            soundio_os_pollable_clear(worker->wake);
+        soundio_os_mutex_lock(worker->mutex);
+
+        double now = soundio_os_get_time();
+
+        // Tasks woken explicitly. The list may change while a task runs, so
+        // the scan starts over after each one; the budget stops a task which
+        // wakes itself from monopolizing the worker.
+        int budget = worker->tasks.length;
+        for (int i = 0; i < worker->tasks.length && budget > 0; i += 1) {
+            struct SoundIoSchedulerTask *task = SoundIoListTaskPtr_val_at(&worker->tasks, i);
+            if (!SOUNDIO_ATOMIC_EXCHANGE(task->wake_requested, false))
+                continue;
+            run_task(worker, task, now, false);
+            budget -= 1;
+            i = -1;
+        }
+
+        // Each due task runs at most once per pass so that a task which keeps
+        // returning past deadlines cannot starve the others.
+        budget = worker->heap.length;
+        while (budget > 0 && worker->heap.length > 0) {
+            struct SoundIoSchedulerTask *task = SoundIoListTaskPtr_val_at(&worker->heap, 0);
+            if (task->deadline > now)
+                break;
+            run_task(worker, task, now, true);
+            budget -= 1;
+        }
+    }
+    soundio_os_mutex_unlock(worker->mutex);
+}
+
+struct SoundIoScheduler *soundio_scheduler_create(struct SoundIo *soundio, int worker_count) {
+    assert(worker_count > 0);
+    struct SoundIoScheduler *scheduler = ALLOCATE(struct SoundIoScheduler, 1);
+    if (!scheduler)
+        return NULL;
+    scheduler->workers = ALLOCATE(struct SoundIoSchedulerWorker, worker_count);
+    if (!scheduler->workers) {
+        soundio_scheduler_destroy(scheduler);
+        return NULL;
+    }
+    scheduler->worker_count = worker_count;
+
+    int cpu_count = soundio_os_cpu_count();
+    for (int i = 0; i < worker_count; i += 1) {
+        struct SoundIoSchedulerWorker *worker = &scheduler->workers[i];
+        worker->cpu = i % cpu_count;
+        SOUNDIO_ATOMIC_STORE(worker->abort, false);
+        worker->wake = soundio_os_pollable_create();
+        worker->mutex = soundio_os_mutex_create();
+        worker->idle_cond = soundio_os_cond_create();
+        if (!worker->wake || !worker->mutex || !worker->idle_cond) {
+            soundio_scheduler_destroy(scheduler);
+            return NULL;
+        }
+        if (soundio_os_thread_create(worker_thread_run, worker, soundio, &worker->thread)) {
+            soundio_scheduler_destroy(scheduler);
+            return NULL;
+        }
+    }
+    return scheduler;
+}
+
+void soundio_scheduler_destroy(struct SoundIoScheduler *scheduler) {
+    if (!scheduler)
+        return;
+
+    for (int i = 0; i < scheduler->worker_count; i += 1) {
+        struct SoundIoSchedulerWorker *worker = &scheduler->workers[i];
+        if (worker->thread) {
+            SOUNDIO_ATOMIC_STORE(worker->abort, true);
+            soundio_os_pollable_signal(worker->wake);
+            soundio_os_thread_destroy(worker->thread);
+        }
+        assert(worker->tasks.length == 0);
+        SoundIoListTaskPtr_deinit(&worker->tasks);
+        SoundIoListTaskPtr_deinit(&worker->heap);
+        soundio_os_pollable_destroy(worker->wake);
+        soundio_os_mutex_destroy(worker->mutex);
+        soundio_os_cond_destroy(worker->idle_cond);
+    }
+
+    free(scheduler->workers);
+    free(scheduler);
+}
+
+int soundio_scheduler_add(struct SoundIoScheduler *scheduler,
+        struct SoundIoSchedulerTask *task, double deadline)
+{
+    struct SoundIoSchedulerWorker *worker = NULL;
+    for (int i = 0; i < scheduler->worker_count; i += 1) {
+        struct SoundIoSchedulerWorker *candidate = &scheduler->workers[i];
+        soundio_os_mutex_lock(candidate->mutex);
+        bool better = !worker || candidate->tasks.length < worker->tasks.length;
+        soundio_os_mutex_unlock(candidate->mutex);
+        if (better)
+            worker = candidate;
+    }
+
+    task->worker = worker;
+    task->heap_index = -1;
+    SOUNDIO_ATOMIC_STORE(task->wake_requested, false);
+
+    soundio_os_mutex_lock(worker->mutex);
+    int err;
+    if ((err = SoundIoListTaskPtr_append(&worker->tasks, task))) {
+        soundio_os_mutex_unlock(worker->mutex);
+        return err;
+    }
+    if ((err = SoundIoListTaskPtr_ensure_capacity(&worker->heap, worker->tasks.length))) {
+        SoundIoListTaskPtr_pop(&worker->tasks);
+        soundio_os_mutex_unlock(worker->mutex);
+        return err;
+    }
+    set_deadline(worker, task, deadline);
+    soundio_os_mutex_unlock(worker->mutex);
+
+    soundio_os_pollable_signal(worker->wake);
+    return 0;
+}
+
+void soundio_scheduler_remove(struct SoundIoScheduler *scheduler, struct SoundIoSchedulerTask *task) {
+    struct SoundIoSchedulerWorker *worker = task->worker;
+    if (!worker)
+        return;
+
+    soundio_os_mutex_lock(worker->mutex);
+    worker->remove_waiting += 1;
+    while (worker->running == task)
+        soundio_os_cond_wait(worker->idle_cond, worker->mutex);
+    worker->remove_waiting -= 1;
+    heap_remove(&worker->heap, task);
+    for (int i = 0; i < worker->tasks.length; i += 1) {
+        if (SoundIoListTaskPtr_val_at(&worker->tasks, i) == task) {
+            SoundIoListTaskPtr_swap_remove(&worker->tasks, i);
+            break;
+        }
+    }
+    soundio_os_mutex_unlock(worker->mutex);
+
+    soundio_os_pollable_signal(worker->wake);
+    task->worker = NULL;
+}
+
+void soundio_scheduler_wake(struct SoundIoSchedulerTask *task) {
+    struct SoundIoSchedulerWorker *worker = task->worker;
+    if (!worker)
+        return;
+    SOUNDIO_ATOMIC_STORE(task->wake_requested, true);
+    soundio_os_pollable_signal(worker->wake);
+}
+
+#else
+
+struct SoundIoScheduler *soundio_scheduler_create(struct SoundIo *soundio, int worker_count) {
+    return NULL;
+}
+
+void soundio_scheduler_destroy(struct SoundIoScheduler *scheduler) { }
+
+int soundio_scheduler_add(struct SoundIoScheduler *scheduler,
+        struct SoundIoSchedulerTask *task, double deadline)
+{
+    return SoundIoErrorIncompatibleBackend;
+}
+
+void soundio_scheduler_remove(struct SoundIoScheduler *scheduler, struct SoundIoSchedulerTask *task) { }
+
+void soundio_scheduler_wake(struct SoundIoSchedulerTask *task) { }
+
+#endif
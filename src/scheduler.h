@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef SOUNDIO_SCHEDULER_H
+#define SOUNDIO_SCHEDULER_H
+
+#include "os.h"
+#include "atomics.h"
+
+#include <stdbool.h>
+
+struct SoundIo;
+struct SoundIoScheduler;
+struct SoundIoSchedulerWorker;
+
+// A unit of work driven by one of the shared realtime worker threads instead
+// of a dedicated thread per stream. The owner fills in the fields marked
+// "owner" before calling soundio_scheduler_add and leaves the task in place
+// until soundio_scheduler_remove returns.
+//
+// Workers only sleep on their deadline heap and wakeup descriptor, so the
+// pool serves timer-paced streams. Backends which block on the device's own
+// descriptors, such as ALSA, keep a thread per stream.
+struct SoundIoSchedulerTask {
+    // owner: Called from a worker thread, without any scheduler lock held,
+    // when `deadline` has passed or after soundio_scheduler_wake. Returns the
+    // next absolute deadline in soundio_os_get_time seconds, or a negative
+    // value to only run when woken.
+    double (*run)(struct SoundIoSchedulerTask *task, double now);
+    void *arg;
+    // owner: How late `run` may start before it counts as a deadline miss.
+    double slack;
+    // owner: Optional. Incremented on every deadline miss.
+    struct SoundIoAtomicLong *miss_count;
+
+    // Everything below is private to the scheduler.
+    double deadline;
+    int heap_index;
+    struct SoundIoAtomicBool wake_requested;
+    struct SoundIoSchedulerWorker *worker;
+};
+
+// Starts `worker_count` realtime threads, pinned round-robin to the
+// available CPUs. Returns NULL on systems without poll().
+struct SoundIoScheduler *soundio_scheduler_create(struct SoundIo *soundio, int worker_count);
+void soundio_scheduler_destroy(struct SoundIoScheduler *scheduler);
+
+// Assigns `task` to the least loaded worker. `task->run` is first called at
+// `deadline`. Not realtime safe.
+int soundio_scheduler_add(struct SoundIoScheduler *scheduler,
+        struct SoundIoSchedulerTask *task, double deadline);
+// Blocks until `task` is not running and detaches it. Must not be called from
+// inside any `run` callback.
+void soundio_scheduler_remove(struct SoundIoScheduler *scheduler, struct SoundIoSchedulerTask *task);
+// Makes the worker call `task->run` as soon as possible regardless of its
+// deadline. Lock-free; safe to call from any thread, including realtime
+// callbacks.
+void soundio_scheduler_wake(struct SoundIoSchedulerTask *task);
+
+#endif
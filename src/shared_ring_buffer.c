@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "soundio_private.h"
+#include "os.h"
+#include "atomics.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARED_RING_MAGIC 0x534f5252 // "SORR"
+#define SHARED_RING_VERSION 3
+#define SHARED_RING_CACHE_LINE 64
+
+// The low bits of a reader slot's state; the rest is the ticket of the
+// reader which claimed it, so that a reader whose slot was evicted and
+// claimed again cannot release its successor.
+#define READER_FREE 0
+#define READER_CLAIMING 1
+#define READER_ATTACHED 2
+#define READER_STATE_MASK 3
+
+// Fills exactly one cache line. Together with `readers` starting on a line
+// boundary this keeps readers in different processes from slowing each
+// other down.
+struct SharedRingReader {
+    struct SoundIoAtomicInt64 state;
+    struct SoundIoAtomicInt64 read_offset;
+    char padding[SHARED_RING_CACHE_LINE - 16];
+};
+
+// Lives at the start of the shared file, followed by the ring data. Every
+// field has a fixed width because processes of different bitness may map it.
+struct SharedRingHeader {
+    // stored last by the creator once everything else is set up
+    struct SoundIoAtomicInt magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t capacity;
+    int32_t format;
+    int32_t sample_rate;
+    int32_t channel_count;
+    int32_t channels[SOUNDIO_MAX_CHANNELS];
+
+    // The writer's cursor, the wakeup counters and each reader get a cache
+    // line of their own; the asserts below keep it that way.
+    struct SoundIoAtomicInt64 write_offset;
+    char write_offset_padding[SHARED_RING_CACHE_LINE - 8];
+
+    // Bumped after every write and every read. Waiters sleep on these and
+    // the other side only makes the wake syscall while `waiter_count` says
+    // someone sleeps.
+    struct SoundIoAtomicInt data_seq;
+    struct SoundIoAtomicInt space_seq;
+    struct SoundIoAtomicInt waiter_count;
+    struct SoundIoAtomicInt64 next_ticket;
+    char seq_padding[SHARED_RING_CACHE_LINE - 24];
+
+    struct SharedRingReader readers[SOUNDIO_SHARED_RING_BUFFER_MAX_READERS];
+};
+
+SOUNDIO_STATIC_ASSERT(sizeof(struct SharedRingReader) == SHARED_RING_CACHE_LINE,
+        "a reader slot must fill one cache line");
+SOUNDIO_STATIC_ASSERT(offsetof(struct SharedRingHeader, write_offset) % SHARED_RING_CACHE_LINE == 0,
+        "write_offset must start a cache line");
+SOUNDIO_STATIC_ASSERT(offsetof(struct SharedRingHeader, data_seq) ==
+        offsetof(struct SharedRingHeader, write_offset) + SHARED_RING_CACHE_LINE,
+        "the wakeup counters must start the line after write_offset");
+SOUNDIO_STATIC_ASSERT(offsetof(struct SharedRingHeader, readers) ==
+        offsetof(struct SharedRingHeader, data_seq) + SHARED_RING_CACHE_LINE,
+        "readers must start the line after the wakeup counters");
+
+struct SoundIoSharedRingBuffer {
+    int fd;
+    char *address;
+    size_t header_size;
+    struct SharedRingHeader *header;
+    char *data;
+    int capacity;
+    // NULL for the writer
+    struct SharedRingReader *reader;
+    // what `reader->state` holds while this reader owns the slot
+    int64_t reader_state;
+    // set when the writer created a named file, to unlink it on destroy
+    char *name;
+};
+
+static size_t shared_ring_header_size(void) {
+    int page_size = soundio_os_page_size();
+    return ((sizeof(struct SharedRingHeader) + page_size - 1) / page_size) * page_size;
+}
+
+static void shared_ring_buffer_free(struct SoundIoSharedRingBuffer *rb) {
+    if (rb->address)
+        soundio_os_unmap_shared_ring(rb->address, rb->header_size, rb->capacity);
+    if (rb->fd >= 0)
+        soundio_os_shared_memory_close(rb->fd);
+    free(rb->name);
+    free(rb);
+}
+
+enum SoundIoError soundio_shared_ring_buffer_create(const char *name, int requested_capacity,
+        enum SoundIoFormat format, int sample_rate, const struct SoundIoChannelLayout *layout,
+        struct SoundIoSharedRingBuffer **out_ring_buffer)
+{
+    *out_ring_buffer = NULL;
+    if (requested_capacity <= 0 || !layout || layout->channel_count > SOUNDIO_MAX_CHANNELS)
+        return SoundIoErrorInvalid;
+
+    enum SoundIoError err;
+    if ((err = soundio_os_init()))
+        return err;
+
+    struct SoundIoSharedRingBuffer *rb = ALLOCATE(struct SoundIoSharedRingBuffer, 1);
+    if (!rb)
+        return SoundIoErrorNoMem;
+    rb->fd = -1;
+
+    int page_size = soundio_os_page_size();
+    rb->header_size = shared_ring_header_size();
+    rb->capacity = ((requested_capacity + page_size - 1) / page_size) * page_size;
+
+    if ((err = soundio_os_shared_memory_create(name, rb->header_size + rb->capacity, &rb->fd))) {
+        shared_ring_buffer_free(rb);
+        return err;
+    }
+    if (name) {
+        rb->name = soundio_str_dupe(name, strlen(name));
+        if (!rb->name) {
+            soundio_os_shared_memory_unlink(name);
+            shared_ring_buffer_free(rb);
+            return SoundIoErrorNoMem;
+        }
+    }
+
+    if ((err = soundio_os_map_shared_ring(rb->fd, rb->header_size, rb->capacity, &rb->address))) {
+        if (name)
+            soundio_os_shared_memory_unlink(name);
+        shared_ring_buffer_free(rb);
+        return err;
+    }
+    rb->header = (struct SharedRingHeader *)rb->address;
+    rb->data = rb->address + rb->header_size;
+
+    // the file starts out zeroed, so only the description needs writing
+    struct SharedRingHeader *header = rb->header;
+    header->version = SHARED_RING_VERSION;
+    header->header_size = rb->header_size;
+    header->capacity = rb->capacity;
+    header->format = format;
+    header->sample_rate = sample_rate;
+    header->channel_count = layout->channel_count;
+    for (int ch = 0; ch < layout->channel_count; ch += 1)
+        header->channels[ch] = layout->channels[ch];
+    SOUNDIO_ATOMIC_STORE(header->magic, SHARED_RING_MAGIC);
+
+    *out_ring_buffer = rb;
+    return 0;
+}
+
+static enum SoundIoError shared_ring_buffer_attach(struct SoundIoSharedRingBuffer *rb, size_t file_size) {
+    enum SoundIoError err;
+    rb->header_size = shared_ring_header_size();
+    if (file_size <= rb->header_size || file_size - rb->header_size > INT32_MAX)
+        return SoundIoErrorInvalid;
+    rb->capacity = file_size - rb->header_size;
+
+    if ((err = soundio_os_map_shared_ring(rb->fd, rb->header_size, rb->capacity, &rb->address)))
+        return err;
+    rb->header = (struct SharedRingHeader *)rb->address;
+    rb->data = rb->address + rb->header_size;
+
+    struct SharedRingHeader *header = rb->header;
+    if (SOUNDIO_ATOMIC_LOAD(header->magic) != SHARED_RING_MAGIC ||
+        header->version != SHARED_RING_VERSION ||
+        header->header_size != rb->header_size ||
+        header->capacity != (uint32_t)rb->capacity ||
+        header->channel_count > SOUNDIO_MAX_CHANNELS)
+    {
+        return SoundIoErrorInvalid;
+    }
+
+    int64_t ticket = SOUNDIO_ATOMIC_FETCH_ADD(header->next_ticket, 1) + 1;
+    for (int i = 0; i < SOUNDIO_SHARED_RING_BUFFER_MAX_READERS; i += 1) {
+        struct SharedRingReader *reader = &header->readers[i];
+        int64_t expected = READER_FREE;
+        if (!SOUNDIO_ATOMIC_COMPARE_EXCHANGE(reader->state, &expected, ticket * 4 + READER_CLAIMING))
+            continue;
+        // new readers start at whatever the writer writes next
+        SOUNDIO_ATOMIC_STORE(reader->read_offset, SOUNDIO_ATOMIC_LOAD(header->write_offset));
+        rb->reader_state = ticket * 4 + READER_ATTACHED;
+        SOUNDIO_ATOMIC_STORE(reader->state, rb->reader_state);
+        // Until the store above the writer ignored this reader and may have
+        // run more than a capacity past the offset taken before it.
+        SOUNDIO_ATOMIC_STORE(reader->read_offset, SOUNDIO_ATOMIC_LOAD(header->write_offset));
+        rb->reader = reader;
+        return 0;
+    }
+    return SoundIoErrorSystemResources;
+}
+
+enum SoundIoError soundio_shared_ring_buffer_attach(const char *name,
+        struct SoundIoSharedRingBuffer **out_ring_buffer)
+{
+    *out_ring_buffer = NULL;
+    if (!name)
+        return SoundIoErrorInvalid;
+
+    enum SoundIoError err;
+    if ((err = soundio_os_init()))
+        return err;
+
+    struct SoundIoSharedRingBuffer *rb = ALLOCATE(struct SoundIoSharedRingBuffer, 1);
+    if (!rb)
+        return SoundIoErrorNoMem;
+    rb->fd = -1;
+
+    size_t file_size;
+    if ((err = soundio_os_shared_memory_open(name, &rb->fd, &file_size))) {
+        shared_ring_buffer_free(rb);
+        return err;
+    }
+    if ((err = shared_ring_buffer_attach(rb, file_size))) {
+        shared_ring_buffer_free(rb);
+        return err;
+    }
+
+    *out_ring_buffer = rb;
+    return 0;
+}
+
+enum SoundIoError soundio_shared_ring_buffer_attach_fd(int fd,
+        struct SoundIoSharedRingBuffer **out_ring_buffer)
+{
+    *out_ring_buffer = NULL;
+
+    enum SoundIoError err;
+    if ((err = soundio_os_init()))
+        return err;
+
+    size_t file_size;
+    if ((err = soundio_os_shared_memory_size(fd, &file_size)))
+        return err;
+
+    struct SoundIoSharedRingBuffer *rb = ALLOCATE(struct SoundIoSharedRingBuffer, 1);
+    if (!rb)
+        return SoundIoErrorNoMem;
+    rb->fd = fd;
+
+    if ((err = shared_ring_buffer_attach(rb, file_size))) {
+        // the caller still owns fd
+        rb->fd = -1;
+        shared_ring_buffer_free(rb);
+        return err;
+    }
+
+    *out_ring_buffer = rb;
+    return 0;
+}
+
+enum SoundIoError soundio_shared_ring_buffer_send(struct SoundIoSharedRingBuffer *rb, int socket_fd) {
+    return soundio_os_send_fd(socket_fd, rb->fd);
+}
+
+enum SoundIoError soundio_shared_ring_buffer_receive(int socket_fd,
+        struct SoundIoSharedRingBuffer **out_ring_buffer)
+{
+    *out_ring_buffer = NULL;
+    int fd;
+    enum SoundIoError err;
+    if ((err = soundio_os_recv_fd(socket_fd, &fd)))
+        return err;
+    if ((err = soundio_shared_ring_buffer_attach_fd(fd, out_ring_buffer))) {
+        soundio_os_shared_memory_close(fd);
+        return err;
+    }
+    return 0;
+}
+
+void soundio_shared_ring_buffer_destroy(struct SoundIoSharedRingBuffer *rb) {
+    if (!rb)
+        return;
+
+    struct SharedRingHeader *header = rb->header;
+    if (rb->reader) {
+        // fails when the writer evicted this reader
+        int64_t expected = rb->reader_state;
+        SOUNDIO_ATOMIC_COMPARE_EXCHANGE(rb->reader->state, &expected, (int64_t)READER_FREE);
+        // the writer may be waiting for this reader to make room
+        SOUNDIO_ATOMIC_FETCH_ADD(header->space_seq, 1);
+        if (SOUNDIO_ATOMIC_LOAD(header->waiter_count))
+            soundio_os_futex_wake_all(&header->space_seq, true);
+    } else if (rb->name) {
+        // attached readers keep their mapping
+        soundio_os_shared_memory_unlink(rb->name);
+    }
+
+    shared_ring_buffer_free(rb);
+}
+
+int soundio_shared_ring_buffer_fd(struct SoundIoSharedRingBuffer *rb) {
+    return rb->fd;
+}
+
+int soundio_shared_ring_buffer_capacity(struct SoundIoSharedRingBuffer *rb) {
+    return rb->capacity;
+}
+
+void soundio_shared_ring_buffer_get_format(struct SoundIoSharedRingBuffer *rb,
+        enum SoundIoFormat *out_format, int *out_sample_rate, struct SoundIoChannelLayout *out_layout)
+{
+    struct SharedRingHeader *header = rb->header;
+    if (out_format)
+        *out_format = (enum SoundIoFormat)header->format;
+    if (out_sample_rate)
+        *out_sample_rate = header->sample_rate;
+    if (out_layout) {
+        memset(out_layout, 0, sizeof(struct SoundIoChannelLayout));
+        out_layout->channel_count = header->channel_count;
+        for (int ch = 0; ch < header->channel_count; ch += 1)
+            out_layout->channels[ch] = (enum SoundIoChannelId)header->channels[ch];
+        soundio_channel_layout_detect_builtin(out_layout);
+    }
+}
+
+char *soundio_shared_ring_buffer_write_ptr(struct SoundIoSharedRingBuffer *rb) {
+    int64_t write_offset = SOUNDIO_ATOMIC_LOAD(rb->header->write_offset);
+    return rb->data + (write_offset % rb->capacity);
+}
+
+void soundio_shared_ring_buffer_advance_write_ptr(struct SoundIoSharedRingBuffer *rb, int count) {
+    struct SharedRingHeader *header = rb->header;
+    SOUNDIO_ATOMIC_FETCH_ADD(header->write_offset, count);
+    SOUNDIO_ATOMIC_FETCH_ADD(header->data_seq, 1);
+    if (SOUNDIO_ATOMIC_LOAD(header->waiter_count))
+        soundio_os_futex_wake_all(&header->data_seq, true);
+}
+
+int soundio_shared_ring_buffer_free_count(struct SoundIoSharedRingBuffer *rb) {
+    struct SharedRingHeader *header = rb->header;
+    int64_t write_offset = SOUNDIO_ATOMIC_LOAD(header->write_offset);
+    int64_t slowest = write_offset;
+    for (int i = 0; i < SOUNDIO_SHARED_RING_BUFFER_MAX_READERS; i += 1) {
+        struct SharedRingReader *reader = &header->readers[i];
+        if ((SOUNDIO_ATOMIC_LOAD(reader->state) & READER_STATE_MASK) != READER_ATTACHED)
+            continue;
+        int64_t read_offset = SOUNDIO_ATOMIC_LOAD(reader->read_offset);
+        if (read_offset < slowest)
+            slowest = read_offset;
+    }
+    int64_t free_count = rb->capacity - (write_offset - slowest);
+    return (free_count > 0) ? (int)free_count : 0;
+}
+
+char *soundio_shared_ring_buffer_read_ptr(struct SoundIoSharedRingBuffer *rb) {
+    int64_t read_offset = SOUNDIO_ATOMIC_LOAD(rb->reader->read_offset);
+    return rb->data + (read_offset % rb->capacity);
+}
+
+void soundio_shared_ring_buffer_advance_read_ptr(struct SoundIoSharedRingBuffer *rb, int count) {
+    struct SharedRingHeader *header = rb->header;
+    SOUNDIO_ATOMIC_FETCH_ADD(rb->reader->read_offset, count);
+    SOUNDIO_ATOMIC_FETCH_ADD(header->space_seq, 1);
+    if (SOUNDIO_ATOMIC_LOAD(header->waiter_count))
+        soundio_os_futex_wake_all(&header->space_seq, true);
+}
+
+int soundio_shared_ring_buffer_fill_count(struct SoundIoSharedRingBuffer *rb) {
+    // the writer no longer leaves this reader's data alone
+    if (!soundio_shared_ring_buffer_is_attached(rb))
+        return 0;
+    int64_t read_offset = SOUNDIO_ATOMIC_LOAD(rb->reader->read_offset);
+    int64_t write_offset = SOUNDIO_ATOMIC_LOAD(rb->header->write_offset);
+    int64_t fill_count = write_offset - read_offset;
+    assert(fill_count >= 0);
+    assert(fill_count <= rb->capacity);
+    return (int)fill_count;
+}
+
+bool soundio_shared_ring_buffer_is_attached(struct SoundIoSharedRingBuffer *rb) {
+    return SOUNDIO_ATOMIC_LOAD(rb->reader->state) == rb->reader_state;
+}
+
+int soundio_shared_ring_buffer_reader_lag(struct SoundIoSharedRingBuffer *rb, int index) {
+    if (rb->reader || index < 0 || index >= SOUNDIO_SHARED_RING_BUFFER_MAX_READERS)
+        return -1;
+    struct SharedRingReader *reader = &rb->header->readers[index];
+    if ((SOUNDIO_ATOMIC_LOAD(reader->state) & READER_STATE_MASK) != READER_ATTACHED)
+        return -1;
+    int64_t lag = SOUNDIO_ATOMIC_LOAD(rb->header->write_offset) - SOUNDIO_ATOMIC_LOAD(reader->read_offset);
+    return (lag > 0) ? (int)lag : 0;
+}
+
+enum SoundIoError soundio_shared_ring_buffer_evict_reader(struct SoundIoSharedRingBuffer *rb, int index) {
+    if (rb->reader || index < 0 || index >= SOUNDIO_SHARED_RING_BUFFER_MAX_READERS)
+        return SoundIoErrorInvalid;
+    struct SharedRingReader *reader = &rb->header->readers[index];
+    int64_t state = SOUNDIO_ATOMIC_LOAD(reader->state);
+    if ((state & READER_STATE_MASK) != READER_ATTACHED)
+        return SoundIoErrorInvalid;
+    // loses against a reader detaching at the same time, which is fine
+    if (!SOUNDIO_ATOMIC_COMPARE_EXCHANGE(reader->state, &state, (int64_t)READER_FREE))
+        return SoundIoErrorInvalid;
+    return SoundIoErrorNone;
+}
+
+// Waiters and wakers may be in different processes, so these futexes are
+// process-shared.
+static bool fill_ready(void *context, int count) {
+    return soundio_shared_ring_buffer_fill_count((struct SoundIoSharedRingBuffer *)context) >= count;
+}
+
+static bool free_ready(void *context, int count) {
+    return soundio_shared_ring_buffer_free_count((struct SoundIoSharedRingBuffer *)context) >= count;
+}
+
+bool soundio_shared_ring_buffer_wait_fill(struct SoundIoSharedRingBuffer *rb, int count, double timeout) {
+    return soundio_os_futex_wait_seq(&rb->header->data_seq, &rb->header->waiter_count, true,
+            fill_ready, rb, count, timeout);
+}
+
+bool soundio_shared_ring_buffer_wait_free(struct SoundIoSharedRingBuffer *rb, int count, double timeout) {
+    return soundio_os_futex_wait_seq(&rb->header->space_seq, &rb->header->waiter_count, true,
+            free_ready, rb, count, timeout);
+}
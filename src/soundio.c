@@ -8,6 +8,9 @@
 #include "soundio_private.h"
 #include "util.h"
 #include "os.h"
+#include "scheduler.h"
+#include "rt_guard.h"
+#include "meter.h"
 #include "config.h"
 
 #include <string.h>
@@ -32,6 +35,11 @@ static const enum SoundIoBackend available_backends[] = {
 #endif
 #ifdef SOUNDIO_HAVE_ANDROID
     SoundIoBackendAndroid,
+#endif
+    // Behind the native backends until it has seen more testing; PipeWire
+    // systems normally also serve the PulseAudio protocol.
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    SoundIoBackendPipeWire,
 #endif
     SoundIoBackendRemote,
     SoundIoBackendDummy,
@@ -76,8 +84,15 @@ static backend_init_t backend_init_fns[] = {
 #else
     NULL,
 #endif
+
     &soundio_remote_init,
     &soundio_dummy_init,
+
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    &soundio_pipewire_init,
+#else
+    NULL,
+#endif
 };
 
 SOUNDIO_MAKE_LIST_DEF(struct SoundIoDevice*, SoundIoListDevicePtr, SOUNDIO_LIST_NOT_STATIC)
@@ -178,6 +193,7 @@ const char *soundio_backend_name(enum SoundIoBackend backend) {
         case SoundIoBackendAndroid: return "Android OpenSL ES";
         case SoundIoBackendRemote: return "Remote";
         case SoundIoBackendDummy: return "Dummy";
+        case SoundIoBackendPipeWire: return "PipeWire";
     }
     return "(invalid backend)";
 }
@@ -245,7 +261,7 @@ enum SoundIoError soundio_connect_backend(struct SoundIo *soundio, enum SoundIoB
     if (soundio->current_backend)
         return SoundIoErrorInvalid;
 
-    if (backend <= 0 || backend > SoundIoBackendDummy)
+    if (backend <= 0 || backend > SoundIoBackendPipeWire)
         return SoundIoErrorInvalid;
 
     enum SoundIoError (*fn)(struct SoundIoPrivate *) = backend_init_fns[backend];
@@ -253,6 +269,22 @@ enum SoundIoError soundio_connect_backend(struct SoundIo *soundio, enum SoundIoB
     if (!fn)
         return SoundIoErrorBackendUnavailable;
 
+    si->events_pollable = soundio_os_pollable_create();
+#if !defined(_WIN32)
+    if (!si->events_pollable)
+        return SoundIoErrorSystemResources;
+#endif
+
+    if (soundio->realtime_worker_count > 0) {
+        si->scheduler = soundio_scheduler_create(soundio, soundio->realtime_worker_count);
+#if !defined(_WIN32)
+        if (!si->scheduler) {
+            soundio_disconnect(soundio);
+            return SoundIoErrorSystemResources;
+        }
+#endif
+    }
+
     int err;
     if ((err = backend_init_fns[backend](si))) {
         soundio_disconnect(soundio);
@@ -278,6 +310,12 @@ void soundio_disconnect(struct SoundIo *soundio) {
     soundio_destroy_devices_info(si->safe_devices_info);
     si->safe_devices_info = NULL;
 
+    soundio_scheduler_destroy(si->scheduler);
+    si->scheduler = NULL;
+
+    soundio_os_pollable_destroy(si->events_pollable);
+    si->events_pollable = NULL;
+
     si->destroy = NULL;
     si->flush_events = NULL;
     si->wait_events = NULL;
@@ -450,14 +488,101 @@ void soundio_wait_events(struct SoundIo *soundio) {
 
 void soundio_wakeup(struct SoundIo *soundio) {
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
+    if (si->events_pollable)
+        soundio_os_pollable_signal(si->events_pollable);
     si->wakeup(si);
 }
 
+enum SoundIoError soundio_get_event_fd(struct SoundIo *soundio, int *out_fd) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
+    *out_fd = -1;
+    if (soundio->current_backend == SoundIoBackendNone)
+        return SoundIoErrorInvalid;
+    if (!si->events_pollable)
+        return SoundIoErrorIncompatibleBackend;
+    *out_fd = soundio_os_pollable_fd(si->events_pollable);
+    return SoundIoErrorNone;
+}
+
+void soundio_dispatch_events(struct SoundIo *soundio) {
+    assert(soundio->current_backend != SoundIoBackendNone);
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
+    // Clear before flushing so that an event arriving during the flush leaves
+    // the descriptor readable for the next iteration of the caller's loop.
+    if (si->events_pollable)
+        soundio_os_pollable_clear(si->events_pollable);
+    si->flush_events(si);
+}
+
+void soundio_emit_events_signal(struct SoundIo *soundio) {
+    struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
+    if (si->events_pollable)
+        soundio_os_pollable_signal(si->events_pollable);
+    soundio->on_events_signal(soundio);
+}
+
 void soundio_force_device_scan(struct SoundIo *soundio) {
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     si->force_device_scan(si);
 }
 
+struct GarbageItem {
+    void *ptr;
+    void (*free_fn)(void *);
+};
+
+static enum SoundIoError stream_queues_init(struct SoundIoMpscQueue *commands,
+        struct SoundIoMpscQueue *garbage, int capacity)
+{
+    if (capacity == 0 || commands->sequences)
+        return SoundIoErrorNone;
+    enum SoundIoError err;
+    if ((err = soundio_mpsc_queue_init(commands, sizeof(struct SoundIoCommand), capacity)))
+        return err;
+    if ((err = soundio_mpsc_queue_init(garbage, sizeof(struct GarbageItem), capacity))) {
+        soundio_mpsc_queue_deinit(commands);
+        return err;
+    }
+    return SoundIoErrorNone;
+}
+
+static void collect_garbage(struct SoundIoMpscQueue *garbage, struct SoundIoAtomicFlag *collecting) {
+    if (!garbage->sequences)
+        return;
+    // another thread is already on it
+    if (SOUNDIO_ATOMIC_FLAG_TEST_AND_SET((*collecting)))
+        return;
+    struct GarbageItem item;
+    while (soundio_mpsc_queue_pop(garbage, &item)) {
+        if (item.free_fn)
+            item.free_fn(item.ptr);
+        else
+            free(item.ptr);
+    }
+    SOUNDIO_ATOMIC_FLAG_CLEAR((*collecting));
+}
+
+static void stream_queues_deinit(struct SoundIoMpscQueue *commands, struct SoundIoMpscQueue *garbage,
+        struct SoundIoAtomicFlag *collecting)
+{
+    collect_garbage(garbage, collecting);
+    soundio_mpsc_queue_deinit(commands);
+    soundio_mpsc_queue_deinit(garbage);
+}
+
+static enum SoundIoError post_command(struct SoundIoMpscQueue *commands, const struct SoundIoCommand *command) {
+    if (!commands->sequences)
+        return SoundIoErrorInvalid;
+    return soundio_mpsc_queue_push(commands, command) ? SoundIoErrorNone : SoundIoErrorSystemResources;
+}
+
+static enum SoundIoError defer_free(struct SoundIoMpscQueue *garbage, void *ptr, void (*free_fn)(void *)) {
+    if (!garbage->sequences)
+        return SoundIoErrorInvalid;
+    struct GarbageItem item = {ptr, free_fn};
+    return soundio_mpsc_queue_push(garbage, &item) ? SoundIoErrorNone : SoundIoErrorSystemResources;
+}
+
 enum SoundIoError soundio_outstream_begin_write(struct SoundIoOutStream *outstream,
         struct SoundIoChannelArea **areas, int *frame_count)
 {
@@ -466,14 +591,25 @@ enum SoundIoError soundio_outstream_begin_write(struct SoundIoOutStream *outstre
     struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
     if (*frame_count <= 0)
         return SoundIoErrorInvalid;
-    return si->outstream_begin_write(si, os, areas, frame_count);
+    enum SoundIoError err = si->outstream_begin_write(si, os, areas, frame_count);
+    os->counters.pending_frames = err ? 0 : *frame_count;
+    os->meter_areas = err ? NULL : *areas;
+    return err;
 }
 
 enum SoundIoError soundio_outstream_end_write(struct SoundIoOutStream *outstream) {
     struct SoundIo *soundio = outstream->device->soundio;
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
-    return si->outstream_end_write(si, os);
+    // the buffer is only ours until the backend takes it back
+    if (os->meter && os->meter_areas)
+        soundio_meter_process(os->meter, os->meter_areas, os->counters.pending_frames);
+    os->meter_areas = NULL;
+    enum SoundIoError err = si->outstream_end_write(si, os);
+    if (!err)
+        SOUNDIO_ATOMIC_FETCH_ADD(os->counters.frames_transferred, os->counters.pending_frames);
+    os->counters.pending_frames = 0;
+    return err;
 }
 
 static void default_outstream_error_callback(struct SoundIoOutStream *os, enum SoundIoError err) {
@@ -482,6 +618,8 @@ static void default_outstream_error_callback(struct SoundIoOutStream *os, enum S
 
 static void default_underflow_callback(struct SoundIoOutStream *outstream) { }
 
+static void default_outstream_period_changed_callback(struct SoundIoOutStream *outstream) { }
+
 struct SoundIoOutStream *soundio_outstream_create(struct SoundIoDevice *device) {
     struct SoundIoOutStreamPrivate *os = ALLOCATE(struct SoundIoOutStreamPrivate, 1);
     struct SoundIoOutStream *outstream = &os->pub;
@@ -496,6 +634,7 @@ struct SoundIoOutStream *soundio_outstream_create(struct SoundIoDevice *device)
 
     outstream->error_callback = default_outstream_error_callback;
     outstream->underflow_callback = default_underflow_callback;
+    outstream->period_changed_callback = default_outstream_period_changed_callback;
 
     return outstream;
 }
@@ -512,6 +651,15 @@ enum SoundIoError soundio_outstream_open(struct SoundIoOutStream *outstream) {
     if (outstream->layout.channel_count > SOUNDIO_MAX_CHANNELS)
         return SoundIoErrorInvalid;
 
+    if (outstream->period_frames < 0 || outstream->period_count < 0)
+        return SoundIoErrorInvalid;
+
+    if (outstream->command_queue_capacity < 0 ||
+            (outstream->command_queue_capacity > 0 && !outstream->command_callback))
+    {
+        return SoundIoErrorInvalid;
+    }
+
     if (outstream->format == SoundIoFormatInvalid) {
         outstream->format = soundio_device_supports_format(device, SoundIoFormatFloat32NE) ?
             SoundIoFormatFloat32NE : device->formats[0];
@@ -532,6 +680,17 @@ enum SoundIoError soundio_outstream_open(struct SoundIoOutStream *outstream) {
     outstream->bytes_per_frame = soundio_get_bytes_per_frame(outstream->format, outstream->layout.channel_count);
     outstream->bytes_per_sample = soundio_get_bytes_per_sample(outstream->format);
 
+    if (outstream->metering && !os->meter) {
+        enum SoundIoError err = soundio_meter_create(outstream->format, &outstream->layout,
+                outstream->sample_rate, &os->meter);
+        if (err == SoundIoErrorNoMem)
+            return err;
+    }
+
+    enum SoundIoError err;
+    if ((err = stream_queues_init(&os->commands, &os->garbage, outstream->command_queue_capacity)))
+        return err;
+
     struct SoundIo *soundio = device->soundio;
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     return si->outstream_open(si, os);
@@ -548,6 +707,9 @@ void soundio_outstream_destroy(struct SoundIoOutStream *outstream) {
     if (si->outstream_destroy)
         si->outstream_destroy(si, os);
 
+    soundio_meter_destroy(os->meter);
+    stream_queues_deinit(&os->commands, &os->garbage, &os->garbage_collecting);
+
     soundio_device_unref(outstream->device);
     free(os);
 }
@@ -580,12 +742,127 @@ enum SoundIoError soundio_outstream_get_latency(struct SoundIoOutStream *outstre
     return si->outstream_get_latency(si, os, out_latency);
 }
 
+int soundio_stats_bucket(double seconds) {
+    long microseconds = (long)(seconds * 1000000.0);
+    int bucket = 0;
+    while (microseconds >= 2 && bucket < SOUNDIO_STATS_BUCKET_COUNT - 1) {
+        microseconds >>= 1;
+        bucket += 1;
+    }
+    return bucket;
+}
+
+static void counters_record_callback(struct SoundIoStreamCounters *counters,
+        int frame_count_min, int frame_count_max, double duration)
+{
+    SOUNDIO_ATOMIC_FETCH_ADD(counters->callback_count, 1);
+    SOUNDIO_ATOMIC_FETCH_ADD(counters->frames_requested, frame_count_min);
+    SOUNDIO_ATOMIC_FETCH_ADD(counters->frames_offered, frame_count_max);
+    SOUNDIO_ATOMIC_FETCH_ADD(counters->callback_duration[soundio_stats_bucket(duration)], 1);
+    // single writer, so a plain compare is enough
+    long duration_ns = (long)(duration * 1000000000.0);
+    if (duration_ns > SOUNDIO_ATOMIC_LOAD(counters->max_callback_duration_ns))
+        SOUNDIO_ATOMIC_STORE(counters->max_callback_duration_ns, duration_ns);
+}
+
+static void counters_record_wakeup(struct SoundIoStreamCounters *counters, double lateness) {
+    if (lateness < 0.0)
+        return;
+    SOUNDIO_ATOMIC_FETCH_ADD(counters->wakeup_jitter[soundio_stats_bucket(lateness)], 1);
+}
+
+static void counters_snapshot(struct SoundIoStreamCounters *counters, struct SoundIoStreamStats *out_stats) {
+    out_stats->callback_count = SOUNDIO_ATOMIC_LOAD(counters->callback_count);
+    for (int i = 0; i < SOUNDIO_STATS_BUCKET_COUNT; i += 1) {
+        out_stats->callback_duration_histogram[i] = SOUNDIO_ATOMIC_LOAD(counters->callback_duration[i]);
+        out_stats->wakeup_jitter_histogram[i] = SOUNDIO_ATOMIC_LOAD(counters->wakeup_jitter[i]);
+    }
+    out_stats->max_callback_duration = SOUNDIO_ATOMIC_LOAD(counters->max_callback_duration_ns) / 1000000000.0;
+    out_stats->xrun_count = SOUNDIO_ATOMIC_LOAD(counters->xrun_count);
+    out_stats->frames_requested = SOUNDIO_ATOMIC_LOAD(counters->frames_requested);
+    out_stats->frames_offered = SOUNDIO_ATOMIC_LOAD(counters->frames_offered);
+    out_stats->frames_transferred = SOUNDIO_ATOMIC_LOAD(counters->frames_transferred);
+    out_stats->zero_copy_periods = SOUNDIO_ATOMIC_LOAD(counters->zero_copy_periods);
+    out_stats->copy_periods = SOUNDIO_ATOMIC_LOAD(counters->copy_periods);
+}
+
+void soundio_outstream_invoke_write(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max)
+{
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    double start = soundio_os_get_time();
+    soundio_rt_guard_enter();
+    if (os->commands.sequences) {
+        // at most one queue's worth, so that busy producers cannot keep the
+        // stream thread from the callback
+        struct SoundIoCommand command;
+        for (int64_t i = 0; i <= os->commands.mask && soundio_mpsc_queue_pop(&os->commands, &command); i += 1)
+            outstream->command_callback(outstream, &command);
+    }
+    outstream->write_callback(outstream, frame_count_min, frame_count_max);
+    soundio_rt_guard_leave();
+    counters_record_callback(&os->counters, frame_count_min, frame_count_max,
+            soundio_os_get_time() - start);
+}
+
+void soundio_outstream_invoke_underflow(struct SoundIoOutStream *outstream) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    SOUNDIO_ATOMIC_FETCH_ADD(os->counters.xrun_count, 1);
+    soundio_rt_guard_enter();
+    outstream->underflow_callback(outstream);
+    soundio_rt_guard_leave();
+}
+
+void soundio_outstream_record_wakeup(struct SoundIoOutStream *outstream, double lateness) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    counters_record_wakeup(&os->counters, lateness);
+}
+
+void soundio_outstream_get_stats(struct SoundIoOutStream *outstream, struct SoundIoStreamStats *out_stats) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    counters_snapshot(&os->counters, out_stats);
+    out_stats->late_wakeup_count = SOUNDIO_ATOMIC_LOAD(os->deadline_miss_count);
+}
+
+enum SoundIoError soundio_outstream_post_command(struct SoundIoOutStream *outstream,
+        const struct SoundIoCommand *command)
+{
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    return post_command(&os->commands, command);
+}
+
+enum SoundIoError soundio_outstream_defer_free(struct SoundIoOutStream *outstream,
+        void *ptr, void (*free_fn)(void *))
+{
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    return defer_free(&os->garbage, ptr, free_fn);
+}
+
+void soundio_outstream_collect_garbage(struct SoundIoOutStream *outstream) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    collect_garbage(&os->garbage, &os->garbage_collecting);
+}
+
+void soundio_outstream_get_meter(struct SoundIoOutStream *outstream,
+        struct SoundIoMeterSnapshot *out_snapshot)
+{
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    soundio_meter_get_snapshot(os->meter, out_snapshot);
+}
+
+long soundio_outstream_deadline_miss_count(struct SoundIoOutStream *outstream) {
+    struct SoundIoOutStreamPrivate *os = (struct SoundIoOutStreamPrivate *)outstream;
+    return SOUNDIO_ATOMIC_LOAD(os->deadline_miss_count);
+}
+
 static void default_instream_error_callback(struct SoundIoInStream *is, enum SoundIoError err) {
     soundio_panic("libsoundio: %s", soundio_error_name(err));
 }
 
 static void default_overflow_callback(struct SoundIoInStream *instream) { }
 
+static void default_instream_period_changed_callback(struct SoundIoInStream *instream) { }
+
 struct SoundIoInStream *soundio_instream_create(struct SoundIoDevice *device) {
     struct SoundIoInStreamPrivate *is = ALLOCATE(struct SoundIoInStreamPrivate, 1);
     struct SoundIoInStream *instream = &is->pub;
@@ -600,6 +877,7 @@ struct SoundIoInStream *soundio_instream_create(struct SoundIoDevice *device) {
 
     instream->error_callback = default_instream_error_callback;
     instream->overflow_callback = default_overflow_callback;
+    instream->period_changed_callback = default_instream_period_changed_callback;
 
     return instream;
 }
@@ -615,6 +893,15 @@ enum SoundIoError soundio_instream_open(struct SoundIoInStream *instream) {
     if (instream->layout.channel_count > SOUNDIO_MAX_CHANNELS)
         return SoundIoErrorInvalid;
 
+    if (instream->period_frames < 0 || instream->period_count < 0)
+        return SoundIoErrorInvalid;
+
+    if (instream->command_queue_capacity < 0 ||
+            (instream->command_queue_capacity > 0 && !instream->command_callback))
+    {
+        return SoundIoErrorInvalid;
+    }
+
     if (device->probe_error)
         return device->probe_error;
 
@@ -637,6 +924,15 @@ enum SoundIoError soundio_instream_open(struct SoundIoInStream *instream) {
     struct SoundIo *soundio = device->soundio;
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    if (instream->metering && !is->meter) {
+        enum SoundIoError err = soundio_meter_create(instream->format, &instream->layout,
+                instream->sample_rate, &is->meter);
+        if (err == SoundIoErrorNoMem)
+            return err;
+    }
+    enum SoundIoError err;
+    if ((err = stream_queues_init(&is->commands, &is->garbage, instream->command_queue_capacity)))
+        return err;
     return si->instream_open(si, is);
 }
 
@@ -658,6 +954,9 @@ void soundio_instream_destroy(struct SoundIoInStream *instream) {
     if (si->instream_destroy)
         si->instream_destroy(si, is);
 
+    soundio_meter_destroy(is->meter);
+    stream_queues_deinit(&is->commands, &is->garbage, &is->garbage_collecting);
+
     soundio_device_unref(instream->device);
     free(is);
 }
@@ -675,14 +974,23 @@ enum SoundIoError soundio_instream_begin_read(struct SoundIoInStream *instream,
     struct SoundIo *soundio = instream->device->soundio;
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
-    return si->instream_begin_read(si, is, areas, frame_count);
+    enum SoundIoError err = si->instream_begin_read(si, is, areas, frame_count);
+    is->counters.pending_frames = err ? 0 : *frame_count;
+    // a NULL area is a hole in the buffer, which has nothing to measure
+    if (!err && is->meter && *areas && *frame_count > 0)
+        soundio_meter_process(is->meter, *areas, *frame_count);
+    return err;
 }
 
 enum SoundIoError soundio_instream_end_read(struct SoundIoInStream *instream) {
     struct SoundIo *soundio = instream->device->soundio;
     struct SoundIoPrivate *si = (struct SoundIoPrivate *)soundio;
     struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
-    return si->instream_end_read(si, is);
+    enum SoundIoError err = si->instream_end_read(si, is);
+    if (!err)
+        SOUNDIO_ATOMIC_FETCH_ADD(is->counters.frames_transferred, is->counters.pending_frames);
+    is->counters.pending_frames = 0;
+    return err;
 }
 
 enum SoundIoError soundio_instream_get_latency(struct SoundIoInStream *instream, double *out_latency) {
@@ -692,6 +1000,73 @@ enum SoundIoError soundio_instream_get_latency(struct SoundIoInStream *instream,
     return si->instream_get_latency(si, is, out_latency);
 }
 
+void soundio_instream_invoke_read(struct SoundIoInStream *instream,
+        int frame_count_min, int frame_count_max)
+{
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    double start = soundio_os_get_time();
+    soundio_rt_guard_enter();
+    if (is->commands.sequences) {
+        struct SoundIoCommand command;
+        for (int64_t i = 0; i <= is->commands.mask && soundio_mpsc_queue_pop(&is->commands, &command); i += 1)
+            instream->command_callback(instream, &command);
+    }
+    instream->read_callback(instream, frame_count_min, frame_count_max);
+    soundio_rt_guard_leave();
+    counters_record_callback(&is->counters, frame_count_min, frame_count_max,
+            soundio_os_get_time() - start);
+}
+
+void soundio_instream_invoke_overflow(struct SoundIoInStream *instream) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    SOUNDIO_ATOMIC_FETCH_ADD(is->counters.xrun_count, 1);
+    soundio_rt_guard_enter();
+    instream->overflow_callback(instream);
+    soundio_rt_guard_leave();
+}
+
+void soundio_instream_record_wakeup(struct SoundIoInStream *instream, double lateness) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    counters_record_wakeup(&is->counters, lateness);
+}
+
+void soundio_instream_get_stats(struct SoundIoInStream *instream, struct SoundIoStreamStats *out_stats) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    counters_snapshot(&is->counters, out_stats);
+    out_stats->late_wakeup_count = SOUNDIO_ATOMIC_LOAD(is->deadline_miss_count);
+}
+
+enum SoundIoError soundio_instream_post_command(struct SoundIoInStream *instream,
+        const struct SoundIoCommand *command)
+{
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    return post_command(&is->commands, command);
+}
+
+enum SoundIoError soundio_instream_defer_free(struct SoundIoInStream *instream,
+        void *ptr, void (*free_fn)(void *))
+{
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    return defer_free(&is->garbage, ptr, free_fn);
+}
+
+void soundio_instream_collect_garbage(struct SoundIoInStream *instream) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    collect_garbage(&is->garbage, &is->garbage_collecting);
+}
+
+void soundio_instream_get_meter(struct SoundIoInStream *instream,
+        struct SoundIoMeterSnapshot *out_snapshot)
+{
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    soundio_meter_get_snapshot(is->meter, out_snapshot);
+}
+
+long soundio_instream_deadline_miss_count(struct SoundIoInStream *instream) {
+    struct SoundIoInStreamPrivate *is = (struct SoundIoInStreamPrivate *)instream;
+    return SOUNDIO_ATOMIC_LOAD(is->deadline_miss_count);
+}
+
 void soundio_destroy_devices_info(struct SoundIoDevicesInfo *devices_info) {
     if (!devices_info)
         return;
@@ -709,7 +1084,7 @@ void soundio_destroy_devices_info(struct SoundIoDevicesInfo *devices_info) {
 
 bool soundio_have_backend(enum SoundIoBackend backend) {
     assert(backend > 0);
-    assert(backend <= SoundIoBackendDummy);
+    assert(backend <= SoundIoBackendPipeWire);
     return backend_init_fns[backend];
 }
 
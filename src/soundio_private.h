@@ -11,6 +11,7 @@
 #include "soundio_internal.h"
 #include "config.h"
 #include "list.h"
+#include "mpsc_queue.h"
 
 #ifdef SOUNDIO_HAVE_JACK
 #include "jack.h"
@@ -36,6 +37,10 @@
 #include "android.h"
 #endif
 
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+#include "pipewire.h"
+#endif
+
 #include "remote.h"
 #include "dummy.h"
 
@@ -57,6 +62,9 @@ union SoundIoBackendData {
 #endif
 #ifdef SOUNDIO_HAVE_ANDROID
     struct SoundIoAndroid android;
+#endif
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    struct SoundIoPipeWire pipewire;
 #endif
     struct SoundIoRemote remote;
     struct SoundIoDummy dummy;
@@ -77,6 +85,9 @@ union SoundIoDeviceBackendData {
 #endif
 #ifdef SOUNDIO_HAVE_WASAPI
     struct SoundIoDeviceWasapi wasapi;
+#endif
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    struct SoundIoDevicePipeWire pipewire;
 #endif
     struct SoundIoRemote remote;
     struct SoundIoDeviceDummy dummy;
@@ -100,6 +111,9 @@ union SoundIoOutStreamBackendData {
 #endif
 #ifdef SOUNDIO_HAVE_ANDROID
     struct SoundIoOutStreamAndroid android;
+#endif
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    struct SoundIoOutStreamPipeWire pipewire;
 #endif
     struct SoundIoOutStreamRemote remote;
     struct SoundIoOutStreamDummy dummy;
@@ -123,6 +137,9 @@ union SoundIoInStreamBackendData {
 #endif
 #ifdef SOUNDIO_HAVE_ANDROID
     struct SoundIoInStreamAndroid android;
+#endif
+#ifdef SOUNDIO_HAVE_PIPEWIRE
+    struct SoundIoInStreamPipeWire pipewire;
 #endif
     struct SoundIoInStreamRemote remote;
     struct SoundIoInStreamDummy dummy;
@@ -139,14 +156,49 @@ struct SoundIoDevicesInfo {
     int default_input_index;
 };
 
+// Backing store of SoundIoStreamStats. Written only from the stream's
+// callback thread.
+struct SoundIoStreamCounters {
+    struct SoundIoAtomicLong callback_count;
+    struct SoundIoAtomicLong callback_duration[SOUNDIO_STATS_BUCKET_COUNT];
+    struct SoundIoAtomicLong max_callback_duration_ns;
+    struct SoundIoAtomicLong wakeup_jitter[SOUNDIO_STATS_BUCKET_COUNT];
+    struct SoundIoAtomicLong xrun_count;
+    struct SoundIoAtomicLong frames_requested;
+    struct SoundIoAtomicLong frames_offered;
+    struct SoundIoAtomicLong frames_transferred;
+    struct SoundIoAtomicLong zero_copy_periods;
+    struct SoundIoAtomicLong copy_periods;
+    // frame count of the begin_write/begin_read awaiting its end call
+    int pending_frames;
+};
+
 struct SoundIoOutStreamPrivate {
     struct SoundIoOutStream pub;
     union SoundIoOutStreamBackendData backend_data;
+    struct SoundIoAtomicLong deadline_miss_count;
+    struct SoundIoStreamCounters counters;
+    // NULL unless metering was requested and the format can be metered
+    struct SoundIoMeter *meter;
+    // areas of the begin_write awaiting its end_write
+    struct SoundIoChannelArea *meter_areas;
+    // Both queues are only allocated when command_queue_capacity is set.
+    // Applications post into `commands`; the stream thread drains it and
+    // posts into `garbage`, which non-realtime threads collect.
+    struct SoundIoMpscQueue commands;
+    struct SoundIoMpscQueue garbage;
+    struct SoundIoAtomicFlag garbage_collecting;
 };
 
 struct SoundIoInStreamPrivate {
     struct SoundIoInStream pub;
     union SoundIoInStreamBackendData backend_data;
+    struct SoundIoAtomicLong deadline_miss_count;
+    struct SoundIoStreamCounters counters;
+    struct SoundIoMeter *meter;
+    struct SoundIoMpscQueue commands;
+    struct SoundIoMpscQueue garbage;
+    struct SoundIoAtomicFlag garbage_collecting;
 };
 
 struct SoundIoPrivate {
@@ -155,6 +207,12 @@ struct SoundIoPrivate {
     // Safe to read from a single thread without a mutex.
     struct SoundIoDevicesInfo *safe_devices_info;
 
+    // Readable whenever ::soundio_flush_events has work to do. Created when
+    // a backend connects; NULL on systems without pollable descriptors.
+    struct SoundIoOsPollable *events_pollable;
+    // NULL unless SoundIo::realtime_worker_count is positive
+    struct SoundIoScheduler *scheduler;
+
     void (*destroy)(struct SoundIoPrivate *);
     void (*flush_events)(struct SoundIoPrivate *);
     void (*wait_events)(struct SoundIoPrivate *);
@@ -198,6 +256,26 @@ struct SoundIoDevicePrivate {
 
 void soundio_destroy_devices_info(struct SoundIoDevicesInfo *devices_info);
 
+// Backends call this instead of SoundIo::on_events_signal directly so that the
+// descriptor returned by ::soundio_get_event_fd becomes readable as well.
+// Safe to call from any thread.
+void soundio_emit_events_signal(struct SoundIo *soundio);
+
+// Backends invoke the stream callbacks through these so that the calls are
+// counted and timed in the stream's SoundIoStreamCounters.
+void soundio_outstream_invoke_write(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max);
+void soundio_outstream_invoke_underflow(struct SoundIoOutStream *outstream);
+void soundio_instream_invoke_read(struct SoundIoInStream *instream,
+        int frame_count_min, int frame_count_max);
+void soundio_instream_invoke_overflow(struct SoundIoInStream *instream);
+// `lateness` is seconds between when the stream thread should have started
+// its work and when it did. Negative values are ignored.
+void soundio_outstream_record_wakeup(struct SoundIoOutStream *outstream, double lateness);
+void soundio_instream_record_wakeup(struct SoundIoInStream *instream, double lateness);
+// Index of the SoundIoStreamStats histogram bucket that counts `seconds`.
+int soundio_stats_bucket(double seconds);
+
 static const int SOUNDIO_MIN_SAMPLE_RATE = 8000;
 static const int SOUNDIO_MAX_SAMPLE_RATE = 5644800;
 
@@ -27,12 +27,20 @@
 #define SOUNDIO_ATTR_FORMAT(...)
 #define SOUNDIO_ATTR_UNUSED __pragma(warning(suppress:4100))
 #define SOUNDIO_ATTR_WARN_UNUSED_RESULT _Check_return_
+#define SOUNDIO_RESTRICT __restrict
 #else
 #define SOUNDIO_ATTR_COLD __attribute__((cold))
 #define SOUNDIO_ATTR_NORETURN __attribute__((noreturn))
 #define SOUNDIO_ATTR_FORMAT(...) __attribute__((format(__VA_ARGS__)))
 #define SOUNDIO_ATTR_UNUSED __attribute__((unused))
 #define SOUNDIO_ATTR_WARN_UNUSED_RESULT __attribute__((warn_unused_result))
+#define SOUNDIO_RESTRICT restrict
+#endif
+
+#ifdef __cplusplus
+#define SOUNDIO_STATIC_ASSERT(condition, message) static_assert(condition, message)
+#else
+#define SOUNDIO_STATIC_ASSERT(condition, message) _Static_assert(condition, message)
 #endif
 
 
@@ -1057,7 +1057,7 @@ static int refresh_devices(struct SoundIoPrivate *si) {
     siw->ready_devices_info = rd.devices_info;
     siw->have_devices_flag = true;
     soundio_os_cond_signal(siw->cond, siw->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(siw->mutex);
 
     rd.devices_info = NULL;
@@ -1073,7 +1073,7 @@ static void shutdown_backend(struct SoundIoPrivate *si, int err) {
     soundio_os_mutex_lock(siw->mutex);
     siw->shutdown_err = err;
     soundio_os_cond_signal(siw->cond, siw->mutex);
-    soundio->on_events_signal(soundio);
+    soundio_emit_events_signal(soundio);
     soundio_os_mutex_unlock(siw->mutex);
 }
 
@@ -1398,7 +1398,7 @@ static void outstream_shared_run(struct SoundIoOutStreamPrivate *os) {
         return;
     }
     int frame_count_min = soundio_int_max(0, (int)osw->min_padding_frames - (int)frames_used);
-    outstream->write_callback(outstream, frame_count_min, osw->writable_frame_count);
+    soundio_outstream_invoke_write(outstream, frame_count_min, osw->writable_frame_count);
 
     if (FAILED(hr = IAudioClient_Start(osw->audio_client))) {
         outstream->error_callback(outstream, SoundIoErrorStreaming);
@@ -1460,9 +1460,9 @@ static void outstream_shared_run(struct SoundIoOutStreamPrivate *os) {
         osw->writable_frame_count = osw->buffer_frame_count - frames_used;
         if (osw->writable_frame_count > 0) {
             if (frames_used == 0 && !reset_buffer)
-                outstream->underflow_callback(outstream);
+                soundio_outstream_invoke_underflow(outstream);
             int frame_count_min = soundio_int_max(0, (int)osw->min_padding_frames - (int)frames_used);
-            outstream->write_callback(outstream, frame_count_min, osw->writable_frame_count);
+            soundio_outstream_invoke_write(outstream, frame_count_min, osw->writable_frame_count);
         }
     }
 }
@@ -1473,7 +1473,7 @@ static void outstream_raw_run(struct SoundIoOutStreamPrivate *os) {
 
     HRESULT hr;
 
-    outstream->write_callback(outstream, osw->buffer_frame_count, osw->buffer_frame_count);
+    soundio_outstream_invoke_write(outstream, osw->buffer_frame_count, osw->buffer_frame_count);
 
     if (FAILED(hr = IAudioClient_Start(osw->audio_client))) {
         outstream->error_callback(outstream, SoundIoErrorStreaming);
@@ -1501,7 +1501,7 @@ static void outstream_raw_run(struct SoundIoOutStreamPrivate *os) {
             }
         }
 
-        outstream->write_callback(outstream, osw->buffer_frame_count, osw->buffer_frame_count);
+        soundio_outstream_invoke_write(outstream, osw->buffer_frame_count, osw->buffer_frame_count);
     }
 }
 
@@ -1592,8 +1592,9 @@ static int outstream_open_wasapi(struct SoundIoPrivate *si, struct SoundIoOutStr
 
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(osw->thread_exit_flag);
     int err;
-    if ((err = soundio_os_thread_create(outstream_thread_run, os,
-                    soundio->emit_rtprio_warning, &osw->thread)))
+    if ((err = soundio_os_thread_create_with_attributes(outstream_thread_run, os, soundio,
+                    &outstream->thread_attributes, outstream->software_latency,
+                    &outstream->actual_thread_attributes, &osw->thread)))
     {
         outstream_destroy_wasapi(si, os);
         return err;
@@ -1904,7 +1905,7 @@ static void instream_raw_run(struct SoundIoInStreamPrivate *is) {
         if (!SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isw->thread_exit_flag))
             return;
 
-        instream->read_callback(instream, isw->buffer_frame_count, isw->buffer_frame_count);
+        soundio_instream_invoke_read(instream, isw->buffer_frame_count, isw->buffer_frame_count);
     }
 }
 
@@ -1936,7 +1937,7 @@ static void instream_shared_run(struct SoundIoInStreamPrivate *is) {
 
         isw->readable_frame_count = frames_available;
         if (isw->readable_frame_count > 0)
-            instream->read_callback(instream, 0, isw->readable_frame_count);
+            soundio_instream_invoke_read(instream, 0, isw->readable_frame_count);
     }
 }
 
@@ -2023,8 +2024,9 @@ static int instream_open_wasapi(struct SoundIoPrivate *si, struct SoundIoInStrea
 
     SOUNDIO_ATOMIC_FLAG_TEST_AND_SET(isw->thread_exit_flag);
     int err;
-    if ((err = soundio_os_thread_create(instream_thread_run, is,
-                    soundio->emit_rtprio_warning, &isw->thread)))
+    if ((err = soundio_os_thread_create_with_attributes(instream_thread_run, is, soundio,
+                    &instream->thread_attributes, instream->software_latency,
+                    &instream->actual_thread_attributes, &isw->thread)))
     {
         instream_destroy_wasapi(si, is);
         return err;
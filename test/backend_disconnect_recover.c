@@ -29,7 +29,7 @@ static void panic(const char *format, ...) {
 static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options]\n"
             "Options:\n"
-            "  [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--timeout seconds]\n", exe);
     return 1;
 }
@@ -61,6 +61,8 @@ int main(int argc, char **argv) {
                     backend = SoundIoBackendAlsa;
                 } else if (strcmp("pulseaudio", argv[i]) == 0) {
                     backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
                 } else if (strcmp("jack", argv[i]) == 0) {
                     backend = SoundIoBackendJack;
                 } else if (strcmp("coreaudio", argv[i]) == 0) {
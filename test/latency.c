@@ -16,7 +16,7 @@
 #include <stdint.h>
 
 static int usage(char *exe) {
-    fprintf(stderr, "Usage: %s [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi] [--latency seconds]\n", exe);
+    fprintf(stderr, "Usage: %s [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi] [--latency seconds]\n", exe);
     return 1;
 }
 
@@ -143,6 +143,8 @@ int main(int argc, char **argv) {
                     backend = SoundIoBackendAlsa;
                 } else if (strcmp("pulseaudio", argv[i]) == 0) {
                     backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
                 } else if (strcmp("jack", argv[i]) == 0) {
                     backend = SoundIoBackendJack;
                 } else if (strcmp("coreaudio", argv[i]) == 0) {
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2015 Andrew Kelley
+ *
+ * This file is part of libsoundio, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// Measures round-trip latency without a human listener: a test signal is
+// played into a loopback (the ALSA snd-aloop card, a PulseAudio monitor
+// source, or JACK ports wired back to themselves) and found again in the
+// captured audio by cross-correlation. The measured time between handing a
+// frame to soundio_outstream_end_write and receiving it from
+// soundio_instream_begin_read is compared with what
+// soundio_outstream_get_latency and soundio_instream_get_latency predicted.
+
+#include "soundio_private.h"
+#include "os.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int usage(char *exe) {
+    fprintf(stderr, "Usage: %s [options]\n"
+            "Options:\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
+            "  [--out-device id]  default: snd-aloop playback on ALSA, the default device otherwise\n"
+            "  [--in-device id]   default: snd-aloop capture on ALSA, the output's monitor on PulseAudio\n"
+            "  [--signal mls|impulse]  default mls\n"
+            "  [--runs count]  default 10\n"
+            "  [--latency seconds]  default 0.01\n", exe);
+    return 1;
+}
+
+// a run gives up on finding the signal after this long
+static const double capture_seconds = 1.0;
+static const int max_chunks = 4096;
+
+struct CaptureChunk {
+    // when the read callback ran
+    double time;
+    int first_frame;
+    int frame_count;
+};
+
+static float *signal_samples;
+static int signal_frame_count;
+
+// written by the main thread between runs, read by the write callback
+static struct SoundIoAtomicBool emit_requested;
+static int signal_pos = -1;
+static double emit_time;
+static double emit_predicted_latency;
+static struct SoundIoAtomicBool emit_done;
+
+static float *capture_samples;
+static int capture_capacity;
+static int capture_frame_count;
+static struct CaptureChunk *capture_chunks;
+static int capture_chunk_count;
+static double capture_predicted_latency;
+static struct SoundIoAtomicBool capturing;
+
+// x^12 + x^11 + x^10 + x^4 + 1, a maximal length sequence of 4095 frames
+static void generate_mls(float amplitude) {
+    signal_frame_count = 4095;
+    signal_samples = ALLOCATE(float, signal_frame_count);
+    if (!signal_samples)
+        soundio_panic("out of memory");
+    unsigned lfsr = 1;
+    for (int i = 0; i < signal_frame_count; i += 1) {
+        signal_samples[i] = (lfsr & 1) ? amplitude : -amplitude;
+        unsigned bit = ((lfsr >> 11) ^ (lfsr >> 10) ^ (lfsr >> 9) ^ (lfsr >> 3)) & 1;
+        lfsr = ((lfsr << 1) | bit) & 0xfff;
+    }
+}
+
+static void generate_impulse(float amplitude) {
+    signal_frame_count = 1;
+    signal_samples = ALLOCATE(float, signal_frame_count);
+    if (!signal_samples)
+        soundio_panic("out of memory");
+    signal_samples[0] = amplitude;
+}
+
+static void write_callback(struct SoundIoOutStream *outstream, int frame_count_min, int frame_count_max) {
+    struct SoundIoChannelArea *areas;
+    int frames_left = frame_count_max;
+    int err;
+
+    while (frames_left > 0) {
+        int frame_count = frames_left;
+        if ((err = soundio_outstream_begin_write(outstream, &areas, &frame_count)))
+            soundio_panic("begin write: %s", soundio_error_name(err));
+        if (!frame_count)
+            break;
+
+        double now = soundio_os_get_time();
+        for (int frame = 0; frame < frame_count; frame += 1) {
+            float sample = 0.0f;
+            if (signal_pos < 0 && SOUNDIO_ATOMIC_LOAD(emit_requested)) {
+                SOUNDIO_ATOMIC_STORE(emit_requested, false);
+                signal_pos = 0;
+                // the frames before this one in the same write play first
+                emit_time = now + frame / (double)outstream->sample_rate;
+                double latency;
+                if ((err = soundio_outstream_get_latency(outstream, &latency)))
+                    soundio_panic("get latency: %s", soundio_error_name(err));
+                emit_predicted_latency = latency;
+            }
+            if (signal_pos >= 0) {
+                sample = signal_samples[signal_pos];
+                signal_pos += 1;
+                if (signal_pos == signal_frame_count) {
+                    signal_pos = -1;
+                    SOUNDIO_ATOMIC_STORE(emit_done, true);
+                }
+            }
+            for (int ch = 0; ch < outstream->layout.channel_count; ch += 1) {
+                *(float *)areas[ch].ptr = sample;
+                areas[ch].ptr += areas[ch].step;
+            }
+        }
+
+        if ((err = soundio_outstream_end_write(outstream)))
+            soundio_panic("end write: %s", soundio_error_name(err));
+        frames_left -= frame_count;
+    }
+}
+
+static void read_callback(struct SoundIoInStream *instream, int frame_count_min, int frame_count_max) {
+    struct SoundIoChannelArea *areas;
+    int frames_left = frame_count_max;
+    int err;
+
+    while (frames_left > 0) {
+        int frame_count = frames_left;
+        if ((err = soundio_instream_begin_read(instream, &areas, &frame_count)))
+            soundio_panic("begin read: %s", soundio_error_name(err));
+        if (!frame_count)
+            break;
+
+        if (SOUNDIO_ATOMIC_LOAD(capturing) && capture_chunk_count < max_chunks) {
+            int count = soundio_int_min(frame_count, capture_capacity - capture_frame_count);
+            struct CaptureChunk *chunk = &capture_chunks[capture_chunk_count++];
+            chunk->time = soundio_os_get_time();
+            chunk->first_frame = capture_frame_count;
+            chunk->frame_count = frame_count;
+            if (capture_chunk_count == 1) {
+                double latency;
+                if ((err = soundio_instream_get_latency(instream, &latency)))
+                    soundio_panic("get latency: %s", soundio_error_name(err));
+                capture_predicted_latency = latency;
+            }
+            for (int frame = 0; frame < count; frame += 1) {
+                // holes come back as NULL areas and count as silence
+                float sample = areas ? *(float *)(areas[0].ptr + areas[0].step * frame) : 0.0f;
+                capture_samples[capture_frame_count + frame] = sample;
+            }
+            capture_frame_count += count;
+            if (capture_frame_count == capture_capacity)
+                SOUNDIO_ATOMIC_STORE(capturing, false);
+        }
+
+        if ((err = soundio_instream_end_read(instream)))
+            soundio_panic("end read: %s", soundio_error_name(err));
+        frames_left -= frame_count;
+    }
+}
+
+// Returns the capture frame where the signal starts, or -1 if the best match
+// is too weak to be the signal.
+static int find_signal(void) {
+    double energy = 0.0;
+    for (int i = 0; i < signal_frame_count; i += 1)
+        energy += signal_samples[i] * signal_samples[i];
+
+    int best_frame = -1;
+    double best = 0.0;
+    for (int start = 0; start + signal_frame_count <= capture_frame_count; start += 1) {
+        double sum = 0.0;
+        for (int i = 0; i < signal_frame_count; i += 1)
+            sum += signal_samples[i] * capture_samples[start + i];
+        if (fabs(sum) > best) {
+            best = fabs(sum);
+            best_frame = start;
+        }
+    }
+    // loopbacks may attenuate but should not bury the signal
+    return (best > 0.25 * energy) ? best_frame : -1;
+}
+
+static struct SoundIoDevice *find_device(struct SoundIo *soundio, bool output, const char *id) {
+    int count = output ? soundio_output_device_count(soundio) : soundio_input_device_count(soundio);
+    for (int i = 0; i < count; i += 1) {
+        struct SoundIoDevice *device = output ?
+            soundio_get_output_device(soundio, i) : soundio_get_input_device(soundio, i);
+        if (strcmp(device->id, id) == 0)
+            return device;
+        soundio_device_unref(device);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    char *exe = argv[0];
+    enum SoundIoBackend backend = SoundIoBackendNone;
+    const char *out_device_id = NULL;
+    const char *in_device_id = NULL;
+    bool use_impulse = false;
+    int run_count = 10;
+    double software_latency = 0.01;
+    for (int i = 1; i < argc; i += 1) {
+        char *arg = argv[i];
+        if (arg[0] == '-' && arg[1] == '-') {
+            i += 1;
+            if (i >= argc) {
+                return usage(exe);
+            } else if (strcmp(arg, "--backend") == 0) {
+                if (strcmp("dummy", argv[i]) == 0) {
+                    backend = SoundIoBackendDummy;
+                } else if (strcmp("alsa", argv[i]) == 0) {
+                    backend = SoundIoBackendAlsa;
+                } else if (strcmp("pulseaudio", argv[i]) == 0) {
+                    backend = SoundIoBackendPulseAudio;
+                } else if (strcmp("pipewire", argv[i]) == 0) {
+                    backend = SoundIoBackendPipeWire;
+                } else if (strcmp("jack", argv[i]) == 0) {
+                    backend = SoundIoBackendJack;
+                } else if (strcmp("coreaudio", argv[i]) == 0) {
+                    backend = SoundIoBackendCoreAudio;
+                } else if (strcmp("wasapi", argv[i]) == 0) {
+                    backend = SoundIoBackendWasapi;
+                } else {
+                    fprintf(stderr, "Invalid backend: %s\n", argv[i]);
+                    return 1;
+                }
+            } else if (strcmp(arg, "--out-device") == 0) {
+                out_device_id = argv[i];
+            } else if (strcmp(arg, "--in-device") == 0) {
+                in_device_id = argv[i];
+            } else if (strcmp(arg, "--signal") == 0) {
+                if (strcmp("impulse", argv[i]) == 0) {
+                    use_impulse = true;
+                } else if (strcmp("mls", argv[i]) != 0) {
+                    return usage(exe);
+                }
+            } else if (strcmp(arg, "--runs") == 0) {
+                run_count = atoi(argv[i]);
+            } else if (strcmp(arg, "--latency") == 0) {
+                software_latency = atof(argv[i]);
+            } else {
+                return usage(exe);
+            }
+        } else {
+            return usage(exe);
+        }
+    }
+    if (run_count < 1)
+        return usage(exe);
+
+    struct SoundIo *soundio = soundio_create();
+    if (!soundio)
+        soundio_panic("out of memory");
+
+    int err = (backend == SoundIoBackendNone) ?
+        soundio_connect(soundio) : soundio_connect_backend(soundio, backend);
+    if (err)
+        soundio_panic("error connecting: %s", soundio_error_name(err));
+    backend = soundio->current_backend;
+
+    soundio_flush_events(soundio);
+
+    if (!out_device_id && backend == SoundIoBackendAlsa)
+        out_device_id = "plughw:CARD=Loopback,DEV=0";
+    if (!in_device_id && backend == SoundIoBackendAlsa)
+        in_device_id = "plughw:CARD=Loopback,DEV=1";
+
+    struct SoundIoDevice *out_device = out_device_id ?
+        find_device(soundio, true, out_device_id) :
+        soundio_get_output_device(soundio, soundio_default_output_device_index(soundio));
+    if (!out_device)
+        soundio_panic("output device not found (is snd-aloop loaded?)");
+
+    char *monitor_id = NULL;
+    if (!in_device_id && backend == SoundIoBackendPulseAudio) {
+        monitor_id = soundio_alloc_sprintf(NULL, "%s.monitor", out_device->id);
+        if (!monitor_id)
+            soundio_panic("out of memory");
+        in_device_id = monitor_id;
+    }
+    if (!in_device_id)
+        soundio_panic("no loopback input known for this backend; pass --in-device");
+    struct SoundIoDevice *in_device = find_device(soundio, false, in_device_id);
+    if (!in_device)
+        soundio_panic("input device not found: %s", in_device_id);
+
+    fprintf(stderr, "Output device: %s\nInput device: %s\n", out_device->name, in_device->name);
+
+    if (!soundio_device_supports_format(out_device, SoundIoFormatFloat32NE) ||
+        !soundio_device_supports_format(in_device, SoundIoFormatFloat32NE))
+    {
+        soundio_panic("devices must support %s", soundio_format_name(SoundIoFormatFloat32NE));
+    }
+
+    if (use_impulse)
+        generate_impulse(0.9f);
+    else
+        generate_mls(0.5f);
+
+    struct SoundIoOutStream *outstream = soundio_outstream_create(out_device);
+    struct SoundIoInStream *instream = soundio_instream_create(in_device);
+    if (!outstream || !instream)
+        soundio_panic("out of memory");
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->software_latency = software_latency;
+    outstream->write_callback = write_callback;
+    instream->format = SoundIoFormatFloat32NE;
+    instream->software_latency = software_latency;
+    instream->read_callback = read_callback;
+
+    if ((err = soundio_outstream_open(outstream)))
+        soundio_panic("unable to open output stream: %s", soundio_error_name(err));
+    instream->sample_rate = outstream->sample_rate;
+    if ((err = soundio_instream_open(instream)))
+        soundio_panic("unable to open input stream: %s", soundio_error_name(err));
+    if (instream->sample_rate != outstream->sample_rate)
+        soundio_panic("input and output sample rates differ");
+
+    capture_capacity = ceil_dbl_to_int(capture_seconds * instream->sample_rate) + signal_frame_count;
+    capture_samples = ALLOCATE(float, capture_capacity);
+    capture_chunks = ALLOCATE(struct CaptureChunk, max_chunks);
+    if (!capture_samples || !capture_chunks)
+        soundio_panic("out of memory");
+
+    if ((err = soundio_instream_start(instream)))
+        soundio_panic("unable to start input stream: %s", soundio_error_name(err));
+    if ((err = soundio_outstream_start(outstream)))
+        soundio_panic("unable to start output stream: %s", soundio_error_name(err));
+
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    if (!cond)
+        soundio_panic("out of memory");
+    // let both streams settle before the first run
+    soundio_os_cond_timed_wait(cond, NULL, 0.5);
+
+    double rate = outstream->sample_rate;
+    double measured_sum = 0.0;
+    double measured_sq_sum = 0.0;
+    double error_sum = 0.0;
+    int found_count = 0;
+    for (int run = 0; run < run_count; run += 1) {
+        capture_frame_count = 0;
+        capture_chunk_count = 0;
+        SOUNDIO_ATOMIC_STORE(emit_done, false);
+        SOUNDIO_ATOMIC_STORE(capturing, true);
+        SOUNDIO_ATOMIC_STORE(emit_requested, true);
+
+        double start = soundio_os_get_time();
+        while (SOUNDIO_ATOMIC_LOAD(capturing) && soundio_os_get_time() - start < capture_seconds + 1.0) {
+            soundio_flush_events(soundio);
+            soundio_os_cond_timed_wait(cond, NULL, 0.01);
+        }
+        SOUNDIO_ATOMIC_STORE(capturing, false);
+        // give the read callback time to notice before looking at its data
+        soundio_os_cond_timed_wait(cond, NULL, 2.0 * instream->software_latency + 0.01);
+        if (!SOUNDIO_ATOMIC_LOAD(emit_done)) {
+            printf("run %d: signal was not played\n", run);
+            continue;
+        }
+
+        int frame = find_signal();
+        if (frame < 0) {
+            printf("run %d: signal not found\n", run);
+            continue;
+        }
+        struct CaptureChunk *chunk = NULL;
+        for (int i = 0; i < capture_chunk_count; i += 1) {
+            if (frame >= capture_chunks[i].first_frame &&
+                frame < capture_chunks[i].first_frame + capture_chunks[i].frame_count)
+            {
+                chunk = &capture_chunks[i];
+                break;
+            }
+        }
+        assert(chunk);
+        // the frames after this one in the same read were captured later
+        double frames_after = chunk->first_frame + chunk->frame_count - frame;
+        double arrival_time = chunk->time - frames_after / rate;
+        double measured = arrival_time - emit_time;
+        double predicted = emit_predicted_latency + capture_predicted_latency;
+
+        printf("run %d: round trip %.3f ms, reported %.3f ms (output %.3f + input %.3f), off by %+.3f ms\n",
+                run, measured * 1000.0, predicted * 1000.0, emit_predicted_latency * 1000.0,
+                capture_predicted_latency * 1000.0, (predicted - measured) * 1000.0);
+        measured_sum += measured;
+        measured_sq_sum += measured * measured;
+        error_sum += predicted - measured;
+        found_count += 1;
+    }
+
+    if (found_count > 0) {
+        double mean = measured_sum / found_count;
+        double variance = measured_sq_sum / found_count - mean * mean;
+        printf("round trip: mean %.3f ms, jitter (stddev) %.3f ms over %d runs; "
+                "reported latency is off by %+.3f ms on average\n",
+                mean * 1000.0, sqrt(variance > 0.0 ? variance : 0.0) * 1000.0, found_count,
+                error_sum / found_count * 1000.0);
+    }
+
+    soundio_os_cond_destroy(cond);
+    soundio_outstream_destroy(outstream);
+    soundio_instream_destroy(instream);
+    soundio_device_unref(out_device);
+    soundio_device_unref(in_device);
+    soundio_destroy(soundio);
+    free(monitor_id);
+    free(capture_samples);
+    free(capture_chunks);
+    free(signal_samples);
+    return (found_count == run_count) ? 0 : 1;
+}
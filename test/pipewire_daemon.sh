@@ -0,0 +1,49 @@
+#!/bin/sh
+# Runs the stream tests against a private PipeWire daemon, so that the
+# PipeWire backend can be exercised on a machine without a desktop session
+# or sound card. Needs `pipewire` and `wireplumber` in PATH; WirePlumber
+# links the test streams to the null devices from test/pipewire.conf.
+#
+# Usage: test/pipewire_daemon.sh [build directory]
+
+set -e
+
+BUILD_DIR=${1:-.}
+TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+
+RUNTIME_DIR=$(mktemp -d)
+export XDG_RUNTIME_DIR="$RUNTIME_DIR"
+export PIPEWIRE_RUNTIME_DIR="$RUNTIME_DIR"
+export PIPEWIRE_REMOTE=libsoundio-test
+
+PW_PID=
+WP_PID=
+cleanup() {
+    [ -n "$WP_PID" ] && kill "$WP_PID" 2>/dev/null
+    [ -n "$PW_PID" ] && kill "$PW_PID" 2>/dev/null
+    wait 2>/dev/null
+    rm -rf "$RUNTIME_DIR"
+}
+trap cleanup EXIT
+
+pipewire -c "$TEST_DIR/pipewire.conf" &
+PW_PID=$!
+i=0
+while [ ! -S "$RUNTIME_DIR/$PIPEWIRE_REMOTE" ]; do
+    i=$((i + 1))
+    if [ "$i" -gt 50 ]; then
+        echo "pipewire did not start" >&2
+        exit 1
+    fi
+    sleep 0.1
+done
+
+wireplumber &
+WP_PID=$!
+# give the session manager time to pick default devices
+sleep 2
+
+"$BUILD_DIR/sio_list_devices" --backend pipewire
+"$BUILD_DIR/underflow" --backend pipewire
+"$BUILD_DIR/overflow" --backend pipewire
+echo "PipeWire backend: OK"
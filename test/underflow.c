@@ -30,7 +30,7 @@ static void panic(const char *format, ...) {
 static int usage(char *exe) {
     fprintf(stderr, "Usage: %s [options]\n"
             "Options:\n"
-            "  [--backend dummy|alsa|pulseaudio|jack|coreaudio|wasapi]\n"
+            "  [--backend dummy|alsa|pulseaudio|pipewire|jack|coreaudio|wasapi]\n"
             "  [--device id]\n"
             "  [--raw]\n"
             "  [--sample-rate hz]\n"
@@ -147,6 +147,8 @@ int main(int argc, char **argv) {
                         backend = SoundIoBackendAlsa;
                     } else if (strcmp(argv[i], "pulseaudio") == 0) {
                         backend = SoundIoBackendPulseAudio;
+                    } else if (strcmp(argv[i], "pipewire") == 0) {
+                        backend = SoundIoBackendPipeWire;
                     } else if (strcmp(argv[i], "jack") == 0) {
                         backend = SoundIoBackendJack;
                     } else if (strcmp(argv[i], "coreaudio") == 0) {
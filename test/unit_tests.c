@@ -4,11 +4,19 @@
 #include "os.h"
 #include "util.h"
 #include "atomics.h"
+#include "rt_guard.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <limits.h>
+#include <math.h>
+
+#if !defined(_WIN32)
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 static inline void ok_or_panic(int err) {
     if (err)
@@ -55,6 +63,220 @@ static void test_create_outstream(void) {
 }
 
 
+static bool gain_is(struct SoundIoChannelMixer *mixer, int dst, int src, float expected) {
+    float gain = soundio_channel_mixer_get_gain(mixer, dst, src);
+    return gain > expected - 0.0001f && gain < expected + 0.0001f;
+}
+
+static void test_channel_mixer(void) {
+    const struct SoundIoChannelLayout *mono = soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdMono);
+    const struct SoundIoChannelLayout *stereo = soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdStereo);
+    const struct SoundIoChannelLayout *surround = soundio_channel_layout_get_builtin(SoundIoChannelLayoutId5Point1);
+    struct SoundIoChannelMixer *mixer;
+
+    // 5.1 to stereo: center and surrounds at -3 dB, LFE dropped
+    ok_or_panic(soundio_channel_mixer_create(surround, stereo, 0, &mixer));
+    int fl = soundio_channel_layout_find_channel(surround, SoundIoChannelIdFrontLeft);
+    int fr = soundio_channel_layout_find_channel(surround, SoundIoChannelIdFrontRight);
+    int fc = soundio_channel_layout_find_channel(surround, SoundIoChannelIdFrontCenter);
+    int lfe = soundio_channel_layout_find_channel(surround, SoundIoChannelIdLfe);
+    int sl = soundio_channel_layout_find_channel(surround, SoundIoChannelIdSideLeft);
+    assert(gain_is(mixer, 0, fl, 1.0f));
+    assert(gain_is(mixer, 0, fr, 0.0f));
+    assert(gain_is(mixer, 0, fc, 0.7071f));
+    assert(gain_is(mixer, 1, fc, 0.7071f));
+    assert(gain_is(mixer, 0, sl, 0.7071f));
+    assert(gain_is(mixer, 1, sl, 0.0f));
+    assert(gain_is(mixer, 0, lfe, 0.0f));
+    soundio_channel_mixer_destroy(mixer);
+
+    ok_or_panic(soundio_channel_mixer_create(surround, stereo,
+                SoundIoChannelMixerFlagMixLfe | SoundIoChannelMixerFlagNormalize, &mixer));
+    float sum = 0.0f;
+    for (int src = 0; src < surround->channel_count; src += 1)
+        sum += soundio_channel_mixer_get_gain(mixer, 0, src);
+    assert(sum < 1.0001f);
+    assert(soundio_channel_mixer_get_gain(mixer, 0, lfe) > 0.0f);
+    soundio_channel_mixer_destroy(mixer);
+
+    // 7.1 to side based 5.1: back and side surrounds share the side
+    // speakers at -3 dB each
+    const struct SoundIoChannelLayout *seven_one = soundio_channel_layout_get_builtin(SoundIoChannelLayoutId7Point1);
+    ok_or_panic(soundio_channel_mixer_create(seven_one, surround, 0, &mixer));
+    int dst_sl = soundio_channel_layout_find_channel(surround, SoundIoChannelIdSideLeft);
+    int dst_sr = soundio_channel_layout_find_channel(surround, SoundIoChannelIdSideRight);
+    int dst_fl = soundio_channel_layout_find_channel(surround, SoundIoChannelIdFrontLeft);
+    int src_fl = soundio_channel_layout_find_channel(seven_one, SoundIoChannelIdFrontLeft);
+    int src_bl = soundio_channel_layout_find_channel(seven_one, SoundIoChannelIdBackLeft);
+    int src_sl = soundio_channel_layout_find_channel(seven_one, SoundIoChannelIdSideLeft);
+    int src_br = soundio_channel_layout_find_channel(seven_one, SoundIoChannelIdBackRight);
+    int src_sr = soundio_channel_layout_find_channel(seven_one, SoundIoChannelIdSideRight);
+    assert(gain_is(mixer, dst_fl, src_fl, 1.0f));
+    assert(gain_is(mixer, dst_sl, src_sl, 0.7071f));
+    assert(gain_is(mixer, dst_sl, src_bl, 0.7071f));
+    assert(gain_is(mixer, dst_sl, src_sr, 0.0f));
+    assert(gain_is(mixer, dst_sr, src_sr, 0.7071f));
+    assert(gain_is(mixer, dst_sr, src_br, 0.7071f));
+    soundio_channel_mixer_destroy(mixer);
+
+    // mono feeds both sides of interleaved stereo
+    ok_or_panic(soundio_channel_mixer_create(mono, stereo, 0, &mixer));
+    float src_buf[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    float dst_buf[8];
+    struct SoundIoChannelArea src_areas[1] = {{(char *)src_buf, sizeof(float)}};
+    struct SoundIoChannelArea dst_areas[2] = {
+        {(char *)&dst_buf[0], 2 * sizeof(float)},
+        {(char *)&dst_buf[1], 2 * sizeof(float)},
+    };
+    soundio_channel_mixer_mix(mixer, src_areas, dst_areas, 4);
+    for (int i = 0; i < 4; i += 1) {
+        assert(dst_buf[2 * i] == dst_buf[2 * i + 1]);
+        assert(dst_buf[2 * i] > src_buf[i] * 0.7070f && dst_buf[2 * i] < src_buf[i] * 0.7072f);
+    }
+    soundio_channel_mixer_destroy(mixer);
+
+    // custom matrix from interleaved stereo to planar: swap plus a silent third channel
+    static const float gains[] = {
+        0.0f, 1.0f,
+        0.5f, 0.5f,
+        0.0f, 0.0f,
+    };
+    ok_or_panic(soundio_channel_mixer_create_custom(2, 3, gains, &mixer));
+    float planar[3][2];
+    struct SoundIoChannelArea stereo_areas[2] = {
+        {(char *)&src_buf[0], 2 * sizeof(float)},
+        {(char *)&src_buf[1], 2 * sizeof(float)},
+    };
+    struct SoundIoChannelArea planar_areas[3] = {
+        {(char *)planar[0], sizeof(float)},
+        {(char *)planar[1], sizeof(float)},
+        {(char *)planar[2], sizeof(float)},
+    };
+    soundio_channel_mixer_mix(mixer, stereo_areas, planar_areas, 2);
+    assert(planar[0][0] == 2.0f && planar[0][1] == 4.0f);
+    assert(planar[1][0] == 1.5f && planar[1][1] == 3.5f);
+    assert(planar[2][0] == 0.0f && planar[2][1] == 0.0f);
+    soundio_channel_mixer_destroy(mixer);
+}
+
+static void test_converter(void) {
+    struct SoundIoConverter *converter;
+    assert(soundio_converter_create(SoundIoFormatU8, SoundIoFormatS16NE, 2, &converter) == SoundIoErrorInvalid);
+
+    // planar float to interleaved s16, clamping out of range samples
+    float left[4] = {0.0f, 0.5f, -1.0f, 2.0f};
+    float right[4] = {1.0f, -0.5f, 0.25f, -2.0f};
+    int16_t interleaved[8];
+    struct SoundIoChannelArea planar_areas[2] = {
+        {(char *)left, sizeof(float)},
+        {(char *)right, sizeof(float)},
+    };
+    struct SoundIoChannelArea interleaved_areas[2] = {
+        {(char *)&interleaved[0], 2 * sizeof(int16_t)},
+        {(char *)&interleaved[1], 2 * sizeof(int16_t)},
+    };
+    ok_or_panic(soundio_converter_create(SoundIoFormatFloat32NE, SoundIoFormatS16NE, 2, &converter));
+    soundio_converter_convert(converter, planar_areas, interleaved_areas, 4);
+    static const int16_t expected[8] = {0, 32767, 16384, -16384, -32768, 8192, 32767, -32768};
+    assert(memcmp(interleaved, expected, sizeof(expected)) == 0);
+    soundio_converter_destroy(converter);
+
+    // and back into s32 through the generic path: every other sample only
+    int32_t wide[16];
+    struct SoundIoChannelArea sparse_areas[2] = {
+        {(char *)&wide[0], 4 * sizeof(int32_t)},
+        {(char *)&wide[1], 4 * sizeof(int32_t)},
+    };
+    ok_or_panic(soundio_converter_create(SoundIoFormatS16NE, SoundIoFormatS32NE, 2, &converter));
+    soundio_converter_convert(converter, interleaved_areas, sparse_areas, 4);
+    for (int i = 0; i < 4; i += 1) {
+        assert(wide[4 * i] == expected[2 * i] * 65536);
+        assert(wide[4 * i + 1] == expected[2 * i + 1] * 65536);
+    }
+    soundio_converter_destroy(converter);
+
+    // interleaved 6 channel s24 to planar float and back
+    int32_t s24[12];
+    for (int i = 0; i < 12; i += 1)
+        s24[i] = (i - 6) * 100000;
+    float planar[6][2];
+    struct SoundIoChannelArea s24_areas[6];
+    struct SoundIoChannelArea float_areas[6];
+    for (int ch = 0; ch < 6; ch += 1) {
+        s24_areas[ch].ptr = (char *)&s24[ch];
+        s24_areas[ch].step = 6 * sizeof(int32_t);
+        float_areas[ch].ptr = (char *)planar[ch];
+        float_areas[ch].step = sizeof(float);
+    }
+    ok_or_panic(soundio_converter_create(SoundIoFormatS24NE, SoundIoFormatFloat32NE, 6, &converter));
+    soundio_converter_convert(converter, s24_areas, float_areas, 2);
+    soundio_converter_destroy(converter);
+    assert(planar[1][1] == (7 - 6) * 100000 / 8388608.0f);
+    int32_t round_trip[12];
+    for (int ch = 0; ch < 6; ch += 1)
+        s24_areas[ch].ptr = (char *)&round_trip[ch];
+    ok_or_panic(soundio_converter_create(SoundIoFormatFloat32NE, SoundIoFormatS24NE, 6, &converter));
+    soundio_converter_convert(converter, float_areas, s24_areas, 2);
+    soundio_converter_destroy(converter);
+    assert(memcmp(round_trip, s24, sizeof(s24)) == 0);
+
+    // float to s32 rounds half away from zero like the narrower formats,
+    // without nudging odd values that are too large to have a fraction
+    float halves[4] = {2.5f / 2147483648.0f, -2.5f / 2147483648.0f,
+        8388609.0f / 2147483648.0f, -8388609.0f / 2147483648.0f};
+    int32_t rounded[4];
+    struct SoundIoChannelArea halves_area = {(char *)halves, sizeof(float)};
+    struct SoundIoChannelArea rounded_area = {(char *)rounded, sizeof(int32_t)};
+    ok_or_panic(soundio_converter_create(SoundIoFormatFloat32NE, SoundIoFormatS32NE, 1, &converter));
+    soundio_converter_convert(converter, &halves_area, &rounded_area, 4);
+    soundio_converter_destroy(converter);
+    assert(rounded[0] == 3 && rounded[1] == -3);
+    assert(rounded[2] == 8388609 && rounded[3] == -8388609);
+}
+
+static void test_converter_dither(void) {
+    // a level between two s16 steps, which plain rounding always maps to the
+    // same value but dither reproduces on average
+    enum { frame_count = 20000 };
+    static float src[frame_count];
+    static int16_t dst[frame_count];
+    for (int i = 0; i < frame_count; i += 1)
+        src[i] = 1000.3f / 32768.0f;
+    struct SoundIoChannelArea src_area = {(char *)src, sizeof(float)};
+    struct SoundIoChannelArea dst_area = {(char *)dst, sizeof(int16_t)};
+
+    struct SoundIoConverter *converter;
+    ok_or_panic(soundio_converter_create(SoundIoFormatFloat32NE, SoundIoFormatS16NE, 1, &converter));
+    assert(soundio_converter_set_dither(converter, (enum SoundIoDither)42) == SoundIoErrorInvalid);
+
+    enum SoundIoDither modes[] = {SoundIoDitherTriangular, SoundIoDitherShapedLight, SoundIoDitherShapedStrong};
+    for (int m = 0; m < 3; m += 1) {
+        ok_or_panic(soundio_converter_set_dither(converter, modes[m]));
+        // in two calls, so that the filter state carries over
+        double sum = 0.0;
+        soundio_converter_convert(converter, &src_area, &dst_area, frame_count / 2);
+        dst_area.ptr = (char *)&dst[frame_count / 2];
+        src_area.ptr = (char *)&src[frame_count / 2];
+        soundio_converter_convert(converter, &src_area, &dst_area, frame_count / 2);
+        dst_area.ptr = (char *)dst;
+        src_area.ptr = (char *)src;
+        bool varies = false;
+        for (int i = 0; i < frame_count; i += 1) {
+            sum += dst[i];
+            varies = varies || dst[i] != dst[0];
+            assert(dst[i] > 1000 - 40 && dst[i] < 1000 + 40);
+        }
+        assert(varies);
+        double mean = sum / frame_count;
+        assert(mean > 1000.25 && mean < 1000.35);
+    }
+
+    ok_or_panic(soundio_converter_set_dither(converter, SoundIoDitherNone));
+    soundio_converter_convert(converter, &src_area, &dst_area, frame_count);
+    assert(dst[0] == 1000 && dst[frame_count - 1] == 1000);
+    soundio_converter_destroy(converter);
+}
+
 static void test_ring_buffer_basic(void) {
     struct SoundIo *soundio = soundio_create();
     assert(soundio);
@@ -166,6 +388,184 @@ static void test_ring_buffer_threaded(void) {
     soundio_destroy(soundio);
 }
 
+static void slow_writer_thread_run(void *arg) {
+    struct SoundIoRingBuffer *ring_buffer = (struct SoundIoRingBuffer *)arg;
+    for (int i = 0; i < 10; i += 1) {
+        double until = soundio_os_get_time() + 0.005;
+        while (soundio_os_get_time() < until) {}
+        soundio_ring_buffer_advance_write_ptr(ring_buffer, 10);
+    }
+}
+
+static void test_ring_buffer_wait(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    struct SoundIoRingBuffer *ring_buffer = soundio_ring_buffer_create(soundio, 4096);
+    assert(ring_buffer);
+    int capacity = soundio_ring_buffer_capacity(ring_buffer);
+
+    assert(!soundio_ring_buffer_wait_fill(ring_buffer, 1, 0.001));
+    assert(soundio_ring_buffer_wait_free(ring_buffer, capacity, 0.0));
+
+    struct SoundIoOsThread *writer_thread;
+    ok_or_panic(soundio_os_thread_create(slow_writer_thread_run, ring_buffer, NULL, &writer_thread));
+    assert(soundio_ring_buffer_wait_fill(ring_buffer, 100, 5.0));
+    soundio_os_thread_destroy(writer_thread);
+    assert(soundio_ring_buffer_fill_count(ring_buffer) == 100);
+
+    soundio_ring_buffer_advance_write_ptr(ring_buffer, capacity - 100);
+    assert(!soundio_ring_buffer_wait_free(ring_buffer, 1, 0.001));
+    soundio_ring_buffer_advance_read_ptr(ring_buffer, 1);
+    assert(soundio_ring_buffer_wait_free(ring_buffer, 1, -1.0));
+
+    soundio_ring_buffer_destroy(ring_buffer);
+    soundio_destroy(soundio);
+}
+
+static void test_frame_ring_buffer(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+
+    struct SoundIoFrameRingBuffer *rb = soundio_frame_ring_buffer_create(soundio, SoundIoFormatS16NE, 2, 1000);
+    assert(rb);
+    assert(soundio_frame_ring_buffer_bytes_per_frame(rb) == 4);
+    int64_t capacity = soundio_frame_ring_buffer_capacity(rb);
+    assert(capacity >= 1000);
+
+    // leave the positions just short of the end so that the next run wraps
+    struct SoundIoChannelArea *areas;
+    int64_t frame_count = capacity - 2;
+    soundio_frame_ring_buffer_begin_write(rb, &areas, &frame_count);
+    assert(frame_count == capacity - 2);
+    soundio_frame_ring_buffer_end_write(rb, frame_count);
+    soundio_frame_ring_buffer_begin_read(rb, &areas, &frame_count);
+    soundio_frame_ring_buffer_end_read(rb, frame_count);
+
+    frame_count = 8;
+    soundio_frame_ring_buffer_begin_write(rb, &areas, &frame_count);
+    assert(frame_count == 8);
+    for (int frame = 0; frame < 8; frame += 1) {
+        for (int ch = 0; ch < 2; ch += 1) {
+            *(int16_t *)areas[ch].ptr = (int16_t)(frame * 10 + ch);
+            areas[ch].ptr += areas[ch].step;
+        }
+    }
+    // commit only part of the reservation
+    soundio_frame_ring_buffer_end_write(rb, 5);
+    assert(soundio_frame_ring_buffer_fill_count(rb) == 5);
+    assert(soundio_frame_ring_buffer_free_count(rb) == capacity - 5);
+
+    frame_count = 100;
+    soundio_frame_ring_buffer_begin_read(rb, &areas, &frame_count);
+    assert(frame_count == 5);
+    for (int frame = 0; frame < 5; frame += 1) {
+        for (int ch = 0; ch < 2; ch += 1)
+            assert(*(int16_t *)(areas[ch].ptr + frame * areas[ch].step) == frame * 10 + ch);
+    }
+    soundio_frame_ring_buffer_end_read(rb, 5);
+    assert(soundio_frame_ring_buffer_fill_count(rb) == 0);
+
+    frame_count = capacity + 1;
+    soundio_frame_ring_buffer_begin_write(rb, &areas, &frame_count);
+    assert(frame_count == capacity);
+    soundio_frame_ring_buffer_end_write(rb, 0);
+
+    soundio_frame_ring_buffer_destroy(rb);
+    soundio_destroy(soundio);
+}
+
+static void test_broadcast_ring_buffer(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+
+    struct SoundIoBroadcastRingBuffer *rb = soundio_broadcast_ring_buffer_create(soundio, 4096, 2,
+            SoundIoBroadcastOverrunBlockWriter);
+    assert(rb);
+    int capacity = soundio_broadcast_ring_buffer_capacity(rb);
+    assert(soundio_broadcast_ring_buffer_free_count(rb) == capacity);
+
+    int reader_a, reader_b, reader_c;
+    ok_or_panic(soundio_broadcast_ring_buffer_add_reader(rb, &reader_a));
+    strcpy(soundio_broadcast_ring_buffer_write_ptr(rb), "hello");
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 6);
+    // a later reader starts at the current write position
+    ok_or_panic(soundio_broadcast_ring_buffer_add_reader(rb, &reader_b));
+    assert(soundio_broadcast_ring_buffer_add_reader(rb, &reader_c) == SoundIoErrorSystemResources);
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_b) == 0);
+
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_a) == 6);
+    assert(strcmp(soundio_broadcast_ring_buffer_read_ptr(rb, reader_a), "hello") == 0);
+    soundio_broadcast_ring_buffer_advance_read_ptr(rb, reader_a, 6);
+
+    // both readers see the same bytes and the slowest one limits free space
+    memcpy(soundio_broadcast_ring_buffer_write_ptr(rb), "abcdefgh", 8);
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 8);
+    assert(memcmp(soundio_broadcast_ring_buffer_read_ptr(rb, reader_a), "abcdefgh", 8) == 0);
+    assert(memcmp(soundio_broadcast_ring_buffer_read_ptr(rb, reader_b), "abcdefgh", 8) == 0);
+    soundio_broadcast_ring_buffer_advance_read_ptr(rb, reader_a, 8);
+    assert(soundio_broadcast_ring_buffer_free_count(rb) == capacity - 8);
+
+    struct SoundIoBroadcastReaderStats stats;
+    soundio_broadcast_ring_buffer_get_reader_stats(rb, reader_b, &stats);
+    assert(stats.lag == 8);
+    assert(stats.max_lag == 8);
+    assert(stats.overrun_count == 0);
+
+    soundio_broadcast_ring_buffer_remove_reader(rb, reader_b);
+    assert(soundio_broadcast_ring_buffer_free_count(rb) == capacity);
+    soundio_broadcast_ring_buffer_destroy(rb);
+
+    // a dropping writer laps a slow reader, which resumes with new data
+    rb = soundio_broadcast_ring_buffer_create(soundio, 4096, 2, SoundIoBroadcastOverrunDropReader);
+    assert(rb);
+    capacity = soundio_broadcast_ring_buffer_capacity(rb);
+    ok_or_panic(soundio_broadcast_ring_buffer_add_reader(rb, &reader_a));
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, capacity);
+    assert(soundio_broadcast_ring_buffer_free_count(rb) == capacity);
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 16);
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_a) == 0);
+    soundio_broadcast_ring_buffer_get_reader_stats(rb, reader_a, &stats);
+    assert(stats.lag == 0);
+    assert(stats.max_lag == capacity);
+    assert(stats.overrun_count == 1);
+    strcpy(soundio_broadcast_ring_buffer_write_ptr(rb), "after");
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 6);
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_a) == 6);
+    assert(strcmp(soundio_broadcast_ring_buffer_read_ptr(rb, reader_a), "after") == 0);
+    soundio_broadcast_ring_buffer_destroy(rb);
+
+    // the writer laps a reader in the middle of its read, which must then
+    // be thrown away
+    rb = soundio_broadcast_ring_buffer_create(soundio, 4096, 1, SoundIoBroadcastOverrunDropReader);
+    assert(rb);
+    capacity = soundio_broadcast_ring_buffer_capacity(rb);
+    ok_or_panic(soundio_broadcast_ring_buffer_add_reader(rb, &reader_a));
+    memcpy(soundio_broadcast_ring_buffer_write_ptr(rb), "abcdefgh", 8);
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 8);
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_a) == 8);
+    assert(soundio_broadcast_ring_buffer_advance_read_ptr(rb, reader_a, 8));
+
+    memcpy(soundio_broadcast_ring_buffer_write_ptr(rb), "ijklmnop", 8);
+    soundio_broadcast_ring_buffer_advance_write_ptr(rb, 8);
+    assert(soundio_broadcast_ring_buffer_fill_count(rb, reader_a) == 8);
+    char *read_ptr = soundio_broadcast_ring_buffer_read_ptr(rb, reader_a);
+    char copied[8];
+    memcpy(copied, read_ptr, 4);
+    for (int written = 0; written < capacity; written += 8) {
+        memset(soundio_broadcast_ring_buffer_write_ptr(rb), 'x', 8);
+        soundio_broadcast_ring_buffer_advance_write_ptr(rb, 8);
+    }
+    memcpy(copied + 4, read_ptr + 4, 4);
+    assert(memcmp(copied, "ijklxxxx", 8) == 0);
+    assert(!soundio_broadcast_ring_buffer_advance_read_ptr(rb, reader_a, 8));
+    soundio_broadcast_ring_buffer_get_reader_stats(rb, reader_a, &stats);
+    assert(stats.overrun_count == 1);
+    assert(stats.lag == 0);
+    soundio_broadcast_ring_buffer_destroy(rb);
+
+    soundio_destroy(soundio);
+}
+
 static void test_mirrored_memory(void) {
     struct SoundIoOsMirroredMemory mem;
     ok_or_panic(soundio_os_init());
@@ -184,6 +584,687 @@ static void test_mirrored_memory(void) {
     soundio_os_deinit_mirrored_memory(&mem);
 }
 
+static void test_ring_buffer_pool(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+
+    struct SoundIoRingBufferPoolStats before;
+    soundio_ring_buffer_pool_get_stats(&before);
+    ok_or_panic(soundio_ring_buffer_pool_reserve(16 * 1024, 2, SoundIoRingBufferPoolFlagLock));
+
+    struct SoundIoRingBufferPoolStats stats;
+    soundio_ring_buffer_pool_get_stats(&stats);
+    assert(stats.idle_count == before.idle_count + 2);
+
+    struct SoundIoRingBuffer *rb = soundio_ring_buffer_create(soundio, 10 * 1024);
+    assert(rb);
+    assert(soundio_ring_buffer_capacity(rb) >= 16 * 1024);
+    // pool memory must look like freshly mapped memory, and stay mirrored
+    char *ptr = soundio_ring_buffer_write_ptr(rb);
+    assert(ptr[0] == 0);
+    int capacity = soundio_ring_buffer_capacity(rb);
+    ptr[0] = 42;
+    assert(ptr[capacity] == 42);
+    soundio_ring_buffer_pool_get_stats(&stats);
+    assert(stats.hits == before.hits + 1);
+    assert(stats.idle_count == before.idle_count + 1);
+
+    // larger than anything in the pool
+    struct SoundIoRingBuffer *big = soundio_ring_buffer_create(soundio, 64 * 1024);
+    assert(big);
+    soundio_ring_buffer_pool_get_stats(&stats);
+    assert(stats.misses == before.misses + 1);
+    soundio_ring_buffer_destroy(big);
+
+    // much smaller than the idle region, which would inflate its capacity
+    if (soundio_os_page_size() < 8 * 1024) {
+        struct SoundIoRingBuffer *small = soundio_ring_buffer_create(soundio, 1024);
+        assert(small);
+        assert(soundio_ring_buffer_capacity(small) < 16 * 1024);
+        soundio_ring_buffer_pool_get_stats(&stats);
+        assert(stats.misses == before.misses + 2);
+        soundio_ring_buffer_destroy(small);
+    }
+
+    soundio_ring_buffer_destroy(rb);
+    soundio_ring_buffer_pool_get_stats(&stats);
+    assert(stats.idle_count == before.idle_count + 2);
+
+    rb = soundio_ring_buffer_create(soundio, 16 * 1024);
+    assert(rb);
+    assert(soundio_ring_buffer_write_ptr(rb)[0] == 0);
+    soundio_ring_buffer_destroy(rb);
+
+    soundio_ring_buffer_pool_trim();
+    soundio_ring_buffer_pool_get_stats(&stats);
+    assert(stats.idle_count == 0);
+
+    // Where huge pages are configured the region rounds up to a whole huge
+    // page, and must then sit out requests of the size it was reserved for
+    // rather than hand them a buffer many times too large.
+    soundio_ring_buffer_pool_get_stats(&before);
+    ok_or_panic(soundio_ring_buffer_pool_reserve(16 * 1024, 1, SoundIoRingBufferPoolFlagHugePages));
+    rb = soundio_ring_buffer_create(soundio, 16 * 1024);
+    assert(rb);
+    assert(soundio_ring_buffer_capacity(rb) < 32 * 1024);
+    soundio_ring_buffer_pool_get_stats(&stats);
+    if (stats.misses > before.misses)
+        assert(stats.idle_count == 1);
+    else
+        assert(stats.idle_count == 0);
+    soundio_ring_buffer_destroy(rb);
+    soundio_ring_buffer_pool_trim();
+
+    soundio_destroy(soundio);
+}
+
+#if !defined(_WIN32)
+static void test_shared_ring_buffer(void) {
+    const struct SoundIoChannelLayout *stereo = soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdStereo);
+    struct SoundIoSharedRingBuffer *writer;
+    ok_or_panic(soundio_shared_ring_buffer_create(NULL, 4096, SoundIoFormatS16LE, 44100, stereo, &writer));
+    int capacity = soundio_shared_ring_buffer_capacity(writer);
+    // nobody reads yet, so the writer may fill the whole buffer
+    assert(soundio_shared_ring_buffer_free_count(writer) == capacity);
+
+    int sockets[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    ok_or_panic(soundio_shared_ring_buffer_send(writer, sockets[0]));
+    struct SoundIoSharedRingBuffer *reader_a;
+    ok_or_panic(soundio_shared_ring_buffer_receive(sockets[1], &reader_a));
+    close(sockets[0]);
+    close(sockets[1]);
+
+    enum SoundIoFormat format;
+    int sample_rate;
+    struct SoundIoChannelLayout layout;
+    soundio_shared_ring_buffer_get_format(reader_a, &format, &sample_rate, &layout);
+    assert(format == SoundIoFormatS16LE);
+    assert(sample_rate == 44100);
+    assert(soundio_channel_layout_equal(&layout, stereo));
+
+    strcpy(soundio_shared_ring_buffer_write_ptr(writer), "hello");
+    soundio_shared_ring_buffer_advance_write_ptr(writer, 6);
+
+    // a second reader starts at the current write position
+    struct SoundIoSharedRingBuffer *reader_b;
+    ok_or_panic(soundio_shared_ring_buffer_attach_fd(dup(soundio_shared_ring_buffer_fd(writer)), &reader_b));
+    assert(soundio_shared_ring_buffer_fill_count(reader_b) == 0);
+    assert(!soundio_shared_ring_buffer_wait_fill(reader_b, 1, 0.001));
+
+    assert(soundio_shared_ring_buffer_wait_fill(reader_a, 6, 0.0));
+    assert(strcmp(soundio_shared_ring_buffer_read_ptr(reader_a), "hello") == 0);
+    assert(soundio_shared_ring_buffer_free_count(writer) == capacity - 6);
+    soundio_shared_ring_buffer_advance_read_ptr(reader_a, 6);
+
+    // writes wrap around contiguously and the slowest reader limits free space
+    soundio_shared_ring_buffer_advance_write_ptr(writer, capacity - 6 - 3);
+    assert(soundio_shared_ring_buffer_free_count(writer) == 6 + 3);
+    char *ptr = soundio_shared_ring_buffer_write_ptr(writer);
+    memcpy(ptr, "abcdefgh", 8);
+    soundio_shared_ring_buffer_advance_write_ptr(writer, 8);
+    assert(soundio_shared_ring_buffer_free_count(writer) == 1);
+    soundio_shared_ring_buffer_advance_read_ptr(reader_a, capacity - 6 - 3);
+    assert(memcmp(soundio_shared_ring_buffer_read_ptr(reader_a), "abcdefgh", 8) == 0);
+
+    // a departed reader no longer holds the writer back
+    soundio_shared_ring_buffer_destroy(reader_b);
+    assert(soundio_shared_ring_buffer_free_count(writer) == capacity - 8);
+
+    // nor does one the writer evicted, as if its process had died
+    ok_or_panic(soundio_shared_ring_buffer_attach_fd(dup(soundio_shared_ring_buffer_fd(writer)), &reader_b));
+    soundio_shared_ring_buffer_advance_write_ptr(writer, 8);
+    int stalled_slot = -1;
+    for (int i = 0; i < SOUNDIO_SHARED_RING_BUFFER_MAX_READERS; i += 1) {
+        if (soundio_shared_ring_buffer_reader_lag(writer, i) == 8)
+            stalled_slot = i;
+    }
+    assert(stalled_slot >= 0);
+    assert(soundio_shared_ring_buffer_evict_reader(reader_a, stalled_slot) == SoundIoErrorInvalid);
+    ok_or_panic(soundio_shared_ring_buffer_evict_reader(writer, stalled_slot));
+    assert(soundio_shared_ring_buffer_evict_reader(writer, stalled_slot) == SoundIoErrorInvalid);
+    assert(soundio_shared_ring_buffer_reader_lag(writer, stalled_slot) == -1);
+    assert(!soundio_shared_ring_buffer_is_attached(reader_b));
+    assert(soundio_shared_ring_buffer_is_attached(reader_a));
+    assert(soundio_shared_ring_buffer_fill_count(reader_b) == 0);
+    soundio_shared_ring_buffer_advance_read_ptr(reader_a, 16);
+    assert(soundio_shared_ring_buffer_free_count(writer) == capacity);
+
+    // the evicted reader leaving must not free the slot of its successor
+    struct SoundIoSharedRingBuffer *reader_c;
+    ok_or_panic(soundio_shared_ring_buffer_attach_fd(dup(soundio_shared_ring_buffer_fd(writer)), &reader_c));
+    soundio_shared_ring_buffer_destroy(reader_b);
+    assert(soundio_shared_ring_buffer_is_attached(reader_c));
+    assert(soundio_shared_ring_buffer_reader_lag(writer, stalled_slot) == 0);
+    soundio_shared_ring_buffer_destroy(reader_c);
+
+    soundio_shared_ring_buffer_destroy(reader_a);
+    soundio_shared_ring_buffer_destroy(writer);
+
+    // named buffers
+    char name[64];
+    snprintf(name, sizeof(name), "soundio-test-%d", (int)getpid());
+    ok_or_panic(soundio_shared_ring_buffer_create(name, 4096, SoundIoFormatFloat32LE, 48000, stereo, &writer));
+    assert(soundio_shared_ring_buffer_create(name, 4096, SoundIoFormatFloat32LE, 48000, stereo,
+                &reader_a) == SoundIoErrorInvalid);
+    ok_or_panic(soundio_shared_ring_buffer_attach(name, &reader_a));
+    soundio_shared_ring_buffer_destroy(writer);
+    assert(soundio_shared_ring_buffer_attach(name, &reader_b) == SoundIoErrorInvalid);
+    soundio_shared_ring_buffer_destroy(reader_a);
+}
+
+static int devices_change_count;
+static void on_devices_change_count(struct SoundIo *soundio) {
+    devices_change_count += 1;
+}
+
+static bool event_fd_readable(int fd) {
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+static void test_event_fd(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    int fd;
+    assert(soundio_get_event_fd(soundio, &fd) == SoundIoErrorInvalid);
+
+    soundio->on_devices_change = on_devices_change_count;
+    devices_change_count = 0;
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    ok_or_panic(soundio_get_event_fd(soundio, &fd));
+    assert(fd >= 0);
+
+    assert(event_fd_readable(fd));
+    soundio_dispatch_events(soundio);
+    assert(devices_change_count == 1);
+    assert(!event_fd_readable(fd));
+
+    soundio_wakeup(soundio);
+    assert(event_fd_readable(fd));
+    soundio_dispatch_events(soundio);
+    assert(!event_fd_readable(fd));
+    assert(devices_change_count == 1);
+
+    soundio_destroy(soundio);
+}
+#endif
+
+#if !defined(_WIN32)
+static struct SoundIoAtomicInt scheduled_write_count;
+
+static void scheduled_write_callback(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max)
+{
+    struct SoundIoChannelArea *areas;
+    int frame_count = frame_count_max;
+    ok_or_panic(soundio_outstream_begin_write(outstream, &areas, &frame_count));
+    ok_or_panic(soundio_outstream_end_write(outstream));
+    SOUNDIO_ATOMIC_FETCH_ADD(scheduled_write_count, 1);
+}
+
+static void test_realtime_workers(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    soundio->realtime_worker_count = 1;
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    soundio_flush_events(soundio);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    assert(device);
+
+    SOUNDIO_ATOMIC_STORE(scheduled_write_count, 0);
+    struct SoundIoOutStream *outstreams[2];
+    for (int i = 0; i < 2; i += 1) {
+        struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+        outstream->format = SoundIoFormatFloat32NE;
+        outstream->sample_rate = 48000;
+        outstream->layout = device->layouts[0];
+        outstream->software_latency = 0.02;
+        outstream->write_callback = scheduled_write_callback;
+        outstream->error_callback = error_callback;
+        ok_or_panic(soundio_outstream_open(outstream));
+        ok_or_panic(soundio_outstream_start(outstream));
+        outstreams[i] = outstream;
+    }
+
+    // both streams share the single worker, each refilling every 10ms
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    double start = soundio_os_get_time();
+    while (SOUNDIO_ATOMIC_LOAD(scheduled_write_count) < 10 && soundio_os_get_time() - start < 2.0)
+        soundio_os_cond_timed_wait(cond, NULL, 0.01);
+    soundio_os_cond_destroy(cond);
+    assert(SOUNDIO_ATOMIC_LOAD(scheduled_write_count) >= 10);
+
+    struct SoundIoStreamStats stats;
+    soundio_outstream_get_stats(outstreams[0], &stats);
+    assert(stats.callback_count >= 1);
+    assert(stats.frames_offered > 0);
+    assert(stats.frames_transferred > 0);
+    // the stream keeps running while the snapshot is taken
+    long callbacks = 0;
+    for (int i = 0; i < SOUNDIO_STATS_BUCKET_COUNT; i += 1)
+        callbacks += stats.callback_duration_histogram[i];
+    assert(callbacks >= stats.callback_count - 1 && callbacks <= stats.callback_count + 1);
+    assert(stats.late_wakeup_count == soundio_outstream_deadline_miss_count(outstreams[0]));
+
+    for (int i = 0; i < 2; i += 1)
+        soundio_outstream_destroy(outstreams[i]);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+#endif
+
+#if defined(__linux__)
+static void test_thread_attributes(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    soundio_flush_events(soundio);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    assert(device);
+
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->sample_rate = 48000;
+    outstream->layout = device->layouts[0];
+    outstream->software_latency = 0.02;
+    outstream->write_callback = write_callback;
+    outstream->error_callback = error_callback;
+    outstream->thread_attributes.policy = SoundIoThreadPolicyNormal;
+    outstream->thread_attributes.cpu_mask = 1;
+    ok_or_panic(soundio_outstream_open(outstream));
+    ok_or_panic(soundio_outstream_start(outstream));
+
+    assert(outstream->actual_thread_attributes.policy == SoundIoThreadPolicyNormal);
+    assert(outstream->actual_thread_attributes.cpu_mask == 1);
+    assert(!outstream->actual_thread_attributes.lock_memory);
+
+    soundio_outstream_destroy(outstream);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+#endif
+
+static struct SoundIoAtomicLong freewheel_frames;
+
+static void freewheel_write_callback(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max)
+{
+    struct SoundIoChannelArea *areas;
+    int frame_count = frame_count_max;
+    ok_or_panic(soundio_outstream_begin_write(outstream, &areas, &frame_count));
+    ok_or_panic(soundio_outstream_end_write(outstream));
+    SOUNDIO_ATOMIC_FETCH_ADD(freewheel_frames, frame_count);
+}
+
+static void test_dummy_freewheel(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    soundio->dummy_freewheel = true;
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    soundio_flush_events(soundio);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    assert(device);
+
+    SOUNDIO_ATOMIC_STORE(freewheel_frames, 0);
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->sample_rate = 48000;
+    outstream->layout = device->layouts[0];
+    outstream->software_latency = 0.01;
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = error_callback;
+    outstream->thread_attributes.policy = SoundIoThreadPolicyFifo;
+    ok_or_panic(soundio_outstream_open(outstream));
+    ok_or_panic(soundio_outstream_start(outstream));
+    // a thread that never sleeps must not hold a real time priority
+    assert(outstream->actual_thread_attributes.policy == SoundIoThreadPolicyNormal);
+
+    // a minute of audio must render in well under a minute of wall time
+    long target = 60L * outstream->sample_rate;
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    double start = soundio_os_get_time();
+    while (SOUNDIO_ATOMIC_LOAD(freewheel_frames) < target && soundio_os_get_time() - start < 10.0)
+        soundio_os_cond_timed_wait(cond, NULL, 0.01);
+    soundio_os_cond_destroy(cond);
+    assert(SOUNDIO_ATOMIC_LOAD(freewheel_frames) >= target);
+
+    struct SoundIoStreamStats stats;
+    soundio_outstream_get_stats(outstream, &stats);
+    assert(stats.xrun_count == 0);
+
+    soundio_outstream_destroy(outstream);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+
+static double meter_phase;
+
+static void meter_write_callback(struct SoundIoOutStream *outstream,
+        int frame_count_min, int frame_count_max)
+{
+    struct SoundIoChannelArea *areas;
+    int frame_count = frame_count_max;
+    ok_or_panic(soundio_outstream_begin_write(outstream, &areas, &frame_count));
+    double phase_step = 2.0 * 3.14159265358979323846 * 997.0 / outstream->sample_rate;
+    for (int frame = 0; frame < frame_count; frame += 1) {
+        float sample = (float)(0.5 * sin(meter_phase));
+        meter_phase += phase_step;
+        for (int ch = 0; ch < outstream->layout.channel_count; ch += 1)
+            *(float *)(areas[ch].ptr + areas[ch].step * frame) = sample;
+    }
+    ok_or_panic(soundio_outstream_end_write(outstream));
+    SOUNDIO_ATOMIC_FETCH_ADD(freewheel_frames, frame_count);
+}
+
+static void test_stream_meter(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    soundio->dummy_freewheel = true;
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    soundio_flush_events(soundio);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    assert(device);
+
+    SOUNDIO_ATOMIC_STORE(freewheel_frames, 0);
+    meter_phase = 0.0;
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->sample_rate = 48000;
+    outstream->layout = *soundio_channel_layout_get_builtin(SoundIoChannelLayoutIdStereo);
+    outstream->software_latency = 0.01;
+    outstream->metering = true;
+    outstream->write_callback = meter_write_callback;
+    outstream->error_callback = error_callback;
+    ok_or_panic(soundio_outstream_open(outstream));
+
+    struct SoundIoMeterSnapshot snapshot;
+    soundio_outstream_get_meter(outstream, &snapshot);
+    assert(snapshot.channel_count == 2);
+    assert(snapshot.block_count == 0);
+    assert(isinf(snapshot.momentary_loudness));
+
+    ok_or_panic(soundio_outstream_start(outstream));
+    long target = 5L * outstream->sample_rate;
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    double start = soundio_os_get_time();
+    while (SOUNDIO_ATOMIC_LOAD(freewheel_frames) < target && soundio_os_get_time() - start < 10.0)
+        soundio_os_cond_timed_wait(cond, NULL, 0.01);
+    soundio_os_cond_destroy(cond);
+    assert(SOUNDIO_ATOMIC_LOAD(freewheel_frames) >= target);
+
+    // a 997 Hz sine at -6 dBFS in both channels of a stereo stream reads
+    // -6 LUFS
+    soundio_outstream_get_meter(outstream, &snapshot);
+    assert(snapshot.block_count >= 40);
+    for (int ch = 0; ch < 2; ch += 1) {
+        assert(fabs(snapshot.channels[ch].peak - 0.5) < 0.001);
+        assert(fabs(snapshot.channels[ch].rms - 0.5 / sqrt(2.0)) < 0.001);
+        assert(snapshot.channels[ch].true_peak >= snapshot.channels[ch].peak);
+        assert(snapshot.channels[ch].true_peak < 0.52);
+    }
+    assert(fabs(snapshot.momentary_loudness + 6.02) < 0.2);
+    assert(fabs(snapshot.short_term_loudness + 6.02) < 0.2);
+
+    soundio_outstream_destroy(outstream);
+
+    // formats the converter cannot read open without a meter
+    outstream = soundio_outstream_create(device);
+    outstream->format = SoundIoFormatU8;
+    outstream->metering = true;
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = error_callback;
+    ok_or_panic(soundio_outstream_open(outstream));
+    soundio_outstream_get_meter(outstream, &snapshot);
+    assert(snapshot.channel_count == 0);
+    soundio_outstream_destroy(outstream);
+
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+
+#define COMMAND_PRODUCERS 4
+#define COMMANDS_PER_PRODUCER 2000
+#define COMMAND_SWAPS 50
+
+static struct SoundIoOutStream *command_outstream;
+// only touched by the stream thread
+static int command_next_index[COMMAND_PRODUCERS];
+static int *command_buffer;
+static struct SoundIoAtomicLong commands_received;
+static struct SoundIoAtomicInt command_swaps_done;
+static struct SoundIoAtomicInt command_buffers_freed;
+
+static void count_freed_buffer(void *ptr) {
+    free(ptr);
+    SOUNDIO_ATOMIC_FETCH_ADD(command_buffers_freed, 1);
+}
+
+static void command_callback(struct SoundIoOutStream *outstream, const struct SoundIoCommand *command) {
+    if (command->ptr) {
+        int *old_buffer = command_buffer;
+        command_buffer = (int *)command->ptr;
+        if (old_buffer)
+            ok_or_panic(soundio_outstream_defer_free(outstream, old_buffer, count_freed_buffer));
+        SOUNDIO_ATOMIC_FETCH_ADD(command_swaps_done, 1);
+        return;
+    }
+    // commands from one producer arrive in the order they were posted
+    assert(command->type >= 0 && command->type < COMMAND_PRODUCERS);
+    assert(command->index == command_next_index[command->type]);
+    command_next_index[command->type] += 1;
+    SOUNDIO_ATOMIC_FETCH_ADD(commands_received, 1);
+}
+
+static void command_producer_run(void *arg) {
+    int producer = (int)(intptr_t)arg;
+    for (int i = 0; i < COMMANDS_PER_PRODUCER; i += 1) {
+        struct SoundIoCommand command = {producer, i, 0.0, NULL};
+        enum SoundIoError err;
+        while ((err = soundio_outstream_post_command(command_outstream, &command)))
+            assert(err == SoundIoErrorSystemResources);
+    }
+}
+
+static void wait_for_long(struct SoundIoAtomicLong *value, long target) {
+    double start = soundio_os_get_time();
+    while (SOUNDIO_ATOMIC_LOAD((*value)) < target && soundio_os_get_time() - start < 10.0) {}
+    assert(SOUNDIO_ATOMIC_LOAD((*value)) == target);
+}
+
+static void test_stream_commands(void) {
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    // a freewheeling stream thread would starve the producers on one CPU
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    soundio_flush_events(soundio);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio,
+            soundio_default_output_device_index(soundio));
+    assert(device);
+
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = error_callback;
+    outstream->command_queue_capacity = 16;
+    assert(soundio_outstream_open(outstream) == SoundIoErrorInvalid);
+    soundio_outstream_destroy(outstream);
+
+    outstream = soundio_outstream_create(device);
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = error_callback;
+    ok_or_panic(soundio_outstream_open(outstream));
+    struct SoundIoCommand command = {0, 0, 0.0, NULL};
+    assert(soundio_outstream_post_command(outstream, &command) == SoundIoErrorInvalid);
+    soundio_outstream_destroy(outstream);
+
+    outstream = soundio_outstream_create(device);
+    command_outstream = outstream;
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->sample_rate = 48000;
+    outstream->software_latency = 0.01;
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = error_callback;
+    outstream->command_queue_capacity = 256;
+    outstream->command_callback = command_callback;
+    memset(command_next_index, 0, sizeof(command_next_index));
+    command_buffer = NULL;
+    SOUNDIO_ATOMIC_STORE(commands_received, 0);
+    SOUNDIO_ATOMIC_STORE(command_swaps_done, 0);
+    SOUNDIO_ATOMIC_STORE(command_buffers_freed, 0);
+    ok_or_panic(soundio_outstream_open(outstream));
+    ok_or_panic(soundio_outstream_start(outstream));
+
+    struct SoundIoOsThread *producers[COMMAND_PRODUCERS];
+    for (int i = 0; i < COMMAND_PRODUCERS; i += 1)
+        ok_or_panic(soundio_os_thread_create(command_producer_run, (void *)(intptr_t)i, NULL, &producers[i]));
+    for (int i = 0; i < COMMAND_PRODUCERS; i += 1)
+        soundio_os_thread_destroy(producers[i]);
+    wait_for_long(&commands_received, (long)COMMAND_PRODUCERS * COMMANDS_PER_PRODUCER);
+
+    // buffers replaced on the stream thread are freed here, not there
+    for (int i = 0; i < COMMAND_SWAPS; i += 1) {
+        int *buffer = ALLOCATE(int, 1024);
+        assert(buffer);
+        struct SoundIoCommand swap = {0, 0, 0.0, buffer};
+        ok_or_panic(soundio_outstream_post_command(outstream, &swap));
+        double start = soundio_os_get_time();
+        while (SOUNDIO_ATOMIC_LOAD(command_swaps_done) <= i && soundio_os_get_time() - start < 10.0) {}
+        assert(SOUNDIO_ATOMIC_LOAD(command_swaps_done) == i + 1);
+        soundio_outstream_collect_garbage(outstream);
+        assert(SOUNDIO_ATOMIC_LOAD(command_buffers_freed) == i);
+    }
+
+    soundio_outstream_destroy(outstream);
+    free(command_buffer);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+
+static struct SoundIoAtomicInt fault_stream_errors;
+static int fault_devices_changes;
+static int fault_disconnects;
+
+static void fault_error_callback(struct SoundIoOutStream *outstream, enum SoundIoError err) {
+    assert(err == SoundIoErrorStreaming);
+    SOUNDIO_ATOMIC_FETCH_ADD(fault_stream_errors, 1);
+}
+
+static void fault_devices_change_callback(struct SoundIo *soundio) {
+    fault_devices_changes += 1;
+}
+
+static void fault_backend_disconnect_callback(struct SoundIo *soundio, enum SoundIoError err) {
+    assert(err == SoundIoErrorBackendDisconnected);
+    fault_disconnects += 1;
+}
+
+static void run_fault_scenario(const struct SoundIoDummyFault *faults, int fault_count,
+        struct SoundIoStreamStats *out_stats)
+{
+    struct SoundIo *soundio = soundio_create();
+    assert(soundio);
+    soundio->dummy_freewheel = true;
+    soundio->dummy_faults = faults;
+    soundio->dummy_fault_count = fault_count;
+    soundio->on_devices_change = fault_devices_change_callback;
+    soundio->on_backend_disconnect = fault_backend_disconnect_callback;
+    ok_or_panic(soundio_connect_backend(soundio, SoundIoBackendDummy));
+    fault_devices_changes = 0;
+    fault_disconnects = 0;
+    soundio_flush_events(soundio);
+    assert(fault_devices_changes == 1);
+    assert(soundio_output_device_count(soundio) == 1);
+    struct SoundIoDevice *device = soundio_get_output_device(soundio, 0);
+    assert(device);
+
+    SOUNDIO_ATOMIC_STORE(fault_stream_errors, 0);
+    struct SoundIoOutStream *outstream = soundio_outstream_create(device);
+    outstream->format = SoundIoFormatFloat32NE;
+    outstream->sample_rate = 48000;
+    outstream->layout = device->layouts[0];
+    outstream->software_latency = 0.01;
+    outstream->write_callback = freewheel_write_callback;
+    outstream->error_callback = fault_error_callback;
+    ok_or_panic(soundio_outstream_open(outstream));
+    ok_or_panic(soundio_outstream_start(outstream));
+
+    // every scenario ends with the stream failing
+    struct SoundIoOsCond *cond = soundio_os_cond_create();
+    double start = soundio_os_get_time();
+    while (SOUNDIO_ATOMIC_LOAD(fault_stream_errors) == 0 && soundio_os_get_time() - start < 10.0)
+        soundio_os_cond_timed_wait(cond, NULL, 0.01);
+    soundio_os_cond_destroy(cond);
+    assert(SOUNDIO_ATOMIC_LOAD(fault_stream_errors) == 1);
+
+    soundio_flush_events(soundio);
+    soundio_outstream_get_stats(outstream, out_stats);
+    soundio_outstream_destroy(outstream);
+    soundio_device_unref(device);
+    soundio_destroy(soundio);
+}
+
+static void test_dummy_faults(void) {
+    struct SoundIoStreamStats stats;
+
+    struct SoundIoDummyFault rate_change[] = {
+        {SoundIoDummyFaultXrun, 48000, 0.0, 0},
+        {SoundIoDummyFaultStall, 72000, 0.5, 0},
+        {SoundIoDummyFaultDevicesChange, 96000, 0.0, 0},
+        {SoundIoDummyFaultSampleRateChange, 144000, 0.0, 44100},
+    };
+    run_fault_scenario(rate_change, 4, &stats);
+    // the injected xrun plus the one caused by the stall
+    assert(stats.xrun_count == 2);
+    assert(fault_devices_changes == 2);
+    assert(fault_disconnects == 0);
+
+    struct SoundIoDummyFault disconnect[] = {
+        {SoundIoDummyFaultJitter, 0, 0.001, 0},
+        {SoundIoDummyFaultDisconnect, 4800, 0.0, 0},
+    };
+    run_fault_scenario(disconnect, 2, &stats);
+    assert(stats.xrun_count == 0);
+    assert(fault_devices_changes == 1);
+    assert(fault_disconnects == 1);
+}
+
+#if defined(SOUNDIO_RT_GUARD)
+static void test_rt_guard(void) {
+    long before = soundio_rt_guard_violation_count();
+    assert(before >= 0);
+    void *volatile ptr = malloc(16);
+    free(ptr);
+    assert(soundio_rt_guard_violation_count() == before);
+
+    soundio_rt_guard_enter();
+    ptr = malloc(16);
+    free(ptr);
+    soundio_rt_guard_leave();
+    assert(soundio_rt_guard_violation_count() == before + 2);
+}
+#endif
+
+static void test_stats_buckets(void) {
+    // bucket 0 is below 2 microseconds, bucket n is [2^n, 2^(n+1))
+    assert(soundio_stats_bucket(0.0) == 0);
+    assert(soundio_stats_bucket(1.5e-6) == 0);
+    assert(soundio_stats_bucket(2.5e-6) == 1);
+    assert(soundio_stats_bucket(3.5e-6) == 1);
+    assert(soundio_stats_bucket(4.5e-6) == 2);
+    assert(soundio_stats_bucket(7.5e-6) == 2);
+    assert(soundio_stats_bucket(8.5e-6) == 3);
+    assert(soundio_stats_bucket(1023.5e-6) == 9);
+    assert(soundio_stats_bucket(1024.5e-6) == 10);
+    assert(soundio_stats_bucket(60.0) == SOUNDIO_STATS_BUCKET_COUNT - 1);
+}
+
 static void test_nearest_sample_rate(void) {
     struct SoundIoDevice device;
     struct SoundIoSampleRateRange sample_rates[2] = {
@@ -220,9 +1301,32 @@ static struct Test tests[] = {
     {"os_get_time", test_os_get_time},
     {"create output stream", test_create_outstream},
     {"mirrored memory", test_mirrored_memory},
+    {"ring buffer pool", test_ring_buffer_pool},
     {"soundio_device_nearest_sample_rate", test_nearest_sample_rate},
+    {"stats buckets", test_stats_buckets},
+    {"channel mixer", test_channel_mixer},
+    {"converter", test_converter},
+    {"converter dither", test_converter_dither},
     {"ring buffer basic", test_ring_buffer_basic},
     {"ring buffer threaded", test_ring_buffer_threaded},
+    {"ring buffer wait", test_ring_buffer_wait},
+    {"frame ring buffer", test_frame_ring_buffer},
+    {"broadcast ring buffer", test_broadcast_ring_buffer},
+#if !defined(_WIN32)
+    {"shared ring buffer", test_shared_ring_buffer},
+    {"event fd", test_event_fd},
+    {"realtime workers", test_realtime_workers},
+#endif
+#if defined(__linux__)
+    {"thread attributes", test_thread_attributes},
+#endif
+    {"dummy freewheel", test_dummy_freewheel},
+    {"dummy fault injection", test_dummy_faults},
+    {"stream meter", test_stream_meter},
+    {"stream commands", test_stream_commands},
+#if defined(SOUNDIO_RT_GUARD)
+    {"realtime guard", test_rt_guard},
+#endif
     {NULL, NULL},
 };
 